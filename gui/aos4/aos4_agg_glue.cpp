@@ -392,6 +392,7 @@ AOS4AggGlue::resize(int width, int height)
       return;
     }
 
+    _agg_renderer->sync();
     delete [] _offscreenbuf;
     prepDrawingArea(width, height);
 }
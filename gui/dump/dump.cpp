@@ -391,6 +391,7 @@ DumpGui::setRenderHandlerSize(int width, int height)
 
     // Reallocate the buffer when it shrinks or grows.
     if (newBufferSize != _offscreenbuf_size) {
+        _agg_renderer->sync();
         try {
             _offscreenbuf.reset(new unsigned char[newBufferSize]);
             log_debug("DUMP-AGG: %i bytes offscreen buffer allocated",
@@ -113,6 +113,7 @@ FltkAggGlue::resize(int width, int height)
       return;
     }
 
+    _renderer->sync();
     delete [] _offscreenbuf;
     initBuffer(width, height);
 }
@@ -48,6 +48,7 @@ GtkAggGlue::GtkAggGlue()
 GtkAggGlue::~GtkAggGlue()
 {
     if (_offscreenbuf) {
+        if (_agg_renderer) _agg_renderer->sync();
         gdk_image_destroy(_offscreenbuf);
     }
 }
@@ -116,6 +117,8 @@ GtkAggGlue::setRenderHandlerSize(int width, int height)
     }
 
     if (_offscreenbuf) {
+        // A frame may be being drawn to it in the background.
+        _agg_renderer->sync();
         gdk_image_destroy(_offscreenbuf);
     }
 
@@ -221,6 +221,9 @@ GtkAggVaapiGlue::resetRenderSurface(unsigned int width, unsigned int height)
     // dprintf("GtkAggVaapiGlue::resetRenderSurface(): size %ux%u\n",
     //         width, height);
 
+    // The old image may still be drawn to in the background.
+    if (_agg_renderer) _agg_renderer->sync();
+
     _vaapi_surface.reset(new VaapiSurface(width, height));
     _vaapi_image.reset(new VaapiImage(aligned_width, height, _vaapi_image_format));
     _vaapi_image_width = width;
@@ -38,6 +38,9 @@
 #include "RunResources.h"
 #include "StreamProvider.h"
 #include "ScreenShotter.h"
+#include "RenderThread.h"
+#include "DisplaySnapshot.h"
+#include "rc.h"
 #include "Movie.h"
 
 #ifdef GNASH_FPS_DEBUG
@@ -176,6 +179,9 @@ Gui::Gui(unsigned long xid, float scale, bool loop, RunResources& r)
 
 Gui::~Gui()
 {
+    // The frame being drawn is finished before the renderer goes.
+    _renderThread.reset();
+
     if ( _movieDef.get() ) {
         log_debug("~Gui - _movieDef refcount: %d", _movieDef->get_ref_count());
     }
@@ -215,6 +221,8 @@ Gui::unsetFullscreen()
 void
 Gui::quit()
 {
+    finishRendering();
+
     // Take a screenshot of the last frame if required.
     if (_screenShotter.get() && _renderer.get()) {
         Display dis(*this, *_stage);
@@ -434,6 +442,9 @@ Gui::resize_view(int width, int height)
     assert(width > 0);
     assert(height > 0);
 
+    // Frames drawn at the old size are done with before it changes.
+    finishRendering();
+
     if (_stage && _started) {
         _stage->setDimensions(width, height);
     }
@@ -687,12 +698,38 @@ Gui::notify_key_event(gnash::key::code k, int modifier, bool pressed)
     
 }
 
+void
+Gui::finishRendering()
+{
+    if (_renderThread.get() && _renderThread->wait()) renderBuffer();
+}
+
 bool
-Gui::display(movie_root* m)
+Gui::renderInBackground()
+{
+    if (_renderThread.get()) return true;
+
+    // Screenshots need the frame drawn at once.
+    if (!_renderer.get() || _screenShotter.get()) return false;
+
+    if (!RcInitFile::getDefaultInstance().renderInBackground() ||
+            !_renderer->supportsBackgroundDrawing()) {
+        return false;
+    }
+
+    _renderThread.reset(new RenderThread(*_renderer));
+    return true;
+}
+
+bool
+Gui::display(movie_root* m, bool background)
 {
     assert(m == _stage); // why taking this arg ??
 
     assert(_started);
+
+    // The previous frame must be on screen before anything else is.
+    finishRendering();
     
     InvalidatedRanges changed_ranges;
     bool redraw_flag;
@@ -720,6 +757,20 @@ Gui::display(movie_root* m)
         // Use multi ranges only when GUI/Renderer supports it
         // (Useless CPU overhead, otherwise)
         changed_ranges.setSingleMode(!want_multiple_regions());
+
+        // Align ranges to the renderer's tiles if it wants them. A
+        // pixel is 20 / _xscale twips, and the tiles start at the top
+        // left pixel. Tiles are whole twips, so when a twip is larger
+        // than a tile they are a twip wide and only roughly aligned.
+        if (_renderer.get()) {
+            const int tile = _renderer->getInvalidatedTileSize();
+            if (tile > 0) {
+                const point corner = _renderer->pixel_to_world(0, 0);
+                const std::int32_t twips = tile * 20 / _xscale;
+                changed_ranges.setTileSize(std::max<std::int32_t>(twips, 1),
+                        corner.x, corner.y);
+            }
+        }
         
         // scan through all sprites to compute invalidated bounds  
         m->add_invalidated_bounds(changed_ranges, false);
@@ -787,16 +838,32 @@ Gui::display(movie_root* m)
         
         // TODO: should this be called even if we're late ?
         beforeRendering();
+
+        // The frame is recorded first, so that only what changed since
+        // the last frame is drawn. When drawing in the background, it is
+        // drawn by the render thread while the movie advances; otherwise
+        // it is drawn at once and needn't be copied.
+        std::unique_ptr<DisplaySnapshot> snapshot;
+        const bool inBackground = background && renderInBackground();
+        if (_renderer.get()) {
+            snapshot.reset(new DisplaySnapshot(*_renderer, inBackground));
+        }
         
         // Render the frame, if not late.
         // It's up to the GUI/renderer combination
         // to do any clipping, if desired.     
-        m->display();
+        if (snapshot.get()) m->display(*snapshot);
+        else {
+            _drawn.clear();
+            m->display();
+        }
         
         // show invalidated region using a red rectangle
         // (Flash debug style)
         IF_DEBUG_REGION_UPDATES (
-            if (_renderer.get() && !changed_ranges.isWorld()) {
+            Renderer* renderer = snapshot.get() ? snapshot.get() :
+                _renderer.get();
+            if (renderer && !changed_ranges.isWorld()) {
                 for (size_t rno = 0; rno < changed_ranges.size(); rno++) {
                     const geometry::Range2d<int>& bounds = 
                         changed_ranges.getRange(rno);
@@ -813,12 +880,24 @@ Gui::display(movie_root* m)
                         point(xmin, ymax)
                     };
                     
-                    _renderer->draw_poly(box, rgba(0,0,0,0), rgba(255,0,0,255),
-                                         SWFMatrix(), false);
+                    renderer->draw_poly(box, rgba(0,0,0,0), rgba(255,0,0,255),
+                                        SWFMatrix(), false);
                     
                 }
             }
         );
+
+        if (snapshot.get() &&
+                !drawChanges(snapshot->commands(), changed_ranges)) {
+            return true;
+        }
+
+        if (inBackground) {
+            // Shown by the next finishRendering().
+            _renderThread->draw(std::move(snapshot));
+            return true;
+        }
+        if (snapshot.get()) snapshot->replay(*_renderer);
         
         // show frame on screen
         renderBuffer();	
@@ -827,6 +906,29 @@ Gui::display(movie_root* m)
     return true;
 }
 
+bool
+Gui::drawChanges(CommandBuffer& frame, const InvalidatedRanges& changed)
+{
+    InvalidatedRanges damage;
+    damage.inheritConfig(changed);
+    if (!changed.isWorld()) frame.damage(_drawn, changed, damage);
+
+    frame.retain(_drawn, changed);
+    _drawn.swap(frame);
+
+    // Everything is drawn when the whole stage changed.
+    if (changed.isWorld()) return true;
+    if (damage.isNull()) return false;
+
+    // As for the changed ranges, this avoids anti-aliasing issues.
+    damage.growBy(40.0f / _xscale);
+    damage.intersect(changed);
+    damage.combineRanges();
+
+    setInvalidatedRegions(damage);
+    return true;
+}
+
 void
 Gui::play()
 {
@@ -972,7 +1074,7 @@ Gui::advanceMovie(bool doDisplay)
 #endif
     
     if (doDisplay && visible()) {
-        display(m);
+        display(m, true);
     }
     
     if (!loops()) {
@@ -985,6 +1087,7 @@ Gui::advanceMovie(bool doDisplay)
     }
     
     if (_screenShotter.get() && _renderer.get()) {
+        finishRendering();
         _screenShotter->screenShot(*_renderer, _advances, doDisplay ? nullptr : &dis);
     }
     
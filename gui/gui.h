@@ -31,6 +31,7 @@
 #include <functional>
 
 #include "snappingrange.h"  // for InvalidatedRanges
+#include "CommandBuffer.h"
 #include "GnashKey.h"
 #include "VirtualClock.h"
 #include "SystemClock.h"
@@ -65,6 +66,7 @@
 namespace gnash {
     class SWFRect;
     class ScreenShotter;
+    class RenderThread;
     class RunResources;
     class movie_root;
     class movie_definition;
@@ -551,7 +553,32 @@ private:
     /// Window pixel Y offset of stage origin
     std::int32_t _yoffset;
 
-    bool display(movie_root* m);
+    /// Render the stage if it changed, and show it.
+    //
+    /// @param m            The stage.
+    /// @param background   Whether the frame may be drawn by the render
+    ///                     thread, if there is one. It is then shown by
+    ///                     the next call to finishRendering().
+    bool display(movie_root* m, bool background = false);
+
+    /// Show the frame drawn by the render thread, if any.
+    void finishRendering();
+
+    /// Set the invalidated regions to the parts of a frame that differ
+    /// from what is drawn.
+    //
+    /// The frame's commands then describe what is drawn.
+    ///
+    /// @param frame    The commands of the frame, drawn to the changed
+    ///                 ranges.
+    /// @param changed  The ranges of the stage that may have changed.
+    /// @return         false if nothing needs drawing.
+    bool drawChanges(CommandBuffer& frame, const InvalidatedRanges& changed);
+
+    /// Whether frames should be drawn by the render thread.
+    //
+    /// This starts the thread when first needed.
+    bool renderInBackground();
     
 #ifdef GNASH_FPS_DEBUG
     unsigned int fps_counter;
@@ -605,6 +632,12 @@ private:
     /// Checked on each advance for screenshot activity if it exists.
     std::unique_ptr<ScreenShotter> _screenShotter;
 
+    /// Draws frames while the movie advances, if enabled.
+    std::unique_ptr<RenderThread> _renderThread;
+
+    /// The commands last drawn, to compare with the next frame's.
+    CommandBuffer _drawn;
+
 #ifdef ENABLE_KEYBOARD_MOUSE_MOVEMENTS 
     int _xpointer;
     int _ypointer;
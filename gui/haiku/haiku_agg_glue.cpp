@@ -378,6 +378,7 @@ HaikuAggGlue::prepDrawingArea(int width, int height, std::uint32_t sdl_flags)
 
     if (_bufsize != (unsigned)bufsize)
     {
+        _agg_renderer->sync();
         if (_xid != 0 && _bufsize != 0)
         {
             if (msync(_sharebuf, _bufsize, MS_INVALIDATE) != 0)
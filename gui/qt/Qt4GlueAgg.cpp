@@ -42,6 +42,8 @@ Qt4AggGlue::Qt4AggGlue()
 
 Qt4AggGlue::~Qt4AggGlue()
 {
+    // The buffer goes with us.
+    if (_renderer) _renderer->sync();
 }
 
 bool
@@ -75,6 +77,8 @@ Qt4AggGlue::initBuffer(int width, int height)
 
     int bufsize = (width * height * depth_bytes / CHUNK_SIZE + 1) * CHUNK_SIZE;
 
+    // Don't free the old buffer while a frame is drawn to it.
+    _renderer->sync();
     _offscreenbuf.reset(new unsigned char[bufsize]);
 
     Renderer_agg_base * renderer =
@@ -48,6 +48,7 @@ KdeAggGlue::KdeAggGlue()
 
 KdeAggGlue::~KdeAggGlue()
 {
+    if (_renderer) _renderer->sync();
 }
 
 bool
@@ -81,6 +82,8 @@ KdeAggGlue::initBuffer(int width, int height)
 
     int bufsize = (width * height * depth_bytes / CHUNK_SIZE + 1) * CHUNK_SIZE;
 
+    // A frame may still be drawn to the old buffer in the background.
+    _renderer->sync();
     _offscreenbuf.reset(new unsigned char[bufsize]);
 
     // Only the AGG renderer has the function init_buffer, which is *not* part of
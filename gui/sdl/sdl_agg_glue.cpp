@@ -43,6 +43,7 @@ _agg_renderer(nullptr)
 SdlAggGlue::~SdlAggGlue()
 {
 //    GNASH_REPORT_FUNCTION;
+    if (_agg_renderer) _agg_renderer->sync();
     SDL_FreeSurface(_sdl_surface);
     SDL_FreeSurface(_screen);
     delete [] _offscreenbuf;
@@ -127,6 +128,13 @@ SdlAggGlue::prepDrawingArea(int width, int height, std::uint32_t sdl_flags)
 
     int bufsize = static_cast<int>(width * height * depth_bytes / CHUNK_SIZE + 1) * CHUNK_SIZE;
 
+    // Replace any previous buffer once no frame is drawn to it.
+    if (_offscreenbuf) {
+        _agg_renderer->sync();
+        SDL_FreeSurface(_sdl_surface);
+        delete [] _offscreenbuf;
+    }
+
     _offscreenbuf = new unsigned char[bufsize];
 
     log_debug (_("SDL-AGG: %i byte offscreen buffer allocated"), bufsize);
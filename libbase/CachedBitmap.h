@@ -20,6 +20,8 @@
 #ifndef GNASH_BITMAP_INFO_H
 #define GNASH_BITMAP_INFO_H
 
+#include <cstddef>
+
 #include "ref_counted.h"
 #include "dsodefs.h"
 
@@ -57,6 +59,11 @@ public:
     /// A disposed CachedBitmap has no data and should not be rendered.
     virtual bool disposed() const = 0;
 
+    /// Return the approximate number of bytes held by this CachedBitmap.
+    //
+    /// This is used to account for the memory used by movie definitions.
+    virtual size_t memoryUsage() const { return 0; }
+
 };
 	
 } // namespace gnash
@@ -0,0 +1,67 @@
+// Checksum.h: 64-bit FNV-1a hashes, for Gnash.
+//
+//   Copyright (C) 2012 Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifndef GNASH_CHECKSUM_H
+#define GNASH_CHECKSUM_H
+
+#include <cstdint>
+
+#include "Point2d.h"
+
+namespace gnash {
+
+/// A 64-bit FNV-1a hash of some values.
+//
+/// This is fast and spreads similar values well, which is all caches
+/// keyed on drawn content need. It is not for security.
+class Checksum
+{
+public:
+
+    /// The hash of no values.
+    static const std::uint64_t basis = 14695981039346656037ULL;
+
+    /// Continue a hash.
+    //
+    /// @param hash     The value of a Checksum, to which values are
+    ///                 then added.
+    explicit Checksum(std::uint64_t hash = basis) : _hash(hash) {}
+
+    void add(std::uint32_t v) {
+        for (int i = 0; i < 4; ++i) {
+            _hash ^= (v >> (i * 8)) & 0xff;
+            _hash *= 1099511628211ULL;
+        }
+    }
+
+    void add(const point& p) {
+        add(p.x);
+        add(p.y);
+    }
+
+    std::uint64_t value() const {
+        return _hash;
+    }
+
+private:
+    std::uint64_t _hash;
+};
+
+} // namespace gnash
+
+#endif
@@ -0,0 +1,306 @@
+// DiskCache.cpp: persistent cache of decoded data, for Gnash.
+//
+//   Copyright (C) 2012 Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+//
+
+#include "DiskCache.h"
+
+#include <sstream>
+#include <iomanip>
+#include <vector>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <utime.h>
+
+#include "GnashFileUtilities.h"
+#include "IOChannel.h"
+#include "tu_file.h"
+#include "rc.h"
+#include "log.h"
+
+namespace gnash {
+
+namespace {
+
+const char* const entrySuffix = ".cache";
+
+struct Entry
+{
+    std::string path;
+    time_t mtime;
+    size_t size;
+};
+
+bool
+olderThan(const Entry& a, const Entry& b)
+{
+    return a.mtime < b.mtime;
+}
+
+/// List the entries of a cache directory.
+std::vector<Entry>
+listEntries(const std::string& dir)
+{
+    std::vector<Entry> entries;
+
+    DIR* d = opendir(dir.c_str());
+    if (!d) return entries;
+
+    const size_t suffixLength = std::strlen(entrySuffix);
+
+    while (struct dirent* ent = readdir(d)) {
+        const std::string name(ent->d_name);
+        if (name.size() <= suffixLength ||
+                name.compare(name.size() - suffixLength, suffixLength,
+                    entrySuffix)) {
+            continue;
+        }
+
+        Entry e;
+        e.path = dir + "/" + name;
+
+        struct stat st;
+        if (stat(e.path.c_str(), &st) < 0) continue;
+        e.mtime = st.st_mtime;
+        e.size = st.st_size;
+        entries.push_back(e);
+    }
+    closedir(d);
+    return entries;
+}
+
+inline std::uint32_t
+rotr(std::uint32_t x, int n)
+{
+    return (x >> n) | (x << (32 - n));
+}
+
+/// Add a 64-byte block to a SHA-256 digest.
+void
+sha256Block(std::uint32_t* h, const std::uint8_t* p)
+{
+    static const std::uint32_t k[64] = {
+        0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b,
+        0x59f111f1, 0x923f82a4, 0xab1c5ed5, 0xd807aa98, 0x12835b01,
+        0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7,
+        0xc19bf174, 0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc,
+        0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da, 0x983e5152,
+        0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147,
+        0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc,
+        0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+        0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819,
+        0xd6990624, 0xf40e3585, 0x106aa070, 0x19a4c116, 0x1e376c08,
+        0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f,
+        0x682e6ff3, 0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+        0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+    };
+
+    std::uint32_t w[64];
+    for (int i = 0; i < 16; ++i) {
+        w[i] = p[i * 4] << 24 | p[i * 4 + 1] << 16 | p[i * 4 + 2] << 8 |
+            p[i * 4 + 3];
+    }
+    for (int i = 16; i < 64; ++i) {
+        const std::uint32_t s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^
+            (w[i - 15] >> 3);
+        const std::uint32_t s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^
+            (w[i - 2] >> 10);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+
+    std::uint32_t v[8];
+    std::copy(h, h + 8, v);
+    for (int i = 0; i < 64; ++i) {
+        const std::uint32_t s1 = rotr(v[4], 6) ^ rotr(v[4], 11) ^
+            rotr(v[4], 25);
+        const std::uint32_t ch = (v[4] & v[5]) ^ (~v[4] & v[6]);
+        const std::uint32_t t1 = v[7] + s1 + ch + k[i] + w[i];
+        const std::uint32_t s0 = rotr(v[0], 2) ^ rotr(v[0], 13) ^
+            rotr(v[0], 22);
+        const std::uint32_t maj = (v[0] & v[1]) ^ (v[0] & v[2]) ^
+            (v[1] & v[2]);
+        std::copy_backward(v, v + 7, v + 8);
+        v[4] += t1;
+        v[0] = t1 + s0 + maj;
+    }
+    for (int i = 0; i < 8; ++i) h[i] += v[i];
+}
+
+/// The SHA-256 digest of some data in hexadecimal, as in FIPS 180-4.
+std::string
+sha256(const std::uint8_t* data, size_t size)
+{
+    std::uint32_t h[8] = {
+        0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+        0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+    };
+
+    const std::uint64_t bits = static_cast<std::uint64_t>(size) * 8;
+    for (; size >= 64; data += 64, size -= 64) sha256Block(h, data);
+
+    // Pad the rest with a one bit, zeros and the length in bits.
+    std::uint8_t last[128] = { 0 };
+    std::copy(data, data + size, last);
+    last[size] = 0x80;
+    const size_t end = size < 56 ? 64 : 128;
+    for (int i = 0; i < 8; ++i) last[end - 1 - i] = bits >> (i * 8);
+    sha256Block(h, last);
+    if (end == 128) sha256Block(h, last + 64);
+
+    std::ostringstream ss;
+    ss << std::hex << std::setfill('0');
+    for (std::uint32_t v : h) ss << std::setw(8) << v;
+    return ss.str();
+}
+
+} // anonymous namespace
+
+DiskCache::DiskCache(std::string dir, size_t limit)
+    :
+    _dir(std::move(dir)),
+    _limit(limit),
+    _size(static_cast<size_t>(-1))
+{
+}
+
+DiskCache&
+DiskCache::getDefaultInstance()
+{
+    const RcInitFile& rc = RcInitFile::getDefaultInstance();
+    static DiskCache cache(rc.getMovieCacheDir(),
+            static_cast<size_t>(rc.getMovieCacheLimit()) << 20);
+    return cache;
+}
+
+std::string
+DiskCache::makeKey(const std::string& prefix, const std::uint8_t* data,
+        size_t size)
+{
+    // Entries are trusted to match their key, so it must not collide.
+    return prefix + '-' + sha256(data, size);
+}
+
+std::string
+DiskCache::path(const std::string& key) const
+{
+    return _dir + "/" + key + entrySuffix;
+}
+
+std::unique_ptr<IOChannel>
+DiskCache::get(const std::string& key) const
+{
+    if (!enabled()) return std::unique_ptr<IOChannel>();
+
+    const std::string file = path(key);
+    std::unique_ptr<IOChannel> ret = makeMappedFileChannel(file.c_str());
+
+    // Mark as recently used.
+    if (ret.get()) utime(file.c_str(), nullptr);
+    return ret;
+}
+
+std::unique_ptr<IOChannel>
+DiskCache::create(const std::string& key, std::string& temp)
+{
+    if (!enabled()) return std::unique_ptr<IOChannel>();
+
+    // Each writer gets its own file, even for the same key.
+    std::string file = path(key) + ".XXXXXX";
+    if (!mkdirRecursive(file)) {
+        log_error(_("Could not create movie cache directory %s"), _dir);
+        return std::unique_ptr<IOChannel>();
+    }
+
+    const int fd = mkstemp(&file[0]);
+    if (fd < 0) return std::unique_ptr<IOChannel>();
+
+    FILE* fp = fdopen(fd, "wb");
+    if (!fp) {
+        ::close(fd);
+        std::remove(file.c_str());
+        return std::unique_ptr<IOChannel>();
+    }
+
+    temp = file;
+    return makeFileChannel(fp, true);
+}
+
+bool
+DiskCache::commit(const std::string& key, const std::string& temp,
+        bool success)
+{
+    if (!enabled() || temp.empty()) return false;
+
+    if (!success) {
+        std::remove(temp.c_str());
+        return false;
+    }
+
+    const std::string file = path(key);
+    if (std::rename(temp.c_str(), file.c_str())) {
+        log_error(_("Could not store %s in the movie cache: %s"), key,
+                std::strerror(errno));
+        std::remove(temp.c_str());
+        return false;
+    }
+
+    struct stat st;
+    if (stat(file.c_str(), &st) < 0) return false;
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_size != static_cast<size_t>(-1)) _size += st.st_size;
+    trim(file);
+    return true;
+}
+
+void
+DiskCache::remove(const std::string& key)
+{
+    if (!enabled()) return;
+    log_debug("Removing invalid movie cache entry %s", key);
+    std::remove(path(key).c_str());
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    _size = static_cast<size_t>(-1);
+}
+
+void
+DiskCache::trim(const std::string& keep)
+{
+    // Only scan the directory when the size is unknown or too big.
+    if (_size != static_cast<size_t>(-1) && _size <= _limit) return;
+
+    std::vector<Entry> entries = listEntries(_dir);
+
+    _size = 0;
+    for (const Entry& e : entries) _size += e.size;
+    if (_size <= _limit) return;
+
+    // Make some room, so that the next commits don't need a scan.
+    const size_t target = _limit - _limit / 8;
+
+    std::sort(entries.begin(), entries.end(), olderThan);
+    for (const Entry& e : entries) {
+        if (_size <= target) break;
+        if (e.path == keep || std::remove(e.path.c_str())) continue;
+        _size -= e.size;
+    }
+}
+
+} // namespace gnash
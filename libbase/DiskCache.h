@@ -0,0 +1,134 @@
+// DiskCache.h: persistent cache of decoded data, for Gnash.
+//
+//   Copyright (C) 2012 Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+//
+
+#ifndef GNASH_DISKCACHE_H
+#define GNASH_DISKCACHE_H
+
+#include <string>
+#include <memory>
+#include <mutex>
+#include <cstdint>
+#include <boost/noncopyable.hpp>
+
+#include "dsodefs.h"
+
+namespace gnash {
+    class IOChannel;
+}
+
+namespace gnash {
+
+/// A directory of files holding data that is expensive to compute.
+//
+/// Entries are identified by a key, usually derived from the content
+/// they were computed from (see makeKey), so they never need to be
+/// invalidated. Users must still check that an entry is well formed
+/// before trusting it, and remove() it if not.
+//
+/// When the total size of the entries grows beyond the configured
+/// limit, the least recently used ones are deleted.
+class DSOEXPORT DiskCache : boost::noncopyable
+{
+public:
+
+    /// Create a cache.
+    //
+    /// @param dir      The directory to store entries in. It is created
+    ///                 when needed. An empty string disables the cache.
+    /// @param limit    The maximum total size of the entries in bytes.
+    DiskCache(std::string dir, size_t limit);
+
+    /// Get the cache configured by the movieCacheDir and movieCacheLimit
+    /// directives of the gnashrc.
+    static DiskCache& getDefaultInstance();
+
+    /// Whether entries can be stored and retrieved
+    bool enabled() const { return !_dir.empty(); }
+
+    /// Make a key identifying the given data.
+    //
+    /// The key is a SHA-256 digest of the data, so that different data
+    /// never share an entry.
+    ///
+    /// @param prefix   Identifies the kind of entry.
+    /// @param data     The data the entry is computed from.
+    /// @param size     The size of the data.
+    static std::string makeKey(const std::string& prefix,
+            const std::uint8_t* data, size_t size);
+
+    /// Open an entry for reading.
+    //
+    /// The entry is marked as recently used.
+    ///
+    /// Entries are mapped in memory. They are never changed in place,
+    /// only replaced or removed, which leaves the mapping intact.
+    ///
+    /// @return a channel giving direct access to the entry's content
+    ///         (see IOChannel::contiguousData()), or 0 if there's
+    ///         no such entry.
+    std::unique_ptr<IOChannel> get(const std::string& key) const;
+
+    /// Start writing an entry.
+    //
+    /// The entry is written to a file of its own, so that several
+    /// writers of the same entry don't mix their data. It is not
+    /// visible until commit() is called, after the returned channel is
+    /// destroyed.
+    ///
+    /// @param temp     Receives the file written, to pass to commit().
+    /// @return a channel to write the entry's content to, or 0 if the
+    ///         cache is disabled or the entry can't be created.
+    std::unique_ptr<IOChannel> create(const std::string& key,
+            std::string& temp);
+
+    /// Make an entry written with create() available.
+    //
+    /// The last entry committed replaces any other.
+    ///
+    /// @param temp     The file given by create().
+    /// @param success  If false, the written data is discarded.
+    /// @return         true if the entry was stored.
+    bool commit(const std::string& key, const std::string& temp,
+            bool success = true);
+
+    /// Delete an entry, for example because it is not valid.
+    void remove(const std::string& key);
+
+private:
+
+    std::string path(const std::string& key) const;
+
+    /// Delete the oldest entries until the cache fits its limit.
+    //
+    /// @param keep     The path of an entry that must not be deleted.
+    void trim(const std::string& keep);
+
+    const std::string _dir;
+
+    const size_t _limit;
+
+    /// The total size of entries, or -1 if not yet computed.
+    size_t _size;
+
+    std::mutex _mutex;
+};
+
+} // namespace gnash
+
+#endif
@@ -25,6 +25,11 @@
 #include <memory> 
 #include <algorithm>
 #include <cassert>
+#include <cstdint>
+
+#ifdef __SSE2__
+# include <emmintrin.h>
+#endif
 
 #ifdef USE_PNG
 # include "GnashImagePng.h"
@@ -43,6 +48,8 @@ namespace image {
 
 namespace {
     void processAlpha(GnashImage::iterator imageData, size_t pixels);
+    void mergeAlphaRow(GnashImage::iterator imageData,
+            GnashImage::const_iterator alphaData, size_t pixels);
     bool checkValidSize(size_t width, size_t height, size_t channels) {
 
         if (width == 0 || height == 0) return false;
@@ -148,22 +155,10 @@ mergeAlpha(ImageRGBA& im, GnashImage::const_iterator alphaData,
 {
     assert(bufferLength * 4 <= im.size());
 
-    // Point to the first alpha byte
-    GnashImage::iterator p = im.begin();
-
     // Premultiplication is also done at rendering time (at least by the
     // agg renderer).
     // TODO: use BitmapData.loadBitmap to check whether it's also done here.
-    for (size_t i = 0; i < bufferLength; ++i, ++alphaData) {
-        *p = std::min(*p, *alphaData);
-        ++p;
-        *p = std::min(*p, *alphaData);
-        ++p;
-        *p = std::min(*p, *alphaData);
-        ++p;
-        *p = *alphaData;
-        ++p;
-    }
+    mergeAlphaRow(im.begin(), alphaData, bufferLength);
 }
 
 //
@@ -263,24 +258,24 @@ Input::readImageData(std::shared_ptr<IOChannel> in, FileType type)
     }
     
 
-    for (size_t i = 0; i < height; ++i) {
-        inChannel->readScanline(scanline(*im, i));
-    }
-
     // The renderers expect RGBA data to be preprocessed. JPEG images are
     // never transparent, but the addition of alpha data stored elsewhere
     // in the SWF is possible; in that case, the processing happens during
-    // mergeAlpha().
-    if (im->type() == TYPE_RGBA) {
-        processAlpha(im->begin(), width * height);
+    // mergeAlpha(). Each scanline is processed while it is in the cache.
+    const bool rgba = im->type() == TYPE_RGBA;
+
+    for (size_t i = 0; i < height; ++i) {
+        inChannel->readScanline(scanline(*im, i));
+        if (rgba) processAlpha(scanline(*im, i), width);
     }
+
     return im;
 }
 
 // For reading SWF JPEG3-style image data, like ordinary JPEG, 
 // but stores the data in ImageRGBA format.
 std::unique_ptr<ImageRGBA>
-Input::readSWFJpeg3(std::shared_ptr<IOChannel> in)
+Input::readSWFJpeg3(std::shared_ptr<IOChannel> in, IOChannel* alpha)
 {
 
     std::unique_ptr<ImageRGBA> im;
@@ -292,6 +287,8 @@ Input::readSWFJpeg3(std::shared_ptr<IOChannel> in)
     // If this isn't true, we should have thrown.
     assert(j_in.get());
 
+    // Decode straight into the image if possible.
+    j_in->setOutputRGBA();
     j_in->read();
 
     const size_t height = j_in->getHeight();
@@ -299,19 +296,23 @@ Input::readSWFJpeg3(std::shared_ptr<IOChannel> in)
 
     im.reset(new ImageRGBA(width, height));
 
-    if (j_in->imageType() == TYPE_RGBA) {
+    const bool rgba = j_in->imageType() == TYPE_RGBA;
 
-        for (size_t y = 0; y < height; ++y) {
-            j_in->readScanline(scanline(*im, y));
-        }
-    } else {
-        std::unique_ptr<GnashImage::value_type[]> line(
-            new GnashImage::value_type[3 * width]);
+    std::unique_ptr<GnashImage::value_type[]> line;
+    if (!rgba) line.reset(new GnashImage::value_type[3 * width]);
 
-        for (size_t y = 0; y < height; ++y) {
-            j_in->readScanline(line.get());
+    std::unique_ptr<GnashImage::value_type[]> alphaLine;
+    if (alpha) alphaLine.reset(new GnashImage::value_type[width]);
 
-            GnashImage::iterator data = scanline(*im, y);
+    for (size_t y = 0; y < height; ++y) {
+
+        GnashImage::iterator data = scanline(*im, y);
+
+        if (rgba) {
+            j_in->readScanline(data);
+        }
+        else {
+            j_in->readScanline(line.get());
             for (size_t x = 0; x < width; ++x) {
                 data[4*x+0] = line[3*x+0];
                 data[4*x+1] = line[3*x+1];
@@ -319,6 +320,18 @@ Input::readSWFJpeg3(std::shared_ptr<IOChannel> in)
                 data[4*x+3] = 255;
             }
         }
+
+        // Merge the alpha data while the scanline is in the cache.
+        if (!alpha) continue;
+
+        const std::streamsize bytes = width;
+        if (alpha->read(alphaLine.get(), bytes) != bytes) {
+            log_error(_("Could not read alpha data for JPEG image, "
+                        "leaving the remaining rows opaque"));
+            alpha = nullptr;
+            continue;
+        }
+        mergeAlphaRow(data, alphaLine.get(), width);
     }
 
     return im;
@@ -326,11 +339,26 @@ Input::readSWFJpeg3(std::shared_ptr<IOChannel> in)
 
 namespace {
 
+/// Limit the colour values of RGBA pixels to their alpha value.
 void
 processAlpha(GnashImage::iterator imageData, size_t pixels)
 {
     GnashImage::iterator p = imageData;
-    for (size_t i = 0; i < pixels; ++i) {
+    size_t i = 0;
+
+#ifdef __SSE2__
+    // Four pixels at a time: spread each alpha byte over its pixel,
+    // then take the minimum of each byte.
+    for (; i + 4 <= pixels; i += 4, p += 16) {
+        __m128i px = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        __m128i a = _mm_srli_epi32(px, 24);
+        a = _mm_or_si128(a, _mm_slli_epi32(a, 8));
+        a = _mm_or_si128(a, _mm_slli_epi32(a, 16));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(p), _mm_min_epu8(px, a));
+    }
+#endif
+
+    for (; i < pixels; ++i) {
         GnashImage::value_type alpha = *(p + 3);
         *p = std::min(*p, alpha);
         ++p;
@@ -341,6 +369,51 @@ processAlpha(GnashImage::iterator imageData, size_t pixels)
     }
 }
 
+/// Set the alpha value of RGBA pixels and limit their colour values to it.
+void
+mergeAlphaRow(GnashImage::iterator imageData,
+        GnashImage::const_iterator alphaData, size_t pixels)
+{
+    GnashImage::iterator p = imageData;
+    size_t i = 0;
+
+#ifdef __SSE2__
+    // Sixteen pixels at a time: spread each alpha byte over its pixel,
+    // take the minimum of each colour byte and replace the alpha byte.
+    const __m128i alphaMask = _mm_set1_epi32(0xff000000);
+
+    for (; i + 16 <= pixels; i += 16, p += 64, alphaData += 16) {
+        const __m128i a = _mm_loadu_si128(
+                reinterpret_cast<const __m128i*>(alphaData));
+        const __m128i lo = _mm_unpacklo_epi8(a, a);
+        const __m128i hi = _mm_unpackhi_epi8(a, a);
+        const __m128i spread[4] = {
+            _mm_unpacklo_epi16(lo, lo), _mm_unpackhi_epi16(lo, lo),
+            _mm_unpacklo_epi16(hi, hi), _mm_unpackhi_epi16(hi, hi)
+        };
+
+        for (size_t j = 0; j < 4; ++j) {
+            __m128i* dst = reinterpret_cast<__m128i*>(p + 16 * j);
+            __m128i px = _mm_min_epu8(_mm_loadu_si128(dst), spread[j]);
+            px = _mm_or_si128(_mm_andnot_si128(alphaMask, px),
+                    _mm_and_si128(alphaMask, spread[j]));
+            _mm_storeu_si128(dst, px);
+        }
+    }
+#endif
+
+    for (; i < pixels; ++i, ++alphaData) {
+        *p = std::min(*p, *alphaData);
+        ++p;
+        *p = std::min(*p, *alphaData);
+        ++p;
+        *p = std::min(*p, *alphaData);
+        ++p;
+        *p = *alphaData;
+        ++p;
+    }
+}
+
 } // anonymous namespace
 } // namespace image
 } // namespace gnash
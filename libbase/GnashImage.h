@@ -306,8 +306,14 @@ public:
     /// \brief
     /// For reading SWF JPEG3-style image data, like ordinary JPEG, 
     /// but stores the data in ImageRGBA format.
+    //
+    /// @param in       The IOChannel to read the JPEG data from.
+    /// @param alpha    An IOChannel to read one byte of alpha for each
+    ///                 pixel from, or 0 for an opaque image. It is merged
+    ///                 as each scanline is decoded, as mergeAlpha() does.
     DSOEXPORT static std::unique_ptr<ImageRGBA> readSWFJpeg3(
-            std::shared_ptr<gnash::IOChannel> in);
+            std::shared_ptr<gnash::IOChannel> in,
+            gnash::IOChannel* alpha = nullptr);
 
     /// Read image data from an IOChannel into an GnashImage.
     //
@@ -406,6 +412,12 @@ scanline(const GnashImage& im, size_t row)
     return im.begin() + im.stride() * row;
 }
 
+/// Set the alpha channel of an image and premultiply its colours.
+//
+/// @param im           The image to modify.
+/// @param alphaData    One alpha value for each pixel.
+/// @param bufferLength The number of alpha values, at most the number
+///                     of pixels in the image.
 DSOEXPORT void mergeAlpha(ImageRGBA& im, GnashImage::const_iterator alphaData,
         const size_t bufferLength);
 
@@ -216,7 +216,8 @@ JpegInput::JpegInput(std::shared_ptr<IOChannel> in)
     Input(in),
     _errorOccurred(nullptr),
     _jmpBuf(),
-    _compressorOpened(false)
+    _compressorOpened(false),
+    _outputRGBA(false)
 {
     setup_jpeg_err(&m_jerr);
     m_cinfo.err = &m_jerr;
@@ -337,6 +338,15 @@ JpegInput::read()
         throw ParserException(ss.str());
     }
 
+#ifdef JCS_ALPHA_EXTENSIONS
+    // libjpeg-turbo converts colour images to RGBA while decoding, which
+    // saves expanding each scanline afterwards.
+    if (_outputRGBA && (m_cinfo.jpeg_color_space == JCS_YCbCr ||
+                m_cinfo.jpeg_color_space == JCS_RGB)) {
+        m_cinfo.out_color_space = JCS_EXT_RGBA;
+    }
+#endif
+
     jpeg_start_decompress(&m_cinfo);
 
     if (_errorOccurred) {
@@ -61,6 +61,8 @@ private:
 
     bool _compressorOpened;
 
+    bool _outputRGBA;
+
 public:
 
     /// Construct a JpegInput object to read from an IOChannel.
@@ -82,6 +84,14 @@ public:
     /// Begin processing the image data.
     void read();
 
+    /// Request RGBA output instead of RGB.
+    //
+    /// This must be called before read(). If libjpeg can convert the
+    /// image to RGBA, which libjpeg-turbo does, imageType() is
+    /// TYPE_RGBA after read() and readScanline() writes opaque RGBA
+    /// pixels.
+    void setOutputRGBA() { _outputRGBA = true; }
+
     /// Discard any data sitting in our input buffer.
     //
     /// Use this before/after reading headers or partial image
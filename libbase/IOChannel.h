@@ -153,6 +153,23 @@ public:
     /// @return unreliable input size, (size_t)-1 if not known. 
     ///
     virtual size_t size() const { return static_cast<size_t>(-1); }
+
+    /// Get direct access to the bytes at the current position.
+    //
+    /// Channels keeping their whole content in memory, like a mapped
+    /// file, can hand out a pointer to it so that callers don't need
+    /// to copy the data. The memory stays valid and unchanged for the
+    /// lifetime of the channel. The stream position is not changed.
+    ///
+    /// @param num  The number of contiguous bytes wanted.
+    ///
+    /// @return a pointer to num bytes, or 0 if the bytes are not
+    ///         available in memory. The default implementation
+    ///         always returns 0.
+    ///
+    virtual const std::uint8_t* contiguousData(std::streamsize /*num*/) const {
+        return nullptr;
+    }
    
 };
 
@@ -110,6 +110,21 @@ StreamProvider::getStream(const URL& url, bool namedCacheFile) const
 	}
 }
 
+std::unique_ptr<IOChannel>
+StreamProvider::getMovieStream(const URL& url, bool namedCacheFile) const
+{
+    if (url.protocol() == "file" && url.path() != "-") {
+        if (!allow(url)) return std::unique_ptr<IOChannel>();
+
+        // Mapping avoids copying the movie through stdio buffers, and
+        // lets its parser refer to the movie's data in place.
+        std::unique_ptr<IOChannel> stream =
+            makeMappedFileChannel(url.path().c_str());
+        if (stream.get()) return stream;
+    }
+    return getStream(url, namedCacheFile);
+}
+
 std::unique_ptr<IOChannel>
 StreamProvider::getStream(const URL& url, const std::string& postdata,
         const NetworkAdapter::RequestHeaders& headers, bool namedCacheFile)
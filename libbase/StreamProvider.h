@@ -69,6 +69,19 @@ public:
 	virtual std::unique_ptr<IOChannel> getStream(const URL& url,
             bool namedCacheFile = false) const;
 
+	/// Get a stream to load a movie from.
+	//
+	/// Local regular files are mapped in memory (see
+	/// makeMappedFileChannel()), so that their tags are parsed without
+	/// reading them into buffers first. The movie is read from the
+	/// mapping for as long as it loads, and a file truncated meanwhile
+	/// raises SIGBUS; the tags and action code kept afterwards are
+	/// copies. Other movies are opened like any stream.
+	///
+	/// On error NULL is returned
+	virtual std::unique_ptr<IOChannel> getMovieStream(const URL& url,
+            bool namedCacheFile = false) const;
+
 	/// Get a stream from the response of a POST operation
 	//
 	/// Returned stream ownership is transferred to caller.
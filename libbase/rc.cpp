@@ -71,6 +71,8 @@ RcInitFile::RcInitFile()
         :
     _delay(0),
     _movieLibraryLimit(8),
+    _movieLibraryMemoryLimit(64),
+    _bitmapMemoryLimit(64),
     _debug(false),
     _debugger(false),
     _verbosity(-1),
@@ -112,6 +114,7 @@ RcInitFile::RcInitFile()
     _quality(-1),
     _saveStreamingMedia(false),
     _saveLoadedMedia(false),
+    _movieCacheLimit(256),
     _popups(true),
     _webcamDevice(-1),
     _microphoneDevice(-1),
@@ -121,7 +124,9 @@ RcInitFile::RcInitFile()
     _ignoreShowMenu(true),
     _scriptsTimeout(15),
     _scriptsRecursionLimit(256),
-    _lockScriptLimits(false)
+    _lockScriptLimits(false),
+    _renderInBackground(false),
+    _renderThreads(0)
 {
     expandPath(_solsandbox);
     loadFiles();
@@ -467,6 +472,12 @@ RcInitFile::parseFile(const std::string& filespec)
                 continue;
             }
             
+            if (noCaseCompare(variable, "movieCacheDir") ) {
+                expandPath(value);
+                _movieCacheDir = value;
+                continue;
+            }
+            
             if (noCaseCompare(variable, "documentroot") ) {
                 _wwwroot = value;
                 continue;
@@ -583,6 +594,15 @@ RcInitFile::parseFile(const std::string& filespec)
             ||
                  extractNumber(_movieLibraryLimit, "movieLibraryLimit",
                          variable, value)
+            ||
+                 extractNumber(_movieLibraryMemoryLimit,
+                         "movieLibraryMemoryLimit", variable, value)
+            ||
+                 extractNumber(_bitmapMemoryLimit, "bitmapMemoryLimit",
+                         variable, value)
+            ||
+                 extractNumber(_movieCacheLimit, "movieCacheLimit",
+                         variable, value)
             ||
                  extractNumber(_delay, "delay", variable, value)
             ||
@@ -620,6 +640,12 @@ RcInitFile::parseFile(const std::string& filespec)
 			||
                  extractSetting(_lockScriptLimits, "lockScriptLimits", variable,
                            value)
+			||
+                 extractSetting(_renderInBackground, "renderInBackground",
+                           variable, value)
+			||
+                 extractNumber(_renderThreads, "renderThreads", variable,
+                         value)
             ||
                  cerr << boost::format(_("Warning: unrecognized directive "
                              "\"%s\" in rcfile %s line %d")) 
@@ -769,6 +795,9 @@ RcInitFile::updateFile(const std::string& filespec)
     cmd << "startStopped " << _startStopped << endl <<
     cmd << "streamsTimeout " << _streamsTimeout << endl <<
     cmd << "movieLibraryLimit " << _movieLibraryLimit << endl <<
+    cmd << "movieLibraryMemoryLimit " << _movieLibraryMemoryLimit << endl <<
+    cmd << "bitmapMemoryLimit " << _bitmapMemoryLimit << endl <<
+    cmd << "movieCacheLimit " << _movieCacheLimit << endl <<
     cmd << "quality " << _quality << endl <<    
     cmd << "delay " << _delay << endl <<
     cmd << "verbosity " << _verbosity << endl <<
@@ -785,6 +814,8 @@ RcInitFile::updateFile(const std::string& filespec)
     cmd << "scriptsTimeout " << _scriptsTimeout << endl <<
     cmd << "scriptsRecursionLimit " << _scriptsRecursionLimit << endl <<
     cmd << "lockScriptLimits " << _lockScriptLimits << endl <<
+    cmd << "renderInBackground " << _renderInBackground << endl <<
+    cmd << "renderThreads " << _renderThreads << endl <<
    
     // Strings.
 
@@ -796,6 +827,7 @@ RcInitFile::updateFile(const std::string& filespec)
     // at the next run (even though that's not the way to use it...)
 
     cmd << "mediaDir " << _mediaCacheDir << endl <<    
+    cmd << "movieCacheDir " << _movieCacheDir << endl <<
     cmd << "debuglog " << _log << endl <<
     cmd << "documentroot " << _wwwroot << endl <<
     cmd << "flashSystemOS " << _flashSystemOS << endl <<
@@ -95,6 +95,29 @@ public:
     int getMovieLibraryLimit() const { return _movieLibraryLimit; }
     void setMovieLibraryLimit(int value) { _movieLibraryLimit = value; }
 
+    /// Get the memory budget of the movie library, in megabytes.
+    //
+    /// Zero means no budget.
+    std::uint32_t getMovieLibraryMemoryLimit() const {
+        return _movieLibraryMemoryLimit;
+    }
+
+    void setMovieLibraryMemoryLimit(std::uint32_t value) {
+        _movieLibraryMemoryLimit = value;
+    }
+
+    /// Get the memory budget of the decoded bitmaps of a movie,
+    /// in megabytes.
+    //
+    /// Zero means no budget.
+    std::uint32_t getBitmapMemoryLimit() const {
+        return _bitmapMemoryLimit;
+    }
+
+    void setBitmapMemoryLimit(std::uint32_t value) {
+        _bitmapMemoryLimit = value;
+    }
+
     bool enableExtensions() const { return _extensionsEnabled; }
 
     /// Return true if user is willing to start the gui in "stop" mode
@@ -306,6 +329,16 @@ public:
     void setMediaDir(const std::string& value) { _mediaCacheDir = value; }
 
     const std::string& getMediaDir() const { return _mediaCacheDir; }
+
+    /// Directory to cache decoded movie data in, empty if disabled.
+    const std::string& getMovieCacheDir() const { return _movieCacheDir; }
+
+    void setMovieCacheDir(const std::string& value) { _movieCacheDir = value; }
+
+    /// Maximum size of the movie cache directory, in megabytes.
+    std::uint32_t getMovieCacheLimit() const { return _movieCacheLimit; }
+
+    void setMovieCacheLimit(std::uint32_t value) { _movieCacheLimit = value; }
 	
     void setWebcamDevice(int value) {_webcamDevice = value;}
     
@@ -358,6 +391,16 @@ public:
 
     bool lockScriptLimits() const { return _lockScriptLimits; }
 
+    /// Whether to render frames in a thread of their own.
+    bool renderInBackground() const { return _renderInBackground; }
+
+    void renderInBackground(bool x) { _renderInBackground = x; }
+
+    /// The number of threads drawing shapes, 0 for one per processor.
+    int getRenderThreads() const { return _renderThreads; }
+
+    void setRenderThreads(int x) { _renderThreads = x; }
+
     void dump();    
 
 protected:
@@ -447,6 +490,12 @@ protected:
     /// Max number of movie clips to store in the library      
     std::uint32_t  _movieLibraryLimit;
 
+    /// Max memory used by movies in the library, in megabytes
+    std::uint32_t  _movieLibraryMemoryLimit;
+
+    /// Max memory used by the decoded bitmaps of a movie, in megabytes
+    std::uint32_t  _bitmapMemoryLimit;
+
     /// Enable debugging of this class
     bool _debug;
 
@@ -577,6 +626,12 @@ protected:
 
     std::string _mediaCacheDir;
 
+    /// Where decoded movie data is cached across runs
+    std::string _movieCacheDir;
+
+    /// Size limit of the movie cache in megabytes
+    std::uint32_t _movieCacheLimit;
+
     bool _popups;
 
     ///FIXME: this should probably eventually be changed to a more readable
@@ -624,6 +679,12 @@ protected:
 
     /// Whether to ignore SWF ScriptLimits tags 
     bool _lockScriptLimits;
+
+    /// Whether to render a frame while the next one is computed
+    bool _renderInBackground;
+
+    /// The number of threads drawing shapes, 0 for one per processor
+    int _renderThreads;
 };
 
 // End of gnash namespace 
@@ -27,6 +27,8 @@
 #include <algorithm>
 #include <ostream>
 #include <cstdint>
+#include <cmath>
+#include <cassert>
 
 namespace gnash {
 
@@ -66,6 +68,13 @@ namespace geometry {
 /// Merging these two ranges would create a much bigger range which in some
 /// situations means that rendering is notably slower (for example, when 
 /// there is a scaled bitmap behind these shapes).
+///
+/// Alternatively, ranges can be aligned to a grid of tiles (see
+/// setTileSize()). Ranges are then simply collected, and combining them
+/// marks the tiles they touch and produces rectangles covering runs of
+/// marked tiles. This costs time linear in the number of ranges and keeps
+/// many small scattered ranges apart, where snapping would merge them
+/// into a few large ones.
 
 // Forward declarations.
 namespace {
@@ -92,6 +101,9 @@ public:
         _snapFactor(1.3f),
         _singleMode(false),
         _rangesLimit(50),
+        _tileSize(0),
+        _tileX(0),
+        _tileY(0),
         _combineCounter(0)
     {
     }
@@ -103,6 +115,9 @@ public:
         _snapFactor(from.getSnapFactor()), 
         _singleMode(from.getSingleMode()),
         _rangesLimit(from.getRangeCountLimit()),
+        _tileSize(from.getTileSize()),
+        _tileX(from.getTileOriginX()),
+        _tileY(from.getTileOriginY()),
         _combineCounter(0)
     {
         if (from.isWorld()) setWorld();
@@ -149,12 +164,44 @@ public:
     size_type getRangeCountLimit() const {
         return _rangesLimit;
     }
+
+    /// Align ranges to a grid of tiles instead of snapping them together.
+    //
+    /// When covering the marked tiles would take more than
+    /// getRangeCountLimit() ranges, or the grid would be very large, the
+    /// tile size is doubled until it does not.
+    ///
+    /// @param size     The width and height of the tiles, or 0 to use
+    ///                 snapping (the default).
+    /// @param x        The horizontal position of a corner of the grid.
+    /// @param y        The vertical position of a corner of the grid.
+    void setTileSize(const T size, const T x = 0, const T y = 0) {
+        assert(size >= 0);
+        _tileSize = size;
+        _tileX = x;
+        _tileY = y;
+    }
+
+    T getTileSize() const {
+        return _tileSize;
+    }
+
+    T getTileOriginX() const {
+        return _tileX;
+    }
+
+    T getTileOriginY() const {
+        return _tileY;
+    }
     
     /// Copy the snapping settings from another ranges list, without
     /// copying the ranges itself
     void inheritConfig(const SnappingRanges2d<T>& from) {
         _snapFactor = from._snapFactor;
         _singleMode = from._singleMode;
+        _tileSize = from._tileSize;
+        _tileX = from._tileX;
+        _tileY = from._tileY;
     }
     
     /// Merge two ranges based on snaptest.
@@ -260,6 +307,14 @@ public:
             _ranges[0].expandTo(range);
             return;
         }
+
+        if (_tileSize > 0) {
+            if (!_ranges.empty() && _ranges.front().isWorld()) return;
+            // Overlaps are taken care of when combining.
+            _ranges.push_back(range);
+            combineRangesLazy();
+            return;
+        }
         
         ExpandToIfSnap exp(range, _snapFactor);
         if (visit(exp)) return;
@@ -498,11 +553,16 @@ public:
     
         // makes no sense in single mode
         if (_singleMode) return;
+
+        _combineCounter = 0;
+
+        if (_tileSize > 0) {
+            combineTiles();
+            return;
+        }
     
         bool restart = true;
         
-        _combineCounter = 0;
-        
         while (restart) {
         
             int rcount = _ranges.size();
@@ -581,10 +641,110 @@ private:
     /// Calls combineRanges() once in a while, but not always. Avoids too many
     /// combineRanges() checks, which could slow down everything.
     void combineRangesLazy() const {
-        const size_type max = 5;
         ++_combineCounter;
+
+        // Tiles are cheap to combine all at once, but the list
+        // should not grow unbounded.
+        if (_tileSize > 0) {
+            if (_ranges.size() > _rangesLimit * 16) combineRanges();
+            return;
+        }
+
+        const size_type max = 5;
         if (_combineCounter > max) combineRanges();
     }
+
+    /// Replace the ranges with rectangles covering the tiles they touch.
+    //
+    /// Each row of tiles is split into runs of marked tiles, and runs
+    /// spanning the same columns in consecutive rows are joined.
+    void combineTiles() const {
+
+        // Nothing to combine, and a WORLD range is alone.
+        if (_ranges.size() < 2) return;
+
+        const RangeType area = getFullArea();
+
+        // Keeps the grid small enough to scan on every frame.
+        const double maxTiles = 1 << 14;
+
+        for (double tile = _tileSize; ; tile *= 2) {
+
+            // Tile indices are counted from the corner of the grid.
+            const double ox = _tileX;
+            const double oy = _tileY;
+
+            const double x0 = std::floor((area.getMinX() - ox) / tile);
+            const double y0 = std::floor((area.getMinY() - oy) / tile);
+            const double columns =
+                std::floor((area.getMaxX() - ox) / tile) - x0 + 1;
+            const double rows =
+                std::floor((area.getMaxY() - oy) / tile) - y0 + 1;
+
+            if (columns * rows > maxTiles) continue;
+
+            const size_t width = columns;
+            const size_t height = rows;
+            std::vector<bool> marked(width * height);
+
+            for (const RangeType& r : _ranges) {
+                const size_t c0 = std::floor((r.getMinX() - ox) / tile) - x0;
+                const size_t c1 = std::floor((r.getMaxX() - ox) / tile) - x0;
+                const size_t r0 = std::floor((r.getMinY() - oy) / tile) - y0;
+                const size_t r1 = std::floor((r.getMaxY() - oy) / tile) - y0;
+                for (size_t row = r0; row <= r1; ++row) {
+                    std::fill(marked.begin() + row * width + c0,
+                            marked.begin() + row * width + c1 + 1, true);
+                }
+            }
+
+            // The runs of the previous row, with the index of the range
+            // they belong to.
+            typedef std::pair<size_t, size_t> Run;
+            std::vector<std::pair<Run, size_t> > above, current;
+            RangeList tiled;
+
+            for (size_t row = 0; row < height; ++row) {
+                current.clear();
+
+                // Both rows' runs are in column order.
+                size_t i = 0;
+                size_t c = 0;
+                while (c < width) {
+                    if (!marked[row * width + c]) {
+                        ++c;
+                        continue;
+                    }
+                    const size_t start = c;
+                    while (c < width && marked[row * width + c]) ++c;
+                    const Run run(start, c);
+
+                    const T maxY = oy + (y0 + row + 1) * tile;
+
+                    while (i < above.size() && above[i].first.first < start) {
+                        ++i;
+                    }
+                    if (i < above.size() && above[i].first == run) {
+                        RangeType& r = tiled[above[i].second];
+                        r.setTo(r.getMinX(), r.getMinY(), r.getMaxX(), maxY);
+                        current.push_back(above[i]);
+                        continue;
+                    }
+
+                    tiled.push_back(RangeType(ox + (x0 + start) * tile,
+                                oy + (y0 + row) * tile, ox + (x0 + c) * tile,
+                                maxY));
+                    current.push_back(std::make_pair(run, tiled.size() - 1));
+                }
+                above.swap(current);
+            }
+
+            if (tiled.size() > std::max<size_type>(_rangesLimit, 1)) continue;
+
+            _ranges.swap(tiled);
+            return;
+        }
+    }
             
     void finalize() const {
         if (_combineCounter > 0) combineRanges();
@@ -604,6 +764,13 @@ private:
     
     /// maximum number of ranges allowed
     size_type _rangesLimit;     
+
+    /// size of the tiles ranges are aligned to, or 0 - see setTileSize()
+    T _tileSize;
+
+    /// corner of the grid of tiles - see setTileSize()
+    T _tileX;
+    T _tileY;
     
     /// Counter used in finalizing ranges.
     mutable size_type _combineCounter;
@@ -5,11 +5,21 @@
 
 // A file class that can be customized with callbacks.
 
+#ifdef HAVE_CONFIG_H
+#include "gnashconfig.h"
+#endif
+
 #include "tu_file.h"
 
 #include <cstdio>
+#include <cstring>
 #include <boost/format.hpp>
 #include <cerrno>
+#include <fcntl.h>
+
+#ifdef HAVE_MMAP
+# include <sys/mman.h>
+#endif
 
 #include "GnashFileUtilities.h"
 #include "utility.h"
@@ -135,6 +145,102 @@ private:
 };
 
 
+/// A read-only IOChannel on data in memory.
+class MemoryChannel : public IOChannel
+{
+public:
+
+    /// The data must stay valid as long as the channel is used.
+    MemoryChannel(const void* data, size_t size);
+
+    std::streamsize read(void* dst, std::streamsize num);
+
+    std::streampos tell() const { return _pos; }
+
+    bool seek(std::streampos p);
+
+    void go_to_end() { _pos = _size; }
+
+    bool eof() const { return _eof; }
+    
+    bool bad() const { return false; }
+    
+    size_t size() const { return _size; }
+
+    const std::uint8_t* contiguousData(std::streamsize num) const {
+        if (num < 0 || _size - _pos < static_cast<size_t>(num)) return nullptr;
+        return _data + _pos;
+    }
+    
+protected:
+
+    const std::uint8_t* _data;
+
+    const size_t _size;
+
+private:
+
+    size_t _pos;
+
+    bool _eof;
+};
+
+MemoryChannel::MemoryChannel(const void* data, size_t size)
+    :
+    _data(static_cast<const std::uint8_t*>(data)),
+    _size(size),
+    _pos(0),
+    _eof(false)
+{
+}
+
+std::streamsize
+MemoryChannel::read(void* dst, std::streamsize num)
+{
+    assert(dst);
+    if (num <= 0) return 0;
+
+    const size_t left = _size - _pos;
+    size_t bytes = num;
+    if (bytes > left) {
+        bytes = left;
+        _eof = true;
+    }
+    std::memcpy(dst, _data + _pos, bytes);
+    _pos += bytes;
+    return bytes;
+}
+
+bool
+MemoryChannel::seek(std::streampos pos)
+{
+    if (pos < 0 || pos > static_cast<std::streampos>(_size)) return false;
+    _pos = pos;
+    _eof = false;
+    return true;
+}
+
+#ifdef HAVE_MMAP
+
+/// A read-only IOChannel on a file mapped in memory.
+class MappedFile : public MemoryChannel
+{
+public:
+
+    /// Take ownership of a mapping of the given size.
+    MappedFile(void* data, size_t size)
+        :
+        MemoryChannel(data, size)
+    {
+    }
+    
+    ~MappedFile() {
+        munmap(const_cast<std::uint8_t*>(_data), _size);
+    }
+};
+
+#endif // HAVE_MMAP
+
 //// Create a file from a standard file pointer.
 tu_file::tu_file(FILE* fp, bool autoclose = false)
     :
@@ -256,6 +362,51 @@ makeFileChannel(const char* filepath, const char* mode)
 	return makeFileChannel(fp, true);
 }
 
+std::unique_ptr<IOChannel>
+makeMemoryChannel(const void* data, size_t size)
+{
+    return std::unique_ptr<IOChannel>(new MemoryChannel(data, size));
+}
+
+std::unique_ptr<IOChannel>
+makeMappedFileChannel(const char* filepath)
+{
+#ifdef HAVE_MMAP
+    const int fd = open(filepath, O_RDONLY);
+    if (fd < 0) return std::unique_ptr<IOChannel>();
+
+    // Only regular files can be mapped, and empty ones can't.
+    struct stat statbuf;
+    if (fstat(fd, &statbuf) < 0 || !S_ISREG(statbuf.st_mode) ||
+            statbuf.st_size <= 0) {
+        ::close(fd);
+        return std::unique_ptr<IOChannel>();
+    }
+
+    // Changes to the file while it is mapped show through, and reading
+    // pages past the end of a truncated file raises SIGBUS, so callers
+    // must copy what they keep.
+    const size_t size = statbuf.st_size;
+    void* data = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+
+    // The mapping doesn't need the descriptor any more.
+    ::close(fd);
+
+    if (data == MAP_FAILED) {
+        log_debug("Could not map %s: %s", filepath, std::strerror(errno));
+        return std::unique_ptr<IOChannel>();
+    }
+
+    // Movies and media are mostly parsed from start to end.
+    madvise(data, size, MADV_SEQUENTIAL);
+
+    return std::unique_ptr<IOChannel>(new MappedFile(data, size));
+#else
+    UNUSED(filepath);
+    return std::unique_ptr<IOChannel>();
+#endif
+}
+
 
 } // end namespace gnash
 
@@ -38,6 +38,38 @@ DSOEXPORT std::unique_ptr<IOChannel> makeFileChannel(FILE* fp, bool close);
 /// @return An IOChannel or NULL if the file could not be opened.
 DSOEXPORT std::unique_ptr<IOChannel> makeFileChannel(const char* filepath, const char* mode);
 
+/// \brief
+/// Creates a read-only IOChannel by mapping the given file in memory.
+//
+/// The channel gives direct access to the file content through
+/// IOChannel::contiguousData(), and the pages are shared with any
+/// other process mapping the same file.
+///
+/// Only the size of the file when it is opened is mapped, and reading
+/// a file truncated by another process raises SIGBUS. Files that may
+/// grow or change while they are read, like media being downloaded,
+/// should be read with makeFileChannel().
+///
+/// @param filepath A path to a regular file in the local filesystem.
+///
+/// @return An IOChannel or NULL if the file could not be mapped, in
+///         which case makeFileChannel() should be used instead.
+DSOEXPORT std::unique_ptr<IOChannel> makeMappedFileChannel(
+        const char* filepath);
+
+/// \brief
+/// Creates a read-only IOChannel on data in memory.
+//
+/// Like a mapped file, the channel gives direct access to the data
+/// through IOChannel::contiguousData().
+///
+/// @param data The data, which must stay valid as long as the channel
+///             is used. It is not copied or freed.
+///
+/// @param size The size of the data in bytes.
+DSOEXPORT std::unique_ptr<IOChannel> makeMemoryChannel(const void* data,
+        size_t size);
+
 } // namespace gnash
 #endif 
 
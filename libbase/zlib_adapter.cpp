@@ -12,10 +12,12 @@
 #include <algorithm>
 #include <sstream>
 #include <memory>
+#include <vector>
 
 #include "IOChannel.h" // for inheritance
 #include "log.h"
 #include "GnashException.h"
+#include "utility.h"
 
 namespace gnash {
 
@@ -79,14 +81,55 @@ public:
 
 private:
 
+    /// Initial size of the compressed input buffer.
     static const int ZBUF_SIZE = 4096;
 
+    /// The input buffer never grows beyond this size.
+    static const int ZBUF_MAX_SIZE = 65536;
+
+    /// Size of the scratch buffer used to skip forward when seeking.
+    static const int SKIP_SIZE = 32768;
+
+    /// Size of the inflate history window (the dictionary).
+    static const int WINDOW_SIZE = 32768;
+
+    /// Minimum amount of uncompressed data between two checkpoints.
+    //
+    /// A seek never inflates more than this (plus one deflate block)
+    /// of data. Each checkpoint costs WINDOW_SIZE bytes of memory.
+    static const int CHECKPOINT_SPAN = 1 << 20;
+
+    /// A point in the stream where inflation can be restarted.
+    //
+    /// Checkpoints are taken at deflate block boundaries, the same
+    /// way zlib's zran example does.
+    struct Checkpoint
+    {
+        /// Position in the uncompressed (logical) stream.
+        std::streampos out;
+
+        /// Position of the first byte of the block in the input stream.
+        std::streampos in;
+
+        /// Number of bits of the byte before 'in' belonging to the block.
+        int bits;
+
+        /// The last WINDOW_SIZE bytes of uncompressed data before 'out'.
+        std::vector<unsigned char> window;
+    };
+
+    typedef std::vector<Checkpoint> Checkpoints;
+
     std::unique_ptr<IOChannel> m_in;
 
     // position of the input stream where we started inflating.
     std::streampos m_initial_stream_pos;
     
-    unsigned char m_rawdata[ZBUF_SIZE];
+    /// Compressed input buffer, grown as large sequential reads happen.
+    std::vector<unsigned char> m_rawdata;
+
+    /// Scratch space used to skip forward on seek.
+    std::vector<unsigned char> m_skipbuf;
     
     z_stream m_zstream;
 
@@ -96,6 +139,14 @@ private:
     bool m_at_eof;
     bool m_error;
 
+    /// Checkpoints sorted by uncompressed position.
+    Checkpoints m_checkpoints;
+
+    /// Whether checkpoints can be recorded and restored.
+    //
+    /// This is false if the zlib we are built against is too old.
+    bool m_can_checkpoint;
+
     /// Discard current results and rewind to the beginning.
     //
     //
@@ -106,6 +157,18 @@ private:
     ///
     void reset();
 
+    /// Restart inflation from the last checkpoint at or before pos.
+    //
+    /// @return false if no suitable checkpoint could be used, in
+    ///         which case the stream is left untouched.
+    bool restoreCheckpoint(std::streampos pos);
+
+    /// Record a checkpoint if inflate stopped at a block boundary
+    /// far enough from the last known checkpoint.
+    //
+    /// @param out  The logical position reached by the last inflate()
+    void maybeAddCheckpoint(std::streampos out);
+
     std::streamsize inflate_from_stream(void* dst, std::streamsize bytes);
 
     // If we have unused bytes in our input buffer, rewind
@@ -115,6 +178,10 @@ private:
 };
 
 const int InflaterIOChannel::ZBUF_SIZE;
+const int InflaterIOChannel::ZBUF_MAX_SIZE;
+const int InflaterIOChannel::SKIP_SIZE;
+const int InflaterIOChannel::WINDOW_SIZE;
+const int InflaterIOChannel::CHECKPOINT_SPAN;
 
 void
 InflaterIOChannel::rewind_unused_bytes()
@@ -136,7 +203,14 @@ InflaterIOChannel::reset()
 {
     m_error = 0;
     m_at_eof = 0;
+
+    // Restoring a checkpoint switches the stream to raw inflate, so
+    // make sure the zlib header is expected again.
+#if ZLIB_VERNUM >= 0x1280
+    const int err = inflateReset2(&m_zstream, MAX_WBITS);
+#else
     const int err = inflateReset(&m_zstream);
+#endif
     if (err != Z_OK) {
 	    log_error("inflater_impl::reset() inflateReset() returned %d",
 		      err);
@@ -162,6 +236,114 @@ InflaterIOChannel::reset()
     m_logical_stream_pos = m_initial_stream_pos;
 }
 
+bool
+InflaterIOChannel::restoreCheckpoint(std::streampos pos)
+{
+#if ZLIB_VERNUM >= 0x1280
+    if (!m_can_checkpoint || m_checkpoints.empty()) return false;
+
+    // Find the last checkpoint not after pos.
+    Checkpoints::const_iterator it = std::upper_bound(m_checkpoints.begin(),
+            m_checkpoints.end(), pos,
+            [](std::streampos p, const Checkpoint& c) { return p < c.out; });
+
+    if (it == m_checkpoints.begin()) return false;
+    --it;
+
+    const Checkpoint& cp = *it;
+
+    // Going to the checkpoint must be cheaper than just going on.
+    if (cp.out <= m_logical_stream_pos && pos >= m_logical_stream_pos) {
+        return false;
+    }
+
+    const std::streampos inpos = cp.bits ? cp.in - std::streamoff(1) : cp.in;
+    if (!m_in->seek(inpos)) {
+        log_error("InflaterIOChannel: unable to seek underlying stream "
+                "to checkpoint at %d", inpos);
+        return false;
+    }
+
+    // The checkpoint is in the middle of the deflate data, so there is
+    // no zlib header to read anymore.
+    int err = inflateReset2(&m_zstream, -MAX_WBITS);
+    if (err != Z_OK) {
+        log_error("InflaterIOChannel: inflateReset2() returned %d", err);
+        m_error = true;
+        return false;
+    }
+
+    m_zstream.next_in = nullptr;
+    m_zstream.avail_in = 0;
+    m_zstream.next_out = nullptr;
+    m_zstream.avail_out = 0;
+
+    if (cp.bits) {
+        unsigned char c;
+        if (m_in->read(&c, 1) != 1) {
+            log_error("InflaterIOChannel: unable to read checkpoint data");
+            m_error = true;
+            return false;
+        }
+        inflatePrime(&m_zstream, cp.bits, c >> (8 - cp.bits));
+    }
+
+    err = inflateSetDictionary(&m_zstream, &cp.window.front(),
+            cp.window.size());
+    if (err != Z_OK) {
+        log_error("InflaterIOChannel: inflateSetDictionary() returned %d",
+                err);
+        m_error = true;
+        return false;
+    }
+
+    m_error = false;
+    m_at_eof = false;
+    m_logical_stream_pos = cp.out;
+    return true;
+#else
+    UNUSED(pos);
+    return false;
+#endif
+}
+
+void
+InflaterIOChannel::maybeAddCheckpoint(std::streampos out)
+{
+#if ZLIB_VERNUM >= 0x1280
+    if (!m_can_checkpoint) return;
+
+    // Bit 7 set means inflate() stopped at a block boundary, bit 6
+    // that this was the last block.
+    if (!(m_zstream.data_type & 128) || (m_zstream.data_type & 64)) return;
+
+    // Only extend the index, and only every CHECKPOINT_SPAN bytes.
+    const std::streampos last = m_checkpoints.empty() ?
+        m_initial_stream_pos : m_checkpoints.back().out;
+
+    if (out - last < CHECKPOINT_SPAN) return;
+
+    Checkpoint cp;
+    cp.out = out;
+    cp.in = m_in->tell() - std::streamoff(m_zstream.avail_in);
+    cp.bits = m_zstream.data_type & 7;
+    cp.window.resize(WINDOW_SIZE);
+
+    uInt len = WINDOW_SIZE;
+    if (inflateGetDictionary(&m_zstream, &cp.window.front(), &len) != Z_OK) {
+        log_error("InflaterIOChannel: unable to get inflate dictionary, "
+                "disabling seek checkpoints");
+        m_can_checkpoint = false;
+        return;
+    }
+    cp.window.resize(len);
+
+    m_checkpoints.push_back(std::move(cp));
+#else
+    UNUSED(out);
+#endif
+}
+
 std::streamsize
 InflaterIOChannel::inflate_from_stream(void* dst, std::streamsize bytes)
 {
@@ -173,21 +355,35 @@ InflaterIOChannel::inflate_from_stream(void* dst, std::streamsize bytes)
     m_zstream.next_out = static_cast<unsigned char*>(dst);
     m_zstream.avail_out = bytes;
 
+    // Z_BLOCK makes inflate() return at every block boundary, which is
+    // where checkpoints can be taken.
+    const int flush = m_can_checkpoint ? Z_BLOCK : Z_SYNC_FLUSH;
+
     for (;;) {
         if (m_zstream.avail_in == 0) {
+
+            // Big reads consume the whole buffer each time: use a larger
+            // one to cut the number of calls to the underlying channel.
+            if (m_zstream.avail_out > m_rawdata.size() &&
+                    m_rawdata.size() < static_cast<size_t>(ZBUF_MAX_SIZE)) {
+                m_rawdata.resize(std::min<size_t>(ZBUF_MAX_SIZE,
+                            m_rawdata.size() * 2));
+            }
+
             // Get more raw data.
-            const int new_bytes = m_in->read(m_rawdata, ZBUF_SIZE);
+            const int new_bytes = m_in->read(&m_rawdata.front(),
+                    m_rawdata.size());
             if (new_bytes == 0) {
                 // The cupboard is bare!  We have nothing to feed to inflate().
                 break;
             }
             else {
-                m_zstream.next_in = m_rawdata;
+                m_zstream.next_in = &m_rawdata.front();
                 m_zstream.avail_in = new_bytes;
             }
         }
 
-        const int err = inflate(&m_zstream, Z_SYNC_FLUSH);
+        const int err = inflate(&m_zstream, flush);
         if (err == Z_STREAM_END) {
             m_at_eof = true;
             break;
@@ -218,6 +414,11 @@ InflaterIOChannel::inflate_from_stream(void* dst, std::streamsize bytes)
             break;
         }
 
+        if (m_can_checkpoint) {
+            maybeAddCheckpoint(m_logical_stream_pos +
+                    std::streamoff(bytes - m_zstream.avail_out));
+        }
+
         if (m_zstream.avail_out == 0) {
             break;
         }
@@ -241,11 +442,10 @@ InflaterIOChannel::go_to_end()
 
     // Keep reading until we can't read any more.
 
-    unsigned char temp[ZBUF_SIZE];
-
     // Seek forwards.
     for (;;) {
-        const std::streamsize bytes_read = inflate_from_stream(temp, ZBUF_SIZE);
+        const std::streamsize bytes_read =
+            inflate_from_stream(&m_skipbuf.front(), m_skipbuf.size());
         if (!bytes_read) {
             // We've seeked as far as we can.
             break;
@@ -261,24 +461,25 @@ InflaterIOChannel::seek(std::streampos pos)
         return false;
     }
 
-    // If we're seeking backwards, then restart from the beginning.
-    if (pos < m_logical_stream_pos) {
+    // Jump to the closest checkpoint if that saves inflating data.
+    // If we're seeking backwards without one, restart from the beginning.
+    if (!restoreCheckpoint(pos) && pos < m_logical_stream_pos) {
 	    log_debug("inflater reset due to seek back from %d to %d",
 		      m_logical_stream_pos, pos );
         reset();
     }
 
-    unsigned char temp[ZBUF_SIZE];
-
     // Now seek forwards, by just reading data in blocks.
     while (m_logical_stream_pos < pos) {
         std::streamsize to_read = pos - m_logical_stream_pos;
         assert(to_read > 0);
 
-        std::streamsize readNow = std::min<std::streamsize>(to_read, ZBUF_SIZE);
+        std::streamsize readNow = std::min<std::streamsize>(to_read,
+                m_skipbuf.size());
         assert(readNow > 0);
 
-        std::streamsize bytes_read = inflate_from_stream(temp, readNow);
+        std::streamsize bytes_read =
+            inflate_from_stream(&m_skipbuf.front(), readNow);
         assert(bytes_read <= readNow);
         if (bytes_read == 0) {
 		log_error("Trouble: can't seek any further.. ");
@@ -295,10 +496,17 @@ InflaterIOChannel::InflaterIOChannel(std::unique_ptr<IOChannel> in)
     :
     m_in(std::move(in)),
     m_initial_stream_pos(m_in->tell()),
+    m_rawdata(ZBUF_SIZE),
+    m_skipbuf(SKIP_SIZE),
     m_zstream(),
     m_logical_stream_pos(m_initial_stream_pos),
     m_at_eof(false),
-    m_error(0)
+    m_error(0),
+#if ZLIB_VERNUM >= 0x1280
+    m_can_checkpoint(true)
+#else
+    m_can_checkpoint(false)
+#endif
 {
     assert(m_in.get());
 
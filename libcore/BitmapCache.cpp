@@ -0,0 +1,233 @@
+// BitmapCache.cpp: rendered image of a MovieClip, for Gnash.
+//
+//   Copyright (C) 2012 Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#include "BitmapCache.h"
+
+#include <algorithm>
+#include <memory>
+#include <cmath>
+
+#include "MovieClip.h"
+#include "GnashImage.h"
+#include "FillStyle.h"
+#include "SWFRect.h"
+#include "SWFMatrix.h"
+#include "Renderer.h"
+#include "Transform.h"
+#include "Filters.h"
+#include "GnashNumeric.h"
+#include "log.h"
+
+namespace gnash {
+
+namespace {
+
+/// The largest image the reference player caches, in pixels.
+const std::int32_t maxSize = 2880;
+
+/// The distance between the pixels used to measure the stage scale.
+const int scaleSample = 1000;
+
+/// How far a blur of some passes spreads, in pixels.
+double
+blurMargin(float blurX, float blurY, int passes)
+{
+    return std::max(blurX, blurY) / 2 * passes;
+}
+
+}
+
+std::int32_t
+filterMargin(const Filters& filters)
+{
+    // Each filter also spreads what the ones before it drew.
+    double margin = 0;
+
+    for (const std::shared_ptr<BitmapFilter>& f : filters) {
+        const BitmapFilter* p = f.get();
+        if (const BlurFilter* b = dynamic_cast<const BlurFilter*>(p)) {
+            margin += blurMargin(b->m_blurX, b->m_blurY, b->m_quality);
+        }
+        else if (const GlowFilter* g = dynamic_cast<const GlowFilter*>(p)) {
+            margin += blurMargin(g->m_blurX, g->m_blurY, g->m_quality);
+        }
+        else if (const DropShadowFilter* d =
+                dynamic_cast<const DropShadowFilter*>(p)) {
+            margin += blurMargin(d->m_blurX, d->m_blurY, d->m_quality) +
+                std::abs(d->m_distance);
+        }
+        else if (const BevelFilter* b = dynamic_cast<const BevelFilter*>(p)) {
+            margin += blurMargin(b->m_blurX, b->m_blurY, b->m_quality) +
+                std::abs(b->m_distance);
+        }
+        else if (const GradientGlowFilter* g =
+                dynamic_cast<const GradientGlowFilter*>(p)) {
+            margin += blurMargin(g->m_blurX, g->m_blurY, g->m_quality) +
+                std::abs(g->m_distance);
+        }
+        else if (const GradientBevelFilter* g =
+                dynamic_cast<const GradientBevelFilter*>(p)) {
+            margin += blurMargin(g->m_blurX, g->m_blurY, g->m_quality) +
+                std::abs(g->m_distance);
+        }
+    }
+    return pixelsToTwips(std::ceil(margin));
+}
+
+BitmapCache::BitmapCache()
+    :
+    _valid(false),
+    _a(0),
+    _b(0),
+    _c(0),
+    _d(0),
+    _tx(0),
+    _ty(0),
+    _left(0),
+    _top(0)
+{
+}
+
+bool
+BitmapCache::display(MovieClip& mc, Renderer& renderer,
+        const Transform& xform)
+{
+    const SWFMatrix& mat = xform.matrix;
+
+    // The stage is only ever scaled and translated.
+    const point origin = renderer.pixel_to_world(0, 0);
+    const point scale = renderer.pixel_to_world(scaleSample, scaleSample);
+    if (scale.x <= origin.x || scale.y <= origin.y) return false;
+
+    const bool current = _valid && !mc.childInvalidated() &&
+        mat.a() == _a && mat.b() == _b && mat.c() == _c && mat.d() == _d &&
+        origin == _origin && scale == _scale && mc.filters() == _filters;
+
+    if (!current) {
+        _a = mat.a();
+        _b = mat.b();
+        _c = mat.c();
+        _d = mat.d();
+        _tx = mat.tx();
+        _ty = mat.ty();
+        _origin = origin;
+        _scale = scale;
+        _filters = mc.filters();
+        _valid = render(mc, renderer, mat);
+        if (!_valid) return false;
+    }
+
+    if (_shape.getBounds().is_null()) return true;
+
+    // Pixels per twip.
+    const double sx = static_cast<double>(scaleSample) / (scale.x - origin.x);
+    const double sy = static_cast<double>(scaleSample) / (scale.y - origin.y);
+
+    const std::int32_t left = _left + std::lround((mat.tx() - _tx) * sx);
+    const std::int32_t top = _top + std::lround((mat.ty() - _ty) * sy);
+
+    SWFMatrix m;
+    m.set_scale(1 / (20 * sx), 1 / (20 * sy));
+    m.set_translation(origin.x + std::lround(left / sx),
+            origin.y + std::lround(top / sy));
+
+    _shape.display(renderer, Transform(m, xform.colorTransform));
+    return true;
+}
+
+bool
+BitmapCache::render(MovieClip& mc, Renderer& renderer, const SWFMatrix& mat)
+{
+    _shape.clear();
+    _shape.setBounds(SWFRect());
+
+    SWFRect bounds = mc.getBounds();
+    if (bounds.is_null()) return true;
+    mat.transform(bounds);
+
+    const double sx = static_cast<double>(scaleSample) /
+        (_scale.x - _origin.x);
+    const double sy = static_cast<double>(scaleSample) /
+        (_scale.y - _origin.y);
+
+    // Leave a pixel around for antialiasing, and room for the filters.
+    const std::int32_t margin = filterMargin(_filters);
+    const std::int32_t mx = std::ceil(margin * sx) + 1;
+    const std::int32_t my = std::ceil(margin * sy) + 1;
+
+    _left = std::floor((bounds.get_x_min() - _origin.x) * sx) - mx;
+    _top = std::floor((bounds.get_y_min() - _origin.y) * sy) - my;
+    const std::int32_t width =
+        std::ceil((bounds.get_x_max() - _origin.x) * sx) + mx - _left;
+    const std::int32_t height =
+        std::ceil((bounds.get_y_max() - _origin.y) * sy) + my - _top;
+
+    if (width > maxSize || height > maxSize) return false;
+
+    std::unique_ptr<image::GnashImage> im(
+            new image::ImageRGBA(width, height));
+    std::fill(im->begin(), im->end(), 0);
+
+    {
+        Renderer::Internal in(renderer, *im);
+        Renderer* internal = in.renderer();
+        if (!internal) return false;
+
+        // Offscreen renderers have one pixel per 20 twips, and the
+        // image's top left corner at the origin.
+        SWFMatrix offscreen;
+        offscreen.set_scale(20 * sx, 20 * sy);
+        offscreen.set_translation(std::lround(-20 * (_origin.x * sx + _left)),
+                std::lround(-20 * (_origin.y * sy + _top)));
+        offscreen.concatenate(mat);
+
+        mc.drawContents(*internal, Transform(offscreen));
+    }
+
+    // Filters are in movie pixels, which are 20 twips.
+    if (!_filters.empty() &&
+            !renderer.applyFilters(*im, _filters, 20 * sx, 20 * sy)) {
+        LOG_ONCE(log_unimpl(_("Bitmap filters with this renderer")));
+    }
+
+    const CachedBitmap* bitmap = renderer.createCachedBitmap(std::move(im));
+    if (!bitmap) return false;
+
+    const std::int32_t w = pixelsToTwips(width);
+    const std::int32_t h = pixelsToTwips(height);
+
+    SWFMatrix fillMatrix;
+    fillMatrix.set_scale(1.0 / 20, 1.0 / 20);
+
+    const FillStyle fill = BitmapFill(BitmapFill::CLIPPED, bitmap,
+            fillMatrix, BitmapFill::SMOOTHING_UNSPECIFIED);
+    const size_t fillLeft = _shape.addFillStyle(fill);
+
+    Path bmpath(w, h, fillLeft, 0, 0);
+    bmpath.drawLineTo(w, 0);
+    bmpath.drawLineTo(0, 0);
+    bmpath.drawLineTo(0, h);
+    bmpath.drawLineTo(w, h);
+
+    _shape.add_path(bmpath);
+    _shape.setBounds(SWFRect(0, 0, w, h));
+    _shape.finalize();
+    return true;
+}
+
+} // namespace gnash
@@ -0,0 +1,117 @@
+// BitmapCache.h: rendered image of a MovieClip, for Gnash.
+//
+//   Copyright (C) 2012 Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifndef GNASH_BITMAPCACHE_H
+#define GNASH_BITMAPCACHE_H
+
+#include <cstdint>
+#include <boost/noncopyable.hpp>
+
+#include "DynamicShape.h"
+#include "Point2d.h"
+#include "filter_factory.h" // for Filters
+
+// Forward declarations
+namespace gnash {
+    class MovieClip;
+    class Renderer;
+    class Transform;
+}
+
+namespace gnash {
+
+/// How far filters may draw beyond the contents they filter, in twips.
+//
+/// Filters are not transformed with the DisplayObject they apply to,
+/// so this is the same at any scale.
+std::int32_t filterMargin(const Filters& filters);
+
+/// The contents of a MovieClip with cacheAsBitmap set, rendered offscreen.
+//
+/// A complex MovieClip that only moves around is then displayed by
+/// drawing a single bitmap. The image is rendered again when the
+/// MovieClip's content changes, or when it is scaled or rotated.
+/// Moves are snapped to whole pixels, as in the reference player.
+///
+/// The image is rendered without the MovieClip's color transform and
+/// mask, which are applied when the image is displayed. The MovieClip's
+/// filters are applied to the image, which has room around the contents
+/// for them (see filterMargin()), so they only run again when the image
+/// is rendered again.
+class BitmapCache : boost::noncopyable
+{
+public:
+
+    BitmapCache();
+
+    /// Display a MovieClip, rendering it again first if needed.
+    //
+    /// @param mc       The MovieClip whose contents are cached. Its
+    ///                 invalidated flags must not have been cleared since
+    ///                 it was last displayed.
+    /// @param renderer The renderer to display to.
+    /// @param xform    The transform the MovieClip is displayed with.
+    /// @return         false if the MovieClip can't be cached, for instance
+    ///                 because it is too big or the renderer can't render
+    ///                 offscreen. Nothing is displayed then.
+    bool display(MovieClip& mc, Renderer& renderer, const Transform& xform);
+
+    /// Drop the image, so that it is rendered again when next displayed.
+    void invalidate() {
+        _valid = false;
+    }
+
+private:
+
+    /// Render the MovieClip's contents to a new image.
+    bool render(MovieClip& mc, Renderer& renderer, const SWFMatrix& mat);
+
+    bool _valid;
+
+    /// The linear part of the matrix the image was rendered with.
+    std::int32_t _a;
+    std::int32_t _b;
+    std::int32_t _c;
+    std::int32_t _d;
+
+    /// The translation of the matrix the image was rendered with.
+    std::int32_t _tx;
+    std::int32_t _ty;
+
+    /// The position of the stage's pixel (0, 0), in twips.
+    point _origin;
+
+    /// The position of the stage's pixel (1000, 1000), in twips.
+    point _scale;
+
+    /// The filters the image was rendered with.
+    Filters _filters;
+
+    /// The pixel the top left corner of the image was rendered at.
+    std::int32_t _left;
+    std::int32_t _top;
+
+    /// The image, filling a rectangle from (0, 0) to its size in twips.
+    //
+    /// This is empty when the MovieClip has nothing to display.
+    DynamicShape _shape;
+};
+
+} // namespace gnash
+
+#endif
@@ -764,6 +764,29 @@ Button::getBounds() const
     return allBounds;
 }
 
+SWFRect
+Button::getHitBounds() const
+{
+    SWFRect allBounds;
+
+    // Active characters may contain Buttons with larger hit areas.
+    std::vector<const DisplayObject*> actChars;
+    getActiveCharacters(actChars);
+    for (const DisplayObject* ch : actChars) {
+        SWFRect lclBounds = ch->getHitBounds();
+        SWFMatrix m = getMatrix(*ch);
+        allBounds.expand_to_transformed_rect(m, lclBounds);
+    }
+
+    for (const DisplayObject* ch : _hitCharacters) {
+        SWFRect lclBounds = ch->getBounds();
+        SWFMatrix m = getMatrix(*ch);
+        allBounds.expand_to_transformed_rect(m, lclBounds);
+    }
+
+    return allBounds;
+}
+
 bool
 Button::pointInShape(std::int32_t x, std::int32_t y) const
 {
@@ -993,8 +1016,13 @@ as_value
 button_cacheAsBitmap(const fn_call& fn)
 {
     Button* obj = ensure<IsDisplayObject<Button> >(fn);
-    LOG_ONCE(log_unimpl(_("Button.cacheAsBitmap")));
-    UNUSED(obj);
+
+    if (!fn.nargs) {
+        return as_value(obj->cacheAsBitmap());
+    }
+
+    // Buttons are still rendered directly.
+    obj->setCacheAsBitmap(toBool(fn.arg(0), getVM(fn)));
     return as_value();
 }
 
@@ -43,31 +43,37 @@ namespace {
     /// in the "removed" depth zone
     DisplayList::iterator beginNonRemoved(DisplayList::container_type& c);
 
-#if GNASH_PARANOIA_LEVEL > 1 && !defined(NDEBUG)
     /// Return an constant iterator to the first element of the
     /// container NOT in the "removed" depth zone
     DisplayList::const_iterator beginNonRemoved(
             const DisplayList::container_type& c);
-#endif
 
     /// Return the first element in the DisplayList whose depth exceeds
     /// 65535 (-16384).
     DisplayList::iterator dlistTagsEffectiveZoneEnd(
             DisplayList::container_type& c);
-	
+
+    /// Return the first element whose depth is not less than the given one.
+    DisplayList::iterator lowerBound(DisplayList::container_type& c,
+            int depth);
+
+    /// Return the first element whose depth is not less than the given one.
+    DisplayList::const_iterator lowerBound(
+            const DisplayList::container_type& c, int depth);
+
+    /// Insert a DisplayObject before any other at the same or a higher depth.
+    void insertByDepth(DisplayList::container_type& c, DisplayObject* ch);
+
+    /// Return the DisplayObject owning the DisplayList, or 0 if unknown.
+    DisplayObject* owner(const DisplayList::container_type& c);
+
+    /// Record a change to the children of a DisplayObject's parent.
+    void childrenChanged(DisplayObject* ch);
 }
 
 /// Anonymous namespace for generic algorithm functors.
 namespace {
 
-struct DepthEquals : std::binary_function<const DisplayObject*, int, bool>
-{
-    bool operator()(const DisplayObject* item, int depth) const {
-        if (!item) return false;
-        return item->get_depth() == depth;
-    }
-};
-
 struct DepthLessThan : std::binary_function<const DisplayObject*, int, bool>
 {
     bool operator()(const DisplayObject* item, int depth) const {
@@ -76,14 +82,6 @@ struct DepthLessThan : std::binary_function<const DisplayObject*, int, bool>
     }
 };
 
-struct DepthGreaterThan : std::binary_function<const DisplayObject*, int, bool>
-{
-    bool operator()(const DisplayObject* item, int depth) const {
-        if (!item) return false;
-        return item->get_depth() > depth;
-    }
-};
-
 class NameEquals
 {
 public:
@@ -118,15 +116,9 @@ DisplayList::getNextHighestDepth() const
 {
     testInvariant();
 
-    int nexthighestdepth=0;
-    for (DisplayObject* ch : _charsByDepth) {
-
-        const int chdepth = ch->get_depth();
-        if (chdepth >= nexthighestdepth) {
-            nexthighestdepth = chdepth+1;
-        }
-    }
-    return nexthighestdepth;
+    // The highest depth is the last.
+    if (_charsByDepth.empty()) return 0;
+    return std::max(_charsByDepth.back()->get_depth() + 1, 0);
 }
 
 DisplayObject*
@@ -134,16 +126,18 @@ DisplayList::getDisplayObjectAtDepth(int depth) const
 {
     testInvariant();
 
-    for (DisplayObject* ch : _charsByDepth) {
+    for (const_iterator it = lowerBound(_charsByDepth, depth),
+            e = _charsByDepth.end(); it != e; ++it) {
+
+        DisplayObject* ch = *it;
+
+        // non-existent (chars are ordered by depth)
+        if (ch->get_depth() != depth) return nullptr;
 
         // Should not be there!
         if (ch->isDestroyed()) continue;
 
-        // found
-        if (ch->get_depth() == depth) return ch;
-
-        // non-existent (chars are ordered by depth)
-        if (ch->get_depth() > depth) return nullptr;
+        return ch;
     }
 
     return nullptr;
@@ -176,9 +170,7 @@ DisplayList::placeDisplayObject(DisplayObject* ch, int depth)
     ch->set_depth(depth);
 
     container_type::iterator it =
-        std::find_if( _charsByDepth.begin(), _charsByDepth.end(),
-                std::bind(std::not2(DepthLessThan()), std::placeholders::_1,
-                     depth));
+        lowerBound(_charsByDepth, depth);
 
     if (it == _charsByDepth.end() || (*it)->get_depth() != depth) {
         // add the new char
@@ -205,6 +197,7 @@ DisplayList::placeDisplayObject(DisplayObject* ch, int depth)
         ch->extend_invalidated_bounds(old_ranges);                
     }
 
+    childrenChanged(ch);
     testInvariant();
 }
 
@@ -214,15 +207,14 @@ DisplayList::add(DisplayObject* ch, bool replace)
     const int depth = ch->get_depth();
 
     container_type::iterator it =
-        std::find_if(_charsByDepth.begin(), _charsByDepth.end(),
-                std::bind(std::not2(DepthLessThan()), std::placeholders::_1,
-                     depth));
+        lowerBound(_charsByDepth, depth);
 
     if (it == _charsByDepth.end() || (*it)->get_depth() != depth) {
         _charsByDepth.insert(it, ch);
     }
     else if (replace) *it = ch;
 
+    childrenChanged(ch);
     testInvariant();
 }
 
@@ -239,8 +231,7 @@ DisplayList::replaceDisplayObject(DisplayObject* ch, int depth,
     ch->set_depth(depth);
 
     container_type::iterator it =
-        std::find_if(_charsByDepth.begin(), _charsByDepth.end(),
-            std::bind(std::not2(DepthLessThan()), std::placeholders::_1, depth));
+        lowerBound(_charsByDepth, depth);
 
     if (it == _charsByDepth.end() || (*it)->get_depth() != depth) {
         _charsByDepth.insert(it, ch);
@@ -284,6 +275,7 @@ DisplayList::replaceDisplayObject(DisplayObject* ch, int depth,
 
     }
 
+    childrenChanged(ch);
     testInvariant();
 }
     
@@ -338,12 +330,9 @@ DisplayList::removeDisplayObject(int depth)
 
     // TODO: would it be legal to call removeDisplayObject with a depth
     //             in the "removed" zone ?
-    // TODO: optimize to take by-depth order into account
-    container_type::iterator it = 
-        std::find_if( _charsByDepth.begin(), _charsByDepth.end(),
-            std::bind(DepthEquals(), std::placeholders::_1, depth));
+    container_type::iterator it = lowerBound(_charsByDepth, depth);
 
-    if (it != _charsByDepth.end()) {
+    if (it != _charsByDepth.end() && (*it)->get_depth() == depth) {
         // Make a copy (before erasing)
         DisplayObject* oldCh = *it;
 
@@ -359,6 +348,8 @@ DisplayList::removeDisplayObject(int depth)
             reinsertRemovedCharacter(oldCh);
         }
         else oldCh->destroy();
+
+        childrenChanged(oldCh);
     }
 
     assert(size >= _charsByDepth.size());
@@ -389,15 +380,16 @@ DisplayList::swapDepths(DisplayObject* ch1, int newdepth)
 
     assert(srcdepth != newdepth);
 
-    // TODO: optimize this scan by taking ch1 depth into account ?
-    container_type::iterator it1 =
-        std::find(_charsByDepth.begin(), _charsByDepth.end(), ch1);
+    container_type::iterator it1 = lowerBound(_charsByDepth, srcdepth);
+    while (it1 != _charsByDepth.end() && *it1 != ch1 &&
+            (*it1)->get_depth() == srcdepth) {
+        ++it1;
+    }
+    if (it1 != _charsByDepth.end() && *it1 != ch1) it1 = _charsByDepth.end();
 
     // upper bound ...
     container_type::iterator it2 =
-        std::find_if(_charsByDepth.begin(), _charsByDepth.end(),
-            std::bind(std::not2(DepthLessThan()), std::placeholders::_1,
-                newdepth));
+        lowerBound(_charsByDepth, newdepth);
 
     if (it1 == _charsByDepth.end()) {
         log_error(_("First argument to DisplayList::swapDepth() "
@@ -422,11 +414,10 @@ DisplayList::swapDepths(DisplayObject* ch1, int newdepth)
     }
     else {
         // No DisplayObject found at the given depth
-        // Move the DisplayObject to the new position
-        // NOTE: insert *before* erasing, in case the list is
-        //             the only referer of the ref-counted DisplayObject
-        _charsByDepth.insert(it2, ch1);
-        _charsByDepth.erase(it1);
+        // Move the DisplayObject to the new position, shifting those
+        // in between.
+        if (it1 < it2) std::rotate(it1, it1 + 1, it2);
+        else std::rotate(it2, it1, it1 + 1);
     }
 
     // don't change depth before the iter_swap case above, as
@@ -441,6 +432,7 @@ DisplayList::swapDepths(DisplayObject* ch1, int newdepth)
     // See displaylist_depths_test6.swf for more info.
     ch1->transformedByScript();
 
+    childrenChanged(ch1);
     testInvariant();
 }
 void
@@ -455,12 +447,10 @@ DisplayList::insertDisplayObject(DisplayObject* obj, int index)
 
     // Find the first index greater than or equal to the required index
     container_type::iterator it =
-        std::find_if(_charsByDepth.begin(), _charsByDepth.end(),
-            std::bind(std::not2(DepthLessThan()), std::placeholders::_1,
-                index));
+        lowerBound(_charsByDepth, index);
         
     // Insert the DisplayObject before that position
-    _charsByDepth.insert(it, obj);
+    it = _charsByDepth.insert(it, obj) + 1;
 
     // Shift depths upwards until no depths are duplicated. No DisplayObjects
     // are removed!
@@ -469,6 +459,7 @@ DisplayList::insertDisplayObject(DisplayObject* obj, int index)
         ++index, ++it;
     }
 
+    childrenChanged(obj);
     testInvariant();
 }
 
@@ -478,14 +469,17 @@ DisplayList::unload()
 {
     testInvariant();
 
+    DisplayObject* o = owner(_charsByDepth);
     bool unloadHandler = false;
 
     // All children with an unload handler should be unloaded. As soon as
     // the first unload handler is encountered, subsequent children should
     // not be destroyed or removed from the display list. This affects
     // children without an unload handler.
-    for (iterator it = beginNonRemoved(_charsByDepth),
-            itEnd = _charsByDepth.end(); it != itEnd; ) {
+    // The DisplayObjects kept are moved down to 'kept', so that the
+    // others are removed at once.
+    iterator kept = beginNonRemoved(_charsByDepth);
+    for (iterator it = kept, itEnd = _charsByDepth.end(); it != itEnd; ++it) {
         // make a copy
         DisplayObject* di = *it;
 
@@ -495,17 +489,16 @@ DisplayList::unload()
         // Destroy those with a handler anyway?
         if (di->unload()) {
             unloadHandler = true;
-            ++it;
+            *kept++ = di;
             continue;
         }
 
-        if (!unloadHandler) {
-            di->destroy();
-            it = _charsByDepth.erase(it);
-        }
-        else ++it;
+        if (!unloadHandler) di->destroy();
+        else *kept++ = di;
     }
+    _charsByDepth.erase(kept, _charsByDepth.end());
 
+    if (o) o->contentChanged();
     testInvariant();
 
     return unloadHandler;
@@ -517,21 +510,23 @@ DisplayList::destroy()
 {
     testInvariant();
 
-    for (iterator it = _charsByDepth.begin(), itEnd = _charsByDepth.end();
-            it != itEnd; ) {
+    DisplayObject* o = owner(_charsByDepth);
+    iterator kept = _charsByDepth.begin();
+    for (iterator it = kept, itEnd = _charsByDepth.end(); it != itEnd; ++it) {
 
         // make a copy
         DisplayObject* di = *it;
 
         // skip if already unloaded
         if ( di->isDestroyed() ) {
-            ++it;
+            *kept++ = di;
             continue;
         }
 
         di->destroy();
-        it = _charsByDepth.erase(it); 
     }
+    _charsByDepth.erase(kept, _charsByDepth.end());
+    if (o) o->contentChanged();
     testInvariant();
 }
 
@@ -589,7 +584,7 @@ DisplayList::display(Renderer& renderer, const Transform& base)
             renderer.begin_submit_mask();
         }
         
-        if (ch->boundsInClippingArea(renderer)) {
+        if (ch->boundsInClippingArea(renderer, base.matrix)) {
             ch->display(renderer, base);
         }
         else ch->omit_display();
@@ -733,127 +728,132 @@ DisplayList::mergeDisplayList(DisplayList& newList, DisplayObject& o)
 {
     testInvariant();
 
-    iterator itOld = beginNonRemoved(_charsByDepth);
-    iterator itNew = beginNonRemoved(newList._charsByDepth);
+    container_type& newChars = newList._charsByDepth;
 
-    iterator itOldEnd = dlistTagsEffectiveZoneEnd(_charsByDepth);
-    iterator itNewEnd = dlistTagsEffectiveZoneEnd(newList._charsByDepth);
+    const iterator oldBegin = beginNonRemoved(_charsByDepth);
+    const iterator oldEnd = dlistTagsEffectiveZoneEnd(_charsByDepth);
+    const iterator newBegin = beginNonRemoved(newChars);
+    const iterator newEnd = dlistTagsEffectiveZoneEnd(newChars);
 
-    // step1. 
-    // starting scanning both lists.
-    while (itOld != itOldEnd) {
+    // The merged list is built aside, starting with the old removed zone.
+    container_type merged(_charsByDepth.begin(), oldBegin);
+    merged.reserve(_charsByDepth.size() + (newEnd - newBegin));
 
-        iterator itOldBackup = itOld;
-        
-        DisplayObject* chOld = *itOldBackup;
-        const int depthOld = chOld->get_depth();
+    // Old DisplayObjects to reinsert in the removed zone once merged.
+    container_type unloaded;
 
-        while (itNew != itNewEnd) {
-            iterator itNewBackup = itNew;
-            
-            DisplayObject* chNew = *itNewBackup;
-            const int depthNew = chNew->get_depth();
-            
-            // depth in old list is occupied, and empty in new list.
-            if (depthOld < depthNew) {
+    // Unload or destroy an old DisplayObject left out of the merged list.
+    auto remove = [&unloaded] (DisplayObject* ch) {
+        if (ch->unload()) unloaded.push_back(ch);
+        else ch->destroy();
+    };
+
+    iterator itOld = oldBegin;
+    iterator itNew = newBegin;
 
-                ++itOld;
-                // unload the DisplayObject if it's in static zone(-16384,0)
-                if (depthOld < 0) {
-                    o.set_invalidated();
-                    _charsByDepth.erase(itOldBackup);
+    // step1. 
+    // starting scanning both lists.
+    while (itOld != oldEnd && itNew != newEnd) {
 
-                     if (chOld->unload()) reinsertRemovedCharacter(chOld);
-                     else chOld->destroy();
-                }
+        DisplayObject* chOld = *itOld;
+        const int depthOld = chOld->get_depth();
 
-                break;
-            }
-            // depth is occupied in both lists
+        DisplayObject* chNew = *itNew;
+        const int depthNew = chNew->get_depth();
             
-            if (depthOld == depthNew) {
-                ++itOld;
-                ++itNew;
-                
-                const bool is_ratio_compatible = 
-                    (chOld->get_ratio() == chNew->get_ratio());
-
-                if (!is_ratio_compatible || chOld->isDynamic() ||
-                        !isReferenceable(*chOld)) {
-                    // replace the DisplayObject in old list with
-                    // corresponding DisplayObject in new list
-                    o.set_invalidated();
-                    _charsByDepth.insert(itOldBackup, *itNewBackup);
-                    _charsByDepth.erase(itOldBackup);
-                    
-                    // unload the old DisplayObject
-                    if (chOld->unload()) reinsertRemovedCharacter(chOld); 
-                    else chOld->destroy();
-                }
-                else {
-                    newList._charsByDepth.erase(itNewBackup);
-
-                    // replace the transformation SWFMatrix if the old
-                    // DisplayObject accepts static transformation.
-                    if (chOld->get_accept_anim_moves()) {
-                        chOld->setMatrix(getMatrix(*chNew), true); 
-                        chOld->setCxForm(getCxForm(*chNew));
-                    }
-                    chNew->unload();
-                    chNew->destroy();
-                }
-
-                break;
+        // depth in old list is occupied, and empty in new list.
+        if (depthOld < depthNew) {
+
+            ++itOld;
+            // unload the DisplayObject if it's in static zone(-16384,0)
+            if (depthOld < 0) {
+                o.set_invalidated();
+                remove(chOld);
             }
+            else merged.push_back(chOld);
+            continue;
+        }
 
-            // depth in old list is empty, but occupied in new list.
+        // depth in old list is empty, but occupied in new list.
+        if (depthOld > depthNew) {
             ++itNew;
             // add the new DisplayObject to the old list.
             o.set_invalidated();
-            _charsByDepth.insert(itOldBackup, *itNewBackup);
+            merged.push_back(chNew);
+            continue;
         }
 
-        // break if finish scanning the new list
-        if (itNew == itNewEnd) break;
+        // depth is occupied in both lists
+        ++itOld;
+        ++itNew;
+                
+        const bool is_ratio_compatible = 
+            (chOld->get_ratio() == chNew->get_ratio());
+
+        if (!is_ratio_compatible || chOld->isDynamic() ||
+                !isReferenceable(*chOld)) {
+            // replace the DisplayObject in old list with
+            // corresponding DisplayObject in new list
+            o.set_invalidated();
+            merged.push_back(chNew);
+            
+            // unload the old DisplayObject
+            remove(chOld);
+        }
+        else {
+            merged.push_back(chOld);
+
+            // Drop it from the new list.
+            *(itNew - 1) = nullptr;
+
+            // replace the transformation SWFMatrix if the old
+            // DisplayObject accepts static transformation.
+            if (chOld->get_accept_anim_moves()) {
+                chOld->setMatrix(getMatrix(*chNew), true); 
+                chOld->setCxForm(getCxForm(*chNew));
+            }
+            chNew->unload();
+            chNew->destroy();
+        }
     }
 
     // step2(only required if scanning of new list finished earlier in step1).
     // continue to scan the static zone of the old list.
     // unload remaining DisplayObjects directly.
-    while ((itOld != itOldEnd) && ((*itOld)->get_depth() < 0)) {
+    for (; itOld != oldEnd; ++itOld) {
 
         DisplayObject* chOld = *itOld;
-        o.set_invalidated();
-        itOld = _charsByDepth.erase(itOld);
-
-        if (chOld->unload()) reinsertRemovedCharacter(chOld);
-        else chOld->destroy();
+        if (chOld->get_depth() < 0) {
+            o.set_invalidated();
+            remove(chOld);
+        }
+        else merged.push_back(chOld);
     }
 
     // step3(only required if scanning of old list finished earlier in step1).
     // continue to scan the new list.
     // add remaining DisplayObjects directly.
-    if (itNew != itNewEnd) {
+    if (itNew != newEnd) {
         o.set_invalidated();
-        _charsByDepth.insert(itOld, itNew, itNewEnd);
+        merged.insert(merged.end(), itNew, newEnd);
     }
 
+    // Keep the old DisplayObjects above the zone of timeline depths.
+    merged.insert(merged.end(), oldEnd, _charsByDepth.end());
+    _charsByDepth.swap(merged);
+
+    for (DisplayObject* ch : unloaded) reinsertRemovedCharacter(ch);
+
     // step4.
     // Copy all unloaded DisplayObjects from the new display list to the
     // old display list, and clear the new display list
-    for (itNew = newList._charsByDepth.begin(); itNew != itNewEnd; ++itNew) {
+    for (itNew = newChars.begin(); itNew != newEnd; ++itNew) {
 
         DisplayObject* chNew = *itNew;
-        const int depthNew = chNew->get_depth();
 
-        if (chNew->unloaded()) {
-            iterator it =
-                std::find_if(_charsByDepth.begin(), _charsByDepth.end(),
-                    std::bind(std::not2(DepthLessThan()), std::placeholders::_1,
-                        depthNew));
-            
+        if (chNew && chNew->unloaded()) {
             o.set_invalidated();
-            _charsByDepth.insert(it, *itNew);
+            insertByDepth(_charsByDepth, chNew);
         }
     }
 
@@ -866,14 +866,14 @@ DisplayList::mergeDisplayList(DisplayList& newList, DisplayObject& o)
             e = newList._charsByDepth.end(); i != e; ++i) {
 
         DisplayObject* ch = *i;
-        if (!ch->unloaded()) {
+        if (ch && !ch->unloaded()) {
 
             iterator found =
                 std::find(_charsByDepth.begin(), _charsByDepth.end(), ch);
             
             if (found == _charsByDepth.end())
             {
-                log_error)_("mergeDisplayList: DisplayObject %s (%s at depth "
+                log_error(_("mergeDisplayList: DisplayObject %s (%s at depth "
                         "%d [%d]) about to be discarded in given display list"
                         " is not marked as unloaded and not found in the"
 			    " merged current displaylist"),
@@ -886,6 +886,7 @@ DisplayList::mergeDisplayList(DisplayList& newList, DisplayObject& o)
 #endif
     newList._charsByDepth.clear();
 
+    o.contentChanged();
     testInvariant();
 }
 
@@ -902,14 +903,9 @@ DisplayList::reinsertRemovedCharacter(DisplayObject* ch)
     int newDepth = DisplayObject::removedDepthOffset - oldDepth;
     ch->set_depth(newDepth);
 
-    // TODO: optimize this by searching from the end(lowest depth).
-    container_type::iterator it =
-        std::find_if(_charsByDepth.begin(), _charsByDepth.end(),
-                std::bind(std::not2(DepthLessThan()), std::placeholders::_1,
-                    newDepth));
-
-    _charsByDepth.insert(it, ch);
+    insertByDepth(_charsByDepth, ch);
 
+    childrenChanged(ch);
     testInvariant();
 }
 
@@ -918,17 +914,46 @@ DisplayList::removeUnloaded()
 {
     testInvariant();
 
-    _charsByDepth.remove_if(std::mem_fn(&DisplayObject::unloaded));
+    DisplayObject* o = owner(_charsByDepth);
+    _charsByDepth.erase(std::remove_if(_charsByDepth.begin(),
+                _charsByDepth.end(), std::mem_fn(&DisplayObject::unloaded)),
+            _charsByDepth.end());
 
+    if (o) o->contentChanged();
     testInvariant();
 }
 
 
+bool
+DisplayList::checkInvariant() const
+{
+    // check we didn't screw up ordering
+    for (const_iterator it = _charsByDepth.begin(), e = _charsByDepth.end();
+            it != e; ++it) {
+        if (it + 1 != e && (*it)->get_depth() > (*(it + 1))->get_depth()) {
+            log_debug("DisplayList %p is not sorted by depth",
+                    (const void*)this);
+            return false;
+        }
+    }
+
+    // check no duplicated depths above non-removed zone.
+    for (const_iterator it = beginNonRemoved(_charsByDepth),
+            e = _charsByDepth.end(); it != e; ++it) {
+        if (it + 1 != e && (*it)->get_depth() == (*(it + 1))->get_depth()) {
+            log_debug("Depth %d is duplicated in DisplayList %p",
+                    (*it)->get_depth(), (const void*)this);
+            return false;
+        }
+    }
+    return true;
+}
+
 #if GNASH_PARANOIA_LEVEL > 1 && !defined(NDEBUG)
-DisplayList::const_iterator
-DisplayList::nonRemoved() const
+void
+DisplayList::testInvariant() const
 {
-    return beginNonRemoved(_charsByDepth);
+    if (!checkInvariant()) std::abort();
 }
 #endif
 
@@ -941,12 +966,9 @@ beginNonRemoved(DisplayList::container_type& c)
     const int depth = 1 + DisplayObject::removedDepthOffset -
         DisplayObject::staticDepthOffset;
     
-    return std::find_if(c.begin(), c.end(),
-            std::bind(std::not2(DepthLessThan()), std::placeholders::_1,
-                depth));
+    return lowerBound(c, depth);
 }
 
-#if GNASH_PARANOIA_LEVEL > 1 && !defined(NDEBUG)
 DisplayList::const_iterator
 beginNonRemoved(const DisplayList::container_type& c)
 {
@@ -954,18 +976,47 @@ beginNonRemoved(const DisplayList::container_type& c)
     const int depth = 1 + DisplayObject::removedDepthOffset -
         DisplayObject::staticDepthOffset;
 
-    return std::find_if(c.begin(), c.end(), 
-            std::bind(std::not2(DepthLessThan()), std::placeholders::_1,
-                depth));
+    return lowerBound(c, depth);
 }
-#endif
 
 DisplayList::iterator
 dlistTagsEffectiveZoneEnd(DisplayList::container_type& c)
 {
-    return std::find_if(c.begin(), c.end(), 
-            std::bind(DepthGreaterThan(), std::placeholders::_1,
-                0xffff + DisplayObject::staticDepthOffset));
+    const int depth = 0xffff + DisplayObject::staticDepthOffset;
+    return std::upper_bound(c.begin(), c.end(), depth,
+            [] (int d, const DisplayObject* item) {
+                return d < item->get_depth();
+            });
+}
+
+DisplayList::iterator
+lowerBound(DisplayList::container_type& c, int depth)
+{
+    return std::lower_bound(c.begin(), c.end(), depth, DepthLessThan());
+}
+
+DisplayList::const_iterator
+lowerBound(const DisplayList::container_type& c, int depth)
+{
+    return std::lower_bound(c.begin(), c.end(), depth, DepthLessThan());
+}
+
+void
+insertByDepth(DisplayList::container_type& c, DisplayObject* ch)
+{
+    c.insert(lowerBound(c, ch->get_depth()), ch);
+}
+
+DisplayObject*
+owner(const DisplayList::container_type& c)
+{
+    return c.empty() ? nullptr : c.front()->parent();
+}
+
+void
+childrenChanged(DisplayObject* ch)
+{
+    if (DisplayObject* p = ch->parent()) p->contentChanged();
 }
 
 } // anonymous namespace
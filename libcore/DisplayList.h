@@ -20,14 +20,8 @@
 #ifndef GNASH_DLIST_H
 #define GNASH_DLIST_H
 
-#include <list>
+#include <vector>
 #include <iosfwd>
-#if GNASH_PARANOIA_LEVEL > 1 && !defined(NDEBUG)
-#include "DisplayObject.h"
-#include <set>  // for testInvariant
-#include <algorithm>
-#include "log.h"
-#endif
 
 #include "snappingrange.h"
 #include "dsodefs.h" // for DSOTEXPORT
@@ -61,12 +55,16 @@ namespace gnash {
 /// tags instructing when to add or remove DisplayObjects
 /// from the stage.
 ///
+/// The DisplayObjects are kept in an array sorted by depth, so that
+/// they are found by binary search and iterated without chasing
+/// pointers. Iterators are invalidated by any change to the list.
+///
 class DisplayList
 {
 
 public:
 
-	typedef std::list<DisplayObject*> container_type;
+	typedef std::vector<DisplayObject*> container_type;
 	typedef container_type::iterator iterator;
 	typedef container_type::const_iterator const_iterator;
 	typedef container_type::reverse_iterator reverse_iterator;
@@ -302,31 +300,14 @@ public:
         return _charsByDepth != other._charsByDepth;
     }
 	
+    /// Check that the DisplayObjects are sorted by depth, and that
+    /// no depth outside the "removed" zone is used twice.
+    //
+    /// @return false if the list is inconsistent.
+    DSOTEXPORT bool checkInvariant() const;
+
 #if GNASH_PARANOIA_LEVEL > 1 && !defined(NDEBUG)
-    DisplayList::const_iterator nonRemoved() const;
-
-    void testInvariant() const
-	{
-		DisplayList sorted = *this;
-
-        // check no duplicated depths above non-removed zone.
-		std::set<int> depths;
-		for (const_iterator it = nonRemoved(),
-                itEnd = _charsByDepth.end(); it != itEnd; ++it) {
-
-			DisplayObject* ch = *it;
-			int depth = ch->get_depth();
-			if (!depths.insert(depth).second) {
-				log_debug("Depth %d is duplicated in DisplayList %p",
-                        depth, (const void*)this);
-                std::abort();
-			}
-		}
-        if (_charsByDepth.empty()) return;
-		// check we didn't screw up ordering
-        assert(std::adjacent_find(_charsByDepth.begin(), _charsByDepth.end(),
-            DepthGreaterThan()) == _charsByDepth.end());
-	}
+    void testInvariant() const;
 #else
     void testInvariant() const {}
 #endif 
@@ -25,6 +25,7 @@
 #include "DisplayObject.h"
 
 #include <utility>
+#include <algorithm>
 #include <functional>
 #include <boost/logic/tribool.hpp>
 
@@ -83,6 +84,10 @@ const int DisplayObject::staticDepthOffset;
 const int DisplayObject::removedDepthOffset;
 const int DisplayObject::noClipDepthValue;
 
+std::uint64_t DisplayObject::_lastVersion = 0;
+
+std::uint64_t DisplayObject::_transformChanges = 1;
+
 DisplayObject::DisplayObject(movie_root& mr, as_object* object,
         DisplayObject* parent)
     :
@@ -91,6 +96,12 @@ DisplayObject::DisplayObject(movie_root& mr, as_object* object,
     _parent(parent),
     _object(object),
     _stage(mr),
+    _contentVersion(++_lastVersion),
+    _transformVersion(_contentVersion),
+    _worldMatrixVersion(0),
+    _worldMatrixChecked(0),
+    _worldCxFormVersion(0),
+    _worldCxFormChecked(0),
     _xscale(100),
     _yscale(100),
     _rotation(0),
@@ -103,6 +114,7 @@ DisplayObject::DisplayObject(movie_root& mr, as_object* object,
     _mask(nullptr),
     _maskee(nullptr),
     _blendMode(BLENDMODE_NORMAL),
+    _cacheAsBitmap(false),
     _visible(true),
     _scriptTransformed(false),
     _dynamicallyCreated(false),
@@ -220,6 +232,11 @@ DisplayObject::set_invalidated(const char* debug_file, int debug_line)
         m_old_invalidated_ranges.setNull();
         add_invalidated_bounds(m_old_invalidated_ranges, true);
     }
+
+    // Cached bounds of our ancestors are stale after every change, not
+    // only the first one since the last redraw. This is done last, as
+    // the old bounds computed above may have been cached.
+    if (_parent) _parent->contentChanged();
 }
 
 void
@@ -399,6 +416,7 @@ DisplayObject::setMatrix(const SWFMatrix& m, bool updateCache)
 
     set_invalidated(__FILE__, __LINE__);
     _transform.matrix = m;
+    transformChanged();
 
     // don't update caches if SWFMatrix wasn't updated too
     if (updateCache) {
@@ -409,6 +427,65 @@ DisplayObject::setMatrix(const SWFMatrix& m, bool updateCache)
 
 }
 
+void
+DisplayObject::contentChanged()
+{
+    const std::uint64_t version = ++_lastVersion;
+    for (DisplayObject* o = this; o; o = o->_parent) {
+        o->_contentVersion = version;
+    }
+}
+
+void
+DisplayObject::transformChanged()
+{
+    _transformVersion = ++_lastVersion;
+    ++_transformChanges;
+}
+
+const SWFMatrix&
+DisplayObject::worldMatrix() const
+{
+    // Nothing moved since the cache was last checked.
+    if (_worldMatrixChecked == _transformChanges) return _worldMatrix;
+
+    // Our parent's cache is brought up to date first, so that its
+    // version covers all our ancestors.
+    const SWFMatrix* parentMatrix =
+        _parent ? &_parent->worldMatrix() : nullptr;
+    const std::uint64_t version = parentMatrix ?
+        std::max(_transformVersion, _parent->_worldMatrixVersion) :
+        _transformVersion;
+
+    if (_worldMatrixVersion != version) {
+        _worldMatrix = parentMatrix ? *parentMatrix : SWFMatrix();
+        _worldMatrix.concatenate(_transform.matrix);
+        _worldMatrixVersion = version;
+    }
+    _worldMatrixChecked = _transformChanges;
+    return _worldMatrix;
+}
+
+const SWFCxForm&
+DisplayObject::worldCxForm() const
+{
+    if (_worldCxFormChecked == _transformChanges) return _worldCxForm;
+
+    const SWFCxForm* parentCxForm =
+        _parent ? &_parent->worldCxForm() : nullptr;
+    const std::uint64_t version = parentCxForm ?
+        std::max(_transformVersion, _parent->_worldCxFormVersion) :
+        _transformVersion;
+
+    if (_worldCxFormVersion != version) {
+        _worldCxForm = parentCxForm ? *parentCxForm : SWFCxForm();
+        _worldCxForm.concatenate(_transform.colorTransform);
+        _worldCxFormVersion = version;
+    }
+    _worldCxFormChecked = _transformChanges;
+    return _worldCxForm;
+}
+
 void
 DisplayObject::set_event_handlers(const Events& copyfrom)
 {
@@ -454,6 +531,7 @@ DisplayObject::unload()
     if (_mask) _mask->setMaskee(nullptr);
 
     _unloaded = true;
+    if (_parent) _parent->contentChanged();
 
     return unloadHandler;
 }
@@ -763,6 +841,8 @@ DisplayObject::setMaskee(DisplayObject* maskee)
 {
     if ( _maskee == maskee ) { return; }
 
+    if (_parent) _parent->contentChanged();
+
     if (_maskee) {
         // We don't want the maskee to call setMaskee(null)
         // on us again
@@ -781,10 +861,13 @@ DisplayObject::setMaskee(DisplayObject* maskee)
 
 
 bool 
-DisplayObject::boundsInClippingArea(Renderer& renderer) const 
+DisplayObject::boundsInClippingArea(Renderer& renderer,
+        const SWFMatrix& base) const 
 {
     SWFRect mybounds = getBounds();
-    getWorldMatrix(*this).transform(mybounds);
+    SWFMatrix m = base;
+    m.concatenate(getMatrix(*this));
+    m.transform(mybounds);
   
     return renderer.bounds_in_clipping_area(mybounds.getRange());  
 }
@@ -41,6 +41,7 @@
 #include "SWFCxForm.h"
 #include "dsodefs.h" 
 #include "snappingrange.h"
+#include "filter_factory.h" // for Filters
 #ifdef USE_SWFTREE
 # include "tree.hh"
 #endif
@@ -260,7 +261,11 @@ public:
     /// a parent. In AS2, this is only used for external movies
     void set_parent(DisplayObject* parent)
     {
+        // The bounds of both parents include ours.
+        if (_parent) _parent->contentChanged();
         _parent = parent;
+        if (_parent) _parent->contentChanged();
+        transformChanged();
     }
 
     virtual MovieClip* to_movie() { return nullptr; }
@@ -354,6 +359,7 @@ public:
         if (_transform.colorTransform != cx) {
             set_invalidated();
             _transform.colorTransform = cx;
+            transformChanged();
         }
     }
 
@@ -377,6 +383,8 @@ public:
     /// See get_clip_depth()
     void set_clip_depth(int d)
     {
+        // Mask layers are indexed differently by our parent.
+        if (_parent) _parent->contentChanged();
         m_clip_depth = d;
     }
         
@@ -479,6 +487,49 @@ public:
 
 	virtual SWFRect getBounds() const = 0;
 
+    /// Return the bounds of the area where this DisplayObject can be hit
+    //
+    /// This is getBounds() extended to any area only reacting to the
+    /// mouse, like a Button's hit area. No point outside these bounds
+    /// hits the DisplayObject or any of its children.
+    virtual SWFRect getHitBounds() const {
+        return getBounds();
+    }
+
+    /// Record a change to the geometry of this DisplayObject or of any
+    /// of its descendants.
+    //
+    /// This changes the contentVersion() of this DisplayObject and of
+    /// all its ancestors, as their bounds include ours.
+    void contentChanged();
+
+    /// A stamp changed whenever the geometry of this DisplayObject or
+    /// of any of its descendants may have changed.
+    //
+    /// Data computed from a container's children, like its HitGrid or
+    /// its bounds, is only stale when this has changed, however often
+    /// other parts of the stage change.
+    std::uint64_t contentVersion() const {
+        return _contentVersion;
+    }
+
+    /// Get our matrix concatenated with those of all our ancestors.
+    //
+    /// This is cached until our matrix or that of an ancestor changes,
+    /// so that it is computed once per change however deep the
+    /// hierarchy is. Until any transform on the stage changes, the
+    /// cache is returned at once; after that, it is checked against
+    /// our parent's, which is itself checked once per change.
+    /// Use getWorldMatrix() rather than calling this directly.
+    const SWFMatrix& worldMatrix() const;
+
+    /// Get our color transform concatenated with those of all our
+    /// ancestors.
+    //
+    /// This is cached like worldMatrix(). Use getWorldCxForm() rather
+    /// than calling this directly.
+    const SWFCxForm& worldCxForm() const;
+
     /// Return true if the given point falls in this DisplayObject's bounds
     //
     /// @param x        Point x coordinate in world space
@@ -812,7 +863,12 @@ public:
     /// There is no need to do any rendering for this DisplayObject when this 
     /// function returns false because the renderer will not change any pixels
     /// in the area where this DisplayObject is placed.    
-    bool boundsInClippingArea(Renderer& renderer) const; 
+    ///
+    /// @param base     The transform the parent is rendered with, which
+    ///                 is not the world transform when rendering
+    ///                 offscreen.
+    bool boundsInClippingArea(Renderer& renderer,
+            const SWFMatrix& base) const; 
 
     /// Return full path to this object, in slash notation
     //
@@ -895,6 +951,34 @@ public:
         _blendMode = bm;
     }
 
+    /// Whether this DisplayObject should be rendered through a bitmap.
+    //
+    /// This is set by ActionScript or by PlaceObject3 tags. Only
+    /// MovieClips make use of it, see BitmapCache.
+    bool cacheAsBitmap() const {
+        return _cacheAsBitmap;
+    }
+
+    void setCacheAsBitmap(bool cache) {
+        if (cache == _cacheAsBitmap) return;
+        _cacheAsBitmap = cache;
+        set_invalidated();
+    }
+
+    /// The bitmap filters applied to this DisplayObject, in order.
+    //
+    /// These are set by PlaceObject3 tags. Only MovieClips make use of
+    /// them, see BitmapCache.
+    const Filters& filters() const {
+        return _filters;
+    }
+
+    void setFilters(const Filters& filters) {
+        if (filters == _filters) return;
+        _filters = filters;
+        set_invalidated();
+    }
+
     // action_buffer is externally owned
     typedef std::vector<const action_buffer*> BufferList;
     typedef std::map<event_id, BufferList> Events;
@@ -1033,6 +1117,24 @@ private:
     /// Register a DisplayObject masked by this instance
     void setMaskee(DisplayObject* maskee);
 
+    /// Record a change to our matrix, color transform or parent.
+    //
+    /// This makes the cached world transforms of this DisplayObject and
+    /// of its descendants stale.
+    void transformChanged();
+
+    /// The last stamp given to a DisplayObject.
+    //
+    /// Stamps only increase, so a stamp newer than a cached value shows
+    /// that the value is stale.
+    static std::uint64_t _lastVersion;
+
+    /// The number of calls to transformChanged(), plus one.
+    //
+    /// Cached world transforms checked since the last change are
+    /// valid without looking at the ancestors.
+    static std::uint64_t _transformChanges;
+
     /// The as_object to which this DisplayObject is attached.
     as_object* _object;
 
@@ -1040,6 +1142,32 @@ private:
     movie_root& _stage;
 
     Transform _transform;
+
+    /// The value of contentVersion()
+    std::uint64_t _contentVersion;
+
+    /// The stamp of the last change to _transform or _parent.
+    std::uint64_t _transformVersion;
+
+    /// The newest _transformVersion of this DisplayObject and its
+    /// ancestors when _worldMatrix was computed.
+    mutable std::uint64_t _worldMatrixVersion;
+
+    /// The value of _transformChanges when _worldMatrix was last
+    /// checked, or 0.
+    mutable std::uint64_t _worldMatrixChecked;
+
+    /// Cached result of worldMatrix()
+    mutable SWFMatrix _worldMatrix;
+
+    /// Like _worldMatrixVersion, for _worldCxForm.
+    mutable std::uint64_t _worldCxFormVersion;
+
+    /// Like _worldMatrixChecked, for _worldCxForm.
+    mutable std::uint64_t _worldCxFormChecked;
+
+    /// Cached result of worldCxForm()
+    mutable SWFCxForm _worldCxForm;
     
     Events _event_handlers;
 
@@ -1077,6 +1205,10 @@ private:
 
     BlendMode _blendMode;
 
+    bool _cacheAsBitmap;
+
+    Filters _filters;
+
     bool _visible;
 
     /// Whether this DisplayObject has been transformed by ActionScript code
@@ -1130,6 +1262,8 @@ getCxForm(const DisplayObject& o)
 inline SWFMatrix
 getWorldMatrix(const DisplayObject& d, bool includeRoot)
 {
+    if (includeRoot) return d.worldMatrix();
+
     SWFMatrix m = d.parent() ?
         getWorldMatrix(*d.parent(), includeRoot) : SWFMatrix();
 
@@ -1140,9 +1274,7 @@ getWorldMatrix(const DisplayObject& d, bool includeRoot)
 inline SWFCxForm
 getWorldCxForm(const DisplayObject& d)
 {
-    SWFCxForm cx = d.parent() ? getWorldCxForm(*d.parent()) : SWFCxForm();
-    cx.concatenate(getCxForm(d));
-    return cx;
+    return d.worldCxForm();
 }
 
 inline bool
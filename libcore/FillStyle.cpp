@@ -187,10 +187,9 @@ BitmapFill::bitmap() const
     if (!_md) {
         return nullptr;
     }
-    _bitmapInfo = _md->getBitmap(_id);
 
     // May still be 0!
-    return _bitmapInfo.get();
+    return _md->getBitmap(_id);
 }
     
 void
@@ -139,8 +139,11 @@ private:
 
     SWFMatrix _matrix;
     
-    /// A Bitmap, used for dynamic fills and to cache parsed bitmaps.
-    mutable boost::intrusive_ptr<const CachedBitmap> _bitmapInfo;
+    /// A Bitmap, used for dynamic fills.
+    //
+    /// Parsed bitmaps are not kept here, because the movie definition
+    /// drops them when they are not used.
+    boost::intrusive_ptr<const CachedBitmap> _bitmapInfo;
 
     /// The movie definition containing the bitmap
     movie_definition* _md;
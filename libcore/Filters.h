@@ -136,6 +136,11 @@ public:
         m_matrix(std::move(a_matrix))
     {}
 
+    // The 4x5 matrix, row by row. Empty if it was not read.
+    const std::vector<float>& matrix() const {
+        return m_matrix;
+    }
+
 protected:
     std::vector<float> m_matrix; // The color SWFMatrix
 };
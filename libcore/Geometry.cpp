@@ -280,6 +280,27 @@ pointTest(const std::vector<Path>& paths,
              (!even_odd && (counter != 0)) );
 }
 
+bool
+samePaths(const std::vector<Path>& a, const std::vector<Path>& b)
+{
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        const Path& p = a[i];
+        const Path& q = b[i];
+        if (p.ap != q.ap || p.m_fill0 != q.m_fill0 ||
+                p.m_fill1 != q.m_fill1 || p.m_line != q.m_line ||
+                p.m_edges.size() != q.m_edges.size()) {
+            return false;
+        }
+        for (size_t j = 0; j < p.m_edges.size(); ++j) {
+            const Edge& e = p.m_edges[j];
+            const Edge& f = q.m_edges[j];
+            if (e.cp != f.cp || e.ap != f.ap) return false;
+        }
+    }
+    return true;
+}
+
 } // namespace geometry
 } // namespace gnash
 
@@ -539,6 +539,10 @@ bool pointTest(const std::vector<Path>& paths,
     const std::vector<LineStyle>& lineStyles, std::int32_t x,
     std::int32_t y, const SWFMatrix& wm);
 
+/// Whether two lists of paths have the same points, edges and styles.
+DSOEXPORT bool samePaths(const std::vector<Path>& a,
+        const std::vector<Path>& b);
+
 } // namespace geometry
 
 
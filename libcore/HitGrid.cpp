@@ -0,0 +1,188 @@
+// HitGrid.cpp: spatial index of a DisplayList's children, for Gnash.
+//
+//   Copyright (C) 2012 Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#include "HitGrid.h"
+
+#include <algorithm>
+#include <iterator>
+#include <cmath>
+#include <cassert>
+
+#include "DisplayList.h"
+#include "DisplayObject.h"
+#include "SWFRect.h"
+#include "SWFMatrix.h"
+
+namespace gnash {
+
+namespace {
+
+/// Added around the bounds of each child, in twips.
+//
+/// Query points are transformed to the grid's space with rounding,
+/// so points just on the edge of a shape must not be lost.
+const std::int32_t margin = 20;
+
+/// Collects the children of a DisplayList with their bounds.
+class BoundsCollector
+{
+public:
+
+    BoundsCollector(std::vector<DisplayObject*>& chars,
+            std::vector<SWFRect>& bounds)
+        :
+        _chars(chars),
+        _bounds(bounds)
+    {}
+
+    void operator()(DisplayObject* ch) {
+        SWFRect b;
+        if (ch->isMaskLayer()) b.set_world();
+        else {
+            b = ch->getHitBounds();
+            // Nothing can hit it.
+            if (b.is_null()) return;
+            if (!b.is_world()) {
+                getMatrix(*ch).transform(b);
+                b.set_to_rect(b.get_x_min() - margin, b.get_y_min() - margin,
+                        b.get_x_max() + margin, b.get_y_max() + margin);
+            }
+        }
+        _chars.push_back(ch);
+        _bounds.push_back(b);
+    }
+
+private:
+    std::vector<DisplayObject*>& _chars;
+    std::vector<SWFRect>& _bounds;
+};
+
+} // anonymous namespace
+
+HitGrid::HitGrid(const DisplayObject& owner, const DisplayList& dl)
+    :
+    _owner(owner),
+    _version(owner.contentVersion()),
+    _xMin(0),
+    _yMin(0),
+    _cellWidth(1),
+    _cellHeight(1),
+    _columns(0),
+    _rows(0)
+{
+    std::vector<SWFRect> bounds;
+    BoundsCollector c(_chars, bounds);
+    dl.visitAll(c);
+
+    SWFRect all;
+    for (const SWFRect& b : bounds) {
+        if (!b.is_world()) all.expand_to_rect(b);
+    }
+
+    for (size_t i = 0; i < bounds.size(); ++i) {
+        if (bounds[i].is_world()) _everywhere.push_back(i);
+    }
+
+    if (all.is_null()) return;
+
+    // About one cell per child.
+    const size_t side = std::max<size_t>(1,
+            std::sqrt(static_cast<double>(_chars.size())));
+
+    _xMin = all.get_x_min();
+    _yMin = all.get_y_min();
+    _columns = side;
+    _rows = side;
+    _cellWidth = std::max<std::int64_t>(1,
+            (static_cast<std::int64_t>(all.width()) + side) / side);
+    _cellHeight = std::max<std::int64_t>(1,
+            (static_cast<std::int64_t>(all.height()) + side) / side);
+    _cells.resize(_columns * _rows);
+
+    // Children covering many cells are cheaper to check for any point.
+    const size_t maxCells = std::max<size_t>(4, _cells.size() / 4);
+
+    for (size_t i = 0; i < bounds.size(); ++i) {
+        const SWFRect& b = bounds[i];
+        if (b.is_world()) continue;
+
+        const size_t c0 = (b.get_x_min() - _xMin) / _cellWidth;
+        const size_t c1 = std::min<size_t>(_columns - 1,
+                (b.get_x_max() - _xMin) / _cellWidth);
+        const size_t r0 = (b.get_y_min() - _yMin) / _cellHeight;
+        const size_t r1 = std::min<size_t>(_rows - 1,
+                (b.get_y_max() - _yMin) / _cellHeight);
+
+        if ((c1 - c0 + 1) * (r1 - r0 + 1) > maxCells) {
+            // Keep the indices sorted.
+            _everywhere.insert(std::upper_bound(_everywhere.begin(),
+                        _everywhere.end(), i), i);
+            continue;
+        }
+
+        for (size_t r = r0; r <= r1; ++r) {
+            for (size_t col = c0; col <= c1; ++col) {
+                _cells[r * _columns + col].push_back(i);
+            }
+        }
+    }
+}
+
+bool
+HitGrid::current() const
+{
+    return _version == _owner.contentVersion();
+}
+
+size_t
+HitGrid::cell(std::int32_t x, std::int32_t y) const
+{
+    if (x < _xMin || y < _yMin) return static_cast<size_t>(-1);
+    const std::int64_t col = (static_cast<std::int64_t>(x) - _xMin) /
+        _cellWidth;
+    const std::int64_t row = (static_cast<std::int64_t>(y) - _yMin) /
+        _cellHeight;
+    if (col >= static_cast<std::int64_t>(_columns) ||
+            row >= static_cast<std::int64_t>(_rows)) {
+        return static_cast<size_t>(-1);
+    }
+    return row * _columns + col;
+}
+
+void
+HitGrid::find(const point& p, std::vector<DisplayObject*>& chars) const
+{
+    assert(current());
+
+    chars.clear();
+
+    Indices found;
+    const size_t c = cell(p.x, p.y);
+    if (c == static_cast<size_t>(-1)) found = _everywhere;
+    else {
+        const Indices& inCell = _cells[c];
+        found.reserve(_everywhere.size() + inCell.size());
+        std::merge(_everywhere.begin(), _everywhere.end(),
+                inCell.begin(), inCell.end(), std::back_inserter(found));
+    }
+
+    chars.reserve(found.size());
+    for (size_t i : found) chars.push_back(_chars[i]);
+}
+
+} // namespace gnash
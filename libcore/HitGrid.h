@@ -0,0 +1,105 @@
+// HitGrid.h: spatial index of a DisplayList's children, for Gnash.
+//
+//   Copyright (C) 2012 Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifndef GNASH_HITGRID_H
+#define GNASH_HITGRID_H
+
+#include <vector>
+#include <cstdint>
+#include <boost/noncopyable.hpp>
+
+#include "Point2d.h"
+#include "dsodefs.h" // for DSOTEXPORT
+
+// Forward declarations
+namespace gnash {
+    class DisplayList;
+    class DisplayObject;
+}
+
+namespace gnash {
+
+/// A uniform grid of the hit bounds of a DisplayList's children.
+//
+/// Finding the DisplayObject under the mouse otherwise means running
+/// exact hit tests on every child. The grid gives the few children
+/// whose hit bounds (see DisplayObject::getHitBounds()) may contain a
+/// point, in depth order, so that only those need exact tests.
+///
+/// Mask layers are returned for every point, as a mask that does not
+/// contain the point still hides the layers it masks.
+///
+/// The grid stores DisplayObject pointers, so it must not be used once
+/// it is no longer current(). It only becomes stale when the owner's
+/// contentVersion() changes, not when other parts of the stage do.
+class HitGrid : boost::noncopyable
+{
+public:
+
+    /// Index the children of a DisplayList.
+    //
+    /// @param owner    The DisplayObject owning the DisplayList.
+    /// @param dl       The DisplayList. Bounds are computed in the
+    ///                 coordinate space of its owner.
+    DSOTEXPORT HitGrid(const DisplayObject& owner, const DisplayList& dl);
+
+    /// Whether none of the owner's descendants has changed since the
+    /// grid was built.
+    DSOTEXPORT bool current() const;
+
+    /// Get the children that may be hit at a point.
+    //
+    /// @param p        The point in the coordinate space of the
+    ///                 DisplayList's owner.
+    /// @param chars    Receives the children, ordered by depth.
+    DSOTEXPORT void find(const point& p,
+            std::vector<DisplayObject*>& chars) const;
+
+private:
+
+    typedef std::vector<size_t> Indices;
+
+    /// Index of the cell containing a point, or -1 if none does.
+    size_t cell(std::int32_t x, std::int32_t y) const;
+
+    const DisplayObject& _owner;
+
+    /// The contentVersion() of the owner when built.
+    const std::uint64_t _version;
+
+    /// The children in depth order.
+    std::vector<DisplayObject*> _chars;
+
+    /// Indices in _chars of the children that are returned for all
+    /// points: masks and those covering a large part of the grid.
+    Indices _everywhere;
+
+    /// Indices in _chars of the children overlapping each cell.
+    std::vector<Indices> _cells;
+
+    std::int32_t _xMin;
+    std::int32_t _yMin;
+    std::int64_t _cellWidth;
+    std::int64_t _cellHeight;
+    size_t _columns;
+    size_t _rows;
+};
+
+} // namespace gnash
+
+#endif
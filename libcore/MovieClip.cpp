@@ -56,6 +56,9 @@
 #include "namedStrings.h"
 #include "LineStyle.h"
 #include "PlaceObject2Tag.h" 
+#include "TimelineSnapshots.h"
+#include "HitGrid.h"
+#include "BitmapCache.h"
 #include "flash/geom/Matrix_as.h"
 #include "GnashNumeric.h"
 #include "InteractiveObject.h"
@@ -87,6 +90,7 @@ namespace gnash {
 namespace {
     MovieClip::TextFields* textfieldVar(MovieClip::TextFieldIndex* t,
             const ObjectURI& name);
+    bool inMask(const DisplayObject& d);
 }
 
 // Utility functors.
@@ -350,6 +354,38 @@ private:
     const std::int32_t _y;
 }; 
 
+/// The number of children above which hit tests use a HitGrid.
+const size_t hitGridMinSize = 64;
+
+/// Visit the children that may contain a point, top-down.
+//
+/// The visitor stops the scan by returning false, as in
+/// DisplayList::visitBackward().
+///
+/// @param x    Point x coordinate in world space
+/// @param y    Point y coordinate in world space
+template<typename V>
+void
+visitBackwardAt(const DisplayList& dl, const HitGrid* grid,
+        const DisplayObject& owner, std::int32_t x, std::int32_t y,
+        V& visitor)
+{
+    if (!grid) {
+        dl.visitBackward(visitor);
+        return;
+    }
+
+    point lp(x, y);
+    getWorldMatrix(owner).invert().transform(lp);
+
+    std::vector<DisplayObject*> chars;
+    grid->find(lp, chars);
+    for (std::vector<DisplayObject*>::const_reverse_iterator
+            it = chars.rbegin(), e = chars.rend(); it != e; ++it) {
+        if (!visitor(*it)) break;
+    }
+}
+
 /// A DisplayList visitor used to compute its overall bounds.
 //
 class BoundsFinder
@@ -369,6 +405,26 @@ private:
     SWFRect& _bounds;
 };
 
+/// A DisplayList visitor used to compute the bounds of its hit area.
+//
+/// This includes unloaded DisplayObjects, which are still tested
+/// for hits, but not mask layers, which only hide others.
+class HitBoundsFinder
+{
+public:
+    explicit HitBoundsFinder(SWFRect& b) : _bounds(b) {}
+
+    void operator()(DisplayObject* ch) {
+        if (ch->isMaskLayer()) return;
+        SWFRect chb = ch->getHitBounds();
+        SWFMatrix m = getMatrix(*ch);
+        _bounds.expand_to_transformed_rect(m, chb);
+    }
+
+private:
+    SWFRect& _bounds;
+};
+
 struct ReachableMarker
 {
     void operator()(DisplayObject *ch) const {
@@ -506,6 +562,8 @@ MovieClip::MovieClip(as_object* object, const movie_definition* def,
     DisplayObjectContainer(object, parent),
     _def(def),
     _swf(r),
+    _boundsVersion(0),
+    _hitBoundsVersion(0),
     _playState(PLAYSTATE_PLAY),
     _environment(getVM(*object)),
     _currentFrame(0),
@@ -1014,7 +1072,21 @@ MovieClip::restoreDisplayList(size_t tgtFrame)
     assert(tgtFrame <= _currentFrame);
 
     DisplayList tmplist;
-    for (size_t f = 0; f < tgtFrame; ++f) {
+    size_t f = 0;
+
+    // Start from the latest snapshot, then execute the tags of the
+    // skipped frames that don't change the DisplayList, in order.
+    const TimelineSnapshot* snapshot = _def->getSnapshot(tgtFrame);
+    if (snapshot) {
+        _currentFrame = snapshot->frames() - 1;
+        snapshot->restore(*this, tmplist);
+        for (; f < snapshot->frames(); ++f) {
+            _currentFrame = f;
+            executeStateTags(f);
+        }
+    }
+
+    for (; f < tgtFrame; ++f) {
         _currentFrame = f;
         executeFrameTags(f, tmplist, SWF::ControlTag::TAG_DLIST);
     }
@@ -1027,6 +1099,21 @@ MovieClip::restoreDisplayList(size_t tgtFrame)
     _displayList.mergeDisplayList(tmplist, *this);
 }
 
+void
+MovieClip::executeStateTags(size_t frame)
+{
+    if (isDestroyed()) return;
+
+    const PlayList* playlist = _def->getPlaylist(frame);
+    if (!playlist) return;
+
+    DisplayList unused;
+    for (const auto& item : *playlist) {
+        if (dynamic_cast<const SWF::DisplayListTag*>(item.get())) continue;
+        item->executeState(this, unused);
+    }
+}
+
 // 0-based frame number !
 void
 MovieClip::executeFrameTags(size_t frame, DisplayList& dlist, int typeflags)
@@ -1195,7 +1282,12 @@ void
 MovieClip::draw(Renderer& renderer, const Transform& xform)
 {
     const DisplayObject::MaskRenderer mr(renderer, *this);
+    drawContents(renderer, xform);
+}
 
+void
+MovieClip::drawContents(Renderer& renderer, const Transform& xform)
+{
     _drawable.finalize();
     _drawable.display(renderer, xform);
     _displayList.display(renderer, xform);
@@ -1212,16 +1304,44 @@ MovieClip::display(Renderer& renderer, const Transform& base)
     
     // Draw everything with our own transform.
     const Transform xform = base * transform();
-    draw(renderer, xform);
+
+    // Filters are applied to the cached image.
+    if ((cacheAsBitmap() || !filters().empty()) && !inMask(*this)) {
+        if (!_bitmapCache.get()) _bitmapCache.reset(new BitmapCache);
+
+        const DisplayObject::MaskRenderer mr(renderer, *this);
+
+        // Too big, or no offscreen rendering: draw directly.
+        if (!_bitmapCache->display(*this, renderer, xform)) {
+            drawContents(renderer, xform);
+        }
+    }
+    else {
+        _bitmapCache.reset();
+        draw(renderer, xform);
+    }
     clear_invalidated();
 }
 
 void MovieClip::omit_display()
 {
-    if (childInvalidated()) _displayList.omit_display();
+    // Our children won't be marked as changed any more.
+    if (childInvalidated()) {
+        if (_bitmapCache.get()) _bitmapCache->invalidate();
+        _displayList.omit_display();
+    }
     clear_invalidated();
 }
 
+DynamicShape&
+MovieClip::graphics()
+{
+    set_invalidated();
+    contentChanged();
+    if (_bitmapCache.get()) _bitmapCache->invalidate();
+    return _drawable;
+}
+
 void
 MovieClip::attachCharacter(DisplayObject& newch, int depth, as_object* initObj)
 { 
@@ -1269,6 +1389,10 @@ MovieClip::add_display_object(const SWF::PlaceObject2Tag* tag,
         ch->setBlendMode(static_cast<DisplayObject::BlendMode>(bm));
     }
 
+    if (tag->hasBitmapCaching()) ch->setCacheAsBitmap(tag->getBitmapCaching());
+
+    if (tag->hasFilters()) ch->setFilters(tag->getFilters());
+
     // Attach event handlers (if any).
     const SWF::PlaceObject2Tag::EventHandlers& event_handlers =
         tag->getEventHandlers();
@@ -1299,6 +1423,11 @@ MovieClip::move_display_object(const SWF::PlaceObject2Tag* tag, DisplayList& dli
         tag->hasCxform() ? &tag->getCxform() : nullptr,
         tag->hasMatrix() ? &tag->getMatrix() : nullptr,
         tag->hasRatio() ? &ratio : nullptr);
+
+    if (tag->hasFilters()) {
+        DisplayObject* ch = dlist.getDisplayObjectAtDepth(tag->getDepth());
+        if (ch) ch->setFilters(tag->getFilters());
+    }
 }
 
 void
@@ -1416,7 +1545,7 @@ bool
 MovieClip::pointInShape(std::int32_t x, std::int32_t y) const
 {
     ShapeContainerFinder finder(x, y);
-    _displayList.visitBackward(finder);
+    visitBackwardAt(_displayList, hitGrid(), *this, x, y, finder);
     if ( finder.hitFound() ) return true;
     return hitTestDrawable(x, y);
 }
@@ -1443,11 +1572,24 @@ MovieClip::pointInVisibleShape(std::int32_t x, std::int32_t y) const
         return false;
     }
     VisibleShapeContainerFinder finder(x, y);
-    _displayList.visitBackward(finder);
+    visitBackwardAt(_displayList, hitGrid(), *this, x, y, finder);
     if (finder.hitFound()) return true;
     return hitTestDrawable(x, y);
 }
 
+const HitGrid*
+MovieClip::hitGrid() const
+{
+    if (_displayList.size() < hitGridMinSize) {
+        _hitGrid.reset();
+        return nullptr;
+    }
+    if (!_hitGrid.get() || !_hitGrid->current()) {
+        _hitGrid.reset(new HitGrid(*this, _displayList));
+    }
+    return _hitGrid.get();
+}
+
 inline bool
 MovieClip::hitTestDrawable(std::int32_t x, std::int32_t y) const
 {
@@ -1467,7 +1609,7 @@ MovieClip::pointInHitableShape(std::int32_t x, std::int32_t y) const
     if (mask && !mask->pointInShape(x, y)) return false;
             
     HitableShapeContainerFinder finder(x, y);
-    _displayList.visitBackward(finder);
+    visitBackwardAt(_displayList, hitGrid(), *this, x, y, finder);
     if (finder.hitFound()) return true; 
     
     return hitTestDrawable(x, y); 
@@ -1501,7 +1643,13 @@ MovieClip::topmostMouseEntity(std::int32_t x, std::int32_t y)
     m.transform(pp);
 
     MouseEntityFinder finder(wp, pp);
-    _displayList.visitAll(finder);
+    if (const HitGrid* grid = hitGrid()) {
+        // Only the children that may contain the point, in depth order.
+        std::vector<DisplayObject*> chars;
+        grid->find(pp, chars);
+        for (DisplayObject* ch : chars) finder(ch);
+    }
+    else _displayList.visitAll(finder);
     InteractiveObject* ch = finder.getEntity();
 
     // It doesn't make any sense to query _drawable, as it's
@@ -1654,14 +1802,25 @@ MovieClip::add_invalidated_bounds(InvalidatedRanges& ranges, bool force)
         ranges.add(m_old_invalidated_ranges); 
     }
     
-    _displayList.add_invalidated_bounds(ranges, force || invalidated());
+    // Filters draw around our contents, so that must be redrawn too.
+    const std::int32_t margin = filterMargin(filters());
+    InvalidatedRanges filtered;
+    filtered.inheritConfig(ranges);
+    InvalidatedRanges& contents = margin ? filtered : ranges;
+
+    _displayList.add_invalidated_bounds(contents, force || invalidated());
 
     /// Add drawable.
     SWFRect bounds;
     bounds.expand_to_transformed_rect(getWorldMatrix(*this),
             _drawable.getBounds());
 
-    ranges.add(bounds.getRange());
+    contents.add(bounds.getRange());
+
+    if (margin) {
+        filtered.growBy(margin);
+        ranges.add(filtered);
+    }
 }
 
 
@@ -1799,6 +1958,7 @@ MovieClip::unloadChildren()
     // some memory. The drawable might take a lot of memory
     // on itself.
     _drawable.clear();
+    _bitmapCache.reset();
     
     const bool childHandler = _displayList.unload();
 
@@ -1975,12 +2135,31 @@ MovieClip::removeMovieClip()
 SWFRect
 MovieClip::getBounds() const
 {
+    if (_boundsVersion == contentVersion()) return _bounds;
+
     SWFRect bounds;
     BoundsFinder f(bounds);
     _displayList.visitAll(f);
     SWFRect drawableBounds = _drawable.getBounds();
     bounds.expand_to_rect(drawableBounds);
-    
+
+    _bounds = bounds;
+    _boundsVersion = contentVersion();
+    return bounds;
+}
+
+SWFRect
+MovieClip::getHitBounds() const
+{
+    if (_hitBoundsVersion == contentVersion()) return _hitBounds;
+
+    SWFRect bounds;
+    HitBoundsFinder f(bounds);
+    _displayList.visitAll(f);
+    bounds.expand_to_rect(_drawable.getBounds());
+
+    _hitBounds = bounds;
+    _hitBoundsVersion = contentVersion();
     return bounds;
 }
 
@@ -2114,6 +2293,18 @@ MovieClip::setPlayState(PlayState s)
 
 namespace {
 
+/// Whether a DisplayObject is drawn as part of a mask.
+//
+/// Masks only use the shape of what is drawn, which a bitmap cache loses.
+bool
+inMask(const DisplayObject& d)
+{
+    for (const DisplayObject* p = &d; p; p = p->parent()) {
+        if (p->isMaskLayer() || p->isDynamicMask()) return true;
+    }
+    return false;
+}
+
 MovieClip::TextFields*
 textfieldVar(MovieClip::TextFieldIndex* t, const ObjectURI& name)
 {
@@ -50,6 +50,8 @@ namespace gnash {
     class BitmapData_as;
     class CachedBitmap;
     class DisplayList;
+    class HitGrid;
+    class BitmapCache;
     namespace SWF {
         class PlaceObject2Tag;
     }
@@ -145,6 +147,9 @@ public:
     /// Get the composite bounds of all component drawing elements
     virtual SWFRect getBounds() const;
 
+    // See dox in DisplayObject.h
+    virtual SWFRect getHitBounds() const;
+
     // See dox in DisplayObject.h
     virtual bool pointInShape(std::int32_t x, std::int32_t y) const;
 
@@ -277,6 +282,11 @@ public:
     /// transform.
     void draw(Renderer& renderer, const Transform& xform);
 
+    /// Draw the drawing API shape and the children of this MovieClip
+    //
+    /// Unlike draw(), this does not apply the MovieClip's mask.
+    void drawContents(Renderer& renderer, const Transform& xform);
+
     void omit_display();
 
     /// Swap depth of the given DisplayObjects in the DisplayList
@@ -561,10 +571,7 @@ public:
     void removeMovieClip();
 
     /// Direct access to the Graphics object for drawing.
-    DynamicShape& graphics() {
-        set_invalidated();
-        return _drawable;
-    }
+    DynamicShape& graphics();
 
     /// Set focus to this MovieClip
     //
@@ -658,6 +665,12 @@ private:
             int typeflags = SWF::ControlTag::TAG_DLIST |
                             SWF::ControlTag::TAG_ACTION);
 
+    /// Execute the state tags of a frame that don't change the DisplayList.
+    //
+    /// @param frame
+    ///     Frame number. 0-based
+    void executeStateTags(size_t frame);
+
     void stopStreamSound();
 
     /// Return value of the 'enabled' property cast to a boolean value.
@@ -675,6 +688,12 @@ private:
     /// world space.
     bool hitTestDrawable(std::int32_t x, std::int32_t y) const;
 
+    /// Get an up to date HitGrid of our children.
+    //
+    /// @return     0 if there are too few children for the grid to be
+    ///             faster than testing all of them.
+    const HitGrid* hitGrid() const;
+
     /// Advance to a previous frame.
     //
     /// This function will basically restore the DisplayList as it supposedly
@@ -741,6 +760,25 @@ private:
     /// The canvas for dynamic drawing
     DynamicShape _drawable;
 
+    /// Index of our children used for hit tests, built when needed.
+    mutable std::unique_ptr<HitGrid> _hitGrid;
+
+    /// Cached result of getBounds(), valid at _boundsVersion.
+    mutable SWFRect _bounds;
+
+    /// The contentVersion() when _bounds was computed.
+    mutable std::uint64_t _boundsVersion;
+
+    /// Cached result of getHitBounds(), valid at _hitBoundsVersion.
+    mutable SWFRect _hitBounds;
+
+    /// The contentVersion() when _hitBounds was computed.
+    mutable std::uint64_t _hitBoundsVersion;
+
+    /// Our rendered contents, when cacheAsBitmap() is set or there are
+    /// filters.
+    std::unique_ptr<BitmapCache> _bitmapCache;
+
     PlayState _playState;
 
     /// This timeline's variable scope
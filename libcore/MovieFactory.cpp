@@ -137,8 +137,11 @@ MovieFactory::makeMovie(const URL& url, const RunResources& runResources,
     // Movie is good, add to the library, but not if we used POST
     if (!postdata) {
         movieLibrary.add(cache_label, mov.get());
-        log_debug("Movie %s (SWF%d) added to library",
-                cache_label, mov->get_version());
+        const MovieLibrary::Stats stats = movieLibrary.stats();
+        log_debug("Movie %s (SWF%d) added to library (%d items, %d bytes, "
+                "%d hits, %d misses, %d evictions)", cache_label,
+                mov->get_version(), stats.items, stats.bytes, stats.hits,
+                stats.misses, stats.evictions);
     }
     else {
         log_debug("Movie %s (SWF%d) NOT added to library (resulted from "
@@ -303,7 +306,7 @@ createNonLibraryMovie(const URL& url, const RunResources& runResources,
     if (postdata) {
         in = streamProvider.getStream(url, *postdata, rcfile.saveLoadedMedia());
     }
-    else in = streamProvider.getStream(url, rcfile.saveLoadedMedia());
+    else in = streamProvider.getMovieStream(url, rcfile.saveLoadedMedia());
   
     if (!in.get()) {
         log_error(_("failed to open '%s'; can't create movie"), url);
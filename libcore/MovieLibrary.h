@@ -21,11 +21,15 @@
 
 #include "rc.h"
 #include "movie_definition.h"
+#include "log.h"
 
 #include <boost/intrusive_ptr.hpp>
 #include <string>
 #include <map>
-#include <algorithm>
+#include <list>
+#include <vector>
+#include <mutex>
+#include <cassert>
 
 namespace gnash {
 
@@ -34,33 +38,77 @@ namespace gnash {
 /// Elements are actually movie_definitions, the ones
 /// associated with URLS. They may be BitmapMovieDefinitions or
 /// SWFMovieDefinitions.
+//
+/// The library is bounded both by a number of items and by the memory
+/// they use (see movie_definition::memoryUsage()). When either limit is
+/// exceeded, the least recently used items are dropped.
 class MovieLibrary
 {
 public:
 
+    /// Usage statistics of the library
+    struct Stats
+    {
+        Stats() : hits(0), misses(0), evictions(0), items(0), bytes(0) {}
+
+        /// Number of successful lookups
+        size_t hits;
+
+        /// Number of failed lookups
+        size_t misses;
+
+        /// Number of items dropped to fit the limits
+        size_t evictions;
+
+        /// Number of items currently in the library
+        size_t items;
+
+        /// Memory used by the items currently in the library
+        size_t bytes;
+    };
+
+    typedef std::list<std::string> UsageList;
+
     struct LibraryItem
     {
         boost::intrusive_ptr<movie_definition> def;
-        unsigned hitCount;
+
+        /// Position in the usage list
+        UsageList::iterator usage;
     };
 
     typedef std::map<std::string, LibraryItem> LibraryContainer;
 
     MovieLibrary()
         : 
-        _limit(8) 
+        _limit(8),
+        _memoryLimit(0)
     {
         RcInitFile& rcfile = RcInitFile::getDefaultInstance();
+        _memoryLimit =
+            static_cast<size_t>(rcfile.getMovieLibraryMemoryLimit()) << 20;
 	    setLimit(rcfile.getMovieLibraryLimit());
     }
   
     /// Sets the maximum number of items to hold in the library. When adding new
-    /// items, the one with the least hit count is being removed in that case.
+    /// items, the least recently used one is removed in that case.
     /// Zero is a valid limit (disables library). 
     void setLimit(LibraryContainer::size_type limit)
     {
+        std::lock_guard<std::mutex> lock(_mapMutex);
         _limit = limit;  
-        limitSize(_limit);  
+        limitSize(_limit, _map.end());
+    }
+
+    /// Sets the maximum memory used by items in the library, in bytes.
+    //
+    /// Zero means no limit. The most recently used item is always kept,
+    /// whatever its size.
+    void setMemoryLimit(size_t bytes)
+    {
+        std::lock_guard<std::mutex> lock(_mapMutex);
+        _memoryLimit = bytes;
+        limitSize(_limit, _map.end());
     }
 
     bool get(const std::string& key,
@@ -68,60 +116,130 @@ public:
     {
         std::lock_guard<std::mutex> lock(_mapMutex);
         LibraryContainer::iterator it = _map.find(key);
-        if (it == _map.end()) return false;
+        if (it == _map.end()) {
+            ++_stats.misses;
+            return false;
+        }
         
         *ret = it->second.def;
-        it->second.hitCount++;
+        ++_stats.hits;
+        _usage.splice(_usage.begin(), _usage, it->second.usage);
+
+        // Movies grow while they load, so check the budget again.
+        limitSize(_limit, it);
         return true;
     }
 
     void add(const std::string& key, movie_definition* mov)
     {
+        std::lock_guard<std::mutex> lock(_mapMutex);
 
         if (!_limit) return;
 
-        if (_limit) limitSize(_limit - 1);
-
-        LibraryItem temp;
+        LibraryContainer::iterator it = _map.find(key);
+        if (it == _map.end()) {
+            _usage.push_front(key);
+            LibraryItem temp;
+            temp.usage = _usage.begin();
+            it = _map.insert(std::make_pair(key, temp)).first;
+        }
+        else {
+            _usage.splice(_usage.begin(), _usage, it->second.usage);
+        }
+        it->second.def = mov;
 
-        temp.def = mov;
-        temp.hitCount = 0;
+        limitSize(_limit, it);
+    }
 
+    /// Get the usage statistics of the library.
+    Stats stats() const
+    {
         std::lock_guard<std::mutex> lock(_mapMutex);
-        _map[key] = temp;
+        Stats ret = _stats;
+        ret.items = _map.size();
+        ret.bytes = memoryUsage();
+        return ret;
     }
-  
 
     void clear()
     {
         std::lock_guard<std::mutex> lock(_mapMutex);
         _map.clear();
+        _usage.clear();
     }
   
 private:
 
-    static bool findWorstHitCount(const LibraryContainer::value_type& a,
-                                const LibraryContainer::value_type& b)
+    /// Compute the memory used by all items.
+    //
+    /// Items that are still loading grow, so this is not cached.
+    size_t memoryUsage() const
     {
-        return (a.second.hitCount < b.second.hitCount);
+        size_t total = 0;
+        for (const LibraryContainer::value_type& item : _map) {
+            total += item.second.def->memoryUsage();
+        }
+        return total;
     }
 
     LibraryContainer _map;
+
+    /// Keys of the items, most recently used first
+    UsageList _usage;
+
     unsigned _limit;
 
-    void limitSize(LibraryContainer::size_type max) {
+    size_t _memoryLimit;
+
+    Stats _stats;
+
+    /// Drop least recently used items until the library fits its limits.
+    //
+    /// Must be called with _mapMutex locked.
+    ///
+    /// @param max      The maximum number of items.
+    /// @param keep     An item that must not be dropped, or _map.end().
+    void limitSize(LibraryContainer::size_type max,
+            LibraryContainer::const_iterator keep) {
 
         if (max < 1) {
-            clear();
+            _map.clear();
+            _usage.clear();
             return;
         }
 
-        while (_map.size() > max) {
-            std::lock_guard<std::mutex> lock(_mapMutex);
-            _map.erase(std::min_element(_map.begin(), _map.end(),
-                        &findWorstHitCount));
+        // Items that are still loading grow, so the usage of each is
+        // read once, and the same value is subtracted when it is dropped.
+        std::vector<size_t> usage;
+        size_t bytes = 0;
+        if (_memoryLimit) {
+            usage.reserve(_usage.size());
+            for (const std::string& key : _usage) {
+                const LibraryContainer::const_iterator it = _map.find(key);
+                assert(it != _map.end());
+                usage.push_back(it->second.def->memoryUsage());
+                bytes += usage.back();
+            }
+        }
+
+        UsageList::iterator victim = _usage.end();
+        size_t index = _usage.size();
+        while (victim != _usage.begin() &&
+                (_map.size() > max || bytes > _memoryLimit)) {
+
+            --victim;
+            --index;
+            LibraryContainer::iterator it = _map.find(*victim);
+            assert(it != _map.end());
+            if (it == keep) continue;
+
+            if (_memoryLimit) bytes -= usage[index];
+            ++_stats.evictions;
+            log_debug("Dropping movie %s from the library", it->first);
+
+            victim = _usage.erase(victim);
+            _map.erase(it);
         }
-    
     }
 
     mutable std::mutex _mapMutex;
@@ -85,6 +85,29 @@ unsigned SWFStream::read(char *buf, unsigned count)
     return m_input->read(buf, count);
 }
 
+const std::uint8_t*
+SWFStream::readDirect(unsigned count)
+{
+    align();
+
+    if (!count) return nullptr;
+
+    if (!_tagBoundsStack.empty()) {
+        const unsigned long endPos = _tagBoundsStack.back().second;
+        const unsigned long cur_pos = tell();
+        assert(endPos >= cur_pos);
+        if (endPos - cur_pos < count) return nullptr;
+    }
+
+    const std::uint8_t* data = m_input->contiguousData(count);
+    if (!data) return nullptr;
+
+    if (!m_input->seek(m_input->tell() + std::streamoff(count))) {
+        return nullptr;
+    }
+    return data;
+}
+
 bool SWFStream::read_bit()
 {
     if (!m_unused_bits)
@@ -143,6 +143,21 @@ public:
 	/// aligned read
 	///
 	unsigned read(char *buf, unsigned count);
+
+	/// Get direct access to the next <count> bytes of the source stream.
+	//
+	/// This avoids copying data when the underlying IOChannel has it
+	/// in memory (see IOChannel::contiguousData). The memory is owned
+	/// by the IOChannel.
+	///
+	/// aligned read
+	///
+	/// @return a pointer to <count> bytes, the stream being advanced
+	///         past them, or 0 if they can't be accessed directly, in
+	///         which case the stream position is unchanged. Fewer than
+	///         <count> bytes left in the current tag also return 0.
+	///
+	const std::uint8_t* readDirect(unsigned count);
 	
 	/// Read a aligned unsigned 8-bit value from the stream.		
 	//
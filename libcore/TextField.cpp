@@ -2515,6 +2515,7 @@ TextField::setWidth(double newwidth)
             bounds.get_y_min(),
             bounds.get_x_min() + newwidth,
             bounds.get_y_max());
+    contentChanged();
 }
 
 void
@@ -2525,6 +2526,7 @@ TextField::setHeight(double newheight)
             bounds.get_y_min(),
             bounds.get_x_max(),
             bounds.get_y_min() + newheight);
+    contentChanged();
 }
 
 } // namespace gnash
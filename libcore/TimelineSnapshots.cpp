@@ -0,0 +1,251 @@
+// TimelineSnapshots.cpp: saved DisplayList states of a timeline, for Gnash.
+//
+//   Copyright (C) 2012 Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#include "TimelineSnapshots.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "movie_definition.h"
+#include "MovieClip.h"
+#include "DisplayList.h"
+#include "RemoveObjectTag.h"
+#include "DisplayListRecordsTag.h"
+#include "log.h"
+
+namespace gnash {
+
+TimelineSnapshot::Step::Step()
+    :
+    order(0),
+    hasCxForm(false),
+    hasMatrix(false),
+    hasRatio(false),
+    hasFilters(false),
+    ratio(0)
+{
+}
+
+TimelineSnapshot::TimelineSnapshot()
+    :
+    _frames(0),
+    _tags(0)
+{
+}
+
+bool
+TimelineSnapshot::addFrame(const movie_definition& def)
+{
+    const movie_definition::PlayList* playlist = def.getPlaylist(_frames);
+    ++_frames;
+    if (!playlist) return true;
+
+    for (const auto& item : *playlist) {
+
+        const SWF::DisplayListTag* tag =
+            dynamic_cast<const SWF::DisplayListTag*>(item.get());
+        if (!tag) continue;
+
+        if (dynamic_cast<const SWF::RemoveObjectTag*>(tag)) {
+            remove(tag->getDepth());
+            continue;
+        }
+
+        const SWF::DisplayListRecordsTag* records =
+            dynamic_cast<const SWF::DisplayListRecordsTag*>(tag);
+        if (records) {
+            records->visit(*this);
+            continue;
+        }
+
+        const SWF::PlaceObject2Tag* place =
+            dynamic_cast<const SWF::PlaceObject2Tag*>(tag);
+        if (!place) return false;
+
+        execute(def, *place);
+    }
+    return true;
+}
+
+void
+TimelineSnapshot::execute(const movie_definition& def,
+        const SWF::PlaceObject2Tag& tag)
+{
+    const int depth = tag.getDepth();
+    Depths::iterator it = _depths.find(depth);
+
+    switch (tag.getPlaceType()) {
+
+        case SWF::PlaceObject2Tag::PLACE:
+        {
+            ++_tags;
+            // Like MovieClip::add_display_object(), don't place anything
+            // on an occupied depth or for an unknown id.
+            if (it != _depths.end()) return;
+            if (!def.getDefinitionTag(tag.getID())) return;
+            Step step;
+            step.tag = &tag;
+            step.order = _tags;
+            _depths[depth].push_back(step);
+            return;
+        }
+
+        case SWF::PlaceObject2Tag::REPLACE:
+        {
+            ++_tags;
+            if (it == _depths.end()) return;
+            if (!def.getDefinitionTag(tag.getID())) return;
+            Step step;
+            step.tag = &tag;
+            step.order = _tags;
+            it->second.push_back(step);
+            return;
+        }
+
+        case SWF::PlaceObject2Tag::MOVE:
+        {
+            const std::uint16_t ratio = tag.getRatio();
+            move(depth, tag.hasCxform() ? &tag.getCxform() : nullptr,
+                    tag.hasMatrix() ? &tag.getMatrix() : nullptr,
+                    tag.hasRatio() ? &ratio : nullptr,
+                    tag.hasFilters() ? &tag.getFilters() : nullptr);
+            return;
+        }
+
+        case SWF::PlaceObject2Tag::REMOVE:
+            remove(depth);
+            return;
+    }
+}
+
+void
+TimelineSnapshot::remove(int depth)
+{
+    ++_tags;
+    _depths.erase(depth);
+}
+
+void
+TimelineSnapshot::move(int depth, const SWFCxForm* cxform,
+        const SWFMatrix* matrix, const std::uint16_t* ratio,
+        const Filters* filters)
+{
+    ++_tags;
+
+    Depths::iterator it = _depths.find(depth);
+    if (it == _depths.end()) return;
+
+    // Merge with a previous move.
+    Steps& steps = it->second;
+    if (steps.back().tag) steps.push_back(Step());
+    Step& step = steps.back();
+    step.order = _tags;
+
+    if (cxform) {
+        step.hasCxForm = true;
+        step.cxform = *cxform;
+    }
+    if (matrix) {
+        step.hasMatrix = true;
+        step.matrix = *matrix;
+    }
+    if (ratio) {
+        step.hasRatio = true;
+        step.ratio = *ratio;
+    }
+    if (filters) {
+        step.hasFilters = true;
+        step.filters = *filters;
+    }
+}
+
+void
+TimelineSnapshot::restore(MovieClip& m, DisplayList& dlist) const
+{
+    // Sort the steps of all depths, so that DisplayObjects are created
+    // in the same order as when replaying the tags.
+    typedef std::pair<size_t, std::pair<int, const Step*> > Ordered;
+    std::vector<Ordered> steps;
+    for (const Depths::value_type& d : _depths) {
+        for (const Step& step : d.second) {
+            steps.push_back(std::make_pair(step.order,
+                        std::make_pair(d.first, &step)));
+        }
+    }
+    std::sort(steps.begin(), steps.end());
+
+    for (const Ordered& o : steps) {
+        const Step& step = *o.second.second;
+
+        if (!step.tag) {
+            std::uint16_t ratio = step.ratio;
+            dlist.moveDisplayObject(o.second.first,
+                    step.hasCxForm ? &step.cxform : nullptr,
+                    step.hasMatrix ? &step.matrix : nullptr,
+                    step.hasRatio ? &ratio : nullptr);
+            if (step.hasFilters) {
+                DisplayObject* ch =
+                    dlist.getDisplayObjectAtDepth(o.second.first);
+                if (ch) ch->setFilters(step.filters);
+            }
+        }
+        else if (step.tag->getPlaceType() == SWF::PlaceObject2Tag::PLACE) {
+            m.add_display_object(step.tag.get(), dlist);
+        }
+        else {
+            m.replace_display_object(step.tag.get(), dlist);
+        }
+    }
+}
+
+TimelineSnapshots::TimelineSnapshots()
+    :
+    _failed(false)
+{
+}
+
+const TimelineSnapshot*
+TimelineSnapshots::get(const movie_definition& def, size_t frame)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    const size_t wanted = frame / interval;
+    const size_t loaded = def.get_loading_frame();
+
+    while (!_failed && _snapshots.size() < wanted) {
+        while (_next.frames() < interval * (_snapshots.size() + 1)) {
+            if (_next.frames() >= loaded) break;
+            if (!_next.addFrame(def)) {
+                log_debug("Not taking snapshots of a timeline with "
+                        "unknown DisplayList tags");
+                _failed = true;
+                break;
+            }
+        }
+        if (_failed || _next.frames() < interval * (_snapshots.size() + 1)) {
+            break;
+        }
+        _snapshots.push_back(_next);
+    }
+
+    const size_t available = std::min(wanted, _snapshots.size());
+    if (!available) return nullptr;
+    return &_snapshots[available - 1];
+}
+
+} // namespace gnash
@@ -0,0 +1,149 @@
+// TimelineSnapshots.h: saved DisplayList states of a timeline, for Gnash.
+//
+//   Copyright (C) 2012 Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifndef GNASH_TIMELINESNAPSHOTS_H
+#define GNASH_TIMELINESNAPSHOTS_H
+
+#include <map>
+#include <deque>
+#include <vector>
+#include <mutex>
+#include <cstdint>
+#include <boost/intrusive_ptr.hpp>
+#include <boost/noncopyable.hpp>
+
+#include "SWFMatrix.h"
+#include "SWFCxForm.h"
+#include "PlaceObject2Tag.h"
+
+// Forward declarations
+namespace gnash {
+    class movie_definition;
+    class MovieClip;
+    class DisplayList;
+}
+
+namespace gnash {
+
+/// The DisplayList built by the DisplayList tags of a timeline's frames.
+//
+/// Replaying the tags of every frame before a frame creates all the
+/// DisplayObjects placed on the way, even those removed again. A snapshot
+/// only records, for each depth, the tags that built what is left there,
+/// so that restoring it creates each remaining DisplayObject once.
+class TimelineSnapshot
+{
+public:
+
+    TimelineSnapshot();
+
+    /// The number of frames whose tags are included.
+    size_t frames() const {
+        return _frames;
+    }
+
+    /// Include the DisplayList tags of the next frame.
+    //
+    /// @return false if a tag can't be recorded.
+    bool addFrame(const movie_definition& def);
+
+    /// Execute the recorded tags, in the order they were found in.
+    void restore(MovieClip& m, DisplayList& dlist) const;
+
+    /// Record a REMOVE tag.
+    void remove(int depth);
+
+    /// Record a MOVE tag, with null pointers for properties not changed.
+    void move(int depth, const SWFCxForm* cxform, const SWFMatrix* matrix,
+            const std::uint16_t* ratio, const Filters* filters);
+
+private:
+
+    void execute(const movie_definition& def, const SWF::PlaceObject2Tag& tag);
+
+    /// A PLACE or REPLACE tag, or the changes of consecutive MOVE tags.
+    struct Step
+    {
+        Step();
+
+        /// The tag, or 0 for a move.
+        boost::intrusive_ptr<const SWF::PlaceObject2Tag> tag;
+
+        /// The position of the (last) tag in the timeline.
+        size_t order;
+
+        bool hasCxForm;
+        bool hasMatrix;
+        bool hasRatio;
+        bool hasFilters;
+        SWFCxForm cxform;
+        SWFMatrix matrix;
+        std::uint16_t ratio;
+        Filters filters;
+    };
+
+    typedef std::vector<Step> Steps;
+
+    typedef std::map<int, Steps> Depths;
+
+    Depths _depths;
+
+    size_t _frames;
+
+    /// The number of DisplayList tags included.
+    size_t _tags;
+};
+
+/// Snapshots of a timeline at regular intervals, taken when needed.
+class TimelineSnapshots : boost::noncopyable
+{
+public:
+
+    /// The number of frames between snapshots.
+    static const size_t interval = 32;
+
+    TimelineSnapshots();
+
+    /// Get the latest snapshot including no frame after the given one.
+    //
+    /// Snapshots are only taken of loaded frames.
+    ///
+    /// @param def      The definition owning this object.
+    /// @param frame    The 0-based frame to restore.
+    /// @return         A snapshot of some frames before the given one,
+    ///                 or 0 if there is none.
+    const TimelineSnapshot* get(const movie_definition& def, size_t frame);
+
+private:
+
+    /// Snapshots of the first interval * (n + 1) frames, stable when
+    /// more are added.
+    std::deque<TimelineSnapshot> _snapshots;
+
+    /// The snapshot being extended.
+    TimelineSnapshot _next;
+
+    /// Whether the timeline has tags that can't be recorded.
+    bool _failed;
+
+    std::mutex _mutex;
+};
+
+} // namespace gnash
+
+#endif
@@ -360,8 +360,12 @@ as_value
 movieclip_cacheAsBitmap(const fn_call& fn)
 {
     MovieClip* movieclip = ensure<IsDisplayObject<MovieClip> >(fn);
-    UNUSED(movieclip);
-    LOG_ONCE( log_unimpl(_("MovieClip.cacheAsBitmap()")) );
+
+    if (!fn.nargs) {
+        return as_value(movieclip->cacheAsBitmap());
+    }
+
+    movieclip->setCacheAsBitmap(toBool(fn.arg(0), getVM(fn)));
     return as_value();
 }
 
@@ -629,6 +629,10 @@ BitmapData_as::updateObjects() const
 void
 BitmapData_as::dispose()
 {
+    // The image may still be drawn in the background.
+    Renderer* r = getRunResources(*_owner).renderer();
+    if (r) r->sync();
+
     if (_cachedBitmap) _cachedBitmap->dispose();
     _cachedBitmap = nullptr;
     _image.reset();
@@ -996,6 +996,14 @@ movie_root::timeToNextFrame() const
 
 void
 movie_root::display()
+{
+    Renderer* renderer = _runResources.renderer();
+    if (renderer) display(*renderer);
+    else clearInvalidated();
+}
+
+void
+movie_root::display(Renderer& renderer)
 {
     // GNASH_REPORT_FUNCTION;
 
@@ -1013,10 +1021,7 @@ movie_root::display()
         return;
     }
 
-    Renderer* renderer = _runResources.renderer();
-    if (!renderer) return;
-
-    Renderer::External ex(*renderer, m_background_color,
+    Renderer::External ex(renderer, m_background_color,
             _stageWidth, _stageHeight,
             frame_size.get_x_min(), frame_size.get_x_max(),
             frame_size.get_y_min(), frame_size.get_y_max());
@@ -1036,7 +1041,7 @@ movie_root::display()
             continue;
         }
 
-        movie->display(*renderer, Transform());
+        movie->display(renderer, Transform());
     }
 }
 
@@ -119,6 +119,7 @@ namespace gnash {
     class Button;
     class VM;
     class Movie;
+    class Renderer;
 }
 
 namespace gnash {
@@ -384,8 +385,14 @@ public:
     ///   - Run the GC collector
     void advanceMovie();
 
+    /// Display the stage with the renderer of our RunResources.
     void display();
 
+    /// Display the stage with the given renderer.
+    //
+    /// This is used to record the frame in a DisplaySnapshot.
+    void display(Renderer& renderer);
+
     /// Get a unique number for unnamed instances.
     size_t nextUnnamedInstance() {
         return ++_unnamedInstance;
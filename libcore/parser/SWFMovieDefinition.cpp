@@ -54,9 +54,12 @@
 #include "CachedBitmap.h"
 #include "TypesParser.h"
 #include "GnashImageJpeg.h"
-
-// Debug frames load
-#undef DEBUG_FRAMES_LOAD
+#include "DiskCache.h"
+#include "DefineBitsTag.h"
+#include "DeferredDefinitionTag.h"
+#include "DisplayListRecordsTag.h"
+#include "Renderer.h"
+#include "rc.h"
 
 // Define this this to load movies using a separate thread
 // (undef and it will fully load a movie before starting to play it)
@@ -71,6 +74,16 @@
 namespace gnash
 {
 
+// Forward declarations
+namespace {
+    std::string bodyCacheKey(IOChannel& in);
+    std::unique_ptr<IOChannel> getCachedBody(const std::string& key,
+            std::uint32_t fileLength);
+    std::unique_ptr<IOChannel> cacheBody(std::unique_ptr<IOChannel> in,
+            const std::string& key, std::uint32_t header,
+            std::uint32_t fileLength);
+}
+
 SWFMovieLoader::SWFMovieLoader(SWFMovieDefinition& md)
     : _movie_def(md)
 {
@@ -130,6 +143,8 @@ SWFMovieLoader::start()
 
 SWFMovieDefinition::SWFMovieDefinition(const RunResources& runResources)
     :
+    _bitmapBytes(0),
+    _decodedBytes(0),
     m_frame_rate(30.0f),
     m_frame_count(0u),
     m_version(0),
@@ -163,13 +178,57 @@ SWFMovieDefinition::addDisplayObject(std::uint16_t id, SWF::DefinitionTag* c)
     addControlTag(c);
 }
 
+void
+SWFMovieDefinition::addDisplayListTag(
+        boost::intrusive_ptr<SWF::DisplayListTag> tag)
+{
+    assert(tag);
+    SWF::DisplayListRecordsTag::addTag(m_playlist[get_loading_frame()], tag);
+}
+
+SWFMovieDefinition::BitmapEntry::BitmapEntry()
+    :
+    decodedBytes(0)
+{
+}
+
+SWFMovieDefinition::BitmapEntry::~BitmapEntry()
+{
+}
+
 SWF::DefinitionTag*
 SWFMovieDefinition::getDefinitionTag(std::uint16_t id) const
 {
+    boost::intrusive_ptr<SWF::DefinitionTag> ch;
+    {
+        std::lock_guard<std::mutex> lock(_dictionaryMutex);
+        ch = _dictionary.getDisplayObject(id);
+    }
+
+    SWF::DeferredDefinitionTag* deferred =
+        dynamic_cast<SWF::DeferredDefinitionTag*>(ch.get());
+    if (!deferred) return ch.get();
+
+    // The dictionary isn't locked while parsing, so that the loader and
+    // other lookups don't wait for it.
+    const boost::intrusive_ptr<SWF::DefinitionTag> parsed =
+        deferred->parse();
+    if (!parsed) return nullptr;
+
+    // The playlist keeps the deferred tag, which only adds its id to the
+    // root when executed; the dictionary gets the parsed one, unless
+    // another lookup has already replaced it.
     std::lock_guard<std::mutex> lock(_dictionaryMutex);
-    boost::intrusive_ptr<SWF::DefinitionTag> ch = 
-        _dictionary.getDisplayObject(id);
-    return ch.get(); 
+    if (_dictionary.getDisplayObject(id) == ch) {
+        _dictionary.addDisplayObject(id, parsed);
+    }
+    return parsed.get();
+}
+
+bool
+SWFMovieDefinition::deferParsing() const
+{
+    return _frames_loaded.load() + 1 < _waiting_for_frame.load();
 }
 
 void
@@ -206,16 +265,110 @@ SWFMovieDefinition::get_font(const std::string& name, bool bold, bool italic)
 CachedBitmap*
 SWFMovieDefinition::getBitmap(int id) const
 {
-    const Bitmaps::const_iterator it = _bitmaps.find(id);
+    std::lock_guard<std::mutex> lock(_bitmapsMutex);
+
+    const Bitmaps::iterator it = _bitmaps.find(id);
     if (it == _bitmaps.end()) return nullptr;
-    return it->second.get();
+
+    BitmapEntry& e = it->second;
+    e.lastUse = std::chrono::steady_clock::now();
+
+    if (e.bitmap || !e.tag.get()) return e.bitmap.get();
+
+    Renderer* renderer = _runResources.renderer();
+    if (!renderer) return nullptr;
+
+    std::unique_ptr<image::GnashImage> im = e.tag->decode();
+    if (im.get()) e.bitmap = renderer->createCachedBitmap(std::move(im));
+
+    if (!e.bitmap) {
+        // Don't try again.
+        IF_VERBOSE_MALFORMED_SWF(
+            log_swferror(_("Failed to parse bitmap for character %1%"), id);
+        );
+        _bitmapBytes -= e.tag->size();
+        e.tag.reset();
+        return nullptr;
+    }
+
+    e.decodedBytes = e.bitmap->memoryUsage();
+    _decodedBytes += e.decodedBytes;
+    _bitmapBytes += e.decodedBytes;
+
+    dropBitmaps(id);
+    return e.bitmap.get();
 }
 
 void
 SWFMovieDefinition::addBitmap(int id, boost::intrusive_ptr<CachedBitmap> im)
 {
     assert(im);
-    _bitmaps.insert(std::make_pair(id, im));
+    std::lock_guard<std::mutex> lock(_bitmapsMutex);
+
+    BitmapEntry& e = _bitmaps[id];
+    if (e.bitmap || e.tag.get()) return;
+
+    e.bitmap = im;
+    _bitmapBytes += im->memoryUsage();
+}
+
+void
+SWFMovieDefinition::addBitmapTag(int id,
+        std::unique_ptr<SWF::DefineBitsTag> tag)
+{
+    assert(tag.get());
+    std::lock_guard<std::mutex> lock(_bitmapsMutex);
+
+    BitmapEntry& e = _bitmaps[id];
+    if (e.bitmap || e.tag.get()) {
+        IF_VERBOSE_MALFORMED_SWF(
+            log_swferror(_("DEFINEBITS: Duplicate id (%d) for bitmap "
+                    "DisplayObject - discarding it"), id);
+        );
+        return;
+    }
+
+    _bitmapBytes += tag->size();
+    e.tag = std::move(tag);
+}
+
+void
+SWFMovieDefinition::dropBitmaps(int keep) const
+{
+    const size_t limit = static_cast<size_t>(
+            RcInitFile::getDefaultInstance().getBitmapMemoryLimit()) << 20;
+
+    if (!limit || _decodedBytes <= limit) return;
+
+    // Bitmaps requested this recently are probably on stage, and may
+    // still be used by the renderer.
+    const std::chrono::steady_clock::time_point recent =
+        std::chrono::steady_clock::now() - std::chrono::seconds(2);
+
+    std::vector<BitmapEntry*> candidates;
+    for (Bitmaps::value_type& b : _bitmaps) {
+        BitmapEntry& e = b.second;
+        if (b.first == keep || !e.bitmap || !e.tag.get()) continue;
+        if (e.lastUse > recent) continue;
+
+        // Referenced elsewhere, for instance by a BitmapData.
+        if (e.bitmap->get_ref_count() > 1) continue;
+
+        candidates.push_back(&e);
+    }
+
+    std::sort(candidates.begin(), candidates.end(),
+            [](const BitmapEntry* a, const BitmapEntry* b) {
+                return a->lastUse < b->lastUse;
+            });
+
+    for (BitmapEntry* e : candidates) {
+        if (_decodedBytes <= limit) break;
+        _decodedBytes -= e->decodedBytes;
+        _bitmapBytes -= e->decodedBytes;
+        e->decodedBytes = 0;
+        e->bitmap.reset();
+    }
 }
 
 sound_sample*
@@ -283,8 +436,18 @@ SWFMovieDefinition::readHeader(std::unique_ptr<IOChannel> in,
             log_parse(_("file is compressed"));
         );
 
-        // Uncompress the input as we read it.
-        _in = zlib_adapter::make_inflater(std::move(_in));
+        // The decompressed movie may be in the cache. If not, it is
+        // put there as it is uncompressed by the loader.
+        const std::string key = bodyCacheKey(*_in);
+        std::unique_ptr<IOChannel> cached = getCachedBody(key, m_file_length);
+
+        if (cached.get()) {
+            _in = std::move(cached);
+        }
+        else {
+            _in = cacheBody(zlib_adapter::make_inflater(std::move(_in)),
+                    key, header, m_file_length);
+        }
 #endif
     }
 
@@ -533,9 +696,12 @@ SWFMovieDefinition::incrementLoadedFrames()
         )
     }
 
-#ifdef DEBUG_FRAMES_LOAD
-    log_debug("Loaded frame %u/%u", _frames_loaded.load(), m_frame_count);
-#endif
+    IF_VERBOSE_PARSE(
+        log_parse(_("Loaded frame %u/%u of %s (%u/%u bytes), "
+                "waiting for %u"), _frames_loaded.load(), m_frame_count,
+                get_url(), get_bytes_loaded(), get_bytes_total(),
+                _waiting_for_frame.load());
+    );
 
     // signal load of frame if anyone requested it
     // FIXME: _waiting_for_frame needs mutex ?
@@ -739,4 +905,213 @@ SWFMovieDefinition::importResources(
     }
 }
 
+namespace {
+
+/// Get the key identifying a compressed SWF in the movie cache.
+//
+/// Only SWFs mapped in memory from the start of a file are cached, as
+/// they are the only ones that can be hashed without copying them.
+///
+/// @param in   The SWF, positioned after its 8-byte header.
+std::string
+bodyCacheKey(IOChannel& in)
+{
+    DiskCache& cache = DiskCache::getDefaultInstance();
+    if (!cache.enabled() || in.tell() != 8) return std::string();
+
+    const size_t size = in.size();
+    if (size == static_cast<size_t>(-1)) return std::string();
+
+    if (!in.seek(0)) return std::string();
+    const std::uint8_t* data = in.contiguousData(size);
+    in.seek(8);
+
+    if (!data) return std::string();
+    return DiskCache::makeKey("swf", data, size);
+}
+
+/// Open the decompressed copy of a SWF from the movie cache
+//
+/// The copy is a complete uncompressed SWF file.
+///
+/// @param key  The key of the SWF, or an empty string if it is not
+///             cached.
+/// @return the copy, positioned after the header, or 0 if there is no
+///         valid copy in the cache.
+std::unique_ptr<IOChannel>
+getCachedBody(const std::string& key, std::uint32_t fileLength)
+{
+    std::unique_ptr<IOChannel> ret;
+    if (key.empty()) return ret;
+
+    DiskCache& cache = DiskCache::getDefaultInstance();
+    ret = cache.get(key);
+    if (!ret.get()) return ret;
+
+    const std::uint32_t header = ret->read_le32();
+    if ((header & 0x0FFFFFF) != 0x00535746 || ret->read_le32() != fileLength
+            || ret->size() != fileLength) {
+        ret.reset();
+        cache.remove(key);
+        return ret;
+    }
+
+    IF_VERBOSE_PARSE(
+        log_parse(_("Using decompressed movie from the cache (%s)"), key);
+    );
+    return ret;
+}
+
+/// A decompressed SWF that is copied to the movie cache as it is read.
+//
+/// The loader reads the movie from start to end, so the whole movie is
+/// stored by the time it is loaded, without delaying its first frame.
+/// The data skipped by seeking forward is copied too. If the movie is
+/// not read to its end, nothing is stored.
+class CachingChannel : public IOChannel
+{
+public:
+
+    /// @param in       The decompressed SWF, after its header.
+    /// @param out      The cache entry, with the header written.
+    CachingChannel(std::unique_ptr<IOChannel> in,
+            std::unique_ptr<IOChannel> out, std::string key,
+            std::string temp, std::uint32_t fileLength)
+        :
+        _in(std::move(in)),
+        _out(std::move(out)),
+        _key(std::move(key)),
+        _temp(std::move(temp)),
+        _written(_in->tell()),
+        _end(fileLength)
+    {
+    }
+
+    ~CachingChannel() {
+        if (_out.get()) commit(false);
+    }
+
+    virtual std::streamsize read(void* dst, std::streamsize num) {
+        const std::streampos pos = _in->tell();
+        const std::streamsize got = _in->read(dst, num);
+        if (!_out.get() || pos > _written || pos + got <= _written) {
+            return got;
+        }
+
+        // Store what wasn't stored yet.
+        const std::streamsize skip = _written - pos;
+        const std::streamsize count = got - skip;
+        if (_out->write(static_cast<char*>(dst) + skip, count) != count) {
+            commit(false);
+            return got;
+        }
+        _written += count;
+        if (_written >= _end) commit(!_out->bad());
+        return got;
+    }
+
+    virtual std::streampos tell() const {
+        return _in->tell();
+    }
+
+    virtual bool seek(std::streampos p) {
+        if (_out.get() && p > _written) {
+            if (!_in->seek(_written)) return false;
+            std::vector<std::uint8_t> buf(65536);
+            while (_out.get() && _written < p) {
+                const std::streamsize chunk =
+                    std::min<std::streamoff>(p - _written, buf.size());
+                if (read(&buf.front(), chunk) != chunk) return false;
+            }
+        }
+        return _in->seek(p);
+    }
+
+    virtual void go_to_end() {
+        if (_out.get()) seek(_end);
+        _in->go_to_end();
+    }
+
+    virtual bool eof() const {
+        return _in->eof();
+    }
+
+    virtual bool bad() const {
+        return _in->bad();
+    }
+
+    virtual size_t size() const {
+        return _in->size();
+    }
+
+private:
+
+    void commit(bool success) {
+        _out.reset();
+        DiskCache& cache = DiskCache::getDefaultInstance();
+        if (cache.commit(_key, _temp, success)) {
+            IF_VERBOSE_PARSE(
+                log_parse(_("Stored decompressed movie in the cache (%s)"),
+                    _key);
+            );
+        }
+    }
+
+    const std::unique_ptr<IOChannel> _in;
+
+    std::unique_ptr<IOChannel> _out;
+
+    const std::string _key;
+
+    const std::string _temp;
+
+    /// The position in the SWF up to which it has been stored.
+    std::streampos _written;
+
+    const std::streampos _end;
+};
+
+/// Store a decompressed SWF in the movie cache as it is read.
+//
+/// @param in       The decompressed SWF, positioned after the header.
+/// @param key      The key of the SWF, or an empty string if it is not
+///                 cached.
+///
+/// @return a channel reading the SWF and storing it, or the SWF itself
+///         if it can't be stored.
+std::unique_ptr<IOChannel>
+cacheBody(std::unique_ptr<IOChannel> in, const std::string& key,
+        std::uint32_t header, std::uint32_t fileLength)
+{
+    if (key.empty() || fileLength <= 8) return in;
+
+    DiskCache& cache = DiskCache::getDefaultInstance();
+    std::string temp;
+    std::unique_ptr<IOChannel> out = cache.create(key, temp);
+    if (!out.get()) return in;
+
+    // Write an uncompressed header.
+    const std::uint32_t fws = (header & 0xFF000000) | 0x00535746;
+    const std::uint8_t head[8] = {
+        static_cast<std::uint8_t>(fws),
+        static_cast<std::uint8_t>(fws >> 8),
+        static_cast<std::uint8_t>(fws >> 16),
+        static_cast<std::uint8_t>(fws >> 24),
+        static_cast<std::uint8_t>(fileLength),
+        static_cast<std::uint8_t>(fileLength >> 8),
+        static_cast<std::uint8_t>(fileLength >> 16),
+        static_cast<std::uint8_t>(fileLength >> 24)
+    };
+    if (out->write(head, 8) != 8) {
+        out.reset();
+        cache.commit(key, temp, false);
+        return in;
+    }
+
+    return std::unique_ptr<IOChannel>(new CachingChannel(std::move(in),
+                std::move(out), key, temp, fileLength));
+}
+
+} // anonymous namespace
+
 } // namespace gnash
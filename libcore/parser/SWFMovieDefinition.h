@@ -30,6 +30,7 @@
 #include <boost/intrusive_ptr.hpp>
 
 #include <atomic>
+#include <chrono>
 #include <vector>
 #include <map>
 #include <set> 
@@ -43,6 +44,7 @@
 #include "StringPredicates.h" 
 #include "SWFRect.h"
 #include "GnashNumeric.h"
+#include "TimelineSnapshots.h"
 #include "dsodefs.h" // for DSOTEXPORT
 
 // Forward declarations
@@ -60,6 +62,7 @@ namespace gnash {
     class Font;
     namespace SWF {
         class DefinitionTag;
+        class DefineBitsTag;
     }
 }
 
@@ -225,14 +228,24 @@ public:
         return m_file_length;
     }
 
+    /// The parsed data, estimated from the input size, and bitmaps.
+    virtual size_t memoryUsage() const {
+        return get_bytes_loaded() + _bitmapBytes.load();
+    }
+
     DSOTEXPORT virtual void importResources(boost::intrusive_ptr<movie_definition> source,
             const Imports& imports);
 
     virtual void addDisplayObject(std::uint16_t id, SWF::DefinitionTag* c);
 
     /// Return a DisplayObject from the dictionary
+    //
+    /// Deferred definitions are parsed first, see deferParsing().
     DSOTEXPORT SWF::DefinitionTag* getDefinitionTag(std::uint16_t id) const;
 
+    /// Defer parsing while a later frame than the next is waited for.
+    virtual bool deferParsing() const;
+
     // See dox in movie_definition
     //
     // locks _namedFramesMutex
@@ -246,11 +259,24 @@ public:
     Font* get_font(const std::string& name, bool bold, bool italic) const;
 
     // See dox in movie_definition.h
+    //
+    // Bitmaps added with addBitmapTag() are decoded here. This may
+    // drop other bitmaps, see dropBitmaps().
+    //
+    // locks _bitmapsMutex
     DSOTEXPORT CachedBitmap* getBitmap(int DisplayObject_id) const;
 
     // See dox in movie_definition.h
+    //
+    // locks _bitmapsMutex
     void addBitmap(int DisplayObject_id, boost::intrusive_ptr<CachedBitmap> im);
 
+    // See dox in movie_definition.h
+    //
+    // locks _bitmapsMutex
+    void addBitmapTag(int DisplayObject_id,
+            std::unique_ptr<SWF::DefineBitsTag> tag);
+
     // See dox in movie_definition.h
     sound_sample* get_sound_sample(int DisplayObject_id) const;
 
@@ -274,6 +300,9 @@ public:
         m_playlist[frames_loaded].push_back(tag);
     }
 
+    // See dox in movie_definition.h
+    void addDisplayListTag(boost::intrusive_ptr<SWF::DisplayListTag> tag);
+
     // See dox in movie_definition.h
     //
     // locks _namedFramesMutex
@@ -300,6 +329,11 @@ public:
         else return &(it->second);
     }
 
+    // See dox in movie_definition.h
+    virtual const TimelineSnapshot* getSnapshot(size_t frame_number) const {
+        return _snapshots.get(*this, frame_number);
+    }
+
     /// Read the header of the SWF file
     //
     /// This function only reads the header of the SWF
@@ -393,7 +427,10 @@ private:
 #endif
 
     /// Characters Dictionary
-    CharacterDictionary    _dictionary;
+    //
+    /// Mutable because looking up a deferred definition replaces it
+    /// with the parsed one.
+    mutable CharacterDictionary _dictionary;
 
     /// Mutex protecting _dictionary
     mutable std::mutex _dictionaryMutex;
@@ -401,8 +438,47 @@ private:
     typedef std::map<int, boost::intrusive_ptr<Font> > FontMap;
     FontMap m_fonts;
 
-    typedef std::map<int, boost::intrusive_ptr<CachedBitmap> > Bitmaps;
-    Bitmaps _bitmaps;
+    struct BitmapEntry
+    {
+        BitmapEntry();
+
+        ~BitmapEntry();
+
+        /// The bitmap, or 0 if it is not decoded.
+        boost::intrusive_ptr<CachedBitmap> bitmap;
+
+        /// The tag to decode the bitmap from, if any.
+        std::unique_ptr<SWF::DefineBitsTag> tag;
+
+        /// The memory used by the bitmap, if decoded from the tag.
+        size_t decodedBytes;
+
+        /// When the bitmap was last requested.
+        std::chrono::steady_clock::time_point lastUse;
+    };
+
+    typedef std::map<int, BitmapEntry> Bitmaps;
+    mutable Bitmaps _bitmaps;
+
+    /// Memory used by _bitmaps
+    mutable std::atomic<size_t> _bitmapBytes;
+
+    /// Memory used by bitmaps decoded from tags
+    mutable size_t _decodedBytes;
+
+    /// Mutex protecting _bitmaps and _decodedBytes
+    mutable std::mutex _bitmapsMutex;
+
+    /// Drop decoded bitmaps until they fit the configured budget.
+    //
+    /// Only bitmaps that can be decoded again, that weren't requested
+    /// recently and that are not referenced elsewhere are dropped,
+    /// least recently requested first.
+    ///
+    /// Must be called with _bitmapsMutex locked.
+    ///
+    /// @param keep     The id of a bitmap that must not be dropped.
+    void dropBitmaps(int keep) const;
 
     typedef std::map<int, boost::intrusive_ptr<sound_sample> > SoundSampleMap;
     SoundSampleMap m_sound_samples;
@@ -412,6 +488,9 @@ private:
     /// Movie control events for each frame.
     PlayListMap m_playlist;
 
+    /// DisplayList states of the timeline, taken on demand.
+    mutable TimelineSnapshots _snapshots;
+
     /// 0-based frame #'s
     typedef std::map<std::string, size_t, StringNoCaseLessThan> NamedFrameMap;
     NamedFrameMap _namedFrames;
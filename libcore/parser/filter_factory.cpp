@@ -37,6 +37,20 @@ enum filter_types
     GRADIENT_BEVEL = 7
 };
 
+namespace {
+
+/// Read an RGB color, as 0xRRGGBB.
+std::uint32_t
+readRGB(SWFStream& in)
+{
+    const std::uint32_t r = in.read_u8();
+    const std::uint32_t g = in.read_u8();
+    const std::uint32_t b = in.read_u8();
+    return r << 16 | g << 8 | b;
+}
+
+} // anonymous namespace
+
 int
 filter_factory::read(SWFStream& in, bool read_multiple, Filters* store)
 {
@@ -113,7 +127,7 @@ bool DropShadowFilter::read(SWFStream& in)
 {
     in.ensureBytes(4 + 8 + 8 + 2 + 1);
 
-    m_color = in.read_u8() << (16 + in.read_u8()) << (8 + in.read_u8());
+    m_color = readRGB(in);
     m_alpha = in.read_u8();
 
     m_blurX = in.read_fixed();
@@ -126,9 +140,11 @@ bool DropShadowFilter::read(SWFStream& in)
 
     m_inner = in.read_bit(); 
     m_knockout = in.read_bit(); 
-    m_hideObject = in.read_bit(); 
 
-    static_cast<void> (in.read_uint(5)); // Throw these away on purpose.
+    // The object is drawn over its shadow unless CompositeSource is 0.
+    m_hideObject = !in.read_bit(); 
+
+    m_quality = static_cast<std::uint8_t> (in.read_uint(5));
 
     IF_VERBOSE_PARSE(
         log_parse(_("   DropShadowFilter: blurX=%f blurY=%f"),
@@ -163,7 +179,7 @@ bool GlowFilter::read(SWFStream& in)
 
     in.ensureBytes(4 + 8 + 2 + 1);
 
-    m_color = in.read_u8() << (16 + in.read_u8()) << (8 + in.read_u8());
+    m_color = readRGB(in);
     m_alpha = in.read_u8();
 
     m_blurX = in.read_fixed();
@@ -173,8 +189,9 @@ bool GlowFilter::read(SWFStream& in)
 
     m_inner = in.read_bit(); 
     m_knockout = in.read_bit(); 
+    in.read_bit(); // CompositeSource, always 1.
 
-    static_cast<void> (in.read_uint(6)); // Throw these away.
+    m_quality = static_cast<std::uint8_t> (in.read_uint(5));
 
     IF_VERBOSE_PARSE(
         log_parse(_("   GlowFilter "));
@@ -190,10 +207,10 @@ bool BevelFilter::read(SWFStream& in)
     // TODO: It is possible that the order of these two should be reversed.
     // highlight might come first. Find out for sure and then fix and remove
     // this comment.
-    m_shadowColor = in.read_u8() << (16 + in.read_u8()) << (8 + in.read_u8());
+    m_shadowColor = readRGB(in);
     m_shadowAlpha = in.read_u8();
 
-    m_highlightColor = in.read_u8() << (16 + in.read_u8()) << (8 + in.read_u8());
+    m_highlightColor = readRGB(in);
     m_highlightAlpha = in.read_u8();
 
     m_blurX = in.read_fixed();
@@ -212,7 +229,7 @@ bool BevelFilter::read(SWFStream& in)
     // Set the bevel type. top and inner is full, top is outer, inner is inner
     m_type = on_top ? (inner_shadow ? FULL_BEVEL : OUTER_BEVEL) : INNER_BEVEL;
     
-    static_cast<void> (in.read_uint(4)); // Throw these away.
+    m_quality = static_cast<std::uint8_t> (in.read_uint(4));
 
     IF_VERBOSE_PARSE(
         log_parse(_("   BevelFilter "));
@@ -235,7 +252,7 @@ bool GradientGlowFilter::read(SWFStream& in)
 
     for (int i = 0; i < count; ++i)
     {
-        m_colors.push_back(in.read_u8() << (16 + in.read_u8()) << (8 + in.read_u8()));
+        m_colors.push_back(readRGB(in));
         m_alphas.push_back(in.read_u8());
     }
 
@@ -289,7 +306,7 @@ ConvolutionFilter::read(SWFStream& in)
         _matrix.push_back(in.read_long_float());
     }
 
-    _color = in.read_u8() << (16 + in.read_u8()) << (8 + in.read_u8());
+    _color = readRGB(in);
     _alpha = in.read_u8();
 
     static_cast<void> (in.read_uint(6)); // Throw away.
@@ -345,7 +362,7 @@ bool GradientBevelFilter::read(SWFStream& in)
     m_ratios.reserve(count);
     for (int i = 0; i < count; ++i)
     {
-        m_colors.push_back(in.read_u8() << (16 + in.read_u8()) << (8 + in.read_u8()));
+        m_colors.push_back(readRGB(in));
         m_alphas.push_back(in.read_u8());
     }
 
@@ -29,7 +29,9 @@ namespace gnash {
 
 namespace gnash {
 
-typedef std::vector<std::unique_ptr<BitmapFilter> > Filters;
+/// Filters are shared by the tags defining them and the DisplayObjects
+/// they are applied to.
+typedef std::vector<std::shared_ptr<BitmapFilter> > Filters;
 
 class filter_factory
 {
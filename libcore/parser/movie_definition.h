@@ -59,6 +59,7 @@
 #include <cstdint>
 
 #include "DefinitionTag.h"
+#include "DisplayListTag.h"
 #include "log.h"
 
 // Forward declarations
@@ -66,8 +67,10 @@ namespace gnash {
 	class CachedBitmap;
 	class Movie;
 	class MovieClip;
+	class TimelineSnapshot;
 	namespace SWF {
         class ControlTag;
+        class DefineBitsTag;
     }
     class Font;
     class sound_sample;
@@ -126,6 +129,16 @@ public:
 	///
 	virtual size_t get_bytes_total() const = 0;
 
+	/// Get the approximate number of bytes of memory used by this movie.
+	//
+	/// This is used to limit the size of the movie library.
+	/// The default is the number of bytes loaded, which is a fair
+	/// estimate when the data is kept as loaded.
+	///
+	virtual size_t memoryUsage() const {
+		return get_bytes_loaded();
+	}
+
 	/// Create a movie instance from a def.
 	//
 	/// Not all movie definitions allow creation of
@@ -147,6 +160,17 @@ public:
 
     virtual void incrementLoadedFrames() {}
 
+    /// Whether definitions may be parsed when first used, not when loaded.
+    //
+    /// This is true while the loader is behind a frame that is waited
+    /// for, so that it reaches it sooner. See SWF::DeferredDefinitionTag.
+    ///
+    /// The default implementation is to always return false.
+    ///
+    virtual bool deferParsing() const {
+        return false;
+    }
+
 	/// Return the list of execute tags for given frame number
 	//
 	/// @param frame_number
@@ -161,6 +185,22 @@ public:
 		return nullptr;
 	}
 
+	/// Get the DisplayList built by the tags of the frames before a frame
+	//
+	/// This is used to restore the DisplayList for a backward jump
+	/// without replaying all frames. See TimelineSnapshots.
+	///
+	/// @param frame_number
+	///	 Frame number, 0-based
+	///
+	/// @return NULL if there is no snapshot before the given frame
+	///	    (the default implementation)
+	///
+	virtual const TimelineSnapshot* getSnapshot(size_t /*frame_number*/) const
+	{
+		return nullptr;
+	}
+
 
 	typedef std::pair<int, std::string> ImportSpec;
 	typedef std::vector< ImportSpec > Imports;
@@ -274,6 +314,21 @@ public:
 	{
 	}
 
+	/// Add a DisplayList tag to this movie_definition's playlist
+	//
+	/// The default implementation calls addControlTag(). Definitions
+	/// with many frames store consecutive MOVE and REMOVE tags
+	/// compactly instead, see SWF::DisplayListRecordsTag.
+	///
+	/// @param tag
+	/// 	The tag to add in the list of executable tags for
+	/// 	the frame currently being loaded.
+	virtual void addDisplayListTag(
+            boost::intrusive_ptr<SWF::DisplayListTag> tag)
+	{
+		addControlTag(tag);
+	}
+
 	/// Labels the frame currently being loaded with the given name.
 	//
 	/// A copy of the name string is made and kept in this object.
@@ -341,6 +396,17 @@ public:
 	{
 	}
 
+	/// \brief
+	/// Add a bitmap DisplayObject in the dictionary, to be decoded
+	/// from the given tag when getBitmap() first requests it.
+	//
+	/// The default implementation is a no-op (deletes the tag).
+	///
+	virtual void addBitmapTag(int /*id*/,
+			std::unique_ptr<SWF::DefineBitsTag> /*tag*/)
+	{
+	}
+
 	/// Get the sound sample with given ID.
 	//
 	/// @return NULL if the given DisplayObject ID isn't found in the
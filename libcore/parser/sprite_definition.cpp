@@ -27,6 +27,7 @@
 #include "SWFParser.h"
 #include "namedStrings.h"
 #include "Global_as.h"
+#include "DisplayListRecordsTag.h"
 
 #include <vector>
 #include <string>
@@ -88,6 +89,13 @@ sprite_definition::read(SWFStream& in, const RunResources& runResources)
     );
 }
 
+void
+sprite_definition::addDisplayListTag(
+        boost::intrusive_ptr<SWF::DisplayListTag> tag)
+{
+    SWF::DisplayListRecordsTag::addTag(m_playlist[m_loading_frame], tag);
+}
+
 void
 sprite_definition::add_frame_name(const std::string& name)
 {
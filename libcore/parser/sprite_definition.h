@@ -29,6 +29,7 @@
 #include "log.h"
 #include "SWFRect.h"
 #include "StringPredicates.h" // StringNoCaseLessThan
+#include "TimelineSnapshots.h"
 
 // Forward declarations
 namespace gnash {
@@ -149,6 +150,15 @@ public:
 		);
 	}
 
+	/// Overridden just for complaining  about malformed SWF
+	virtual void addBitmapTag(int /*id*/,
+			std::unique_ptr<SWF::DefineBitsTag> /*tag*/)
+	{
+		IF_VERBOSE_MALFORMED_SWF (
+		log_swferror(_("add_bitmap_SWF::DefinitionTag appears in sprite tags"));
+		);
+	}
+
 	/// Delegate call to associated root movie
 	virtual sound_sample* get_sound_sample(int id) const
 	{
@@ -213,6 +223,10 @@ public:
 		m_playlist[m_loading_frame].push_back(c);
 	}
 
+	// See dox in movie_definition.h
+	virtual void addDisplayListTag(
+            boost::intrusive_ptr<SWF::DisplayListTag> tag);
+
 private:
 
 	void read(SWFStream& in, const RunResources& runResources);
@@ -226,6 +240,9 @@ private:
 	/// movie control events for each frame.
 	PlayListMap m_playlist;
 
+	/// DisplayList states of the timeline, taken on demand.
+	mutable TimelineSnapshots _snapshots;
+
 	// stores 0-based frame #'s
 	typedef std::map<std::string, size_t, StringNoCaseLessThan> NamedFrameMap;
 	NamedFrameMap _namedFrames;
@@ -254,6 +271,12 @@ private:
 		else return &(it->second);
 	}
 
+	// See dox in movie_definition.h
+	const TimelineSnapshot* getSnapshot(size_t frame_number) const
+	{
+		return _snapshots.get(*this, frame_number);
+	}
+
 	virtual const std::string& get_url() const
 	{
 		return m_movie_def.get_url();
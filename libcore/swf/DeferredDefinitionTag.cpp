@@ -0,0 +1,98 @@
+// DeferredDefinitionTag.cpp: definitions parsed when first used, for Gnash.
+//
+//   Copyright (C) 2012 Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#include "DeferredDefinitionTag.h"
+
+#include <exception>
+
+#include "StoredTag.h"
+#include "SWFStream.h"
+#include "movie_definition.h"
+#include "log.h"
+
+namespace gnash {
+namespace SWF {
+
+bool
+DeferredDefinitionTag::defer(SWFStream& in, TagType tag, movie_definition& m,
+        const RunResources& r, std::uint16_t id, Parser parser)
+{
+    if (!m.deferParsing()) return false;
+
+    IF_VERBOSE_PARSE(
+        log_parse(_("Deferring parsing of definition %d (tag %s)"), id, tag);
+    );
+
+    m.addDisplayObject(id, new DeferredDefinitionTag(in, tag, m, r, id,
+                parser));
+    return true;
+}
+
+DeferredDefinitionTag::DeferredDefinitionTag(SWFStream& in, TagType tag,
+        movie_definition& m, const RunResources& r, std::uint16_t id,
+        Parser parser)
+    :
+    DefinitionTag(id),
+    _tag(tag),
+    _movie(m),
+    _runResources(r),
+    _parser(parser),
+    _data(new StoredTag(in, tag, id))
+{
+}
+
+DeferredDefinitionTag::~DeferredDefinitionTag()
+{
+}
+
+boost::intrusive_ptr<DefinitionTag>
+DeferredDefinitionTag::parse()
+{
+    std::lock_guard<std::mutex> lock(_parseMutex);
+    if (!_data.get()) return _parsed;
+
+    try {
+        StoredTag::Reader reader(*_data);
+        _parsed = _parser(reader.stream(), _tag, _movie, _runResources,
+                id());
+    }
+    catch (const std::exception& e) {
+        IF_VERBOSE_MALFORMED_SWF(
+            log_swferror(_("Could not parse definition %d: %s"), id(),
+                e.what());
+        );
+    }
+    _data.reset();
+    return _parsed;
+}
+
+DisplayObject*
+DeferredDefinitionTag::createDisplayObject(Global_as& gl,
+        DisplayObject* parent) const
+{
+    // Looking the definition up parses it and replaces this tag in the
+    // dictionary, which may hold the last reference to it.
+    const boost::intrusive_ptr<const DeferredDefinitionTag> keep(this);
+    const boost::intrusive_ptr<DefinitionTag> def =
+        _movie.getDefinitionTag(id());
+    if (!def || def == this) return nullptr;
+    return def->createDisplayObject(gl, parent);
+}
+
+} // namespace SWF
+} // namespace gnash
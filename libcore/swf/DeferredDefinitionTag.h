@@ -0,0 +1,105 @@
+// DeferredDefinitionTag.h: definitions parsed when first used, for Gnash.
+//
+//   Copyright (C) 2012 Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifndef GNASH_SWF_DEFERREDDEFINITIONTAG_H
+#define GNASH_SWF_DEFERREDDEFINITIONTAG_H
+
+#include <memory>
+#include <mutex>
+#include <cstdint>
+#include <boost/intrusive_ptr.hpp>
+
+#include "DefinitionTag.h"
+#include "SWF.h"
+
+// Forward declarations
+namespace gnash {
+    class SWFStream;
+    class movie_definition;
+    class RunResources;
+    namespace SWF {
+        class StoredTag;
+    }
+}
+
+namespace gnash {
+namespace SWF {
+
+/// A definition whose parsing is postponed until it is looked up.
+//
+/// While the playhead is waiting for a later frame, definitions in the
+/// frames before it are only copied, so that the wanted frame is reached
+/// sooner. Looking one up with movie_definition::getDefinitionTag()
+/// parses it and replaces it in the dictionary.
+class DeferredDefinitionTag : public DefinitionTag
+{
+public:
+
+    /// A function parsing the rest of a definition tag.
+    typedef DefinitionTag* (*Parser)(SWFStream& in, TagType tag,
+            movie_definition& m, const RunResources& r, std::uint16_t id);
+
+    /// Store the definition being parsed if the movie doesn't need it yet.
+    //
+    /// @param in       The stream, positioned after the id of the tag.
+    /// @param parser   The function to parse the definition with later.
+    /// @return         true if the definition was added to the movie,
+    ///                 false if it should be parsed now.
+    static bool defer(SWFStream& in, TagType tag, movie_definition& m,
+            const RunResources& r, std::uint16_t id, Parser parser);
+
+    ~DeferredDefinitionTag();
+
+    /// Parse the stored definition.
+    //
+    /// It is only parsed once: later calls, from any thread, wait for
+    /// the first one and return the same definition.
+    ///
+    /// @return the definition, or 0 if it is malformed.
+    boost::intrusive_ptr<DefinitionTag> parse();
+
+    /// Create a DisplayObject from the parsed definition.
+    virtual DisplayObject* createDisplayObject(Global_as& gl,
+            DisplayObject* parent) const;
+
+private:
+
+    DeferredDefinitionTag(SWFStream& in, TagType tag, movie_definition& m,
+            const RunResources& r, std::uint16_t id, Parser parser);
+
+    const TagType _tag;
+
+    movie_definition& _movie;
+
+    const RunResources& _runResources;
+
+    const Parser _parser;
+
+    std::mutex _parseMutex;
+
+    /// The stored tag, released when parsed.
+    std::unique_ptr<StoredTag> _data;
+
+    boost::intrusive_ptr<DefinitionTag> _parsed;
+
+};
+
+} // namespace SWF
+} // namespace gnash
+
+#endif
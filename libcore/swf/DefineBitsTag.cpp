@@ -25,7 +25,9 @@
 #include "DefineBitsTag.h"
 
 #include <limits>
+#include <algorithm>
 #include <cassert>
+#include <sstream>
 
 #include "IOChannel.h"
 #include "utility.h"
@@ -41,6 +43,9 @@
 #include "CachedBitmap.h"
 #include "GnashImage.h"
 #include "GnashImageJpeg.h"
+#include "DiskCache.h"
+#include "StoredTag.h"
+#include "tu_file.h"
 
 #ifdef HAVE_ZLIB_H
 #include <zlib.h>
@@ -59,7 +64,12 @@ namespace {
     /// DefineBitsJpeg3, also DefineBitsJpeg4!
     std::unique_ptr<image::GnashImage> readDefineBitsJpeg3(SWFStream& in, TagType tag);
     std::unique_ptr<image::GnashImage> readLossless(SWFStream& in, TagType tag);
+    std::unique_ptr<image::GnashImage> readBitmap(SWFStream& in, TagType tag,
+            movie_definition* m);
 
+    std::string bitmapCacheKey(SWFStream& in, TagType tag);
+    std::unique_ptr<image::GnashImage> getCachedBitmap(const std::string& key);
+    void cacheBitmap(const std::string& key, const image::GnashImage& im);
 }
 
 namespace {
@@ -92,6 +102,7 @@ class StreamAdapter : public IOChannel
             //log_debug("Requested to read past end of stream range");
             bytes = bytesLeft;
         }
+
         std::streamsize actuallyRead = s.read(static_cast<char*>(dst), bytes);
         currPos += actuallyRead;
         return actuallyRead;
@@ -192,6 +203,38 @@ jpeg_tables_loader(SWFStream& in, TagType tag, movie_definition& m,
     m.set_jpeg_loader(std::move(input));
 }
 
+DefineBitsTag::DefineBitsTag(SWFStream& in, TagType tag, std::uint16_t id)
+    :
+    _tag(tag),
+    _data(new StoredTag(in, tag, id))
+{
+}
+
+DefineBitsTag::~DefineBitsTag()
+{
+}
+
+size_t
+DefineBitsTag::size() const
+{
+    return _data->size();
+}
+
+std::unique_ptr<image::GnashImage>
+DefineBitsTag::decode() const
+{
+    try {
+        StoredTag::Reader reader(*_data);
+        return readBitmap(reader.stream(), _tag, nullptr);
+    }
+    catch (const std::exception& e) {
+        IF_VERBOSE_MALFORMED_SWF(
+            log_swferror(_("Error decoding bitmap: %s"), e.what());
+        );
+    }
+    return std::unique_ptr<image::GnashImage>();
+}
+
 void
 DefineBitsTag::loader(SWFStream& in, TagType tag, movie_definition& m,
         const RunResources& r)
@@ -199,6 +242,26 @@ DefineBitsTag::loader(SWFStream& in, TagType tag, movie_definition& m,
     in.ensureBytes(2);
     const std::uint16_t id = in.read_u16();
 
+    Renderer* renderer = r.renderer();
+
+    // Keep the data of bitmaps that can be decoded later.
+    if (tag != SWF::DEFINEBITS) {
+
+        if (!renderer) {
+            IF_VERBOSE_PARSE(
+                log_parse(_("No renderer, not adding bitmap %1%"), id)
+            );
+            return;
+        }
+
+        IF_VERBOSE_PARSE(
+            log_parse(_("Adding bitmap tag id %1%"), id);
+        );
+        m.addBitmapTag(id, std::unique_ptr<DefineBitsTag>(
+                    new DefineBitsTag(in, tag, id)));
+        return;
+    }
+
     if (m.getBitmap(id)) {
         IF_VERBOSE_MALFORMED_SWF(
             log_swferror(_("DEFINEBITS: Duplicate id (%d) for bitmap "
@@ -207,26 +270,7 @@ DefineBitsTag::loader(SWFStream& in, TagType tag, movie_definition& m,
         return;
     }
 
-    std::unique_ptr<image::GnashImage> im;
-
-    switch (tag) {
-        case SWF::DEFINEBITS:
-            im = readDefineBitsJpeg(in, m);
-            break;
-        case SWF::DEFINEBITSJPEG2:
-            im = readDefineBitsJpeg2(in);
-            break;
-        case SWF::DEFINEBITSJPEG3:
-        case SWF::DEFINEBITSJPEG4:
-            im = readDefineBitsJpeg3(in, tag);
-            break;
-        case SWF::DEFINELOSSLESS:
-        case SWF::DEFINELOSSLESS2:
-            im = readLossless(in, tag);
-            break;
-        default:
-            std::abort();
-    }
+    std::unique_ptr<image::GnashImage> im = readBitmap(in, tag, &m);
 
     if (!im.get()) {
         IF_VERBOSE_MALFORMED_SWF(
@@ -235,7 +279,6 @@ DefineBitsTag::loader(SWFStream& in, TagType tag, movie_definition& m,
         return;
     }
 
-    Renderer* renderer = r.renderer();
     if (!renderer) {
         IF_VERBOSE_PARSE(
             log_parse(_("No renderer, not adding bitmap %1%"), id)
@@ -253,6 +296,48 @@ DefineBitsTag::loader(SWFStream& in, TagType tag, movie_definition& m,
 
 namespace {
 
+/// Read the image of a bitmap tag.
+//
+/// @param m    The movie definition holding the JPEG tables, only
+///             needed for DefineBits tags.
+std::unique_ptr<image::GnashImage>
+readBitmap(SWFStream& in, TagType tag, movie_definition* m)
+{
+    // Decoded bitmaps may be in the movie cache. DefineBits data
+    // depends on a previous JPEGTables tag, so it isn't cached.
+    std::string cacheKey;
+    if (tag != SWF::DEFINEBITS) cacheKey = bitmapCacheKey(in, tag);
+
+    std::unique_ptr<image::GnashImage> im;
+    if (!cacheKey.empty()) {
+        im = getCachedBitmap(cacheKey);
+        if (im.get()) return im;
+    }
+
+    switch (tag) {
+        case SWF::DEFINEBITS:
+            assert(m);
+            im = readDefineBitsJpeg(in, *m);
+            break;
+        case SWF::DEFINEBITSJPEG2:
+            im = readDefineBitsJpeg2(in);
+            break;
+        case SWF::DEFINEBITSJPEG3:
+        case SWF::DEFINEBITSJPEG4:
+            im = readDefineBitsJpeg3(in, tag);
+            break;
+        case SWF::DEFINELOSSLESS:
+        case SWF::DEFINELOSSLESS2:
+            im = readLossless(in, tag);
+            break;
+        default:
+            std::abort();
+    }
+
+    if (im.get() && !cacheKey.empty()) cacheBitmap(cacheKey, *im);
+    return im;
+}
+
 // A JPEG image without included tables; those should be in an
 // existing image::JpegInput object stored in the movie.
 std::unique_ptr<image::GnashImage>
@@ -367,29 +452,39 @@ readDefineBitsJpeg3(SWFStream& in, TagType tag)
     return std::unique_ptr<image::GnashImage>();
 #else
 
+    const std::streampos jpeg_position = in.tell();
+
+    // The alpha channel is inflated while the rgb data is decoded, so
+    // that each scanline is written once. Stored tags are in memory
+    // already, otherwise the compressed alpha data is copied.
+    if (!in.seek(alpha_position)) return std::unique_ptr<image::GnashImage>();
+
+    size_t alphaSize = in.get_tag_end_position() - alpha_position;
+    std::vector<std::uint8_t> alphaCopy;
+    const std::uint8_t* alphaData = in.readDirect(alphaSize);
+    if (!alphaData) {
+        alphaCopy.resize(alphaSize);
+        alphaSize = in.read(reinterpret_cast<char*>(alphaCopy.data()),
+                alphaSize);
+        alphaData = alphaCopy.data();
+    }
+    std::unique_ptr<IOChannel> alpha(zlib_adapter::make_inflater(
+                makeMemoryChannel(alphaData, alphaSize)));
+
+    in.seek(jpeg_position);
+
     // Read rgb data.
     std::unique_ptr<IOChannel> ad(StreamAdapter::getFile(in,
                 alpha_position).release());
-    std::unique_ptr<image::ImageRGBA> im = image::Input::readSWFJpeg3(std::move(ad));
-    
-    /// Failure to read the jpeg.
-    if (!im.get()) return std::unique_ptr<image::GnashImage>();
-
-    // Read alpha channel.
-    in.seek(alpha_position);
-
-    const size_t imWidth = im->width();
-    const size_t imHeight = im->height();
-    const size_t bufferLength = imWidth * imHeight;
-
-    std::unique_ptr<std::uint8_t[]> buffer(new std::uint8_t[bufferLength]);
-
-    inflateWrapper(in, buffer.get(), bufferLength);
 
     // TESTING:
     // magical trevor contains this tag
     //  ea8bbad50ccbc52dd734dfc93a7f06a7  6964trev3c.swf
-    image::mergeAlpha(*im, buffer.get(), bufferLength);
+    std::unique_ptr<image::ImageRGBA> im =
+        image::Input::readSWFJpeg3(std::move(ad), alpha.get());
+    
+    /// Failure to read the jpeg.
+    if (!im.get()) return std::unique_ptr<image::GnashImage>();
 
 #endif
     return std::move(im);
@@ -563,6 +658,106 @@ readLossless(SWFStream& in, TagType tag)
 
 }
 
+/// Header of a bitmap in the movie cache
+//
+/// It is followed by the image data.
+struct CachedBitmapHeader
+{
+    char magic[4];
+    std::uint32_t type;
+    std::uint32_t width;
+    std::uint32_t height;
+};
+
+const char cachedBitmapMagic[4] = { 'G', 'B', 'M', '1' };
+
+/// Decoding bitmaps smaller than this isn't worth a cache lookup.
+const size_t minCachedBitmapSize = 16384;
+
+/// Get the key identifying the bitmap tag at the current position.
+//
+/// @return the key, or an empty string if the cache is disabled or the
+///         tag data can't be accessed without copying it.
+std::string
+bitmapCacheKey(SWFStream& in, TagType tag)
+{
+    if (!DiskCache::getDefaultInstance().enabled()) return std::string();
+
+    const unsigned long start = in.tell();
+    const unsigned long size = in.get_tag_end_position() - start;
+    if (size < 16) return std::string();
+
+    const std::uint8_t* data = in.readDirect(size);
+    if (!data) return std::string();
+    in.seek(start);
+
+    std::ostringstream prefix;
+    prefix << "bitmap" << tag;
+    return DiskCache::makeKey(prefix.str(), data, size);
+}
+
+std::unique_ptr<image::GnashImage>
+getCachedBitmap(const std::string& key)
+{
+    std::unique_ptr<image::GnashImage> im;
+
+    DiskCache& cache = DiskCache::getDefaultInstance();
+    std::unique_ptr<IOChannel> file = cache.get(key);
+    if (!file.get()) return im;
+
+    CachedBitmapHeader h;
+    const bool valid = file->read(&h, sizeof h) == sizeof h &&
+        std::equal(h.magic, h.magic + 4, cachedBitmapMagic) &&
+        (h.type == image::TYPE_RGB || h.type == image::TYPE_RGBA) &&
+        h.width && h.height && h.width <= 65535 && h.height <= 65535 &&
+        file->size() == sizeof h + static_cast<size_t>(h.width) * h.height *
+            image::numChannels(static_cast<image::ImageType>(h.type));
+
+    if (!valid) {
+        cache.remove(key);
+        return im;
+    }
+
+    if (h.type == image::TYPE_RGB) {
+        im.reset(new image::ImageRGB(h.width, h.height));
+    }
+    else im.reset(new image::ImageRGBA(h.width, h.height));
+
+    if (file->read(im->begin(), im->size()) !=
+            static_cast<std::streamsize>(im->size())) {
+        im.reset();
+        cache.remove(key);
+    }
+    return im;
+}
+
+void
+cacheBitmap(const std::string& key, const image::GnashImage& im)
+{
+    if (im.size() < minCachedBitmapSize) return;
+
+    // Only plain images can be stored.
+    if (im.location() != image::GNASH_IMAGE_CPU) return;
+
+    DiskCache& cache = DiskCache::getDefaultInstance();
+    std::string temp;
+    std::unique_ptr<IOChannel> file = cache.create(key, temp);
+    if (!file.get()) return;
+
+    CachedBitmapHeader h;
+    std::copy(cachedBitmapMagic, cachedBitmapMagic + 4, h.magic);
+    h.type = im.type();
+    h.width = im.width();
+    h.height = im.height();
+
+    const bool ok = file->write(&h, sizeof h) == sizeof h &&
+        file->write(im.begin(), im.size()) ==
+            static_cast<std::streamsize>(im.size()) && !file->bad();
+
+    file.reset();
+    cache.commit(key, temp, ok);
+}
+
 #ifdef HAVE_ZLIB_H
 // Wrapper function -- uses Zlib to uncompress in_bytes worth
 // of data from the input file into buffer_bytes worth of data
@@ -20,6 +20,10 @@
 #ifndef GNASH_SWF_DEFINEBITSTAG_H
 #define GNASH_SWF_DEFINEBITSTAG_H
 
+#include <memory>
+#include <cstdint>
+#include <boost/noncopyable.hpp>
+
 #include "SWF.h" 
 
 // Forward declarations
@@ -27,6 +31,12 @@ namespace gnash {
     class movie_definition;
     class RunResources;
     class SWFStream;
+    namespace image {
+        class GnashImage;
+    }
+    namespace SWF {
+        class StoredTag;
+    }
 }
 
 namespace gnash {
@@ -35,12 +45,37 @@ namespace SWF {
 void jpeg_tables_loader(SWFStream&, TagType, movie_definition&,
 		const RunResources&);
 
-class DefineBitsTag
+/// The undecoded data of a bitmap tag.
+//
+/// DefineBits tags depend on the JPEGTables tag, so they are decoded
+/// while parsing. Other bitmap tags are kept in the movie_definition
+/// and decoded when the bitmap is first used, possibly several times
+/// if the decoded bitmap is dropped (see movie_definition::addBitmapTag).
+class DefineBitsTag : boost::noncopyable
 {
 public:
     static void loader(SWFStream&, TagType, movie_definition&,
             const RunResources&);
 
+    ~DefineBitsTag();
+
+    /// Decode the bitmap.
+    //
+    /// @return the image, or 0 if the tag data is not valid.
+    std::unique_ptr<image::GnashImage> decode() const;
+
+    /// The size of the tag data in bytes.
+    size_t size() const;
+
+private:
+
+    /// Copy the rest of the tag being parsed.
+    DefineBitsTag(SWFStream& in, TagType tag, std::uint16_t id);
+
+    const TagType _tag;
+
+    const std::unique_ptr<const StoredTag> _data;
+
 };
 
 } // namespace SWF
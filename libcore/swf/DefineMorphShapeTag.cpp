@@ -38,6 +38,7 @@
 #include "Renderer.h"
 #include "FillStyle.h"
 #include "Transform.h"
+#include "DeferredDefinitionTag.h"
 
 namespace gnash {
 namespace SWF {
@@ -53,6 +54,14 @@ DefineMorphShapeTag::loader(SWFStream& in, TagType tag, movie_definition& md,
             log_parse("DefineMorphShapeTag: id = %d", id);
     );
 
+    const DeferredDefinitionTag::Parser parser = [] (SWFStream& in,
+            TagType tag, movie_definition& md, const RunResources& r,
+            std::uint16_t id) -> DefinitionTag* {
+        return new DefineMorphShapeTag(in, tag, md, r, id);
+    };
+
+    if (DeferredDefinitionTag::defer(in, tag, md, r, id, parser)) return;
+
     DefineMorphShapeTag* morph = new DefineMorphShapeTag(in, tag, md, r, id);
     md.addDisplayObject(id, morph);
 }
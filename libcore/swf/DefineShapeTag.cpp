@@ -31,6 +31,7 @@
 #include "Renderer.h"
 #include "Global_as.h"
 #include "Transform.h"
+#include "DeferredDefinitionTag.h"
 
 #include <algorithm>
 
@@ -58,6 +59,14 @@ DefineShapeTag::loader(SWFStream& in, TagType tag, movie_definition& m,
         log_parse(_("DefineShapeTag(%s): id = %d"), tag, id);
     );
 
+    const DeferredDefinitionTag::Parser parser = [] (SWFStream& in,
+            TagType tag, movie_definition& m, const RunResources& r,
+            std::uint16_t id) -> DefinitionTag* {
+        return new DefineShapeTag(in, tag, m, r, id);
+    };
+
+    if (DeferredDefinitionTag::defer(in, tag, m, r, id, parser)) return;
+
     DefineShapeTag* ch = new DefineShapeTag(in, tag, m, r, id);
     m.addDisplayObject(id, ch);
 
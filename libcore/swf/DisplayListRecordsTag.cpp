@@ -0,0 +1,146 @@
+// DisplayListRecordsTag.cpp: compact runs of DisplayList tags, for Gnash.
+//
+//   Copyright (C) 2012 Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#include "DisplayListRecordsTag.h"
+
+#include "PlaceObject2Tag.h"
+#include "RemoveObjectTag.h"
+#include "MovieClip.h"
+#include "DisplayList.h"
+
+namespace gnash {
+namespace SWF {
+
+namespace {
+
+/// Executes the stored tags on a DisplayList.
+class Executor
+{
+public:
+
+    Executor(MovieClip& m, DisplayList& dlist)
+        :
+        _m(m),
+        _dlist(dlist)
+    {}
+
+    void remove(int depth) {
+        _m.set_invalidated();
+        _dlist.removeDisplayObject(depth);
+    }
+
+    void move(int depth, const SWFCxForm* cxform, const SWFMatrix* matrix,
+            const std::uint16_t* ratio, const Filters* filters) {
+        std::uint16_t r = ratio ? *ratio : 0;
+        _dlist.moveDisplayObject(depth, cxform, matrix, ratio ? &r : nullptr);
+
+        if (filters) {
+            DisplayObject* ch = _dlist.getDisplayObjectAtDepth(depth);
+            if (ch) ch->setFilters(*filters);
+        }
+    }
+
+private:
+    MovieClip& _m;
+    DisplayList& _dlist;
+};
+
+}
+
+DisplayListRecordsTag::DisplayListRecordsTag()
+    :
+    DisplayListTag(0)
+{
+}
+
+void
+DisplayListRecordsTag::addTag(movie_definition::PlayList& playlist,
+        boost::intrusive_ptr<DisplayListTag> tag)
+{
+    if (!playlist.empty()) {
+        DisplayListRecordsTag* last =
+            dynamic_cast<DisplayListRecordsTag*>(playlist.back().get());
+        if (last && last->add(*tag)) return;
+    }
+
+    boost::intrusive_ptr<DisplayListRecordsTag> records(
+            new DisplayListRecordsTag);
+    if (records->add(*tag)) playlist.push_back(records);
+    else playlist.push_back(tag);
+}
+
+bool
+DisplayListRecordsTag::add(const DisplayListTag& tag)
+{
+    if (dynamic_cast<const RemoveObjectTag*>(&tag)) {
+        _depths.push_back(tag.getDepth());
+        _flags.push_back(REMOVE);
+        return true;
+    }
+
+    const PlaceObject2Tag* place = dynamic_cast<const PlaceObject2Tag*>(&tag);
+    if (!place) return false;
+
+    switch (place->getPlaceType()) {
+
+        case PlaceObject2Tag::REMOVE:
+            _depths.push_back(tag.getDepth());
+            _flags.push_back(REMOVE);
+            return true;
+
+        // Names, clip depths, event handlers and other properties except
+        // filters are ignored for MOVE, see
+        // MovieClip::move_display_object().
+        case PlaceObject2Tag::MOVE:
+        {
+            std::uint8_t flags = 0;
+            if (place->hasCxform()) {
+                flags |= HAS_CXFORM;
+                _cxforms.push_back(place->getCxform());
+            }
+            if (place->hasMatrix()) {
+                flags |= HAS_MATRIX;
+                _matrices.push_back(place->getMatrix());
+            }
+            if (place->hasRatio()) {
+                flags |= HAS_RATIO;
+                _ratios.push_back(place->getRatio());
+            }
+            if (place->hasFilters()) {
+                flags |= HAS_FILTERS;
+                _filters.push_back(place->getFilters());
+            }
+            _depths.push_back(tag.getDepth());
+            _flags.push_back(flags);
+            return true;
+        }
+
+        default:
+            return false;
+    }
+}
+
+void
+DisplayListRecordsTag::executeState(MovieClip* m, DisplayList& dlist) const
+{
+    Executor e(*m, dlist);
+    visit(e);
+}
+
+} // namespace SWF
+} // namespace gnash
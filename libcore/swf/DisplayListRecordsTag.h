@@ -0,0 +1,136 @@
+// DisplayListRecordsTag.h: compact runs of DisplayList tags, for Gnash.
+//
+//   Copyright (C) 2012 Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifndef GNASH_SWF_DISPLAYLISTRECORDSTAG_H
+#define GNASH_SWF_DISPLAYLISTRECORDSTAG_H
+
+#include <vector>
+#include <cstdint>
+#include <boost/intrusive_ptr.hpp>
+
+#include "DisplayListTag.h" // for inheritance
+#include "movie_definition.h" // for PlayList
+#include "SWFMatrix.h"
+#include "SWFCxForm.h"
+#include "filter_factory.h" // for Filters
+
+// Forward declarations
+namespace gnash {
+    class MovieClip;
+    class DisplayList;
+}
+
+namespace gnash {
+namespace SWF {
+
+/// Consecutive MOVE and REMOVE tags of a frame.
+//
+/// Long animations consist mostly of PlaceObject tags moving existing
+/// DisplayObjects. Only their depth, the transformation and the filters
+/// they change are used, so they are stored in arrays here instead of
+/// one PlaceObject2Tag each. RemoveObject tags are stored too, so that
+/// runs are not interrupted by them.
+///
+/// The depth of this tag is meaningless.
+class DisplayListRecordsTag : public DisplayListTag
+{
+public:
+
+    /// Add a DisplayList tag to a frame's playlist.
+    //
+    /// MOVE and REMOVE tags are appended to a DisplayListRecordsTag at the
+    /// end of the playlist, which is added if needed. Other tags are
+    /// added as they are.
+    static void addTag(movie_definition::PlayList& playlist,
+            boost::intrusive_ptr<DisplayListTag> tag);
+
+    /// Move or remove DisplayObjects as the stored tags would.
+    void executeState(MovieClip* m, DisplayList& dlist) const;
+
+    /// Call a visitor for each stored tag, in order.
+    //
+    /// The visitor must have the following functions:
+    ///     void remove(int depth);
+    ///     void move(int depth, const SWFCxForm* cxform,
+    ///             const SWFMatrix* matrix, const std::uint16_t* ratio,
+    ///             const Filters* filters);
+    /// where the pointers are null for properties not changed.
+    template<typename Visitor>
+    void visit(Visitor& v) const;
+
+    /// The number of stored tags.
+    size_t size() const {
+        return _depths.size();
+    }
+
+private:
+
+    DisplayListRecordsTag();
+
+    /// Store a tag if possible.
+    //
+    /// @return false if the tag can't be stored here.
+    bool add(const DisplayListTag& tag);
+
+    enum Flags
+    {
+        REMOVE = 1 << 0,
+        HAS_CXFORM = 1 << 1,
+        HAS_MATRIX = 1 << 2,
+        HAS_RATIO = 1 << 3,
+        HAS_FILTERS = 1 << 4
+    };
+
+    /// The depth and flags of each tag.
+    std::vector<std::int32_t> _depths;
+    std::vector<std::uint8_t> _flags;
+
+    /// The properties set by the tags that have them, in order.
+    std::vector<SWFCxForm> _cxforms;
+    std::vector<SWFMatrix> _matrices;
+    std::vector<std::uint16_t> _ratios;
+    std::vector<Filters> _filters;
+};
+
+template<typename Visitor>
+void
+DisplayListRecordsTag::visit(Visitor& v) const
+{
+    std::vector<SWFCxForm>::const_iterator cxform = _cxforms.begin();
+    std::vector<SWFMatrix>::const_iterator matrix = _matrices.begin();
+    std::vector<std::uint16_t>::const_iterator ratio = _ratios.begin();
+    std::vector<Filters>::const_iterator filters = _filters.begin();
+
+    for (size_t i = 0, e = _depths.size(); i < e; ++i) {
+        const std::uint8_t flags = _flags[i];
+        if (flags & REMOVE) {
+            v.remove(_depths[i]);
+            continue;
+        }
+        v.move(_depths[i],
+                flags & HAS_CXFORM ? &*cxform++ : nullptr,
+                flags & HAS_MATRIX ? &*matrix++ : nullptr,
+                flags & HAS_RATIO ? &*ratio++ : nullptr,
+                flags & HAS_FILTERS ? &*filters++ : nullptr);
+    }
+}
+
+} // namespace SWF
+} // namespace gnash
+
+#endif
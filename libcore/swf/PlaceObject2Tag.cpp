@@ -51,6 +51,7 @@ PlaceObject2Tag::PlaceObject2Tag(const movie_definition& def)
     _ratio(0),
     m_clip_depth(0),
     _blendMode(0),
+    _bitmapCaching(0),
     _movie_def(def)
 {
 }
@@ -387,10 +388,7 @@ PlaceObject2Tag::readPlaceObject3(SWFStream& in)
     }
 
     if (hasFilters()) {
-        Filters v; // TODO: Attach the filters to the display object.
-        filter_factory::read(in, true, &v);
-	    // at time of writing no renderer supports bitmap filters
-	    LOG_ONCE( log_unimpl("Bitmap filters") );
+        filter_factory::read(in, true, &_filters);
     }
 
     if (hasBlendMode()) {
@@ -399,7 +397,6 @@ PlaceObject2Tag::readPlaceObject3(SWFStream& in)
         LOG_ONCE(log_unimpl("Blend mode in PlaceObject tag"));
     }
 
-    std::uint8_t bitmask = 0;
     if (hasBitmapCaching()) {
         // cacheAsBitmap is a boolean value, so the flag itself ought to be
         // enough. Alexis' SWF reference is unsure about this, but suggests
@@ -410,11 +407,8 @@ PlaceObject2Tag::readPlaceObject3(SWFStream& in)
         // with both PlaceActions and bitmap caching, and the reserved bytes
         // of the PlaceActions (see readPlaceActions) are not 0 if this byte
         // isn't read.
-        // TODO: set object property
         in.ensureBytes(1);
-        bitmask = in.read_u8();
-	    LOG_ONCE(log_unimpl("Bitmap caching"));
-        UNUSED(bitmask);
+        _bitmapCaching = in.read_u8();
     }
 
     if (hasClipActions()) {
@@ -491,7 +485,7 @@ PlaceObject2Tag::loader(SWFStream& in, TagType tag, movie_definition& m,
     boost::intrusive_ptr<PlaceObject2Tag> ch(new PlaceObject2Tag(m));
     ch->read(in, tag);
 
-    m.addControlTag(ch);
+    m.addDisplayListTag(ch);
 }
 
 } // namespace gnash::SWF
@@ -26,6 +26,7 @@
 #include "SWF.h" // for TagType definition
 #include "SWFMatrix.h" // for composition
 #include "SWFCxForm.h" // for composition 
+#include "filter_factory.h" // for Filters
 
 // Forward declarations
 namespace gnash {
@@ -102,6 +103,15 @@ public:
     static void loader(SWFStream& in, TagType tag, movie_definition& m,
             const RunResources& r);
 
+    /// NOTE: getPlaceType() is dependent on the enum values.
+    enum PlaceType
+    {
+        REMOVE  = 0, 
+        MOVE    = 1,
+        PLACE   = 2,
+        REPLACE = 3
+    };
+
     int getPlaceType() const { 
         return m_has_flags2 & (HAS_CHARACTER_MASK | MOVE_MASK);
     } 
@@ -148,6 +158,20 @@ public:
         return _blendMode;
     }
 
+    /// Whether the DisplayObject should be cached as a bitmap.
+    //
+    /// Only meaningful if hasBitmapCaching() is true.
+    bool getBitmapCaching() const {
+        return _bitmapCaching;
+    }
+
+    /// The filters to apply to the DisplayObject.
+    //
+    /// Only meaningful if hasFilters() is true.
+    const Filters& getFilters() const {
+        return _filters;
+    }
+
 private:
 
     // read SWF::PLACEOBJECT 
@@ -173,14 +197,9 @@ private:
     
     std::uint8_t _blendMode;
 
-    /// NOTE: getPlaceType() is dependent on the enum values.
-    enum PlaceType
-    {
-        REMOVE  = 0, 
-        MOVE    = 1,
-        PLACE   = 2,
-        REPLACE = 3
-    };
+    std::uint8_t _bitmapCaching;
+
+    Filters _filters;
 
     enum has_flags2_mask_e
     {
@@ -72,7 +72,7 @@ RemoveObjectTag::loader(SWFStream& in, TagType tag, movie_definition& m,
     );
 
     // Ownership transferred to movie_definition
-    m.addControlTag(t);
+    m.addDisplayListTag(t);
 }
 
 } // namespace gnash::SWF
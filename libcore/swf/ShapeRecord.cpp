@@ -20,6 +20,7 @@
 #include "ShapeRecord.h"
 
 #include <vector>
+#include <boost/variant.hpp>
 
 #include "TypesParser.h"
 #include "utility.h"
@@ -29,6 +30,7 @@
 #include "FillStyle.h"
 #include "Geometry.h"
 #include "GnashNumeric.h"
+#include "Checksum.h"
 #include "log.h"
 
 namespace gnash {
@@ -69,15 +71,101 @@ private:
     const double _ratio;
 };
 
+/// Add a matrix to a checksum.
+inline void
+addMatrix(Checksum& sum, const SWFMatrix& m)
+{
+    sum.add(m.a());
+    sum.add(m.b());
+    sum.add(m.c());
+    sum.add(m.d());
+    sum.add(m.tx());
+    sum.add(m.ty());
+}
+
+/// Add a fill style to a checksum.
+//
+/// Only the bitmap of a BitmapFill is left out, as its pixels may change
+/// without the shape changing.
+class AddFill : public boost::static_visitor<>
+{
+public:
+    explicit AddFill(Checksum& sum) : _sum(sum) {}
+
+    void operator()(const BitmapFill& f) const {
+        _sum.add(0);
+        _sum.add(f.type() << 4 | f.smoothingPolicy());
+        addMatrix(_sum, f.matrix());
+    }
+
+    void operator()(const SolidFill& f) const {
+        _sum.add(1);
+        _sum.add(f.color().toRGBA());
+    }
+
+    void operator()(const GradientFill& f) const {
+        _sum.add(2);
+        _sum.add(f.type() << 4 | f.spreadMode << 2 | f.interpolation);
+        addMatrix(_sum, f.matrix());
+        _sum.add(static_cast<std::int32_t>(f.focalPoint() * 65536));
+        for (const GradientRecord& r : f.getRecords()) {
+            _sum.add(r.ratio);
+            _sum.add(r.color.toRGBA());
+        }
+    }
+
+private:
+    Checksum& _sum;
+};
+
+/// Continue a hash with everything about a subshape that affects its
+/// drawing.
+std::uint64_t
+addToHash(std::uint64_t hash, const Subshape& sub)
+{
+    Checksum sum(hash);
+    sum.add(sub.fillStyles().size());
+    for (const FillStyle& style : sub.fillStyles()) {
+        boost::apply_visitor(AddFill(sum), style.fill);
+    }
+    sum.add(sub.lineStyles().size());
+    for (const LineStyle& ls : sub.lineStyles()) {
+        sum.add(ls.getThickness());
+        sum.add(ls.get_color().toRGBA());
+        sum.add(ls.startCapStyle() << 12 | ls.endCapStyle() << 8 |
+                ls.joinStyle() << 4 | ls.scaleThicknessVertically() << 3 |
+                ls.scaleThicknessHorizontally() << 2 |
+                ls.doPixelHinting() << 1 | ls.noClose());
+        sum.add(static_cast<std::int32_t>(ls.miterLimitFactor() * 65536));
+    }
+    sum.add(sub.paths().size());
+    for (const Path& p : sub.paths()) {
+        sum.add(p.ap);
+        sum.add(p.m_fill0);
+        sum.add(p.m_fill1);
+        sum.add(p.m_line);
+        sum.add(p.m_edges.size());
+        for (const Edge& e : p.m_edges) {
+            sum.add(e.cp);
+            sum.add(e.ap);
+        }
+    }
+    return sum.value();
+}
+
 } // anonymous namespace
 
 ShapeRecord::ShapeRecord(SWFStream& in, SWF::TagType tag, movie_definition& m,
         const RunResources& r)
+    :
+    _contentHash(Checksum::basis)
 {
     read(in, tag, m, r);
 }
 
 ShapeRecord::ShapeRecord()
+    :
+    _contentHash(Checksum::basis)
 {
 }
 
@@ -90,6 +178,23 @@ ShapeRecord::clear()
 {
     _bounds.set_null();
     _subshapes.clear();
+    _contentHash = Checksum::basis;
+}
+
+void
+ShapeRecord::addSubshape(const Subshape& subshape)
+{
+    _subshapes.push_back(subshape);
+    _contentHash = addToHash(_contentHash, subshape);
+}
+
+void
+ShapeRecord::rehash()
+{
+    _contentHash = Checksum::basis;
+    for (const Subshape& sub : _subshapes) {
+        _contentHash = addToHash(_contentHash, sub);
+    }
 }
 
 void
@@ -197,6 +302,8 @@ ShapeRecord::setLerp(const ShapeRecord& aa, const ShapeRecord& bb,
             }
         }
     }
+
+    rehash();
 }
 
 unsigned
@@ -296,6 +403,7 @@ ShapeRecord::read(SWFStream& in, SWF::TagType tag, movie_definition& m,
                 tag == SWF::DEFINEFONT3) {
             log_debug("Skipping glyph read, being fill and line bits zero. "
                     "SWF tag is %d.", tag);
+            rehash();
             return;
         }
     }
@@ -532,6 +640,8 @@ ShapeRecord::read(SWFStream& in, SWF::TagType tag, movie_definition& m,
         }
     }
 #endif
+
+    rehash();
 }
 
 namespace {
@@ -26,6 +26,7 @@
 #include "SWFRect.h"
 
 #include <vector>
+#include <cstdint>
 
 
 namespace gnash {
@@ -159,14 +160,22 @@ public:
     	return _subshapes;
     }
 
-    void addSubshape(const Subshape& subshape) {
-    	_subshapes.push_back(subshape);
-    }
+    void addSubshape(const Subshape& subshape);
 
     const SWFRect& getBounds() const {
         return _bounds;
     }
 
+    /// A hash of the styles and paths of all subshapes.
+    //
+    /// It is computed whenever the shape changes, so that renderers can
+    /// recognize shapes drawn before without reading all their edges.
+    /// Copies of a shape have the same hash, but so may, rarely, other
+    /// shapes.
+    std::uint64_t contentHash() const {
+        return _contentHash;
+    }
+
     /// Set to the lerp of two ShapeRecords.
     //
     /// Used in shape morphing.
@@ -195,6 +204,9 @@ private:
 
     unsigned readStyleChange(SWFStream& in, size_t num_fill_bits, size_t numStyles);
 
+    /// Compute the hash of all subshapes again.
+    void rehash();
+
     /// Shape record flags for use in parsing.
     enum ShapeRecordFlags {
         SHAPE_END = 0x00,
@@ -207,6 +219,7 @@ private:
 
     SWFRect _bounds;
     Subshapes _subshapes;
+    std::uint64_t _contentHash;
 };
 
 std::ostream& operator<<(std::ostream& o, const ShapeRecord& sh);
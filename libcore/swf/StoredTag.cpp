@@ -0,0 +1,80 @@
+// StoredTag.cpp: copies of SWF tags parsed later, for Gnash.
+//
+//   Copyright (C) 2012 Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#include "StoredTag.h"
+
+#include <sstream>
+#include <algorithm>
+
+#include "IOChannel.h"
+#include "tu_file.h"
+#include "GnashException.h"
+
+namespace gnash {
+namespace SWF {
+
+namespace {
+
+/// A long tag header and the id.
+const size_t headerSize = 8;
+
+}
+
+StoredTag::StoredTag(SWFStream& in, TagType tag, std::uint16_t id)
+{
+    const size_t size = in.get_tag_end_position() - in.tell();
+    const std::uint32_t length = size + 2;
+    const std::uint16_t code = (tag << 6) | 0x3f;
+
+    _data.resize(headerSize + size);
+    _data[0] = code & 0xff;
+    _data[1] = code >> 8;
+    for (size_t i = 0; i < 4; ++i) _data[2 + i] = length >> (8 * i);
+    _data[6] = id & 0xff;
+    _data[7] = id >> 8;
+
+    if (!size) return;
+
+    const std::uint8_t* data = in.readDirect(size);
+    if (data) {
+        std::copy(data, data + size, _data.begin() + headerSize);
+    }
+    else if (in.read(reinterpret_cast<char*>(&_data[headerSize]), size)
+            != size) {
+        std::ostringstream ss;
+        ss << "Could not read " << size << " bytes of tag " << tag;
+        throw ParserException(ss.str());
+    }
+}
+
+StoredTag::Reader::Reader(const StoredTag& tag)
+    :
+    _channel(makeMemoryChannel(tag._data.data(), tag._data.size())),
+    _stream(_channel.get())
+{
+    _stream.open_tag();
+    _stream.ensureBytes(2);
+    _stream.read_u16();
+}
+
+StoredTag::Reader::~Reader()
+{
+}
+
+} // namespace SWF
+} // namespace gnash
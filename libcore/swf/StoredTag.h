@@ -0,0 +1,93 @@
+// StoredTag.h: copies of SWF tags parsed later, for Gnash.
+//
+//   Copyright (C) 2012 Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifndef GNASH_SWF_STOREDTAG_H
+#define GNASH_SWF_STOREDTAG_H
+
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <boost/noncopyable.hpp>
+
+#include "SWF.h"
+#include "SWFStream.h"
+
+// Forward declarations
+namespace gnash {
+    class IOChannel;
+}
+
+namespace gnash {
+namespace SWF {
+
+/// A copy of a tag with an id, to be parsed later.
+//
+/// The copy has a tag header, so that it is parsed from a SWFStream
+/// like the original tag.
+class StoredTag : boost::noncopyable
+{
+public:
+
+    /// Copy the rest of the tag being parsed.
+    //
+    /// Throws a ParserException if the tag can't be read.
+    ///
+    /// @param in   The stream, positioned after the id of the tag.
+    /// @param tag  The type of the tag.
+    /// @param id   The id read from the tag.
+    StoredTag(SWFStream& in, TagType tag, std::uint16_t id);
+
+    /// The size of the copy in bytes.
+    size_t size() const {
+        return _data.size();
+    }
+
+    /// A SWFStream reading a StoredTag.
+    //
+    /// The tag is opened and the stream positioned after its id, as
+    /// when the tag was copied.
+    class Reader : boost::noncopyable
+    {
+    public:
+
+        /// Open the tag. Throws a ParserException on failure.
+        explicit Reader(const StoredTag& tag);
+
+        ~Reader();
+
+        SWFStream& stream() {
+            return _stream;
+        }
+
+    private:
+
+        const std::unique_ptr<IOChannel> _channel;
+
+        SWFStream _stream;
+    };
+
+private:
+
+    std::vector<std::uint8_t> _data;
+
+};
+
+} // namespace SWF
+} // namespace gnash
+
+#endif
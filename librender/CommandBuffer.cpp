@@ -0,0 +1,325 @@
+// CommandBuffer.cpp: a compact record of the drawing of a frame, for Gnash.
+//
+//   Copyright (C) 2012 Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#include "CommandBuffer.h"
+
+#include <unordered_map>
+#include <algorithm>
+#include <boost/variant.hpp>
+
+#include "swf/ShapeRecord.h"
+#include "FillStyle.h"
+#include "Transform.h"
+#include "SWFRect.h"
+#include "RGBA.h"
+#include "Checksum.h"
+
+namespace gnash {
+
+namespace {
+
+/// Whether the fills of a shape may change without its ShapeRecord
+/// changing, as the pixels of bitmaps may.
+bool
+changingFills(const SWF::ShapeRecord& shape)
+{
+    for (const SWF::Subshape& sub : shape.subshapes()) {
+        for (const FillStyle& style : sub.fillStyles()) {
+            if (boost::get<BitmapFill>(&style.fill)) return true;
+        }
+    }
+    return false;
+}
+
+/// The bounds of some points.
+SWFRect
+pointBounds(const std::vector<point>& points)
+{
+    SWFRect bounds;
+    for (const point& p : points) bounds.expand_to_point(p.x, p.y);
+    return bounds;
+}
+
+/// Whether two commands draw the same thing with the same transformation.
+inline bool
+equal(const CommandBuffer::Command& a, const CommandBuffer::Command& b)
+{
+    return a.kind == b.kind && a.id == b.id && a.shape == b.shape &&
+        a.color == b.color && a.matrix == b.matrix && a.cxform == b.cxform;
+}
+
+/// Whether two commands draw the same.
+inline bool
+same(const CommandBuffer::Command& a, const CommandBuffer::Command& b)
+{
+    return !a.changing && !b.changing && equal(a, b);
+}
+
+/// A checksum of all that equal() compares.
+std::uint64_t
+key(const CommandBuffer::Command& c)
+{
+    const std::uint64_t shape = reinterpret_cast<std::uintptr_t>(c.shape);
+
+    Checksum sum;
+    sum.add(c.kind);
+    sum.add(c.id);
+    sum.add(c.id >> 32);
+    sum.add(shape);
+    sum.add(shape >> 32);
+    sum.add(c.color);
+    sum.add(c.matrix.a());
+    sum.add(c.matrix.b());
+    sum.add(c.matrix.c());
+    sum.add(c.matrix.d());
+    sum.add(c.matrix.tx());
+    sum.add(c.matrix.ty());
+    sum.add(c.cxform.ra << 16 | (c.cxform.ga & 0xffff));
+    sum.add(c.cxform.ba << 16 | (c.cxform.aa & 0xffff));
+    sum.add(c.cxform.rb << 16 | (c.cxform.gb & 0xffff));
+    sum.add(c.cxform.bb << 16 | (c.cxform.ab & 0xffff));
+    return sum.value();
+}
+
+typedef std::vector<const CommandBuffer::Command*> Commands;
+
+struct CommandHash
+{
+    size_t operator()(const CommandBuffer::Command* c) const {
+        return key(*c);
+    }
+};
+
+struct CommandEqual
+{
+    bool operator()(const CommandBuffer::Command* a,
+            const CommandBuffer::Command* b) const {
+        return equal(*a, *b);
+    }
+};
+
+/// A number of each command, counting equal ones together.
+typedef std::unordered_map<const CommandBuffer::Command*, size_t,
+        CommandHash, CommandEqual> Counts;
+
+/// The commands drawing to a region of the stage.
+Commands
+drawingTo(const CommandBuffer& buffer, const InvalidatedRanges& region)
+{
+    Commands found;
+    for (const CommandBuffer::Command& c : buffer) {
+        if (region.intersects(c.bounds)) found.push_back(&c);
+    }
+    return found;
+}
+
+} // anonymous namespace
+
+CommandBuffer::CommandBuffer()
+    :
+    _complete(false)
+{
+}
+
+void
+CommandBuffer::addShape(const SWF::ShapeRecord& shape,
+        const Transform& xform)
+{
+    add(SHAPE, shape.contentHash(), xform.matrix, xform.colorTransform,
+            shape.getBounds(), changingFills(shape));
+    _commands.back().shape = &shape;
+}
+
+void
+CommandBuffer::addGlyph(const SWF::ShapeRecord& rec, const rgba& color,
+        const SWFMatrix& mat)
+{
+    add(GLYPH, rec.contentHash(), mat, SWFCxForm(), rec.getBounds(),
+            changingFills(rec));
+    _commands.back().shape = &rec;
+    _commands.back().color = color.toRGBA();
+}
+
+void
+CommandBuffer::addLine(const std::vector<point>& coords, const rgba& color,
+        const SWFMatrix& mat)
+{
+    Checksum sum;
+    for (const point& p : coords) sum.add(p);
+    sum.add(color.toRGBA());
+    add(LINE, sum.value(), mat, SWFCxForm(), pointBounds(coords), false);
+}
+
+void
+CommandBuffer::addPolygon(const std::vector<point>& corners,
+        const rgba& fill, const rgba& outline, const SWFMatrix& mat,
+        bool masked)
+{
+    Checksum sum;
+    for (const point& p : corners) sum.add(p);
+    sum.add(fill.toRGBA());
+    sum.add(outline.toRGBA());
+    sum.add(masked);
+    add(POLYGON, sum.value(), mat, SWFCxForm(), pointBounds(corners), false);
+}
+
+void
+CommandBuffer::addVideo(const Transform& xform, const SWFRect& bounds)
+{
+    add(VIDEO, 0, xform.matrix, xform.colorTransform, bounds, true);
+}
+
+void
+CommandBuffer::addMask(Kind kind)
+{
+    SWFRect world;
+    world.set_world();
+    add(kind, 0, SWFMatrix(), SWFCxForm(), world, false);
+}
+
+void
+CommandBuffer::add(Kind kind, std::uint64_t id, const SWFMatrix& mat,
+        const SWFCxForm& cx, const SWFRect& bounds, bool changing)
+{
+    SWFRect stage;
+    if (bounds.is_world()) stage.set_world();
+    else stage.expand_to_transformed_rect(mat, bounds);
+
+    const Command c = { kind, id, nullptr, 0, mat, cx, stage.getRange(),
+        changing };
+    _commands.push_back(c);
+}
+
+void
+CommandBuffer::damage(const CommandBuffer& previous,
+        const InvalidatedRanges& region, InvalidatedRanges& damage) const
+{
+    if (region.isNull()) return;
+    if (!previous.complete()) {
+        damage.add(region);
+        return;
+    }
+
+    const Commands before = drawingTo(previous, region);
+    const Commands after = drawingTo(*this, region);
+
+    // Most frames change few commands, so skip those the frames start and
+    // end with.
+    size_t first = 0;
+    while (first < before.size() && first < after.size() &&
+            same(*before[first], *after[first])) {
+        ++first;
+    }
+    size_t endBefore = before.size();
+    size_t endAfter = after.size();
+    while (endBefore > first && endAfter > first &&
+            same(*before[endBefore - 1], *after[endAfter - 1])) {
+        --endBefore;
+        --endAfter;
+    }
+
+    // Commands in between that are in both frames need not be drawn
+    // again, unless their order changed.
+    Counts unmatched;
+    for (size_t i = first; i < endBefore; ++i) {
+        if (!before[i]->changing) ++unmatched[before[i]];
+    }
+
+    InvalidatedRanges found;
+    found.inheritConfig(damage);
+
+    Counts matched;
+    Commands orderAfter;
+    for (size_t i = first; i < endAfter; ++i) {
+        const Command* c = after[i];
+        if (!c->changing && unmatched[c]) {
+            --unmatched[c];
+            ++matched[c];
+            orderAfter.push_back(c);
+        }
+        else found.add(c->bounds);
+    }
+
+    Commands orderBefore;
+    for (size_t i = first; i < endBefore; ++i) {
+        const Command* c = before[i];
+        if (!c->changing && matched[c]) {
+            --matched[c];
+            orderBefore.push_back(c);
+        }
+        else found.add(c->bounds);
+    }
+
+    // Both hold the same commands, so they only differ in their order.
+    if (!std::equal(orderBefore.begin(), orderBefore.end(),
+                orderAfter.begin(), CommandEqual())) {
+        for (size_t i = first; i < endBefore; ++i) {
+            found.add(before[i]->bounds);
+        }
+        for (size_t i = first; i < endAfter; ++i) {
+            found.add(after[i]->bounds);
+        }
+    }
+
+    found.intersect(region);
+    damage.add(found);
+}
+
+void
+CommandBuffer::retain(const CommandBuffer& previous,
+        const InvalidatedRanges& region)
+{
+    if (region.isWorld()) {
+        _complete = true;
+        return;
+    }
+
+    // The kept commands go before the frame's, although they may have
+    // been drawn after them. Where they overlap, their order is unknown,
+    // so such kept commands are always compared as changed.
+    InvalidatedRanges drawn;
+    for (const Command& c : _commands) {
+        if (!c.bounds.isWorld()) drawn.add(c.bounds);
+    }
+
+    std::vector<Command> commands;
+    for (const Command& c : previous) {
+        if (c.bounds.isWorld() || region.intersects(c.bounds)) continue;
+        commands.push_back(c);
+        if (drawn.intersects(c.bounds)) commands.back().changing = true;
+    }
+    commands.insert(commands.end(), _commands.begin(), _commands.end());
+    _commands.swap(commands);
+    _complete = previous.complete();
+}
+
+void
+CommandBuffer::clear()
+{
+    _commands.clear();
+    _complete = false;
+}
+
+void
+CommandBuffer::swap(CommandBuffer& other)
+{
+    _commands.swap(other._commands);
+    std::swap(_complete, other._complete);
+}
+
+} // namespace gnash
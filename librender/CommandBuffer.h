@@ -0,0 +1,180 @@
+// CommandBuffer.h: a compact record of the drawing of a frame, for Gnash.
+//
+//   Copyright (C) 2012 Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifndef GNASH_COMMANDBUFFER_H
+#define GNASH_COMMANDBUFFER_H
+
+#include <vector>
+#include <cstdint>
+
+#include "SWFMatrix.h"
+#include "SWFCxForm.h"
+#include "Range2d.h"
+#include "snappingrange.h"
+#include "Point2d.h"
+#include "dsodefs.h" // for DSOEXPORT
+
+namespace gnash {
+    class Transform;
+    class SWFRect;
+    class rgba;
+    namespace SWF {
+        class ShapeRecord;
+    }
+}
+
+namespace gnash {
+
+/// A compact record of the drawing of a frame.
+//
+/// Each drawing command is kept as what it draws, identified by a checksum
+/// of the shape, glyph or points, with its matrix, color transform and
+/// bounds on the stage. Shapes and glyphs also keep the address of their
+/// ShapeRecord, so that different shapes with the same checksum are never
+/// confused. Comparing the records of two frames finds the parts of the
+/// stage they draw differently, so that only those need to be drawn again.
+///
+/// A frame is normally drawn only where the stage was invalidated, so its
+/// commands are merged with those of the previous frame elsewhere (see
+/// retain()). Once a frame has been recorded over the whole stage, the
+/// buffer is complete: it describes the whole stage.
+class DSOEXPORT CommandBuffer
+{
+public:
+
+    enum Kind
+    {
+        SHAPE,
+        GLYPH,
+        LINE,
+        POLYGON,
+        VIDEO,
+        BEGIN_MASK,
+        END_MASK,
+        DISABLE_MASK
+    };
+
+    struct Command
+    {
+        Kind kind;
+
+        /// A checksum of what is drawn, without its transformation.
+        std::uint64_t id;
+
+        /// The shape or glyph drawn, or nullptr.
+        //
+        /// It is only compared, never used, as it may be gone by the
+        /// next frame.
+        const SWF::ShapeRecord* shape;
+
+        /// The color of a glyph.
+        std::uint32_t color;
+
+        SWFMatrix matrix;
+
+        SWFCxForm cxform;
+
+        /// The part of the stage drawn to, in twips.
+        //
+        /// This is the world for masks, as they change all drawing after
+        /// them.
+        geometry::Range2d<std::int32_t> bounds;
+
+        /// Whether the command may draw differently although it is the
+        /// same, as bitmaps and video frames can, or its order is unknown.
+        bool changing;
+    };
+
+    typedef std::vector<Command>::const_iterator const_iterator;
+
+    CommandBuffer();
+
+    void addShape(const SWF::ShapeRecord& shape, const Transform& xform);
+
+    void addGlyph(const SWF::ShapeRecord& rec, const rgba& color,
+            const SWFMatrix& mat);
+
+    void addLine(const std::vector<point>& coords, const rgba& color,
+            const SWFMatrix& mat);
+
+    void addPolygon(const std::vector<point>& corners, const rgba& fill,
+            const rgba& outline, const SWFMatrix& mat, bool masked);
+
+    void addVideo(const Transform& xform, const SWFRect& bounds);
+
+    /// Add a BEGIN_MASK, END_MASK or DISABLE_MASK command.
+    void addMask(Kind kind);
+
+    /// Add the parts of the stage drawn differently by the previous frame.
+    //
+    /// Only commands drawing to the region are compared. If the previous
+    /// frame is not complete, the whole region is added.
+    ///
+    /// @param previous     The commands of the previous frame, after
+    ///                     retain().
+    /// @param region       The part of the stage this frame was drawn to.
+    /// @param damage       The ranges to add to.
+    void damage(const CommandBuffer& previous, const InvalidatedRanges& region,
+            InvalidatedRanges& damage) const;
+
+    /// Add the commands of the previous frame outside a region.
+    //
+    /// They are drawn before the frame's commands, so afterwards the buffer
+    /// describes the stage as far as the previous one did. Those overlapping
+    /// the frame's commands may really be drawn after them, so they are
+    /// marked as changing until they are drawn again.
+    ///
+    /// @param previous     The commands of the previous frame.
+    /// @param region       The part of the stage this frame was drawn to.
+    void retain(const CommandBuffer& previous,
+            const InvalidatedRanges& region);
+
+    /// Whether the commands describe the whole stage.
+    bool complete() const {
+        return _complete;
+    }
+
+    const_iterator begin() const {
+        return _commands.begin();
+    }
+
+    const_iterator end() const {
+        return _commands.end();
+    }
+
+    size_t size() const {
+        return _commands.size();
+    }
+
+    void clear();
+
+    void swap(CommandBuffer& other);
+
+private:
+
+    void add(Kind kind, std::uint64_t id, const SWFMatrix& mat,
+            const SWFCxForm& cx, const SWFRect& bounds, bool changing);
+
+    std::vector<Command> _commands;
+
+    bool _complete;
+};
+
+} // namespace gnash
+
+#endif
@@ -0,0 +1,284 @@
+// DisplaySnapshot.cpp: recorded drawing of a frame, for Gnash.
+//
+//   Copyright (C) 2012 Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#include "DisplaySnapshot.h"
+
+#include <boost/variant.hpp>
+
+#include "swf/ShapeRecord.h"
+#include "FillStyle.h"
+#include "GnashImage.h"
+#include "SWFMatrix.h"
+#include "Transform.h"
+#include "log.h"
+
+namespace gnash {
+
+namespace {
+
+/// Copy a shape, so that it does not depend on its movie any more.
+//
+/// Bitmap fills from SWF tags only refer to their movie definition,
+/// so they are replaced by fills holding the bitmap.
+SWF::ShapeRecord
+copyShape(const SWF::ShapeRecord& shape)
+{
+    SWF::ShapeRecord copy;
+    for (SWF::Subshape sub : shape.subshapes()) {
+        for (FillStyle& style : sub.fillStyles()) {
+            BitmapFill* f = boost::get<BitmapFill>(&style.fill);
+            if (!f) continue;
+            *f = BitmapFill(f->type(), f->bitmap(), f->matrix(),
+                    f->smoothingPolicy());
+        }
+        copy.addSubshape(sub);
+    }
+    copy.setBounds(shape.getBounds());
+    return copy;
+}
+
+/// Copy a video frame, which is replaced when the next one is decoded.
+std::shared_ptr<image::GnashImage>
+copyFrame(const image::GnashImage& frame)
+{
+    std::shared_ptr<image::GnashImage> copy;
+    if (frame.location() != image::GNASH_IMAGE_CPU) return copy;
+
+    switch (frame.type()) {
+        case image::TYPE_RGB:
+            copy.reset(new image::ImageRGB(frame.width(), frame.height()));
+            break;
+        case image::TYPE_RGBA:
+            copy.reset(new image::ImageRGBA(frame.width(), frame.height()));
+            break;
+        default:
+            return copy;
+    }
+    copy->update(frame);
+    return copy;
+}
+
+} // anonymous namespace
+
+DisplaySnapshot::DisplaySnapshot(Renderer& target, bool copy)
+    :
+    _target(target),
+    _copy(copy),
+    _displayed(false),
+    _viewportWidth(0),
+    _viewportHeight(0),
+    _x0(0),
+    _x1(0),
+    _y0(0),
+    _y1(0)
+{
+}
+
+void
+DisplaySnapshot::replay(Renderer& r) const
+{
+    if (!_displayed) return;
+
+    Renderer::External ex(r, _background, _viewportWidth, _viewportHeight,
+            _x0, _x1, _y0, _y1);
+
+    for (const Command& c : _commands) c(r);
+}
+
+std::string
+DisplaySnapshot::description() const
+{
+    return "Snapshot for " + _target.description();
+}
+
+CachedBitmap*
+DisplaySnapshot::createCachedBitmap(std::unique_ptr<image::GnashImage> im)
+{
+    return _target.createCachedBitmap(std::move(im));
+}
+
+bool
+DisplaySnapshot::applyFilters(image::GnashImage& im, const Filters& filters,
+        double xscale, double yscale)
+{
+    return _target.applyFilters(im, filters, xscale, yscale);
+}
+
+void
+DisplaySnapshot::drawVideoFrame(image::GnashImage* frame,
+        const Transform& xform, const SWFRect* bounds, bool smooth)
+{
+    if (!frame || !bounds) return;
+
+    _record.addVideo(xform, *bounds);
+    const SWFRect b = *bounds;
+
+    if (!_copy) {
+        _commands.push_back([frame, xform, b, smooth](Renderer& r) {
+                r.drawVideoFrame(frame, xform, &b, smooth);
+            });
+        return;
+    }
+
+    std::shared_ptr<image::GnashImage> copy = copyFrame(*frame);
+    if (!copy.get()) {
+        LOG_ONCE(log_unimpl(_("Video frames stored outside main memory "
+                        "when rendering in the background")));
+        return;
+    }
+
+    _commands.push_back([copy, xform, b, smooth](Renderer& r) {
+            r.drawVideoFrame(copy.get(), xform, &b, smooth);
+        });
+}
+
+void
+DisplaySnapshot::drawLine(const std::vector<point>& coords,
+        const rgba& color, const SWFMatrix& mat)
+{
+    _record.addLine(coords, color, mat);
+    _commands.push_back([coords, color, mat](Renderer& r) {
+            r.drawLine(coords, color, mat);
+        });
+}
+
+void
+DisplaySnapshot::draw_poly(const std::vector<point>& corners,
+        const rgba& fill, const rgba& outline, const SWFMatrix& mat,
+        bool masked)
+{
+    _record.addPolygon(corners, fill, outline, mat, masked);
+    _commands.push_back([corners, fill, outline, mat, masked](Renderer& r) {
+            r.draw_poly(corners, fill, outline, mat, masked);
+        });
+}
+
+void
+DisplaySnapshot::drawShape(const SWF::ShapeRecord& shape,
+        const Transform& xform)
+{
+    _record.addShape(shape, xform);
+
+    if (!_copy) {
+        const SWF::ShapeRecord* s = &shape;
+        _commands.push_back([s, xform](Renderer& r) {
+                r.drawShape(*s, xform);
+            });
+        return;
+    }
+
+    const SWF::ShapeRecord copy = copyShape(shape);
+    _commands.push_back([copy, xform](Renderer& r) {
+            r.drawShape(copy, xform);
+        });
+}
+
+void
+DisplaySnapshot::drawGlyph(const SWF::ShapeRecord& rec, const rgba& color,
+        const SWFMatrix& mat)
+{
+    _record.addGlyph(rec, color, mat);
+
+    if (!_copy) {
+        const SWF::ShapeRecord* s = &rec;
+        _commands.push_back([s, color, mat](Renderer& r) {
+                r.drawGlyph(*s, color, mat);
+            });
+        return;
+    }
+
+    const SWF::ShapeRecord copy = rec;
+    _commands.push_back([copy, color, mat](Renderer& r) {
+            r.drawGlyph(copy, color, mat);
+        });
+}
+
+void
+DisplaySnapshot::begin_submit_mask()
+{
+    _record.addMask(CommandBuffer::BEGIN_MASK);
+    _commands.push_back([](Renderer& r) { r.begin_submit_mask(); });
+}
+
+void
+DisplaySnapshot::end_submit_mask()
+{
+    _record.addMask(CommandBuffer::END_MASK);
+    _commands.push_back([](Renderer& r) { r.end_submit_mask(); });
+}
+
+void
+DisplaySnapshot::disable_mask()
+{
+    _record.addMask(CommandBuffer::DISABLE_MASK);
+    _commands.push_back([](Renderer& r) { r.disable_mask(); });
+}
+
+geometry::Range2d<int>
+DisplaySnapshot::world_to_pixel(const SWFRect& worldbounds) const
+{
+    return _target.world_to_pixel(worldbounds);
+}
+
+point
+DisplaySnapshot::pixel_to_world(int x, int y) const
+{
+    return _target.pixel_to_world(x, y);
+}
+
+bool
+DisplaySnapshot::bounds_in_clipping_area(
+        const geometry::Range2d<int>& b) const
+{
+    return _target.bounds_in_clipping_area(b);
+}
+
+void
+DisplaySnapshot::begin_display(const rgba& background_color,
+        int viewport_width, int viewport_height,
+        float x0, float x1, float y0, float y1)
+{
+    _displayed = true;
+    _background = background_color;
+    _viewportWidth = viewport_width;
+    _viewportHeight = viewport_height;
+    _x0 = x0;
+    _x1 = x1;
+    _y0 = y0;
+    _y1 = y1;
+}
+
+void
+DisplaySnapshot::end_display()
+{
+}
+
+Renderer*
+DisplaySnapshot::startInternalRender(image::GnashImage& buffer)
+{
+    _internal.reset(new Renderer::Internal(_target, buffer));
+    return _internal->renderer();
+}
+
+void
+DisplaySnapshot::endInternalRender()
+{
+    _internal.reset();
+}
+
+} // namespace gnash
@@ -0,0 +1,154 @@
+// DisplaySnapshot.h: recorded drawing of a frame, for Gnash.
+//
+//   Copyright (C) 2012 Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifndef GNASH_DISPLAYSNAPSHOT_H
+#define GNASH_DISPLAYSNAPSHOT_H
+
+#include <vector>
+#include <memory>
+#include <functional>
+#include <string>
+
+#include "Renderer.h"
+#include "CommandBuffer.h"
+#include "dsodefs.h" // for DSOEXPORT
+
+namespace gnash {
+
+/// A Renderer recording the drawing of a frame, to draw it later.
+//
+/// A movie is displayed to a DisplaySnapshot, which keeps copies of
+/// everything drawn: shapes, glyphs, lines and video frames. The
+/// snapshot can then be drawn to the target renderer by another thread,
+/// while the movie goes on changing.
+///
+/// Bitmaps are shared with the movie. Code changing or freeing them
+/// must call Renderer::sync() on the target renderer first.
+///
+/// A snapshot drawn before the movie changes needn't copy anything. It
+/// then only refers to what was drawn.
+///
+/// The drawing is also recorded compactly as a CommandBuffer, which can
+/// be compared with the previous frame's to find what needs drawing.
+///
+/// Queries about the stage, such as coordinate conversions and clipping
+/// tests, are answered by the target renderer, which must not change
+/// while the frame is recorded.
+class DSOEXPORT DisplaySnapshot : public Renderer
+{
+public:
+
+    /// Record drawing meant for a renderer.
+    //
+    /// @param target   The renderer the snapshot will be drawn to.
+    /// @param copy     Whether to copy what is drawn. If not, the snapshot
+    ///                 must be drawn before the movie changes.
+    explicit DisplaySnapshot(Renderer& target, bool copy = true);
+
+    /// Draw the recorded frame.
+    //
+    /// This may be called from any thread, but only once.
+    ///
+    /// @param r    The renderer to draw to, usually the target renderer.
+    void replay(Renderer& r) const;
+
+    /// The drawing commands recorded.
+    CommandBuffer& commands() {
+        return _record;
+    }
+
+    virtual std::string description() const;
+
+    virtual CachedBitmap* createCachedBitmap(
+            std::unique_ptr<image::GnashImage> im);
+
+    virtual bool applyFilters(image::GnashImage& im, const Filters& filters,
+            double xscale, double yscale);
+
+    virtual void drawVideoFrame(image::GnashImage* frame,
+            const Transform& xform, const SWFRect* bounds, bool smooth);
+
+    virtual void drawLine(const std::vector<point>& coords,
+            const rgba& color, const SWFMatrix& mat);
+
+    virtual void draw_poly(const std::vector<point>& corners,
+        const rgba& fill, const rgba& outline, const SWFMatrix& mat,
+        bool masked);
+
+    virtual void drawShape(const SWF::ShapeRecord& shape,
+            const Transform& xform);
+
+    virtual void drawGlyph(const SWF::ShapeRecord& rec, const rgba& color,
+           const SWFMatrix& mat);
+
+    virtual void begin_submit_mask();
+    virtual void end_submit_mask();
+    virtual void disable_mask();
+
+    virtual geometry::Range2d<int> world_to_pixel(
+            const SWFRect& worldbounds) const;
+
+    virtual point pixel_to_world(int x, int y) const;
+
+    virtual bool bounds_in_clipping_area(
+            const geometry::Range2d<int>& b) const;
+
+private:
+
+    typedef std::function<void(Renderer&)> Command;
+
+    virtual void begin_display(const rgba& background_color,
+                    int viewport_width, int viewport_height,
+                    float x0, float x1, float y0, float y1);
+
+    virtual void end_display();
+
+    virtual Renderer* startInternalRender(image::GnashImage& buffer);
+
+    virtual void endInternalRender();
+
+    Renderer& _target;
+
+    /// Whether what is drawn is copied.
+    const bool _copy;
+
+    /// Internal rendering started on the target renderer.
+    std::unique_ptr<Renderer::Internal> _internal;
+
+    /// Whether begin_display() was called.
+    bool _displayed;
+
+    /// The arguments to begin_display().
+    rgba _background;
+    int _viewportWidth;
+    int _viewportHeight;
+    float _x0;
+    float _x1;
+    float _y0;
+    float _y1;
+
+    /// The drawing between begin_display() and end_display().
+    std::vector<Command> _commands;
+
+    /// The same drawing, as compared between frames.
+    CommandBuffer _record;
+};
+
+} // namespace gnash
+
+#endif
@@ -0,0 +1,88 @@
+// RenderThread.cpp: drawing frames in the background, for Gnash.
+//
+//   Copyright (C) 2012 Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#include "RenderThread.h"
+
+#include <cassert>
+
+#include "Renderer.h"
+#include "DisplaySnapshot.h"
+
+namespace gnash {
+
+RenderThread::RenderThread(Renderer& r)
+    :
+    _renderer(r),
+    _quit(false),
+    _pending(false),
+    _thread(&RenderThread::run, this)
+{
+}
+
+RenderThread::~RenderThread()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _quit = true;
+    }
+    _ready.notify_one();
+    _thread.join();
+}
+
+void
+RenderThread::draw(std::unique_ptr<DisplaySnapshot> s)
+{
+    assert(s.get());
+
+    _renderer.sync();
+    _renderer.startBackgroundDrawing();
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _snapshot = std::move(s);
+    }
+    _pending = true;
+    _ready.notify_one();
+}
+
+bool
+RenderThread::wait()
+{
+    _renderer.sync();
+    const bool drawn = _pending;
+    _pending = false;
+    return drawn;
+}
+
+void
+RenderThread::run()
+{
+    while (true) {
+        std::unique_ptr<DisplaySnapshot> s;
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _ready.wait(lock, [this] { return _quit || _snapshot.get(); });
+            if (!_snapshot.get()) return;
+            s = std::move(_snapshot);
+        }
+        s->replay(_renderer);
+        s.reset();
+        _renderer.finishBackgroundDrawing();
+    }
+}
+
+} // namespace gnash
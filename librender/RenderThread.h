@@ -0,0 +1,86 @@
+// RenderThread.h: drawing frames in the background, for Gnash.
+//
+//   Copyright (C) 2012 Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifndef GNASH_RENDERTHREAD_H
+#define GNASH_RENDERTHREAD_H
+
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <boost/noncopyable.hpp>
+
+#include "dsodefs.h" // for DSOEXPORT
+
+namespace gnash {
+    class Renderer;
+    class DisplaySnapshot;
+}
+
+namespace gnash {
+
+/// Draws recorded frames to a renderer while the movie advances.
+//
+/// Only one frame is drawn at a time. The renderer must support
+/// drawing from another thread (see Renderer::supportsBackgroundDrawing).
+class DSOEXPORT RenderThread : boost::noncopyable
+{
+public:
+
+    /// Start a thread drawing to a renderer.
+    explicit RenderThread(Renderer& r);
+
+    /// Finish drawing the current frame and stop the thread.
+    ~RenderThread();
+
+    /// Draw a frame.
+    //
+    /// This waits until the previous frame has been drawn.
+    void draw(std::unique_ptr<DisplaySnapshot> s);
+
+    /// Wait until the last frame has been drawn.
+    //
+    /// @return     true if a frame was drawn since the last call, so that
+    ///             it should be shown.
+    bool wait();
+
+private:
+
+    void run();
+
+    Renderer& _renderer;
+
+    std::mutex _mutex;
+    std::condition_variable _ready;
+
+    /// The frame waiting to be drawn, if any.
+    std::unique_ptr<DisplaySnapshot> _snapshot;
+
+    /// Set to make the thread return.
+    bool _quit;
+
+    /// Whether a frame was submitted and not yet waited for.
+    bool _pending;
+
+    /// Started last, when everything it uses is initialized.
+    std::thread _thread;
+};
+
+} // namespace gnash
+
+#endif
@@ -142,6 +142,8 @@
 
 
 #include <vector>
+#include <mutex>
+#include <condition_variable>
 #include <boost/noncopyable.hpp>
 
 #include "dsodefs.h" // for DSOEXPORT
@@ -153,6 +155,7 @@
 #include "log.h"
 #include "snappingrange.h"
 #include "SWFRect.h"
+#include "filter_factory.h" // for Filters
 
 // Forward declarations.
 namespace gnash {
@@ -189,7 +192,7 @@ class DSOEXPORT Renderer : boost::noncopyable
 {
 public:
 
-    Renderer(): _quality(QUALITY_HIGH) { }
+    Renderer(): _quality(QUALITY_HIGH), _drawingInBackground(false) { }
     
     virtual ~Renderer() {}
 
@@ -221,6 +224,23 @@ public:
     virtual CachedBitmap *
         createCachedBitmap(std::unique_ptr<image::GnashImage> im) = 0;
 
+    /// Apply bitmap filters to an image rendered offscreen.
+    //
+    /// This is used by BitmapCache for MovieClips with filters. The
+    /// image leaves room around its contents for the filters to draw to.
+    ///
+    /// @param im       A premultiplied RGBA image, filtered in place.
+    /// @param filters  The filters, applied in order.
+    /// @param xscale   The number of image pixels per movie pixel across.
+    /// @param yscale   The number of image pixels per movie pixel down.
+    /// @return         false if the renderer can't filter images. The
+    ///                 image is left unchanged then.
+    virtual bool applyFilters(image::GnashImage& /*im*/,
+            const Filters& /*filters*/, double /*xscale*/,
+            double /*yscale*/) {
+        return false;
+    }
+
 
     /// ==================================================================
     /// Rendering Interface.
@@ -341,6 +361,18 @@ public:
     {        
     }
 
+    /// The size in pixels of the tiles invalidated regions are aligned to.
+    //
+    /// Renderers that render many small regions cheaply can return a tile
+    /// size, so that scattered updates are not merged into large regions.
+    /// See InvalidatedRanges::setTileSize().
+    ///
+    /// @return     The tile size, or 0 to snap close regions together.
+    virtual int getInvalidatedTileSize() const
+    {
+        return 0;
+    }
+
     /// ==================================================================
     /// Machinery for delayed images rendering (e.g. Xv with YV12 or VAAPI)
     /// ==================================================================
@@ -583,6 +615,49 @@ public:
         Renderer* _ext;
     };
 
+    /// ==================================================================
+    /// Drawing from another thread.
+    /// ==================================================================
+
+    /// Whether a frame may be drawn by another thread.
+    //
+    /// Such renderers must call sync() before any change to their state
+    /// made from outside the drawing, such as resizing the buffer or
+    /// setting invalidated regions. Only creating CachedBitmaps, internal
+    /// rendering, applying filters and coordinate conversions may run
+    /// concurrently.
+    virtual bool supportsBackgroundDrawing() const {
+        return false;
+    }
+
+    /// Mark the start of drawing that another thread will do.
+    //
+    /// This is called by the thread handing the drawing over, so that
+    /// sync() waits for it. The drawing thread calls
+    /// finishBackgroundDrawing() when done.
+    void startBackgroundDrawing() {
+        std::lock_guard<std::mutex> lock(_backgroundMutex);
+        _drawingInBackground = true;
+    }
+
+    void finishBackgroundDrawing() {
+        {
+            std::lock_guard<std::mutex> lock(_backgroundMutex);
+            _drawingInBackground = false;
+        }
+        _backgroundDone.notify_all();
+    }
+
+    /// Wait until drawing done by another thread has finished.
+    //
+    /// Data such drawing may be reading, such as the images of
+    /// CachedBitmaps, must not be changed or freed before this returns.
+    /// Nor must the buffer it draws to, which GUIs replace on resizing.
+    void sync() const {
+        std::unique_lock<std::mutex> lock(_backgroundMutex);
+        while (_drawingInBackground) _backgroundDone.wait(lock);
+    }
+
 protected:
 
     /// Kept in parallel with movie_root's setting.
@@ -592,6 +667,14 @@ protected:
     RenderImages _render_images;
 
 private:
+
+    mutable std::mutex _backgroundMutex;
+
+    mutable std::condition_variable _backgroundDone;
+
+    /// Whether another thread is drawing to this renderer.
+    bool _drawingInBackground;
+
     /// Bracket the displaying of a frame from a movie.
     //
     /// Set up to render a full frame from a movie and fills the
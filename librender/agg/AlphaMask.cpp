@@ -0,0 +1,169 @@
+// AlphaMask.cpp: masks limited to the pixels they cover, for Gnash.
+//
+//   Copyright (C) 2012 Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#include "AlphaMask.h"
+
+#include <algorithm>
+#include <cstring>
+#include <cmath>
+#include <cassert>
+
+namespace gnash {
+
+namespace {
+
+/// The pixel containing a coordinate in twips.
+inline int
+pixel(int twips)
+{
+    return static_cast<int>(std::floor(twips / 20.0));
+}
+
+} // anonymous namespace
+
+AlphaMask::AlphaMask()
+    :
+    _rectangular(false),
+    _stride(0)
+{
+}
+
+void
+AlphaMask::setRectangle(const geometry::Range2d<int>& rect)
+{
+    _bounds = rect;
+    _rectangular = true;
+    _stride = 0;
+    _buffer.reset();
+}
+
+void
+AlphaMask::setBuffer(const geometry::Range2d<int>& bounds)
+{
+    _bounds = bounds;
+    _rectangular = false;
+    if (_bounds.isNull()) {
+        _stride = 0;
+        _buffer.reset();
+        return;
+    }
+    assert(_bounds.isFinite());
+
+    _stride = _bounds.width() + 1;
+    _buffer.reset(new std::uint8_t[_stride * (_bounds.height() + 1)]());
+}
+
+void
+AlphaMask::intersect(const AlphaMask& other)
+{
+    if (rectangular()) {
+        assert(other.rectangular());
+        _bounds = geometry::Intersection(_bounds, other._bounds);
+        return;
+    }
+    if (_bounds.isNull()) return;
+
+    std::uint8_t* row = _buffer.get();
+    for (int y = _bounds.getMinY(); y <= _bounds.getMaxY(); ++y) {
+        other.combine_hspan(_bounds.getMinX(), y, row, _stride);
+        row += _stride;
+    }
+}
+
+void
+AlphaMask::combine_hspan(int x, int y, cover_type* covers, int count) const
+{
+    if (_bounds.isNull() || y < _bounds.getMinY() || y > _bounds.getMaxY()) {
+        std::memset(covers, 0, count);
+        return;
+    }
+
+    const int begin = std::max(x, _bounds.getMinX());
+    const int end = std::min(x + count, _bounds.getMaxX() + 1);
+    if (begin >= end) {
+        std::memset(covers, 0, count);
+        return;
+    }
+
+    std::fill(covers, covers + (begin - x), 0);
+    std::fill(covers + (end - x), covers + count, 0);
+
+    if (rectangular()) return;
+
+    // The same rounding as agg::alpha_mask_u8.
+    const std::uint8_t* mask = _buffer.get() +
+        (y - _bounds.getMinY()) * _stride + (begin - _bounds.getMinX());
+    for (cover_type* c = covers + (begin - x), *e = covers + (end - x);
+            c != e; ++c, ++mask) {
+        *c = (255 + *c * *mask) >> 8;
+    }
+}
+
+geometry::Range2d<int>
+pathBounds(const std::vector<Path>& paths)
+{
+    geometry::Range2d<int> bounds;
+    for (const Path& p : paths) {
+        bounds.expandTo(pixel(p.ap.x), pixel(p.ap.y));
+        for (const Edge& e : p.m_edges) {
+            bounds.expandTo(pixel(e.cp.x), pixel(e.cp.y));
+            bounds.expandTo(pixel(e.ap.x), pixel(e.ap.y));
+        }
+    }
+    return bounds;
+}
+
+bool
+pixelRectangle(const std::vector<Path>& paths, geometry::Range2d<int>& rect)
+{
+    const Path* filled = nullptr;
+    for (const Path& p : paths) {
+        if (!p.m_fill0 && !p.m_fill1) continue;
+        if (filled) return false;
+        filled = &p;
+    }
+
+    // One side filled and four edges along alternate axes, back to the
+    // start.
+    if (!filled || (filled->m_fill0 && filled->m_fill1)) return false;
+    const std::vector<Edge>& edges = filled->m_edges;
+    if (edges.size() != 4 || edges.back().ap != filled->ap) return false;
+
+    point from = filled->ap;
+    bool across = from.y == edges.front().ap.y;
+    for (const Edge& e : edges) {
+        if (!e.straight()) return false;
+        if (from.x % 20 || from.y % 20) return false;
+        if (across ? (e.ap.y != from.y || e.ap.x == from.x) :
+                (e.ap.x != from.x || e.ap.y == from.y)) {
+            return false;
+        }
+        from = e.ap;
+        across = !across;
+    }
+
+    const int x0 = filled->ap.x / 20;
+    const int y0 = filled->ap.y / 20;
+    const int x1 = edges[1].ap.x / 20;
+    const int y1 = edges[1].ap.y / 20;
+    rect.setTo(std::min(x0, x1), std::min(y0, y1), std::max(x0, x1) - 1,
+            std::max(y0, y1) - 1);
+    return true;
+}
+
+} // namespace gnash
@@ -0,0 +1,116 @@
+// AlphaMask.h: masks limited to the pixels they cover, for Gnash.
+//
+//   Copyright (C) 2012 Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifndef GNASH_ALPHAMASK_H
+#define GNASH_ALPHAMASK_H
+
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <boost/noncopyable.hpp>
+
+#include "Geometry.h"
+#include "Range2d.h"
+
+namespace gnash {
+
+/// The coverage of the pixels of a mask.
+//
+/// Only the pixels inside the mask's bounds are kept, so masks of small
+/// clips need little memory however large the stage is. Pixels outside
+/// the bounds are not covered at all.
+///
+/// A mask that is a rectangle of whole pixels keeps no coverage values:
+/// every pixel inside its bounds is fully covered.
+///
+/// The mask may be used by AGG's scanline_u8_am like an agg::alpha_mask_u8.
+class AlphaMask : boost::noncopyable
+{
+public:
+
+    typedef std::uint8_t cover_type;
+
+    /// Construct a mask covering nothing.
+    AlphaMask();
+
+    /// Cover the pixels of a rectangle fully.
+    void setRectangle(const geometry::Range2d<int>& rect);
+
+    /// Keep coverage values for the pixels of some bounds, all zero.
+    //
+    /// The values are written through buffer().
+    void setBuffer(const geometry::Range2d<int>& bounds);
+
+    /// Keep only what another mask covers too.
+    //
+    /// A rectangular mask can only be intersected with another rectangle.
+    void intersect(const AlphaMask& other);
+
+    /// The pixels that may be covered.
+    const geometry::Range2d<int>& bounds() const {
+        return _bounds;
+    }
+
+    /// Whether the mask is a rectangle without coverage values.
+    bool rectangular() const {
+        return _rectangular;
+    }
+
+    /// The coverage values, row by row from the top left of the bounds.
+    //
+    /// This is null for rectangular masks and masks covering nothing.
+    std::uint8_t* buffer() {
+        return _buffer.get();
+    }
+
+    /// The number of coverage values in each row of the buffer.
+    size_t stride() const {
+        return _stride;
+    }
+
+    /// Scale the coverage of a horizontal span by the mask's.
+    //
+    /// This is what AGG's scanline_u8_am calls for every span.
+    void combine_hspan(int x, int y, cover_type* covers, int count) const;
+
+private:
+
+    geometry::Range2d<int> _bounds;
+
+    bool _rectangular;
+
+    size_t _stride;
+
+    std::unique_ptr<std::uint8_t[]> _buffer;
+};
+
+/// The pixels that paths in twips may touch.
+geometry::Range2d<int> pathBounds(const std::vector<Path>& paths);
+
+/// Find whether paths in twips fill a rectangle of whole pixels.
+//
+/// @param paths    The paths to look at.
+/// @param rect     Set to the pixels of the rectangle if it is one.
+/// @return         Whether the paths fill only a rectangle of whole
+///                 pixels.
+bool pixelRectangle(const std::vector<Path>& paths,
+        geometry::Range2d<int>& rect);
+
+} // namespace gnash
+
+#endif
@@ -0,0 +1,195 @@
+// BandRasterizer.h: AGG rasterizer sweeping a band of rows, for Gnash.
+//
+//   Copyright (C) 2012 Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifndef GNASH_BANDRASTERIZER_H
+#define GNASH_BANDRASTERIZER_H
+
+#include <algorithm>
+#include <agg_basics.h>
+
+namespace gnash {
+
+/// A compound AGG rasterizer only giving the scanlines of some rows.
+//
+/// Threads drawing bands of a shape each rasterize the edges reaching
+/// their band (see BandFilter), with the same clipping box as if it were
+/// drawn whole. Clipping paths to the band instead would round the
+/// points where they cross its edges, so that the pixels along them
+/// could differ from those drawn without bands. The sweep of the
+/// scanlines, and so the generation and blending of spans, is limited
+/// to the band.
+///
+/// This can be passed to agg::render_scanlines_compound_layered(), which
+/// then only draws the band. The renderer should also be clipped to the
+/// band, as the first row after it may be swept.
+template<class Rasterizer>
+class BandRasterizer : public Rasterizer
+{
+public:
+
+    /// @param top      The first row swept.
+    /// @param bottom   The last row swept.
+    BandRasterizer(int top, int bottom)
+        :
+        _top(top),
+        _bottom(bottom),
+        _done(false)
+    {}
+
+    bool rewind_scanlines() {
+        _done = false;
+        return Rasterizer::rewind_scanlines() &&
+            Rasterizer::navigate_scanline(std::max(_top,
+                        Rasterizer::min_y()));
+    }
+
+    unsigned sweep_styles() {
+        return _done ? 0 : Rasterizer::sweep_styles();
+    }
+
+    template<class Scanline>
+    bool sweep_scanline(Scanline& sl, int style) {
+        if (!Rasterizer::sweep_scanline(sl, style)) return false;
+
+        // Empty rows are skipped, so the row is only known now.
+        if (sl.y() <= _bottom) return true;
+        _done = true;
+        return false;
+    }
+
+private:
+    const int _top;
+    const int _bottom;
+    bool _done;
+};
+
+/// A vertex source leaving out the edges that can't reach some rows.
+//
+/// Lines and curves entirely above or below the rows, by more than a
+/// row, are replaced by moves to their end. A compound rasterizer only
+/// has cells in the rows an edge crosses and doesn't close polygons on
+/// moves, so the cells of the rows are the same as with the whole path.
+/// Each band of a shape then only rasterizes and sorts the cells of its
+/// own edges, rather than those of all the shape.
+///
+/// The moves would change the point a compound rasterizer closes a
+/// polygon to, so polygons are closed with a line back to their start.
+/// This goes before agg::conv_curve, so that curves left out aren't
+/// flattened.
+template<class VertexSource>
+class BandFilter
+{
+public:
+
+    /// @param top      The first row kept.
+    /// @param bottom   The last row kept.
+    BandFilter(VertexSource& source, int top, int bottom)
+        :
+        _source(source),
+        _top(top - 1.0),
+        _bottom(bottom + 2.0),
+        _startX(0),
+        _startY(0),
+        _lastY(0),
+        _pending(false),
+        _endX(0),
+        _endY(0)
+    {}
+
+    void rewind(unsigned pathId) {
+        _source.rewind(pathId);
+        _pending = false;
+    }
+
+    unsigned vertex(double* x, double* y) {
+
+        // The end of a curve kept.
+        if (_pending) {
+            _pending = false;
+            *x = _endX;
+            *y = _endY;
+            _lastY = _endY;
+            return agg::path_cmd_curve3;
+        }
+
+        unsigned cmd = _source.vertex(x, y);
+
+        if (agg::is_move_to(cmd)) {
+            _startX = *x;
+            _startY = *y;
+            _lastY = *y;
+            return cmd;
+        }
+
+        if (agg::is_close(cmd)) {
+            *x = _startX;
+            *y = _startY;
+            cmd = agg::path_cmd_line_to;
+        }
+
+        if (agg::is_curve3(cmd)) {
+            double endX, endY;
+            _source.vertex(&endX, &endY);
+            if (outside(*y, endY)) {
+                *x = endX;
+                *y = endY;
+                _lastY = endY;
+                return agg::path_cmd_move_to;
+            }
+            _pending = true;
+            _endX = endX;
+            _endY = endY;
+            return cmd;
+        }
+
+        if (agg::is_line_to(cmd) && outside(*y, *y)) {
+            cmd = agg::path_cmd_move_to;
+        }
+        if (agg::is_vertex(cmd)) _lastY = *y;
+        return cmd;
+    }
+
+private:
+
+    /// Whether an edge from the last point through some others is
+    /// entirely above or below the rows.
+    bool outside(double y1, double y2) const {
+        return (_lastY < _top && y1 < _top && y2 < _top) ||
+            (_lastY > _bottom && y1 > _bottom && y2 > _bottom);
+    }
+
+    VertexSource& _source;
+    const double _top;
+    const double _bottom;
+
+    /// The start of the current polygon.
+    double _startX;
+    double _startY;
+
+    /// The last point given.
+    double _lastY;
+
+    /// The end of a curve whose control point was given.
+    bool _pending;
+    double _endX;
+    double _endY;
+};
+
+} // namespace gnash
+
+#endif
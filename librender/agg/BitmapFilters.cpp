@@ -0,0 +1,656 @@
+// BitmapFilters.cpp: bitmap filters applied to offscreen images, for Gnash.
+//
+//   Copyright (C) 2012 Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#include "BitmapFilters.h"
+
+#include <vector>
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+
+#include "RenderWorkers.h"
+#include "GnashImage.h"
+#include "Filters.h"
+#include "log.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+# define GNASH_SIMD_X86 1
+# include <immintrin.h>
+#endif
+
+// A box blur keeps a running sum of the 2 * r + 1 values under the box
+// for each byte of a row, and moves the box down one row at a time, so
+// that its cost does not depend on the radius. Rows are blurred by
+// blurring the columns of the transposed image. The sums are divided by
+// multiplying with 65536 / (2 * r + 1) in 16.16 fixed point, which the
+// vector code does exactly like the scalar code.
+
+namespace gnash {
+
+namespace {
+
+/// The number of bytes of each row a task blurs.
+const size_t stripBytes = 256;
+
+/// The number of rows of each task that works on rows.
+const size_t bandRows = 32;
+
+/// Run a function on bands of rows, sharing them among the RenderWorkers.
+template<typename F>
+void
+inBands(size_t rows, const F& f)
+{
+    const size_t bands = (rows + bandRows - 1) / bandRows;
+    RenderWorkers::pool().run(bands, [&](size_t band) {
+        const size_t begin = band * bandRows;
+        f(begin, std::min(rows, begin + bandRows));
+    });
+}
+
+/// a * b / 255, rounded.
+inline unsigned
+mul255(unsigned a, unsigned b)
+{
+    const unsigned t = a * b + 128;
+    return (t + (t >> 8)) >> 8;
+}
+
+/// The fixed point factor dividing a sum of 2 * radius + 1 values.
+inline std::uint32_t
+divider(unsigned radius)
+{
+    const std::uint32_t n = 2 * radius + 1;
+    return (65536 + n / 2) / n;
+}
+
+inline std::uint8_t
+average(std::uint32_t sum, std::uint32_t mul)
+{
+    return std::min<std::uint32_t>((sum * mul + 32768) >> 16, 255);
+}
+
+/// Blur some bytes of each row down the columns.
+//
+/// @param sums     Room for one sum per byte.
+void
+blurStripScalar(const std::uint8_t* src, std::uint8_t* dst, size_t bytes,
+        size_t rows, size_t stride, unsigned radius, std::uint32_t* sums)
+{
+    std::fill(sums, sums + bytes, 0);
+    for (size_t y = 0; y <= radius && y < rows; ++y) {
+        const std::uint8_t* s = src + y * stride;
+        for (size_t i = 0; i < bytes; ++i) sums[i] += s[i];
+    }
+
+    const std::uint32_t mul = divider(radius);
+
+    for (size_t y = 0; y < rows; ++y) {
+        std::uint8_t* d = dst + y * stride;
+        for (size_t i = 0; i < bytes; ++i) d[i] = average(sums[i], mul);
+
+        if (y + radius + 1 < rows) {
+            const std::uint8_t* s = src + (y + radius + 1) * stride;
+            for (size_t i = 0; i < bytes; ++i) sums[i] += s[i];
+        }
+        if (y >= radius) {
+            const std::uint8_t* s = src + (y - radius) * stride;
+            for (size_t i = 0; i < bytes; ++i) sums[i] -= s[i];
+        }
+    }
+}
+
+#ifdef GNASH_SIMD_X86
+
+/// Add or subtract a row from the sums, 16 bytes at a time.
+template<bool Add>
+__attribute__((target("sse2")))
+inline void
+accumulateSSE2(std::uint32_t* sums, const std::uint8_t* s, size_t bytes)
+{
+    const __m128i zero = _mm_setzero_si128();
+
+    for (size_t i = 0; i < bytes; i += 16) {
+        const __m128i v = _mm_loadu_si128(
+                reinterpret_cast<const __m128i*>(s + i));
+        const __m128i lo = _mm_unpacklo_epi8(v, zero);
+        const __m128i hi = _mm_unpackhi_epi8(v, zero);
+        const __m128i parts[4] = {
+            _mm_unpacklo_epi16(lo, zero), _mm_unpackhi_epi16(lo, zero),
+            _mm_unpacklo_epi16(hi, zero), _mm_unpackhi_epi16(hi, zero)
+        };
+        for (size_t k = 0; k < 4; ++k) {
+            __m128i* sum = reinterpret_cast<__m128i*>(sums + i + 4 * k);
+            const __m128i old = _mm_loadu_si128(sum);
+            _mm_storeu_si128(sum, Add ? _mm_add_epi32(old, parts[k]) :
+                    _mm_sub_epi32(old, parts[k]));
+        }
+    }
+}
+
+/// Divide four sums as average() does, before clamping.
+__attribute__((target("sse2")))
+inline __m128i
+averageSSE2(__m128i sum, __m128i mul, __m128i half)
+{
+    const __m128i even = _mm_srli_epi64(
+            _mm_add_epi64(_mm_mul_epu32(sum, mul), half), 16);
+    const __m128i odd = _mm_srli_epi64(_mm_add_epi64(
+                _mm_mul_epu32(_mm_srli_epi64(sum, 32), mul), half), 16);
+    return _mm_or_si128(even, _mm_slli_epi64(odd, 32));
+}
+
+__attribute__((target("sse2")))
+void
+blurStripSSE2(const std::uint8_t* src, std::uint8_t* dst, size_t bytes,
+        size_t rows, size_t stride, unsigned radius, std::uint32_t* sums)
+{
+    const size_t vbytes = bytes & ~size_t(15);
+    blurStripScalar(src + vbytes, dst + vbytes, bytes - vbytes, rows,
+            stride, radius, sums + vbytes);
+
+    std::fill(sums, sums + vbytes, 0);
+    for (size_t y = 0; y <= radius && y < rows; ++y) {
+        accumulateSSE2<true>(sums, src + y * stride, vbytes);
+    }
+
+    const __m128i mul = _mm_set1_epi32(divider(radius));
+    const __m128i half = _mm_set1_epi64x(32768);
+
+    for (size_t y = 0; y < rows; ++y) {
+        std::uint8_t* d = dst + y * stride;
+        for (size_t i = 0; i < vbytes; i += 16) {
+            const __m128i* s = reinterpret_cast<const __m128i*>(sums + i);
+            const __m128i a0 = averageSSE2(_mm_loadu_si128(s), mul, half);
+            const __m128i a1 = averageSSE2(_mm_loadu_si128(s + 1), mul, half);
+            const __m128i a2 = averageSSE2(_mm_loadu_si128(s + 2), mul, half);
+            const __m128i a3 = averageSSE2(_mm_loadu_si128(s + 3), mul, half);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(d + i),
+                    _mm_packus_epi16(_mm_packs_epi32(a0, a1),
+                        _mm_packs_epi32(a2, a3)));
+        }
+
+        if (y + radius + 1 < rows) {
+            accumulateSSE2<true>(sums, src + (y + radius + 1) * stride,
+                    vbytes);
+        }
+        if (y >= radius) {
+            accumulateSSE2<false>(sums, src + (y - radius) * stride, vbytes);
+        }
+    }
+}
+
+/// Transform one premultiplied pixel with the columns of a color matrix.
+__attribute__((target("sse2")))
+inline void
+colorMatrixPixelSSE2(std::uint8_t* p, const __m128i zero,
+        const __m128* cols, __m128 offset)
+{
+    std::int32_t v;
+    std::memcpy(&v, p, 4);
+    const __m128 c = _mm_cvtepi32_ps(_mm_unpacklo_epi16(
+                _mm_unpacklo_epi8(_mm_cvtsi32_si128(v), zero), zero));
+
+    const __m128 alphaLane = _mm_castsi128_ps(_mm_set_epi32(-1, 0, 0, 0));
+
+    // Unpremultiply the colors; transparent pixels have none.
+    const __m128 a = _mm_shuffle_ps(c, c, 0xff);
+    const __m128 opaque = _mm_cmpneq_ps(a, _mm_setzero_ps());
+    const __m128 k = _mm_and_ps(opaque, _mm_div_ps(_mm_set1_ps(255.0f), a));
+    const __m128 u = _mm_mul_ps(c, _mm_or_ps(
+                _mm_and_ps(alphaLane, _mm_set1_ps(1.0f)),
+                _mm_andnot_ps(alphaLane, k)));
+
+    __m128 r = offset;
+    r = _mm_add_ps(r, _mm_mul_ps(cols[0], _mm_shuffle_ps(u, u, 0x00)));
+    r = _mm_add_ps(r, _mm_mul_ps(cols[1], _mm_shuffle_ps(u, u, 0x55)));
+    r = _mm_add_ps(r, _mm_mul_ps(cols[2], _mm_shuffle_ps(u, u, 0xaa)));
+    r = _mm_add_ps(r, _mm_mul_ps(cols[3], _mm_shuffle_ps(u, u, 0xff)));
+    r = _mm_min_ps(_mm_max_ps(r, _mm_setzero_ps()), _mm_set1_ps(255.0f));
+
+    // Premultiply by the new alpha.
+    const __m128 na = _mm_shuffle_ps(r, r, 0xff);
+    const __m128 scaled = _mm_mul_ps(r, _mm_div_ps(na, _mm_set1_ps(255.0f)));
+    r = _mm_or_ps(_mm_and_ps(alphaLane, r), _mm_andnot_ps(alphaLane, scaled));
+
+    const __m128i i = _mm_cvtps_epi32(r);
+    v = _mm_cvtsi128_si32(_mm_packus_epi16(_mm_packs_epi32(i, zero), zero));
+    std::memcpy(p, &v, 4);
+}
+
+__attribute__((target("sse2")))
+void
+colorMatrixSSE2(std::uint8_t* p, size_t pixels, const float* m)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128 cols[4] = {
+        _mm_setr_ps(m[0], m[5], m[10], m[15]),
+        _mm_setr_ps(m[1], m[6], m[11], m[16]),
+        _mm_setr_ps(m[2], m[7], m[12], m[17]),
+        _mm_setr_ps(m[3], m[8], m[13], m[18])
+    };
+    const __m128 offset = _mm_setr_ps(m[4], m[9], m[14], m[19]);
+
+    for (; pixels; --pixels, p += 4) {
+        colorMatrixPixelSSE2(p, zero, cols, offset);
+    }
+}
+
+#endif // GNASH_SIMD_X86
+
+inline float
+clampColor(float c)
+{
+    return std::min(std::max(c, 0.0f), 255.0f);
+}
+
+void
+colorMatrixScalar(std::uint8_t* p, size_t pixels, const float* m)
+{
+    for (; pixels; --pixels, p += 4) {
+        const float a = p[3];
+        const float k = a ? 255.0f / a : 0.0f;
+        const float u[4] = { p[0] * k, p[1] * k, p[2] * k, a };
+
+        float r[4];
+        for (size_t i = 0; i < 4; ++i) {
+            const float* row = m + i * 5;
+            r[i] = clampColor(row[0] * u[0] + row[1] * u[1] + row[2] * u[2] +
+                    row[3] * u[3] + row[4]);
+        }
+        for (size_t i = 0; i < 3; ++i) {
+            p[i] = std::lround(r[i] * r[3] / 255.0f);
+        }
+        p[3] = std::lround(r[3]);
+    }
+}
+
+/// Blur down the columns of an image.
+void
+blurColumns(simd::Level level, const std::uint8_t* src, std::uint8_t* dst,
+        size_t rowBytes, size_t rows, unsigned radius)
+{
+    const size_t strips = (rowBytes + stripBytes - 1) / stripBytes;
+
+    RenderWorkers::pool().run(strips, [&](size_t strip) {
+        const size_t begin = strip * stripBytes;
+        const size_t bytes = std::min(stripBytes, rowBytes - begin);
+        std::uint32_t sums[stripBytes];
+
+        switch (level) {
+#ifdef GNASH_SIMD_X86
+            case simd::LEVEL_AVX2:
+            case simd::LEVEL_SSE2:
+                blurStripSSE2(src + begin, dst + begin, bytes, rows,
+                        rowBytes, radius, sums);
+                return;
+#endif
+            default:
+                blurStripScalar(src + begin, dst + begin, bytes, rows,
+                        rowBytes, radius, sums);
+        }
+    });
+}
+
+/// Blur down the columns a number of times.
+//
+/// @return     a or b, whichever holds the result.
+std::uint8_t*
+blurPasses(simd::Level level, std::uint8_t* a, std::uint8_t* b,
+        size_t rowBytes, size_t rows, unsigned radius, unsigned passes)
+{
+    for (unsigned i = 0; i < passes; ++i) {
+        blurColumns(level, a, b, rowBytes, rows, radius);
+        std::swap(a, b);
+    }
+    return a;
+}
+
+/// A pixel of some bytes, copied as a whole.
+template<size_t N>
+struct Pixel
+{
+    std::uint8_t c[N];
+};
+
+/// Turn the rows of an image into columns.
+template<size_t N>
+void
+transpose(const std::uint8_t* src, std::uint8_t* dst, size_t width,
+        size_t height)
+{
+    const Pixel<N>* s = reinterpret_cast<const Pixel<N>*>(src);
+    Pixel<N>* d = reinterpret_cast<Pixel<N>*>(dst);
+
+    inBands(height, [&](size_t begin, size_t end) {
+        for (size_t x = 0; x < width; ++x) {
+            for (size_t y = begin; y < end; ++y) {
+                d[x * height + y] = s[y * width + x];
+            }
+        }
+    });
+}
+
+void
+transpose(size_t channels, const std::uint8_t* src, std::uint8_t* dst,
+        size_t width, size_t height)
+{
+    if (channels == 4) transpose<4>(src, dst, width, height);
+    else transpose<1>(src, dst, width, height);
+}
+
+/// Where an effect is drawn, compared to the object it is made from.
+enum Placement
+{
+    PLACE_INSIDE,
+    PLACE_OUTSIDE,
+    PLACE_ALL
+};
+
+/// Combine an effect with a pixel of the object.
+//
+/// Effects inside the object are drawn over it and keep its alpha,
+/// while those outside are drawn behind it. Knocked out objects are
+/// only used to place the effect.
+///
+/// @param e    The premultiplied color of the effect.
+inline void
+composite(std::uint8_t* p, const unsigned* e, Placement where,
+        bool knockout)
+{
+    const unsigned sa = p[3];
+    const unsigned mask = where == PLACE_INSIDE ? sa :
+        where == PLACE_OUTSIDE ? 255 - sa : 255;
+
+    unsigned m[4];
+    for (size_t i = 0; i < 4; ++i) m[i] = mul255(e[i], mask);
+
+    if (knockout) {
+        for (size_t i = 0; i < 4; ++i) p[i] = m[i];
+        return;
+    }
+
+    if (where == PLACE_OUTSIDE) {
+        for (size_t i = 0; i < 4; ++i) p[i] = std::min(p[i] + m[i], 255u);
+        return;
+    }
+
+    for (size_t i = 0; i < 3; ++i) {
+        p[i] = std::min(m[i] + mul255(p[i], 255 - e[3]), 255u);
+    }
+    if (where == PLACE_ALL) {
+        p[3] = std::min(e[3] + mul255(sa, 255 - e[3]), 255u);
+    }
+}
+
+/// The strength of an effect, in 8.8 fixed point.
+inline unsigned
+fixedStrength(float strength)
+{
+    return std::lround(std::min(std::max(strength, 0.0f), 255.0f) * 256);
+}
+
+inline unsigned
+strengthen(int v, unsigned strength)
+{
+    return v <= 0 ? 0 : std::min((v * strength + 128) >> 8, 255u);
+}
+
+/// The parameters shared by glows and drop shadows.
+struct Shadow
+{
+    std::uint32_t color;
+    std::uint8_t alpha;
+    float blurX;
+    float blurY;
+    float strength;
+    unsigned passes;
+    bool inner;
+    bool knockout;
+    bool hideObject;
+    float distance;
+    float angle;
+};
+
+/// Draw a glow or a drop shadow.
+//
+/// The object's alpha, or its inverse for inner shadows, is offset,
+/// blurred and strengthened to give the coverage of the shadow.
+void
+shadow(simd::Level level, std::uint8_t* p, size_t width, size_t height,
+        const Shadow& s, double xscale, double yscale)
+{
+    const std::ptrdiff_t dx = std::lround(s.distance * std::cos(s.angle) *
+            xscale);
+    const std::ptrdiff_t dy = std::lround(s.distance * std::sin(s.angle) *
+            yscale);
+    const std::ptrdiff_t w = width;
+    const std::ptrdiff_t h = height;
+
+    std::vector<std::uint8_t> plane(width * height);
+
+    inBands(height, [&](size_t begin, size_t end) {
+        for (std::ptrdiff_t y = begin; y < static_cast<std::ptrdiff_t>(end);
+                ++y) {
+            std::uint8_t* out = &plane[y * width];
+            const std::ptrdiff_t sy = y - dy;
+            for (std::ptrdiff_t x = 0; x < w; ++x) {
+                const std::ptrdiff_t sx = x - dx;
+                const unsigned a = (sx >= 0 && sx < w && sy >= 0 && sy < h) ?
+                    p[(sy * w + sx) * 4 + 3] : 0;
+                out[x] = s.inner ? 255 - a : a;
+            }
+        }
+    });
+
+    boxBlur(level, &plane.front(), width, height, 1,
+            blurRadius(s.blurX, xscale), blurRadius(s.blurY, yscale),
+            s.passes);
+
+    const unsigned strength = fixedStrength(s.strength);
+    const unsigned rgb[3] = {
+        (s.color >> 16) & 0xff, (s.color >> 8) & 0xff, s.color & 0xff
+    };
+    const Placement where = s.inner ? PLACE_INSIDE : PLACE_OUTSIDE;
+
+    inBands(height, [&](size_t begin, size_t end) {
+        for (size_t i = begin * width; i < end * width; ++i) {
+            const unsigned g = mul255(strengthen(plane[i], strength),
+                    s.alpha);
+            const unsigned e[4] = {
+                mul255(rgb[0], g), mul255(rgb[1], g), mul255(rgb[2], g), g
+            };
+            std::uint8_t* px = p + i * 4;
+            if (s.hideObject && !s.inner) {
+                for (size_t c = 0; c < 4; ++c) px[c] = e[c];
+            }
+            else composite(px, e, where, s.knockout || s.hideObject);
+        }
+    });
+}
+
+/// Draw a bevel.
+//
+/// The object's blurred alpha is compared with itself offset towards and
+/// away from the light. The shadow goes where the side away from the
+/// light is more opaque, and the highlight where the other is.
+void
+bevel(simd::Level level, std::uint8_t* p, size_t width, size_t height,
+        const BevelFilter& b, double xscale, double yscale)
+{
+    const std::ptrdiff_t dx = std::lround(b.m_distance *
+            std::cos(b.m_angle) * xscale);
+    const std::ptrdiff_t dy = std::lround(b.m_distance *
+            std::sin(b.m_angle) * yscale);
+    const std::ptrdiff_t w = width;
+    const std::ptrdiff_t h = height;
+
+    std::vector<std::uint8_t> plane(width * height);
+    for (size_t i = 0; i < plane.size(); ++i) plane[i] = p[i * 4 + 3];
+
+    boxBlur(level, &plane.front(), width, height, 1,
+            blurRadius(b.m_blurX, xscale), blurRadius(b.m_blurY, yscale),
+            b.m_quality);
+
+    const auto at = [&](std::ptrdiff_t x, std::ptrdiff_t y) -> int {
+        return (x >= 0 && x < w && y >= 0 && y < h) ? plane[y * w + x] : 0;
+    };
+
+    const unsigned strength = fixedStrength(b.m_strength);
+    const std::uint32_t hc = b.m_highlightColor;
+    const std::uint32_t sc = b.m_shadowColor;
+    const Placement where = b.m_type == BevelFilter::INNER_BEVEL ?
+        PLACE_INSIDE : b.m_type == BevelFilter::OUTER_BEVEL ?
+        PLACE_OUTSIDE : PLACE_ALL;
+
+    inBands(height, [&](size_t begin, size_t end) {
+        for (std::ptrdiff_t y = begin; y < static_cast<std::ptrdiff_t>(end);
+                ++y) {
+            for (std::ptrdiff_t x = 0; x < w; ++x) {
+                const int diff = at(x - dx, y - dy) - at(x + dx, y + dy);
+                const unsigned sg = mul255(strengthen(diff, strength),
+                        b.m_shadowAlpha);
+                const unsigned hg = mul255(strengthen(-diff, strength),
+                        b.m_highlightAlpha);
+
+                // Only one of them is not 0.
+                const unsigned e[4] = {
+                    mul255((hc >> 16) & 0xff, hg) +
+                        mul255((sc >> 16) & 0xff, sg),
+                    mul255((hc >> 8) & 0xff, hg) +
+                        mul255((sc >> 8) & 0xff, sg),
+                    mul255(hc & 0xff, hg) + mul255(sc & 0xff, sg),
+                    hg + sg
+                };
+                composite(p + (y * w + x) * 4, e, where, b.m_knockout);
+            }
+        }
+    });
+}
+
+} // anonymous namespace
+
+void
+boxBlur(simd::Level level, std::uint8_t* p, size_t width, size_t height,
+        size_t channels, unsigned radiusX, unsigned radiusY, unsigned passes)
+{
+    assert(channels == 1 || channels == 4);
+
+    if (!passes || !width || !height || (!radiusX && !radiusY)) return;
+
+    const size_t rowBytes = width * channels;
+    const size_t size = rowBytes * height;
+    std::vector<std::uint8_t> tmp(size);
+
+    if (radiusY) {
+        const std::uint8_t* r = blurPasses(level, p, &tmp.front(), rowBytes,
+                height, radiusY, passes);
+        if (r != p) std::copy(r, r + size, p);
+    }
+
+    if (radiusX) {
+        std::vector<std::uint8_t> transposed(size);
+        transpose(channels, p, &transposed.front(), width, height);
+        const std::uint8_t* r = blurPasses(level, &transposed.front(),
+                &tmp.front(), height * channels, width, radiusX, passes);
+        transpose(channels, r, p, height, width);
+    }
+}
+
+void
+colorMatrix(simd::Level level, std::uint8_t* p, size_t pixels,
+        const float* matrix)
+{
+    // Share out runs of 256 pixels as if they were rows.
+    const size_t run = 256;
+    inBands((pixels + run - 1) / run, [&](size_t begin, size_t end) {
+        std::uint8_t* start = p + begin * run * 4;
+        const size_t count = std::min(pixels, end * run) - begin * run;
+
+        switch (level) {
+#ifdef GNASH_SIMD_X86
+            case simd::LEVEL_AVX2:
+            case simd::LEVEL_SSE2:
+                colorMatrixSSE2(start, count, matrix);
+                return;
+#endif
+            default:
+                colorMatrixScalar(start, count, matrix);
+        }
+    });
+}
+
+unsigned
+blurRadius(float blur, double scale)
+{
+    // A box of 2 * radius + 1 pixels is nearest to the width.
+    const double box = blur * scale;
+    return box > 1 ? std::lround((box - 1) / 2) : 0;
+}
+
+void
+applyFilters(simd::Level level, image::GnashImage& im,
+        const Filters& filters, double xscale, double yscale)
+{
+    assert(im.type() == image::TYPE_RGBA);
+    assert(im.stride() == im.width() * 4);
+
+    std::uint8_t* p = im.begin();
+    const size_t width = im.width();
+    const size_t height = im.height();
+
+    for (const std::shared_ptr<BitmapFilter>& f : filters) {
+        const BitmapFilter* filter = f.get();
+
+        if (const BlurFilter* b = dynamic_cast<const BlurFilter*>(filter)) {
+            boxBlur(level, p, width, height, 4,
+                    blurRadius(b->m_blurX, xscale),
+                    blurRadius(b->m_blurY, yscale), b->m_quality);
+        }
+        else if (const ColorMatrixFilter* c =
+                dynamic_cast<const ColorMatrixFilter*>(filter)) {
+            if (c->matrix().size() == 20) {
+                colorMatrix(level, p, width * height, &c->matrix().front());
+            }
+        }
+        else if (const GlowFilter* g =
+                dynamic_cast<const GlowFilter*>(filter)) {
+            const Shadow s = { g->m_color, g->m_alpha, g->m_blurX,
+                g->m_blurY, g->m_strength, g->m_quality, g->m_inner,
+                g->m_knockout, false, 0, 0 };
+            shadow(level, p, width, height, s, xscale, yscale);
+        }
+        else if (const DropShadowFilter* d =
+                dynamic_cast<const DropShadowFilter*>(filter)) {
+            const Shadow s = { d->m_color, d->m_alpha, d->m_blurX,
+                d->m_blurY, d->m_strength, d->m_quality, d->m_inner,
+                d->m_knockout, d->m_hideObject, d->m_distance, d->m_angle };
+            shadow(level, p, width, height, s, xscale, yscale);
+        }
+        else if (const BevelFilter* b =
+                dynamic_cast<const BevelFilter*>(filter)) {
+            bevel(level, p, width, height, *b, xscale, yscale);
+        }
+        else {
+            LOG_ONCE(log_unimpl(_("Gradient glow, gradient bevel and "
+                            "convolution filters")));
+        }
+    }
+}
+
+} // namespace gnash
@@ -0,0 +1,94 @@
+// BitmapFilters.h: bitmap filters applied to offscreen images, for Gnash.
+//
+//   Copyright (C) 2012 Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifndef GNASH_BITMAPFILTERS_H
+#define GNASH_BITMAPFILTERS_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "SimdBlend.h"
+#include "filter_factory.h"
+#include "dsodefs.h" // for DSOEXPORT
+
+namespace gnash {
+    namespace image {
+        class GnashImage;
+    }
+}
+
+namespace gnash {
+
+/// Blur an image with a box filter, a number of times.
+//
+/// Each pass averages every pixel with the radius pixels on each side,
+/// first down the columns and then along the rows. Pixels beyond the
+/// image are transparent. Several passes approach a gaussian blur.
+///
+/// The result is the same at any level. The work is shared by the
+/// RenderWorkers.
+///
+/// @param level    The instructions to use. Levels the processor does not
+///                 support must not be used.
+/// @param p        The first byte of the image, whose rows follow each
+///                 other without padding.
+/// @param width    The width of the image in pixels.
+/// @param height   The height of the image in pixels.
+/// @param channels The number of bytes per pixel, 1 or 4.
+/// @param radiusX  The radius of the blur along the rows.
+/// @param radiusY  The radius of the blur down the columns.
+/// @param passes   The number of times to blur.
+DSOEXPORT void boxBlur(simd::Level level, std::uint8_t* p, size_t width,
+        size_t height, size_t channels, unsigned radiusX, unsigned radiusY,
+        unsigned passes);
+
+/// Transform the colors of premultiplied RGBA pixels with a 4x5 matrix.
+//
+/// The matrix applies to unpremultiplied colors from 0 to 255, as in
+/// ColorMatrixFilter. The levels may round differently by one.
+///
+/// @param level    The instructions to use.
+/// @param p        The first pixel.
+/// @param pixels   The number of pixels.
+/// @param matrix   The 20 values of the matrix, row by row.
+DSOEXPORT void colorMatrix(simd::Level level, std::uint8_t* p,
+        size_t pixels, const float* matrix);
+
+/// The radius of a box blur for an amount of blur given by a filter.
+//
+/// @param blur     The width of the blur in movie pixels.
+/// @param scale    The number of image pixels per movie pixel.
+DSOEXPORT unsigned blurRadius(float blur, double scale);
+
+/// Apply filters to a premultiplied RGBA image.
+//
+/// Blurs, color matrices, glows, drop shadows and bevels are applied.
+/// Gradient glows, gradient bevels and convolutions are not implemented,
+/// and are skipped.
+///
+/// @param level    The instructions to use.
+/// @param im       The image, which must be of TYPE_RGBA.
+/// @param filters  The filters to apply, in order.
+/// @param xscale   The number of image pixels per movie pixel across.
+/// @param yscale   The number of image pixels per movie pixel down.
+DSOEXPORT void applyFilters(simd::Level level, image::GnashImage& im,
+        const Filters& filters, double xscale, double yscale);
+
+} // namespace gnash
+
+#endif
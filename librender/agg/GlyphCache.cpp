@@ -0,0 +1,137 @@
+// GlyphCache.cpp: coverage of glyphs packed into an atlas, for Gnash.
+//
+//   Copyright (C) 2012 Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#include "GlyphCache.h"
+
+#include <tuple>
+#include <cmath>
+#include <cstring>
+#include <cassert>
+
+#include "SWFMatrix.h"
+
+namespace gnash {
+
+namespace {
+
+/// The height of the shelf for a glyph, so that glyphs of similar sizes
+/// share them.
+inline int
+shelfHeight(int height)
+{
+    return (height + 3) & ~3;
+}
+
+} // anonymous namespace
+
+bool
+GlyphCache::Key::operator<(const Key& o) const
+{
+    return std::tie(hash, a, d, x, y) < std::tie(o.hash, o.a, o.d, o.x, o.y);
+}
+
+GlyphCache::GlyphCache(int size)
+    :
+    _size(size)
+{
+}
+
+bool
+GlyphCache::key(std::uint64_t hash, const SWFMatrix& mat, Key& key,
+        point& origin)
+{
+    if (mat.b() || mat.c()) return false;
+
+    // The twips in each part of a pixel.
+    const double part = 20.0 / subpixels;
+
+    const std::int32_t x = std::floor(mat.tx() / part);
+    const std::int32_t y = std::floor(mat.ty() / part);
+    origin = point(std::floor(x / static_cast<double>(subpixels)),
+            std::floor(y / static_cast<double>(subpixels)));
+
+    key.hash = hash;
+    key.a = mat.a();
+    key.d = mat.d();
+    key.x = x - origin.x * subpixels;
+    key.y = y - origin.y * subpixels;
+    return true;
+}
+
+const GlyphCache::Glyph*
+GlyphCache::find(const Key& key, const std::vector<Path>& paths) const
+{
+    const auto it = _glyphs.find(key);
+    if (it == _glyphs.end()) return nullptr;
+    if (!geometry::samePaths(it->second.source, paths)) return nullptr;
+    return &it->second.glyph;
+}
+
+GlyphCache::Glyph*
+GlyphCache::insert(const Key& key, const std::vector<Path>& paths, int left,
+        int top, int width, int height)
+{
+    assert(width > 0 && height > 0);
+    if (width > maxSize() || height > maxSize()) return nullptr;
+
+    if (!_atlas) _atlas.reset(new std::uint8_t[_size * _size]);
+
+    const int shelf = shelfHeight(height);
+
+    Shelf* found = nullptr;
+    for (Shelf& s : _shelves) {
+        if (s.height == shelf && s.width + width <= _size) {
+            found = &s;
+            break;
+        }
+    }
+
+    if (!found) {
+        const int y = _shelves.empty() ? 0 :
+            _shelves.back().y + _shelves.back().height;
+        if (y + shelf > _size) {
+            clear();
+            return insert(key, paths, left, top, width, height);
+        }
+        const Shelf s = { y, shelf, 0 };
+        _shelves.push_back(s);
+        found = &_shelves.back();
+    }
+
+    const Glyph g = { found->width, found->y, width, height, left, top };
+    found->width += width;
+
+    // Glyphs with the same key but other paths are replaced.
+    Entry& e = _glyphs[key];
+    e.glyph = g;
+    e.source = paths;
+
+    for (int i = 0; i < height; ++i) {
+        std::memset(row(e.glyph, i), 0, width);
+    }
+    return &e.glyph;
+}
+
+void
+GlyphCache::clear()
+{
+    _shelves.clear();
+    _glyphs.clear();
+}
+
+} // namespace gnash
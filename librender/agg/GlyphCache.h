@@ -0,0 +1,166 @@
+// GlyphCache.h: coverage of glyphs packed into an atlas, for Gnash.
+//
+//   Copyright (C) 2012 Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifndef GNASH_GLYPHCACHE_H
+#define GNASH_GLYPHCACHE_H
+
+#include <map>
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <boost/noncopyable.hpp>
+
+#include "Geometry.h"
+#include "Point2d.h"
+#include "dsodefs.h" // for DSOEXPORT
+
+namespace gnash {
+    class SWFMatrix;
+}
+
+namespace gnash {
+
+/// The coverage of recently drawn glyphs, packed into an atlas.
+//
+/// Text is drawn again on every redraw of a text field, although its
+/// glyphs rarely change. A glyph's coverage of the pixels it is drawn to
+/// only depends on its outline, its scale and where it starts within a
+/// pixel, so it is kept for those and drawn with any color. Glyphs are
+/// found by a hash of their outline, and keep the outline itself, so
+/// that outlines with the same hash are never confused.
+///
+/// Glyphs are packed into rows of the atlas by their height. When the
+/// atlas is full, it is emptied.
+class DSOEXPORT GlyphCache : boost::noncopyable
+{
+public:
+
+    /// Where a glyph starts within a pixel, in quarters of it.
+    static const int subpixels = 4;
+
+    /// A glyph drawn with a certain matrix.
+    struct Key
+    {
+        std::uint64_t hash;
+        std::int32_t a, d;
+        std::uint8_t x, y;
+        bool operator<(const Key& o) const;
+    };
+
+    /// The place of a glyph in the atlas.
+    struct Glyph
+    {
+        /// The top left pixel of the glyph in the atlas.
+        int x, y;
+
+        int width, height;
+
+        /// The top left pixel of the glyph from the pixel it starts in.
+        int left, top;
+    };
+
+    /// @param size     The width and height of the atlas.
+    explicit GlyphCache(int size = 1024);
+
+    /// Get the key of a glyph, if it can be cached.
+    //
+    /// Only glyphs that are scaled, not rotated or skewed, are cached.
+    ///
+    /// @param hash     The content hash of the glyph's shape.
+    /// @param mat      The matrix from twips to device twips.
+    /// @param key      Receives the key.
+    /// @param origin   Receives the pixel the glyph starts in.
+    /// @return         Whether the glyph can be cached.
+    static bool key(std::uint64_t hash, const SWFMatrix& mat, Key& key,
+            point& origin);
+
+    /// Find a glyph with the paths it was drawn from, or return nullptr.
+    const Glyph* find(const Key& key, const std::vector<Path>& paths) const;
+
+    /// Make room for a glyph, emptying the atlas if it is full.
+    //
+    /// The coverage of its pixels is zero.
+    ///
+    /// @param paths    The untransformed paths of the glyph.
+    /// @param left     The left pixel of the glyph from its origin.
+    /// @param top      The top pixel of the glyph from its origin.
+    /// @param width    The width of the glyph, at least one pixel.
+    /// @param height   The height of the glyph, at least one pixel.
+    /// @return     The place of the glyph, or nullptr if it is larger
+    ///             than maxSize().
+    Glyph* insert(const Key& key, const std::vector<Path>& paths, int left,
+            int top, int width, int height);
+
+    /// The largest width and height of glyphs cached.
+    int maxSize() const {
+        return _size / 16;
+    }
+
+    /// The coverage of a row of a glyph.
+    std::uint8_t* row(const Glyph& glyph, int y) {
+        return _atlas.get() + (glyph.y + y) * _size + glyph.x;
+    }
+
+    const std::uint8_t* row(const Glyph& glyph, int y) const {
+        return _atlas.get() + (glyph.y + y) * _size + glyph.x;
+    }
+
+    /// The number of bytes between rows of the atlas.
+    size_t stride() const {
+        return _size;
+    }
+
+    /// The number of glyphs cached.
+    size_t size() const {
+        return _glyphs.size();
+    }
+
+    void clear();
+
+private:
+
+    /// A row of glyphs of at most its height.
+    struct Shelf
+    {
+        int y;
+        int height;
+
+        /// The width used.
+        int width;
+    };
+
+    struct Entry
+    {
+        Glyph glyph;
+
+        /// The paths the glyph was drawn from.
+        std::vector<Path> source;
+    };
+
+    const int _size;
+
+    std::unique_ptr<std::uint8_t[]> _atlas;
+
+    std::vector<Shelf> _shelves;
+
+    std::map<Key, Entry> _glyphs;
+};
+
+} // namespace gnash
+
+#endif
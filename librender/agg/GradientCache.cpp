@@ -0,0 +1,121 @@
+// GradientCache.cpp: gradient lookup tables kept across frames, for Gnash.
+//
+//   Copyright (C) 2012 Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#include "GradientCache.h"
+
+#include <cassert>
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#include <agg_gradient_lut.h>
+#pragma GCC diagnostic pop
+
+#include "LinearRGB.h"
+#include "FillStyle.h"
+#include "SWFCxForm.h"
+#include "RGBA.h"
+
+namespace gnash {
+
+namespace {
+
+/// Interpolate the records of a gradient and premultiply the result.
+template<typename Interpolator>
+void
+buildLut(GradientCache::Lut& lut, const GradientFill& fs,
+        const SWFCxForm& cx)
+{
+    agg::gradient_lut<Interpolator, 256> colors;
+
+    // It is essential that at least two colours are added; otherwise agg
+    // will use uninitialized values.
+    assert(fs.recordCount() > 1);
+
+    for (const GradientRecord& gr : fs.getRecords()) {
+        const rgba tr = cx.transform(gr.color);
+        colors.add_color(gr.ratio / 255.0,
+                agg::rgba8(tr.m_r, tr.m_g, tr.m_b, tr.m_a));
+    }
+    colors.build_lut();
+
+    for (size_t i = 0; i < lut.size(); ++i) {
+        lut[i] = colors[i];
+        lut[i].premultiply();
+    }
+}
+
+} // anonymous namespace
+
+GradientCache::GradientCache(size_t limit)
+    :
+    _limit(limit)
+{
+}
+
+std::shared_ptr<const GradientCache::Lut>
+GradientCache::get(const GradientFill& fs, const SWFCxForm& cx)
+{
+    Key key;
+    key.reserve(fs.recordCount() + 1);
+    key.push_back(fs.interpolation);
+    for (const GradientRecord& gr : fs.getRecords()) {
+        const rgba tr = cx.transform(gr.color);
+        key.push_back(std::uint64_t(gr.ratio) << 32 |
+                std::uint32_t(tr.m_r) << 24 | tr.m_g << 16 | tr.m_b << 8 |
+                tr.m_a);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        const auto it = _index.find(key);
+        if (it != _index.end()) {
+            _entries.splice(_entries.begin(), _entries, it->second);
+            return it->second->second;
+        }
+    }
+
+    // Build outside the lock so that other lookups are not held up.
+    std::shared_ptr<Lut> lut(new Lut);
+    if (fs.interpolation == GradientFill::LINEAR_RGB) {
+        buildLut<linear_rgb_interpolator<agg::rgba8> >(*lut, fs, cx);
+    }
+    else buildLut<agg::color_interpolator<agg::rgba8> >(*lut, fs, cx);
+
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    // Another thread may have built the same table meanwhile.
+    const auto it = _index.find(key);
+    if (it != _index.end()) return it->second->second;
+
+    _entries.emplace_front(key, lut);
+    _index[key] = _entries.begin();
+
+    while (_entries.size() > _limit) {
+        _index.erase(_entries.back().first);
+        _entries.pop_back();
+    }
+    return lut;
+}
+
+size_t
+GradientCache::size() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _entries.size();
+}
+
+} // namespace gnash
@@ -0,0 +1,87 @@
+// GradientCache.h: gradient lookup tables kept across frames, for Gnash.
+//
+//   Copyright (C) 2012 Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifndef GNASH_GRADIENTCACHE_H
+#define GNASH_GRADIENTCACHE_H
+
+#include <array>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <cstdint>
+#include <boost/noncopyable.hpp>
+#include <agg_color_rgba.h>
+
+#include "dsodefs.h" // for DSOEXPORT
+
+namespace gnash {
+    class GradientFill;
+    class SWFCxForm;
+}
+
+namespace gnash {
+
+/// The most recently used gradient lookup tables of a renderer.
+//
+/// Building a table means interpolating 256 colors, which is a waste
+/// when the same gradient is drawn every frame. Tables are identified by
+/// the color transformed records and the interpolation mode, so any
+/// gradients that look the same share one.
+//
+/// Lookups may come from several threads at once.
+class DSOEXPORT GradientCache : boost::noncopyable
+{
+public:
+
+    /// The premultiplied colors of a gradient from ratio 0 to 255.
+    typedef std::array<agg::rgba8, 256> Lut;
+
+    /// @param limit    The number of tables to keep.
+    explicit GradientCache(size_t limit = 256);
+
+    /// Get the table for a gradient, building it if it is not cached.
+    //
+    /// The table stays valid for as long as it is held, even if the
+    /// cache drops it.
+    std::shared_ptr<const Lut> get(const GradientFill& fs,
+            const SWFCxForm& cx);
+
+    /// The number of tables cached.
+    size_t size() const;
+
+private:
+
+    typedef std::vector<std::uint64_t> Key;
+
+    typedef std::list<std::pair<Key, std::shared_ptr<const Lut> > > Entries;
+
+    const size_t _limit;
+
+    mutable std::mutex _mutex;
+
+    /// The tables, most recently used first.
+    Entries _entries;
+
+    std::map<Key, Entries::iterator> _index;
+};
+
+} // namespace gnash
+
+#endif
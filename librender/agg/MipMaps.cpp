@@ -0,0 +1,138 @@
+// MipMaps.cpp: bitmaps at halved sizes for drawing them scaled down.
+//
+//   Copyright (C) 2012 Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#include "MipMaps.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cassert>
+
+#include "GnashImage.h"
+#include "SWFMatrix.h"
+
+namespace gnash {
+
+MipMaps::MipMaps()
+{
+}
+
+std::shared_ptr<const image::GnashImage>
+MipMaps::select(const std::shared_ptr<const image::GnashImage>& base,
+        SWFMatrix& mat, bool smooth)
+{
+    assert(base);
+
+    const size_t level = mipLevel(mat);
+    if (!level) return base;
+
+    std::shared_ptr<const image::GnashImage> im;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        std::vector<std::shared_ptr<const image::GnashImage> >& levels =
+            _levels[smooth];
+
+        // Images of a single pixel are not halved any further.
+        while (levels.size() < level) {
+            const image::GnashImage& last =
+                levels.empty() ? *base : *levels.back();
+            if (last.width() == 1 && last.height() == 1) break;
+            levels.push_back(
+                    std::shared_ptr<const image::GnashImage>(
+                        halve(last, smooth)));
+        }
+        if (levels.empty()) return base;
+        im = levels[std::min(level, levels.size()) - 1];
+    }
+
+    SWFMatrix scale;
+    scale.set_scale(static_cast<double>(im->width()) / base->width(),
+            static_cast<double>(im->height()) / base->height());
+    scale.concatenate(mat);
+    mat = scale;
+    return im;
+}
+
+void
+MipMaps::clear()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _levels[0].clear();
+    _levels[1].clear();
+}
+
+size_t
+MipMaps::memoryUsage() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    size_t bytes = 0;
+    for (const auto& levels : _levels) {
+        for (const auto& im : levels) bytes += im->size();
+    }
+    return bytes;
+}
+
+size_t
+mipLevel(const SWFMatrix& mat)
+{
+    // The pixels of the bitmap covered by a step along either axis of the
+    // device. A bitmap stretched one way is halved as far as the other
+    // allows, as it would be blurred otherwise.
+    const double scale = std::min(mat.get_x_scale(), mat.get_y_scale());
+    if (!(scale >= 2)) return 0;
+    return static_cast<size_t>(std::floor(std::log2(scale)));
+}
+
+std::unique_ptr<image::GnashImage>
+halve(const image::GnashImage& im, bool average)
+{
+    const size_t width = (im.width() + 1) / 2;
+    const size_t height = (im.height() + 1) / 2;
+    const size_t channels = im.channels();
+
+    std::unique_ptr<image::GnashImage> half;
+    if (im.type() == image::TYPE_RGBA) {
+        half.reset(new image::ImageRGBA(width, height));
+    }
+    else {
+        half.reset(new image::ImageRGB(width, height));
+    }
+
+    for (size_t y = 0; y < height; ++y) {
+
+        // The last row and column of odd sizes are used twice.
+        const image::GnashImage::const_iterator top =
+            scanline(im, 2 * y);
+        const image::GnashImage::const_iterator bottom =
+            scanline(im, std::min(2 * y + 1, im.height() - 1));
+        image::GnashImage::iterator out = scanline(*half, y);
+
+        for (size_t x = 0; x < width; ++x) {
+            const size_t left = 2 * x * channels;
+            const size_t right =
+                std::min(2 * x + 1, im.width() - 1) * channels;
+            for (size_t c = 0; c < channels; ++c) {
+                *out++ = average ? (top[left + c] + top[right + c] +
+                        bottom[left + c] + bottom[right + c] + 2) / 4 :
+                    top[left + c];
+            }
+        }
+    }
+    return half;
+}
+
+} // namespace gnash
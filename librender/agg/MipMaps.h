@@ -0,0 +1,96 @@
+// MipMaps.h: bitmaps at halved sizes for drawing them scaled down.
+//
+//   Copyright (C) 2012 Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifndef GNASH_MIPMAPS_H
+#define GNASH_MIPMAPS_H
+
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <boost/noncopyable.hpp>
+
+#include "dsodefs.h" // for DSOEXPORT
+
+namespace gnash {
+    class SWFMatrix;
+    namespace image {
+        class GnashImage;
+    }
+}
+
+namespace gnash {
+
+/// The images of a bitmap at halved sizes, built when it is first drawn
+/// scaled down.
+//
+/// A bitmap drawn at an eighth of its size is sampled at every eighth
+/// pixel, which misses most of the cache and aliases. Drawing it from an
+/// image of about its size on screen does neither.
+///
+/// Smoothed bitmaps are drawn from images averaging the pixels they
+/// halve, others from images keeping one of them, so that they stay as
+/// sharp as they would be drawn from the bitmap.
+///
+/// Images may be selected from several threads at once.
+class DSOEXPORT MipMaps : boost::noncopyable
+{
+public:
+
+    MipMaps();
+
+    /// Select the image to draw a bitmap from.
+    //
+    /// @param base     The bitmap.
+    /// @param mat      The matrix from the device to the bitmap's pixels.
+    ///                 It is changed to one to the pixels of the image.
+    /// @param smooth   Whether the bitmap is smoothed.
+    /// @return         The bitmap itself or one of its images.
+    std::shared_ptr<const image::GnashImage> select(
+            const std::shared_ptr<const image::GnashImage>& base,
+            SWFMatrix& mat, bool smooth);
+
+    /// Drop all images, as the bitmap changed.
+    void clear();
+
+    /// The number of bytes held by the images.
+    size_t memoryUsage() const;
+
+private:
+
+    mutable std::mutex _mutex;
+
+    /// The images from half the size of the bitmap down, averaged or not.
+    std::vector<std::shared_ptr<const image::GnashImage> > _levels[2];
+};
+
+/// The number of times to halve a bitmap drawn with a matrix.
+//
+/// @param mat  The matrix from the device to the bitmap's pixels.
+DSOEXPORT size_t mipLevel(const SWFMatrix& mat);
+
+/// An image of half the size, rounded up.
+//
+/// @param im       An RGB or RGBA image.
+/// @param average  Whether to average the pixels halved or to keep the
+///                 first of them.
+DSOEXPORT std::unique_ptr<image::GnashImage> halve(
+        const image::GnashImage& im, bool average);
+
+} // namespace gnash
+
+#endif
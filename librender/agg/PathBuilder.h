@@ -0,0 +1,202 @@
+// PathBuilder.h: AGG paths of Gnash paths, for Gnash.
+//
+//   Copyright (C) 2012 Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifndef GNASH_PATHBUILDER_H
+#define GNASH_PATHBUILDER_H
+
+#include <vector>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+#include <agg_path_storage.h>
+
+#include "Geometry.h"
+#include "GnashNumeric.h"
+#include "SWFRect.h"
+#include "SWFMatrix.h"
+#include "PathCache.h" // for AggPaths
+
+namespace gnash {
+
+/// How far, in pixels, the paths of fills and hairlines may be moved to
+/// leave out vertices.
+//
+/// Paths are built on the device, so the smaller a shape is drawn the more
+/// of its vertices are left out. AGG itself flattens curves to within half
+/// a pixel.
+const double pathTolerance = 0.125;
+
+/// Whether a curve strays from the line between its anchors by no more
+/// than a tolerance.
+//
+/// A curve strays furthest in its middle, by half the distance between
+/// its control point and the middle of the line.
+inline bool
+flatCurve(double x0, double y0, double cx, double cy, double x1, double y1,
+        double tolerance)
+{
+    return std::hypot(cx - (x0 + x1) / 2, cy - (y0 + y1) / 2) <=
+        2 * tolerance;
+}
+
+/// Adds edges to an AGG path.
+//
+/// With a tolerance, straight edges ending within it of the last vertex
+/// and curves within it of a line are simplified. The end of the last
+/// edge is only added by finish().
+class EdgeToPath
+{
+
+public:
+    EdgeToPath(AggPaths::value_type& path, double shift = 0,
+            double tolerance = 0)
+        :
+        _path(path),
+        _shift(shift),
+        _tolerance(tolerance),
+        _pending(false),
+        _x(0),
+        _y(0)
+    {}
+
+    void operator()(const Edge& edge)
+    {
+        const double x = twipsToPixels(edge.ap.x) + _shift;
+        const double y = twipsToPixels(edge.ap.y) + _shift;
+
+        if (edge.straight()) {
+            lineTo(x, y);
+            return;
+        }
+
+        const double cx = twipsToPixels(edge.cp.x) + _shift;
+        const double cy = twipsToPixels(edge.cp.y) + _shift;
+
+        finish();
+        if (_tolerance && flatCurve(_path.last_x(), _path.last_y(), cx, cy,
+                    x, y, _tolerance)) {
+            lineTo(x, y);
+            return;
+        }
+        _path.curve3(cx, cy, x, y);
+    }
+
+    /// Add the end of the last edge, if it was left out.
+    void finish()
+    {
+        if (!_pending) return;
+        _path.line_to(_x, _y);
+        _pending = false;
+    }
+
+private:
+
+    void lineTo(double x, double y)
+    {
+        if (_tolerance && std::hypot(x - _path.last_x(),
+                    y - _path.last_y()) <= _tolerance) {
+            _pending = true;
+            _x = x;
+            _y = y;
+            return;
+        }
+        _pending = false;
+        _path.line_to(x, y);
+    }
+
+    agg::path_storage& _path;
+    const double _shift;
+    const double _tolerance;
+
+    /// Whether the end of the last edge was left out.
+    bool _pending;
+    double _x;
+    double _y;
+};
+
+/// In-place transformation of Gnash paths to AGG paths.
+class GnashToAggPath
+{
+public:
+
+    GnashToAggPath(AggPaths& dest, double shift = 0, double tolerance = 0)
+        :
+        _dest(dest),
+        _it(_dest.begin()),
+        _shift(shift),
+        _tolerance(tolerance)
+    {
+    }
+
+    void operator()(const Path& in)
+    {
+        agg::path_storage& p = *_it;
+
+        p.move_to(twipsToPixels(in.ap.x) + _shift, 
+                  twipsToPixels(in.ap.y) + _shift);
+
+        std::for_each(in.m_edges.begin(), in.m_edges.end(),
+                EdgeToPath(p, _shift, _tolerance)).finish();
+        ++_it;
+    }
+
+private:
+    AggPaths& _dest;
+    AggPaths::iterator _it;
+    const double _shift;
+    const double _tolerance;
+
+};
+
+/// Transposes Gnash paths to AGG paths, which can be used for both outlines
+/// and shapes. Subshapes are ignored (ie. all paths are converted). Converts 
+/// TWIPS to pixels on the fly. Vertices are left out within pathTolerance.
+inline void
+buildPaths(AggPaths& dest, const std::vector<Path>& paths)
+{
+    dest.resize(paths.size());
+    std::for_each(paths.begin(), paths.end(),
+            GnashToAggPath(dest, 0.05, pathTolerance));
+}
+
+/// Whether bounds drawn with a matrix cover so little of a pixel that
+/// fills in them can't be seen.
+//
+/// Zoomed out, shapes and glyphs may be drawn to less than a pixel
+/// each, and there may be thousands of them. Outlines are at least a
+/// pixel wide, so they are still drawn.
+///
+/// @param bounds   The bounds, in TWIPS.
+/// @param mat      The matrix from them to TWIPS on the device.
+inline bool
+subpixelSize(const SWFRect& bounds, const SWFMatrix& mat)
+{
+    // The most of a pixel that can be left undrawn in each direction, in
+    // TWIPS.
+    const std::int32_t size = 5;
+
+    if (bounds.is_null()) return false;
+
+    SWFRect drawn;
+    drawn.expand_to_transformed_rect(mat, bounds);
+    return drawn.width() < size && drawn.height() < size;
+}
+
+} // namespace gnash
+
+#endif
@@ -0,0 +1,144 @@
+// PathCache.cpp: AGG paths of shapes kept across frames, for Gnash.
+//
+//   Copyright (C) 2012 Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifdef HAVE_CONFIG_H
+#include "gnashconfig.h" // USE_STATS_CACHE
+#endif
+
+#include "PathCache.h"
+
+#include <tuple>
+#include <utility>
+#include <cassert>
+
+#include "LineStyle.h"
+#include "SWFMatrix.h"
+#include "log.h"
+
+namespace gnash {
+
+namespace {
+
+/// Everything about some line styles that affects AGG paths.
+std::vector<std::uint32_t>
+lineKey(const std::vector<LineStyle>& lineStyles)
+{
+    std::vector<std::uint32_t> key;
+    key.reserve(lineStyles.size());
+    for (const LineStyle& ls : lineStyles) {
+        key.push_back(ls.getThickness() << 2 | ls.doPixelHinting() << 1 |
+                ls.noClose());
+    }
+    return key;
+}
+
+size_t
+memoryUsed(const AggPaths& paths)
+{
+    size_t bytes = paths.capacity() * sizeof(agg::path_storage);
+    for (const agg::path_storage& p : paths) {
+        bytes += p.total_vertices() * (2 * sizeof(double) + 1);
+    }
+    return bytes;
+}
+
+size_t
+memoryUsed(const std::vector<Path>& paths)
+{
+    size_t bytes = paths.capacity() * sizeof(Path);
+    for (const Path& p : paths) {
+        bytes += p.m_edges.capacity() * sizeof(Edge);
+    }
+    return bytes;
+}
+
+} // anonymous namespace
+
+bool
+PathCache::Key::operator<(const Key& o) const
+{
+    return std::tie(hash, a, b, c, d) <
+        std::tie(o.hash, o.a, o.b, o.c, o.d);
+}
+
+PathCache::PathCache(size_t budget)
+    :
+    _budget(budget),
+    _memory(0),
+    _uses()
+{
+}
+
+PathCache::~PathCache()
+{
+#ifdef USE_STATS_CACHE
+    log_debug("Shape paths: %d drawn as built, %d moved, %d built",
+            _uses[USE_HIT], _uses[USE_MOVED], _uses[USE_BUILT]);
+#endif
+}
+
+ShapePaths&
+PathCache::get(std::uint64_t hash, const std::vector<Path>& paths,
+        const std::vector<LineStyle>& lineStyles, const SWFMatrix& mat)
+{
+    const Key key = { hash, mat.a(), mat.b(), mat.c(), mat.d() };
+    std::vector<std::uint32_t> lines = lineKey(lineStyles);
+
+    const auto it = _index.find(key);
+    if (it != _index.end()) {
+        Entry& e = *it->second;
+        _entries.splice(_entries.begin(), _entries, it->second);
+
+        // Other paths with the same hash replace the entry.
+        if (e.lines != lines || !geometry::samePaths(e.source, paths)) {
+            e.source = paths;
+            e.lines.swap(lines);
+            e.paths = ShapePaths();
+        }
+        return e.paths;
+    }
+
+    Entry e = { key, paths, std::move(lines), ShapePaths(), 0 };
+    _entries.push_front(std::move(e));
+    _index[key] = _entries.begin();
+    return _entries.front().paths;
+}
+
+void
+PathCache::used(const ShapePaths& entry, Use use)
+{
+    assert(!_entries.empty());
+    Entry& e = _entries.front();
+    assert(&e.paths == &entry);
+
+    ++_uses[use];
+
+    _memory -= e.memory;
+    e.memory = memoryUsed(entry.fills) + memoryUsed(entry.outlines) +
+        memoryUsed(e.source);
+    _memory += e.memory;
+
+    while (_memory > _budget && _entries.size() > 1) {
+        const Entry& last = _entries.back();
+        _memory -= last.memory;
+        _index.erase(last.key);
+        _entries.pop_back();
+    }
+}
+
+} // namespace gnash
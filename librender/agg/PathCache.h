@@ -0,0 +1,165 @@
+// PathCache.h: AGG paths of shapes kept across frames, for Gnash.
+//
+//   Copyright (C) 2012 Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifndef GNASH_PATHCACHE_H
+#define GNASH_PATHCACHE_H
+
+#include <list>
+#include <map>
+#include <vector>
+#include <cstdint>
+#include <boost/noncopyable.hpp>
+#include <agg_path_storage.h>
+
+#include "Geometry.h"
+
+namespace gnash {
+    class LineStyle;
+}
+
+namespace gnash {
+
+typedef std::vector<agg::path_storage> AggPaths;
+
+/// The AGG paths of a shape drawn with a certain matrix.
+//
+/// The paths are in pixels. They are built for the translation of the
+/// matrix given as their origin, in twips, and can be drawn at any other
+/// translation by offsetting them.
+struct ShapePaths
+{
+    ShapePaths() : haveFills(false), haveOutlines(false) {}
+
+    /// The paths used for fills, if haveFills is true.
+    AggPaths fills;
+    point fillsOrigin;
+    bool haveFills;
+
+    /// The paths used for outlines, if haveOutlines is true.
+    //
+    /// Outlines are aligned to pixels, so they may only be offset by
+    /// whole pixels.
+    AggPaths outlines;
+    point outlinesOrigin;
+    bool haveOutlines;
+};
+
+/// The AGG paths of the most recently drawn shapes.
+//
+/// Converting a shape's paths to AGG paths means transforming and copying
+/// every edge, which is wasted when a shape is drawn the same way on
+/// every frame. Entries are found by a hash of the shape's paths, which
+/// the shape keeps (see SWF::ShapeRecord::contentHash()), and by the
+/// matrix without its translation, so moving shapes and copies of shapes
+/// (see DisplaySnapshot) are cached too. Entries keep the paths they were
+/// built from, so that paths with the same hash are never confused.
+///
+/// The renderer fills the entries; the cache only keeps them within
+/// its memory budget.
+class PathCache : boost::noncopyable
+{
+public:
+
+    /// How an entry was used.
+    enum Use
+    {
+        /// The paths were drawn where they were built.
+        USE_HIT,
+
+        /// The paths were drawn at an offset.
+        USE_MOVED,
+
+        /// Some paths had to be built.
+        USE_BUILT
+    };
+
+    /// @param budget   The number of bytes the paths may use.
+    explicit PathCache(size_t budget);
+
+    /// Log the hit statistics, if they are collected.
+    ~PathCache();
+
+    /// Get the entry for some paths drawn with a matrix.
+    //
+    /// @param hash         A hash of the paths and line styles.
+    /// @param paths        The untransformed Gnash paths.
+    /// @param lineStyles   The line styles used by the paths.
+    /// @param mat          The matrix from twips to device twips.
+    ShapePaths& get(std::uint64_t hash, const std::vector<Path>& paths,
+            const std::vector<LineStyle>& lineStyles, const SWFMatrix& mat);
+
+    /// Count a use of the entry last returned by get().
+    //
+    /// Entries beyond the memory budget are dropped, except that one.
+    void used(const ShapePaths& entry, Use use);
+
+    /// The number of entries cached.
+    size_t size() const {
+        return _entries.size();
+    }
+
+    /// The number of bytes used by the cached paths.
+    size_t memory() const {
+        return _memory;
+    }
+
+    /// The number of uses of each kind, indexed by Use.
+    unsigned long uses(Use use) const {
+        return _uses[use];
+    }
+
+private:
+
+    struct Key
+    {
+        std::uint64_t hash;
+        std::int32_t a, b, c, d;
+        bool operator<(const Key& o) const;
+    };
+
+    struct Entry
+    {
+        Key key;
+
+        /// The Gnash paths the entry was built from.
+        std::vector<Path> source;
+
+        /// What the entry depends on of each line style.
+        std::vector<std::uint32_t> lines;
+
+        ShapePaths paths;
+        size_t memory;
+    };
+
+    typedef std::list<Entry> Entries;
+
+    const size_t _budget;
+
+    /// The entries, most recently used first.
+    Entries _entries;
+
+    std::map<Key, Entries::iterator> _index;
+
+    size_t _memory;
+
+    unsigned long _uses[USE_BUILT + 1];
+};
+
+} // namespace gnash
+
+#endif
@@ -0,0 +1,107 @@
+// RenderWorkers.cpp: threads sharing the rasterization of shapes, for Gnash.
+//
+//   Copyright (C) 2012 Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#include "RenderWorkers.h"
+
+#include <algorithm>
+
+#include "rc.h"
+#include "log.h"
+
+namespace gnash {
+
+RenderWorkers::RenderWorkers(size_t threads)
+    :
+    _quit(false)
+{
+    _threads.reserve(threads);
+    for (size_t i = 0; i < threads; ++i) {
+        _threads.emplace_back(&RenderWorkers::loop, this);
+    }
+}
+
+RenderWorkers::~RenderWorkers()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _quit = true;
+    }
+    _changed.notify_all();
+    for (std::thread& t : _threads) t.join();
+}
+
+RenderWorkers&
+RenderWorkers::pool()
+{
+    static RenderWorkers workers([] {
+        const int configured =
+            RcInitFile::getDefaultInstance().getRenderThreads();
+        const size_t threads = configured > 0 ? configured :
+            std::max(1u, std::thread::hardware_concurrency());
+        log_debug("Drawing shapes with %d threads", threads);
+        return threads - 1;
+    }());
+    return workers;
+}
+
+void
+RenderWorkers::run(size_t count, const Task& task)
+{
+    if (_threads.empty() || count < 2) {
+        for (size_t i = 0; i < count; ++i) task(i);
+        return;
+    }
+
+    Batch b(count, task);
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    _batches.push_back(&b);
+    _changed.notify_all();
+
+    while (b.next < b.count) work(lock, b);
+
+    _changed.wait(lock, [&b] { return b.done == b.count; });
+}
+
+void
+RenderWorkers::work(std::unique_lock<std::mutex>& lock, Batch& b)
+{
+    const size_t i = b.next++;
+    if (b.next == b.count) {
+        _batches.erase(std::find(_batches.begin(), _batches.end(), &b));
+    }
+
+    lock.unlock();
+    b.task(i);
+    lock.lock();
+
+    if (++b.done == b.count) _changed.notify_all();
+}
+
+void
+RenderWorkers::loop()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (true) {
+        _changed.wait(lock, [this] { return _quit || !_batches.empty(); });
+        if (_batches.empty()) return;
+        work(lock, *_batches.front());
+    }
+}
+
+} // namespace gnash
@@ -0,0 +1,106 @@
+// RenderWorkers.h: threads sharing the rasterization of shapes, for Gnash.
+//
+//   Copyright (C) 2012 Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifndef GNASH_RENDERWORKERS_H
+#define GNASH_RENDERWORKERS_H
+
+#include <cstddef>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <boost/noncopyable.hpp>
+
+namespace gnash {
+
+/// A pool of threads running independent tasks, such as drawing bands of
+/// the frame buffer.
+//
+/// The pool is shared by all renderers, which may use it from several
+/// threads at once. The calling thread runs tasks too, so a pool
+/// without threads runs everything in the caller.
+class RenderWorkers : boost::noncopyable
+{
+public:
+
+    typedef std::function<void(size_t)> Task;
+
+    /// Start the threads.
+    //
+    /// @param threads  The number of threads to start besides the callers.
+    explicit RenderWorkers(size_t threads);
+
+    /// Stop the threads once no tasks are left.
+    ~RenderWorkers();
+
+    /// The pool sized as configured in gnashrc (see renderThreads).
+    static RenderWorkers& pool();
+
+    /// The number of threads running tasks, including the caller's.
+    size_t size() const {
+        return _threads.size() + 1;
+    }
+
+    /// Run a task for each index from 0 to count - 1, and wait for them.
+    //
+    /// The tasks may run in any order and at the same time, so they must
+    /// not depend on each other.
+    void run(size_t count, const Task& task);
+
+private:
+
+    /// Tasks from one call to run().
+    struct Batch
+    {
+        Batch(size_t c, const Task& t) : count(c), next(0), done(0), task(t) {}
+        const size_t count;
+
+        /// The index of the next task to start.
+        size_t next;
+
+        /// The number of tasks finished.
+        size_t done;
+
+        const Task& task;
+    };
+
+    /// Run the next task of a batch.
+    //
+    /// @param lock     A lock on _mutex, released while the task runs.
+    void work(std::unique_lock<std::mutex>& lock, Batch& b);
+
+    void loop();
+
+    std::mutex _mutex;
+
+    /// Signalled when a batch is added and when one is finished.
+    std::condition_variable _changed;
+
+    /// Batches that have tasks left to start, oldest first.
+    std::deque<Batch*> _batches;
+
+    bool _quit;
+
+    std::vector<std::thread> _threads;
+};
+
+} // namespace gnash
+
+#endif
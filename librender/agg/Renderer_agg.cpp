@@ -114,6 +114,8 @@ AGG resources
 #include <cmath>
 #include <math.h> // We use round()!
 #include <climits>
+#include <limits>
+#include <algorithm>
 #include <functional>
 
 #pragma GCC diagnostic push
@@ -140,10 +142,17 @@ AGG resources
 #include <agg_conv_stroke.h>
 #include <agg_renderer_primitives.h>
 #include <agg_image_accessors.h>
-#include <agg_alpha_mask_u8.h>
 #pragma GCC diagnostic pop
 
 #include "Renderer_agg_style.h"
+#include "RenderWorkers.h"
+#include "BandRasterizer.h"
+#include "SimdBlend.h"
+#include "PathCache.h"
+#include "PathBuilder.h"
+#include "GlyphCache.h"
+#include "BitmapFilters.h"
+#include "AlphaMask.h"
 
 #include "GnashEnums.h"
 #include "CachedBitmap.h"
@@ -177,9 +186,6 @@ namespace gnash {
 
 namespace {
 
-class AlphaMask;
-
-typedef std::vector<agg::path_storage> AggPaths;
 typedef std::vector<geometry::Range2d<int> > ClipBounds;
 typedef boost::ptr_vector<AlphaMask> AlphaMasks;
 typedef std::vector<Path> GnashPaths;
@@ -233,89 +239,233 @@ analyzePaths(const GnashPaths &paths, bool& have_shape,
     }
 }
 
-class EdgeToPath
+/// Reads an AGG path without changing it, optionally moving it.
+//
+/// agg::path_storage keeps its read position, so it can't be read by
+/// several threads at once; each of them uses a PathReader instead.
+class PathReader
 {
-
 public:
-    EdgeToPath(AggPaths::value_type& path, double shift = 0)
+
+    explicit PathReader(const agg::path_storage& path, double dx = 0,
+            double dy = 0)
         :
         _path(path),
-        _shift(shift)
+        _pos(0),
+        _dx(dx),
+        _dy(dy)
     {}
 
-    void operator()(const Edge& edge)
-    {
-        if (edge.straight()) {
-            _path.line_to(twipsToPixels(edge.ap.x) + _shift, 
-                          twipsToPixels(edge.ap.y) + _shift);
-        }
-        else {
-            _path.curve3(twipsToPixels(edge.cp.x) + _shift, 
-                     twipsToPixels(edge.cp.y) + _shift,
-                     twipsToPixels(edge.ap.x) + _shift, 
-                     twipsToPixels(edge.ap.y) + _shift);             
+    void rewind(unsigned pos) {
+        _pos = pos;
+    }
+
+    unsigned vertex(double* x, double* y) {
+        if (_pos >= _path.total_vertices()) return agg::path_cmd_stop;
+        const unsigned cmd = _path.vertex(_pos++, x, y);
+        if (agg::is_vertex(cmd)) {
+            *x += _dx;
+            *y += _dy;
         }
+        return cmd;
     }
 
 private:
-    agg::path_storage& _path;
-    const double _shift;
+    const agg::path_storage& _path;
+    unsigned _pos;
+    const double _dx;
+    const double _dy;
 };
 
-/// In-place transformation of Gnash paths to AGG paths.
-class GnashToAggPath
+/// The fewest rows of a band drawn by a separate thread.
+//
+/// Each thread reads all the edges of the shape and builds its styles,
+/// so shapes smaller than two bands are drawn faster by the caller alone.
+const int minBandHeight = 64;
+
+/// The number of bytes of AGG paths kept for shapes drawn again.
+const size_t pathCacheBudget = 8 * 1024 * 1024;
+
+/// Split some rows into bands, skipping those outside the paths.
+//
+/// @param bounds   The clipping bounds to split.
+/// @param paths    The paths that will be drawn.
+/// @param dy       The vertical offset the paths will be drawn at.
+/// @param count    The most bands wanted.
+/// @param bands    Receives the bands, or nothing if the paths are
+///                 too small to be split.
+void
+splitIntoBands(const geometry::Range2d<int>& bounds, const AggPaths& paths,
+        double dy, size_t count, ClipBounds& bands)
+{
+    double minY = std::numeric_limits<double>::max();
+    double maxY = -std::numeric_limits<double>::max();
+    for (const agg::path_storage& path : paths) {
+        for (unsigned i = 0, e = path.total_vertices(); i < e; ++i) {
+            double x, y;
+            if (!agg::is_vertex(path.vertex(i, &x, &y))) continue;
+            minY = std::min(minY, y);
+            maxY = std::max(maxY, y);
+        }
+    }
+    if (minY > maxY) return;
+    minY += dy;
+    maxY += dy;
+
+    const int top = std::max<double>(bounds.getMinY(), std::floor(minY));
+    const int bottom = std::min<double>(bounds.getMaxY(), std::ceil(maxY));
+    const int rows = bottom - top + 1;
+    const int n = std::min<int>(count, rows / minBandHeight);
+    if (n < 2) return;
+
+    for (int i = 0; i < n; ++i) {
+        bands.push_back(geometry::Range2d<int>(bounds.getMinX(),
+                    top + rows * i / n, bounds.getMaxX(),
+                    top + rows * (i + 1) / n - 1));
+    }
+}
+
+/// A premultiplied 32-bit AGG pixel format blending spans with vector
+/// instructions (see SimdBlend.h).
+//
+/// The vector code is checked once to give the same pixels as the format
+/// it replaces; if it does not, for instance because AGG rounds
+/// differently, the AGG format's own blending is used.
+template<class Base, simd::Order O>
+class SimdPixelFormat : public Base
 {
 public:
 
-    GnashToAggPath(AggPaths& dest, double shift = 0)
+    typedef typename Base::color_type color_type;
+
+    explicit SimdPixelFormat(agg::rendering_buffer& rb)
         :
-        _dest(dest),
-        _it(_dest.begin()),
-        _shift(shift)
-    {
-    }
+        Base(rb)
+    {}
 
-    void operator()(const Path& in)
-    {
-        agg::path_storage& p = *_it;
+    void blend_hline(int x, int y, unsigned len, const color_type& c,
+            agg::int8u cover) {
+        if (!level()) {
+            Base::blend_hline(x, y, len, c, cover);
+            return;
+        }
+        simd::blendSpan(level(), O, this->pix_ptr(x, y), len, &c.r, true,
+                nullptr, cover);
+    }
 
-        p.move_to(twipsToPixels(in.ap.x) + _shift, 
-                  twipsToPixels(in.ap.y) + _shift);
+    void blend_solid_hspan(int x, int y, unsigned len, const color_type& c,
+            const agg::int8u* covers) {
+        if (!level()) {
+            Base::blend_solid_hspan(x, y, len, c, covers);
+            return;
+        }
+        simd::blendSpan(level(), O, this->pix_ptr(x, y), len, &c.r, true,
+                covers, 0);
+    }
 
-        std::for_each(in.m_edges.begin(), in.m_edges.end(),
-                EdgeToPath(p, _shift));
-        ++_it;
+    void blend_color_hspan(int x, int y, unsigned len,
+            const color_type* colors, const agg::int8u* covers,
+            agg::int8u cover) {
+        if (!level()) {
+            Base::blend_color_hspan(x, y, len, colors, covers, cover);
+            return;
+        }
+        simd::blendSpan(level(), O, this->pix_ptr(x, y), len, &colors->r,
+                false, covers, cover);
     }
 
 private:
-    AggPaths& _dest;
-    AggPaths::iterator _it;
-    const double _shift;
 
-};
+    static_assert(sizeof(color_type) == 4, "colors are four bytes");
+
+    static simd::Level level() {
+        static const simd::Level l = checkedLevel();
+        return l;
+    }
 
+    /// The best level, if it blends like Base.
+    static simd::Level checkedLevel() {
+
+        const simd::Level best = simd::bestLevel();
+        if (best == simd::LEVEL_SCALAR) return best;
+
+        const unsigned size = 1024;
+        std::vector<agg::int8u> expected(size * 4);
+        std::vector<agg::int8u> actual(size * 4);
+        std::vector<color_type> colors(size);
+        std::vector<agg::int8u> covers(size);
+
+        // Some pixels, colors and coverages, including the extremes.
+        std::uint32_t seed = 1;
+        for (size_t i = 0; i < size; ++i) {
+            seed = seed * 1103515245 + 12345;
+            const std::uint32_t r = seed >> 8;
+            for (size_t j = 0; j < 4; ++j) {
+                expected[i * 4 + j] = r >> (j * 5);
+            }
+            const agg::int8u a = (i % 7) ? (r >> 16) : (i % 2) * 255;
+            colors[i] = color_type((r & 0xff) * a / 255,
+                    ((r >> 4) & 0xff) * a / 255, ((r >> 12) & 0xff) * a / 255,
+                    a);
+            covers[i] = (i % 5) ? (r >> 20) : (i % 3) * 127;
+        }
 
-/// Transposes Gnash paths to AGG paths, which can be used for both outlines
-/// and shapes. Subshapes are ignored (ie. all paths are converted). Converts 
-/// TWIPS to pixels on the fly.
-inline void
-buildPaths(AggPaths& dest, const GnashPaths& paths) 
-{
-    dest.resize(paths.size());
-    std::for_each(paths.begin(), paths.end(), GnashToAggPath(dest, 0.05));
-} 
-
-// --- ALPHA MASK BUFFER CONTAINER ---------------------------------------------
-// How masks are implemented: A mask is basically a full alpha buffer. Each 
-// pixel in the alpha buffer defines the fraction of color values that are
-// copied to the main buffer. The alpha mask buffer has 256 alpha levels per
-// pixel, which is good as it allows anti-aliased masks. A full size buffer
-// is allocated for each mask even if the invalidated bounds may be much 
-// smaller. The advantage of this is that the alpha mask adaptor does not need
-// to do any clipping which results in better performance.
+        agg::rendering_buffer rb(&expected.front(), size, 1, size * 4);
+        Base ref(rb);
+
+        bool same = true;
+        for (size_t i = 0; same && i < 8; ++i) {
+            std::copy(expected.begin(), expected.end(), actual.begin());
+            std::uint8_t* p = &actual.front();
+            const std::uint8_t* c = &colors[i * 37].r;
+            const agg::int8u cover = covers[i * 11];
+
+            switch (i % 4) {
+                case 0:
+                    ref.blend_hline(0, 0, size, colors[i * 37], cover);
+                    simd::blendSpan(best, O, p, size, c, true, nullptr,
+                            cover);
+                    break;
+                case 1:
+                    ref.blend_solid_hspan(0, 0, size, colors[i * 37],
+                            &covers.front());
+                    simd::blendSpan(best, O, p, size, c, true,
+                            &covers.front(), 0);
+                    break;
+                case 2:
+                    ref.blend_color_hspan(0, 0, size, &colors.front(),
+                            &covers.front(), 0);
+                    simd::blendSpan(best, O, p, size, &colors.front().r,
+                            false, &covers.front(), 0);
+                    break;
+                default:
+                    ref.blend_color_hspan(0, 0, size, &colors.front(),
+                            nullptr, cover);
+                    simd::blendSpan(best, O, p, size, &colors.front().r,
+                            false, nullptr, cover);
+            }
+            same = (expected == actual);
+        }
+
+        if (!same) {
+            log_debug("Vector blending does not match AGG's, not using it");
+            return simd::LEVEL_SCALAR;
+        }
+        return best;
+    }
+};
+
+// --- ALPHA MASKS -------------------------------------------------------------
+// How masks are implemented: A mask holds the coverage of the pixels it may
+// cover (see AlphaMask.h). Each coverage value defines the fraction of color
+// values that are copied to the main buffer. There are 256 levels per
+// pixel, which is good as it allows anti-aliased masks. The shapes of a mask
+// are collected while it is submitted and drawn when it is complete, to a
+// buffer covering only their bounds within the invalidated bounds. A mask
+// that is a rectangle of whole pixels needs no buffer at all.
 // Masks can be nested, which means the intersection of all masks should be 
-// visible (logical AND). To allow this we hold a stack of alpha masks and the 
-// topmost mask is used itself as a mask to draw any new mask. When rendering 
+// visible (logical AND). To allow this we hold a stack of alpha masks and 
+// each new mask is intersected with the topmost one. When rendering 
 // visible shapes only the topmost mask must be used and when a mask should not 
 // be used anymore it's simply discarded so that the next mask becomes active 
 // again.
@@ -324,71 +474,11 @@ buildPaths(AggPaths& dest, const GnashPaths& paths)
 // anything we can draw otherwise (except lines, which are excluded 
 // explicitly).    
 
-class AlphaMask 
+/// A shape submitted to a mask, in twips.
+struct MaskShape
 {
-
-    typedef agg::renderer_base<agg::pixfmt_gray8> Renderer;
-    typedef agg::alpha_mask_gray8 Mask;
-
-public:
-
-    AlphaMask(int width, int height)
-        :
-        _rbuf(nullptr, width, height, width),
-        _pixf(_rbuf),
-        _rbase(_pixf),
-        _amask(_rbuf),
-        _buffer(new std::uint8_t[width * height]())
-    {
-        _rbuf.attach(_buffer.get(), width, height, width);
-    }
-    
-    void clear(const geometry::Range2d<int>& region)
-    {
-        if (region.isNull()) return;
-        assert(region.isFinite());
-
-        const agg::gray8 black(0);
-                
-        // region can't be world as it should be intersected with 
-        // the visible SWFRect
-        assert(!region.isWorld());
-
-        unsigned int left = region.getMinX();
-        unsigned int width = region.width() + 1;
-
-        const unsigned int max_y = region.getMaxY();
-        for (unsigned int y=region.getMinY(); y <= max_y; ++y) 
-        {
-             _pixf.copy_hline(left, y, width, black);
-        }
-    }
-    
-    Renderer& get_rbase() {
-        return _rbase;
-    }
-    
-    const Mask& getMask() const {
-        return _amask;
-    }    
-    
-private:
-
-    // agg class to access the buffer
-    agg::rendering_buffer _rbuf;
-    
-    // pixel access
-    agg::pixfmt_gray8 _pixf;    
-    
-    // renderer base
-    Renderer _rbase;
-    
-    // alpha mask
-    Mask _amask;
-    
-    // in-memory buffer
-    std::unique_ptr<std::uint8_t[]> _buffer;
-    
+    GnashPaths paths;
+    bool evenOdd;
 };
 
 /// Class for rendering lines.
@@ -470,8 +560,8 @@ public:
         }
         else {
             // Untested.
-            typedef agg::scanline_u8_am<agg::alpha_mask_gray8> Scanline;
-            Scanline sl(masks.back().getMask());
+            typedef agg::scanline_u8_am<AlphaMask> Scanline;
+            Scanline sl(masks.back());
             renderScanlines(path, rbase, sl);
         }
     } 
@@ -615,8 +705,8 @@ private:
         }
         else {
             // Untested.
-            typedef agg::scanline_u8_am<agg::alpha_mask_gray8> Scanline;
-            Scanline sl(masks.back().getMask());
+            typedef agg::scanline_u8_am<AlphaMask> Scanline;
+            Scanline sl(masks.back());
             renderScanlines(path, rbase, sl, sg);
         }
     } 
@@ -685,9 +775,19 @@ public:
         return new agg_bitmap_info(std::move(im));
     }
 
+    virtual bool applyFilters(image::GnashImage& im, const Filters& filters,
+            double xscale, double yscale)
+    {
+        if (im.type() != image::TYPE_RGBA) return false;
+        static const simd::Level level = simd::bestLevel();
+        gnash::applyFilters(level, im, filters, xscale, yscale);
+        return true;
+    }
+
     virtual void renderToImage(std::unique_ptr<IOChannel> io,
             FileType type, int quality) const
     {
+        sync();
         image::ImageRGBA im(xres, yres);
         for (int x = 0; x < xres; ++x) {
             for (int y = 0; y < yres; ++y) {
@@ -802,7 +902,8 @@ public:
       yres(1),
       bpp(bits_per_pixel),
       scale_set(false),
-      m_drawing_mask(false)
+      m_drawing_mask(false),
+      _pathCache(pathCacheBudget)
   {
     // TODO: we really don't want to set the scale here as the core should
     // tell us the right values before rendering anything. However this is
@@ -823,6 +924,8 @@ public:
         assert(x > 0);
         assert(y > 0);
 
+    sync();
+
     xres    = x;
     yres    = y;
     
@@ -873,7 +976,8 @@ public:
                 in.reset(new Renderer_agg<typename RGB::PixelFormat>(24));
                 break;
             case image::TYPE_RGBA:
-                in.reset(new Renderer_agg<typename RGBA::PixelFormat>(32));
+                in.reset(new Renderer_agg<SimdPixelFormat<
+                        RGBA::PixelFormat, simd::ORDER_RGBA> >(32));
                 break;
             default:
                 std::abort();
@@ -981,8 +1085,8 @@ public:
         }
         else {
             // Mask is active!
-            typedef agg::scanline_u8_am<agg::alpha_mask_gray8> sl_type;
-            sl_type sl(_alphaMasks.back().getMask());      
+            typedef agg::scanline_u8_am<AlphaMask> sl_type;
+            sl_type sl(_alphaMasks.back());      
             lr.render(sl, stroke, color);
         }
 
@@ -994,18 +1098,55 @@ public:
         // Set flag so that rendering of shapes is simplified (only solid fill) 
         m_drawing_mask = true;
 
-        _alphaMasks.push_back(new AlphaMask(xres, yres));
-        AlphaMask& new_mask = _alphaMasks.back();
-
-        for (const auto& bounds : _clipbounds ) {
-            new_mask.clear(bounds);
-        }
-
+        _alphaMasks.push_back(new AlphaMask());
+        _maskShapes.clear();
     }
 
+    /// Draw the submitted shapes to the new mask.
+    //
+    /// Only the pixels of the shapes inside the invalidated bounds, and
+    /// inside the enclosing mask, are kept.
     void end_submit_mask()
     {
         m_drawing_mask = false;
+
+        assert(!_alphaMasks.empty());
+        AlphaMask& mask = _alphaMasks.back();
+        const AlphaMask* parent = _alphaMasks.size() > 1 ?
+            &_alphaMasks[_alphaMasks.size() - 2] : nullptr;
+
+        geometry::Range2d<int> area;
+        for (const auto& bounds : _clipbounds) {
+            area.expandTo(bounds);
+        }
+        if (parent) area = geometry::Intersection(area, parent->bounds());
+
+        geometry::Range2d<int> bounds;
+        for (const MaskShape& shape : _maskShapes) {
+            bounds.expandTo(pathBounds(shape.paths));
+        }
+        bounds = geometry::Intersection(bounds, area);
+
+        // A rectangle needs no coverage values, unless it is intersected
+        // with some.
+        geometry::Range2d<int> rect;
+        if (_maskShapes.size() == 1 &&
+                pixelRectangle(_maskShapes.front().paths, rect) &&
+                (!parent || parent->rectangular())) {
+            mask.setRectangle(geometry::Intersection(rect, area));
+            _maskShapes.clear();
+            return;
+        }
+
+        mask.setBuffer(bounds);
+        if (!bounds.isNull()) {
+            for (const MaskShape& shape : _maskShapes) {
+                draw_coverage(shape.paths, shape.evenOdd, mask.buffer(),
+                        mask.bounds(), mask.stride());
+            }
+            if (parent) mask.intersect(*parent);
+        }
+        _maskShapes.clear();
     }
 
     void disable_mask()
@@ -1025,30 +1166,37 @@ public:
     if (shape.getBounds().is_null()) {
         return;
     } 
+    if (!m_drawing_mask && subpixel(shape.getBounds(), mat)) return;
+
     select_clipbounds(shape.getBounds(), mat);
     
     if (_clipbounds_selected.empty()) return; 
       
-    GnashPaths paths;
-    apply_matrix_to_path(shape.subshapes().front().paths(), paths, mat);
+    const GnashPaths& objpaths = shape.subshapes().front().paths();
 
     // If it's a mask, we don't need the rest.
     if (m_drawing_mask) {
+      GnashPaths paths;
+      apply_matrix_to_path(objpaths, paths, mat);
       draw_mask_shape(paths, false);
       return;
     }
 
+    if (drawCachedGlyph(shape, color, mat)) {
+      _clipbounds_selected.clear();
+      return;
+    }
+
     // convert gnash paths to agg paths.
-    AggPaths agg_paths;    
-    buildPaths(agg_paths, paths);
+    point origin;
+    const ShapePaths& agg_paths = shapePaths(shape.contentHash(), objpaths,
+            shape.subshapes().front().lineStyles(), mat, true, false, origin);
  
     std::vector<FillStyle> v(1, FillStyle(SolidFill(color)));
 
-    // prepare style handler
-    StyleHandler sh;
-    build_agg_styles(sh, v, mat, SWFCxForm());
-    
-    draw_shape(paths, agg_paths, sh, false);
+    draw_shape(objpaths, agg_paths.fills, v, mat, SWFCxForm(), false,
+            twipsToPixels(origin.x - agg_paths.fillsOrigin.x),
+            twipsToPixels(origin.y - agg_paths.fillsOrigin.y));
     
     // NOTE: Do not use even-odd filling rule for glyphs!
     
@@ -1091,6 +1239,92 @@ public:
     }  
   }
   
+  /// Draw a glyph from its coverage in the glyph cache, adding it first if
+  /// needed.
+  //
+  /// The glyph is drawn from where it starts within a pixel, to the
+  /// nearest quarter of a pixel.
+  ///
+  /// @return   Whether the glyph can be cached. Rotated and skewed
+  ///           glyphs can't, nor can those larger than
+  ///           GlyphCache::maxSize(); they are drawn as shapes.
+  bool drawCachedGlyph(const SWF::ShapeRecord& shape, const rgba& color,
+          const SWFMatrix& source_mat)
+  {
+    const GnashPaths& objpaths = shape.subshapes().front().paths();
+    SWFMatrix mat = deviceMatrix(source_mat);
+
+    GlyphCache::Key key;
+    point origin;
+    if (!GlyphCache::key(shape.contentHash(), mat, key, origin)) return false;
+
+    const GlyphCache::Glyph* glyph = _glyphs.find(key, objpaths);
+
+    if (!glyph) {
+      const int part = 20 / GlyphCache::subpixels;
+      mat.set_translation(key.x * part, key.y * part);
+
+      // A twip more on each side, as the bounds are rounded.
+      SWFRect bounds;
+      bounds.expand_to_transformed_rect(mat, shape.getBounds());
+      const int left = std::floor((bounds.get_x_min() - 1) / 20.0);
+      const int top = std::floor((bounds.get_y_min() - 1) / 20.0);
+      const int right = std::ceil((bounds.get_x_max() + 1) / 20.0);
+      const int bottom = std::ceil((bounds.get_y_max() + 1) / 20.0);
+
+      GlyphCache::Glyph* added = _glyphs.insert(key, objpaths, left, top,
+              right - left, bottom - top);
+      if (!added) return false;
+
+      GnashPaths paths(objpaths);
+      for (Path& p : paths) p.transform(mat);
+
+      // NOTE: Do not use even-odd filling rule for glyphs!
+      draw_coverage(paths, false, _glyphs.row(*added, 0),
+              geometry::Range2d<int>(left, top, right - 1, bottom - 1),
+              _glyphs.stride());
+      glyph = added;
+    }
+
+    const geometry::Range2d<int> area(origin.x + glyph->left,
+            origin.y + glyph->top,
+            origin.x + glyph->left + glyph->width - 1,
+            origin.y + glyph->top + glyph->height - 1);
+
+    const agg::rgba8 c = agg::rgba8_pre(color.m_r, color.m_g, color.m_b,
+            color.m_a);
+
+    std::vector<std::uint8_t> covers;
+
+    for (const geometry::Range2d<int>* bounds : _clipbounds_selected) {
+
+      const geometry::Range2d<int> r = geometry::Intersection(area, *bounds);
+      if (r.isNull()) continue;
+
+      const int len = r.width() + 1;
+      for (int y = r.getMinY(); y <= r.getMaxY(); ++y) {
+        const std::uint8_t* row = _glyphs.row(*glyph, y - area.getMinY()) +
+          (r.getMinX() - area.getMinX());
+        if (!_alphaMasks.empty()) {
+          covers.assign(row, row + len);
+          _alphaMasks.back().combine_hspan(r.getMinX(), y, &covers.front(),
+                  len);
+          row = &covers.front();
+        }
+        m_rbase->blend_solid_hspan(r.getMinX(), y, len, c, row);
+      }
+    }
+    return true;
+  }
+
+  /// Whether a character is drawn to so little of a pixel that its fills
+  /// can't be seen.
+  bool subpixel(const SWFRect& objectBounds, const SWFMatrix& source_mat)
+      const
+  {
+    return subpixelSize(objectBounds, deviceMatrix(source_mat));
+  }
+
   void select_all_clipbounds() {
   
     if (_clipbounds_selected.size() == _clipbounds.size()) return; 
@@ -1116,6 +1350,11 @@ public:
             return; // no need to draw
         }
 
+        const bool fills = !subpixel(shape.getBounds(), xform.matrix);
+
+        // Each subshape's paths are cached under a hash of their own.
+        std::uint64_t hash = shape.contentHash();
+
         for (const SWF::Subshape& subshape : shape.subshapes()) {
 
             const SWF::ShapeRecord::FillStyles& fillStyles = subshape.fillStyles();
@@ -1126,53 +1365,44 @@ public:
             select_clipbounds(shape.getBounds(), xform.matrix);
 
             // render the DisplayObject's subshape.
-            drawShape(fillStyles, lineStyles, paths, xform.matrix,
-                      xform.colorTransform);
+            drawShape(hash++, fillStyles, lineStyles, paths, xform.matrix,
+                      xform.colorTransform, fills);
         }
     }
 
-    void drawShape(const std::vector<FillStyle>& FillStyles,
+    /// @param hash     A hash of the paths and line styles, for the
+    ///                 PathCache.
+    void drawShape(std::uint64_t hash,
+        const std::vector<FillStyle>& FillStyles,
         const std::vector<LineStyle>& line_styles,
         const std::vector<Path>& objpaths, const SWFMatrix& mat,
-        const SWFCxForm& cx)
+        const SWFCxForm& cx, bool fills = true)
     {
 
         bool have_shape, have_outline;
 
         analyzePaths(objpaths, have_shape, have_outline);
 
+        // Masks are drawn whole, however small.
+        if (!fills && !m_drawing_mask) have_shape = false;
+
         if (!have_shape && !have_outline) {
             // Early return for invisible character.
             return; 
         }
 
-        GnashPaths paths;
-        apply_matrix_to_path(objpaths, paths, mat);
-
         // Masks apparently do not use agg_paths, so return
         // early
         if (m_drawing_mask) {
 
             // Shape is drawn inside a mask, skip sub-shapes handling and
             // outlines
+            GnashPaths paths;
+            apply_matrix_to_path(objpaths, paths, mat);
             draw_mask_shape(paths, false); 
             return;
         }
 
-        AggPaths agg_paths;    
-        AggPaths agg_paths_rounded;    
-
-        // Flash only aligns outlines. Probably this is done at rendering
-        // level.
-        if (have_outline) {
-            buildPaths_rounded(agg_paths_rounded, paths, line_styles);     
-        }
-
-        if (have_shape) {
-            buildPaths(agg_paths, paths);
-        }
-        
-
         if (_clipbounds_selected.empty()) {
 #ifdef GNASH_WARN_WHOLE_CHARACTER_SKIP
             log_debug("Warning: AGG renderer skipping a whole character");
@@ -1180,17 +1410,24 @@ public:
             return; 
         }
 
-        // prepare fill styles
-        StyleHandler sh;
-        if (have_shape) build_agg_styles(sh, FillStyles, mat, cx);
-
+        // The paths only differ from the transformed ones in their
+        // coordinates, which the drawing functions take from the AGG
+        // paths.
+        point origin;
+        const ShapePaths& agg_paths = shapePaths(hash, objpaths, line_styles,
+                mat, have_shape, have_outline, origin);
 
             if (have_shape) {
-                draw_shape(paths, agg_paths, sh, true);        
+                draw_shape(objpaths, agg_paths.fills, FillStyles, mat, cx,
+                        true,
+                        twipsToPixels(origin.x - agg_paths.fillsOrigin.x),
+                        twipsToPixels(origin.y - agg_paths.fillsOrigin.y));
             }
             if (have_outline)            {
-                draw_outlines(paths, agg_paths_rounded,
-                        line_styles, cx, mat);
+                draw_outlines(objpaths, agg_paths.outlines,
+                        line_styles, cx, mat,
+                        twipsToPixels(origin.x - agg_paths.outlinesOrigin.x),
+                        twipsToPixels(origin.y - agg_paths.outlinesOrigin.y));
             }
 
         // Clear selected clipbounds to ease debugging 
@@ -1204,11 +1441,7 @@ public:
           GnashPaths& paths_out, const SWFMatrix &source_mat) 
     {
 
-        SWFMatrix mat;
-        // make sure paths_out is also in TWIPS to keep accuracy.
-        mat.concatenate_scale(20.0,  20.0);
-        mat.concatenate(stage_matrix);
-        mat.concatenate(source_mat);
+        const SWFMatrix mat = deviceMatrix(source_mat);
 
         // Copy paths for in-place transform
         paths_out = paths_in;
@@ -1219,6 +1452,79 @@ public:
 		    std::ref(mat)));
     } 
 
+    /// The matrix transforming a shape's TWIPS to TWIPS on the device.
+    SWFMatrix deviceMatrix(const SWFMatrix& source_mat) const
+    {
+        SWFMatrix mat;
+        // make sure paths_out is also in TWIPS to keep accuracy.
+        mat.concatenate_scale(20.0,  20.0);
+        mat.concatenate(stage_matrix);
+        mat.concatenate(source_mat);
+        return mat;
+    }
+
+    /// Get the AGG paths of a shape from the cache, building those
+    /// missing.
+    //
+    /// The paths are drawn at the offset between the given origin and
+    /// theirs.
+    ///
+    /// @param hash     A hash of the paths and line styles.
+    /// @param fills    Whether the paths for fills are needed.
+    /// @param outlines Whether the paths for outlines are needed.
+    /// @param origin   Receives the translation of the shape on the
+    ///                 device, in TWIPS.
+    const ShapePaths& shapePaths(std::uint64_t hash,
+            const GnashPaths& objpaths,
+            const std::vector<LineStyle>& line_styles,
+            const SWFMatrix& source_mat, bool fills, bool outlines,
+            point& origin)
+    {
+        const SWFMatrix mat = deviceMatrix(source_mat);
+        origin = point(mat.tx(), mat.ty());
+
+        ShapePaths& cached = _pathCache.get(hash, objpaths, line_styles, mat);
+
+        // The paths are moved exactly, as the matrix only adds the
+        // translation to transformed points, but aligned outlines
+        // only by whole pixels.
+        const bool build_fills = fills && !cached.haveFills;
+        const bool build_outlines = outlines && (!cached.haveOutlines ||
+                (origin.x - cached.outlinesOrigin.x) % 20 ||
+                (origin.y - cached.outlinesOrigin.y) % 20);
+
+        if (!build_fills && !build_outlines) {
+            const bool moved = (fills && cached.fillsOrigin != origin) ||
+                (outlines && cached.outlinesOrigin != origin);
+            _pathCache.used(cached, moved ? PathCache::USE_MOVED :
+                    PathCache::USE_HIT);
+            return cached;
+        }
+
+        GnashPaths paths;
+        apply_matrix_to_path(objpaths, paths, source_mat);
+
+        if (build_fills) {
+            cached.fills.clear();
+            buildPaths(cached.fills, paths);
+            cached.fillsOrigin = origin;
+            cached.haveFills = true;
+        }
+
+        // Flash only aligns outlines. Probably this is done at rendering
+        // level.
+        if (build_outlines) {
+            cached.outlines.clear();
+            buildPaths_rounded(cached.outlines, paths, line_styles,
+                    strokeScale(source_mat));
+            cached.outlinesOrigin = origin;
+            cached.haveOutlines = true;
+        }
+
+        _pathCache.used(cached, PathCache::USE_BUILT);
+        return cached;
+    }
+
   // Version of buildPaths that uses rounded coordinates (pixel hinting)
   // for line styles that want it.  
   // This is used for outlines which are aligned to the pixel grid to avoid
@@ -1234,10 +1540,12 @@ public:
   // This function - in contrast to buildPaths() - also checks noClose 
   // flag and automatically closes polygons.
   //
-  // TODO: Flash never aligns lines that are wider than 1 pixel on *screen*,
-  // but we currently don't check the width.  
+  // Flash never aligns lines that are wider than 1 pixel on *screen*. Those
+  // that are not can also do without the vertices and curves they hardly
+  // change (see pathTolerance).
   void buildPaths_rounded(AggPaths& dest, 
-    const GnashPaths& paths, const std::vector<LineStyle>& line_styles)
+    const GnashPaths& paths, const std::vector<LineStyle>& line_styles,
+    float stroke_scale)
   {
 
     const float subpixel_offset = 0.5f;
@@ -1260,9 +1568,7 @@ public:
         closed = this_path.isClosed() && !lstyle.noClose();
         
         // check if this line is a hairline ON SCREEN
-        // TODO: we currently only check for hairlines per definiton, not
-        // for thin lines that become hair lines due to scaling
-        if (lstyle.getThickness()<=20)
+        if (strokeWidth(lstyle, stroke_scale) <= 1)
           hairline = true;
       }
       
@@ -1283,8 +1589,19 @@ public:
         
         float this_ax = twipsToPixels(this_edge.ap.x);  
         float this_ay = twipsToPixels(this_edge.ap.y);  
+
+        const bool straight = this_edge.straight() || (hairline &&
+            flatCurve(prev_ax, prev_ay, twipsToPixels(this_edge.cp.x),
+              twipsToPixels(this_edge.cp.y), this_ax, this_ay,
+              pathTolerance));
+
+        // keep the first and last anchors of hairlines, but not those
+        // that hardly move them
+        if (hairline && !hinting && straight && eno && eno + 1 < ecount &&
+            std::hypot(this_ax - prev_ax, this_ay - prev_ay) <=
+              pathTolerance) continue;
         
-        if (hinting || this_edge.straight()) {
+        if (hinting || straight) {
         
           // candidate for alignment?
           bool align_x = hinting || (hairline && (prev_ax == this_ax));
@@ -1385,7 +1702,7 @@ public:
 
         for (size_t fno = 0; fno < fcount; ++fno) {
             const AddStyles st(stage_matrix, fillstyle_matrix, cx, sh,
-                    _quality);
+                    _quality, _gradients);
             boost::apply_visitor(st, FillStyles[fno].fill);
         } 
     } 
@@ -1403,12 +1720,15 @@ public:
   /// already prepared in agg_paths. The (nearly ambiguous) "path" parameter
   /// is used to access other properties like fill styles and subshapes.   
   ///
-  /// @param subshape_id
-  ///    Defines which subshape to draw. -1 means all subshapes.
+  /// The fill styles, their matrix and color transform are passed
+  /// instead of a StyleHandler, as each thread drawing a band of the
+  /// shape needs its own.
   ///
+  /// The agg_paths are drawn moved by dx and dy pixels.
   void draw_shape(const GnashPaths &paths,
     const AggPaths& agg_paths,  
-    StyleHandler& sh, bool even_odd) {
+    const std::vector<FillStyle>& fill_styles, const SWFMatrix& mat,
+    const SWFCxForm& cx, bool even_odd, double dx, double dy) {
     
     if (_alphaMasks.empty()) {
     
@@ -1419,18 +1739,18 @@ public:
       scanline_type sl;
       
       draw_shape_impl<scanline_type> (paths, agg_paths, 
-        sh, even_odd, sl);
+        fill_styles, mat, cx, even_odd, dx, dy, sl);
         
     } else {
     
       // Mask is active, use alpha mask scanline renderer
       
-      typedef agg::scanline_u8_am<agg::alpha_mask_gray8> scanline_type;
+      typedef agg::scanline_u8_am<AlphaMask> scanline_type;
       
-      scanline_type sl(_alphaMasks.back().getMask());
+      scanline_type sl(_alphaMasks.back());
       
       draw_shape_impl<scanline_type> (paths, agg_paths, 
-        sh, even_odd, sl);
+        fill_styles, mat, cx, even_odd, dx, dy, sl);
         
     }
     
@@ -1439,10 +1759,17 @@ public:
   /// Template for draw_shape(). Two different scanline types are suppored, 
   /// one with and one without an alpha mask. This makes drawing without masks
   /// much faster.  
+  ///
+  /// Large shapes are split into a band of rows for each of the
+  /// RenderWorkers, which draw them at the same time. Every band has a
+  /// scanline copied from the given one, and gives the same pixels as
+  /// drawing the shape whole (see BandRasterizer).
   template <class scanline_type>
   void draw_shape_impl(const GnashPaths &paths,
     const AggPaths& agg_paths,
-    StyleHandler& sh, bool even_odd, scanline_type& sl) {
+    const std::vector<FillStyle>& fill_styles, const SWFMatrix& mat,
+    const SWFCxForm& cx, bool even_odd, double dx, double dy,
+    const scanline_type& proto_sl) {
     /*
     Fortunately, AGG provides a rasterizer that fits perfectly to the flash
     data model. So we just have to feed AGG with all data and we're done. :-)
@@ -1462,102 +1789,134 @@ public:
     renderer_base& rbase = *m_rbase;
 
     typedef agg::rasterizer_compound_aa<agg::rasterizer_sl_clip_int> ras_type;
-    ras_type rasc;  // flash-like renderer
 
-    agg::renderer_scanline_aa_solid<
-      agg::renderer_base<PixelFormat> > ren_sl(rbase); // solid fills
-    agg::span_allocator<agg::rgba8> alloc;  // span allocator (?)
+    // Styles for the first band, built once. The other bands build
+    // their own, as AGG's span generators can't be shared.
+    StyleHandler first_sh;
+    build_agg_styles(first_sh, fill_styles, mat, cx);
+
+    RenderWorkers& workers = RenderWorkers::pool();
+    ClipBounds bands;
+
+    // Clipping bounds may share their edge pixels, so they are drawn
+    // one after the other.
+    for (const geometry::Range2d<int>* bounds : _clipbounds_selected) {
+
+      bands.clear();
+      if (workers.size() > 1) {
+        splitIntoBands(*bounds, agg_paths, dy, workers.size(), bands);
+      }
+
+      if (bands.empty()) {
+        ras_type rasc;
+        scanline_type sl(proto_sl);
+        draw_fills(rasc, *bounds, *bounds, paths, agg_paths, even_odd,
+            dx, dy, sl, rbase, first_sh);
+        continue;
+      }
+
+      workers.run(bands.size(), [&](size_t band) {
+
+        const geometry::Range2d<int>& rows = bands[band];
+        BandRasterizer<ras_type> rasc(rows.getMinY(), rows.getMaxY());
+        scanline_type sl(proto_sl);
+
+        // Only the rows of the band are written.
+        renderer_base band_rbase(*m_pixf);
+        band_rbase.clip_box(rows.getMinX(), rows.getMinY(),
+            rows.getMaxX(), rows.getMaxY());
+
+        StyleHandler band_sh;
+        if (band) build_agg_styles(band_sh, fill_styles, mat, cx);
+
+        draw_fills(rasc, *bounds, rows, paths, agg_paths, even_odd, dx, dy,
+            sl, band_rbase, band ? band_sh : first_sh);
+      });
+    }
     
+  } // draw_shape_impl
+
+  /// Rasterize the fills of a shape and draw them.
+  //
+  /// @param rasc     A compound rasterizer, empty.
+  /// @param bounds   The clipping bounds the paths are rasterized with.
+  /// @param rows     The rows drawn. Edges not reaching them are left
+  ///                 out (see BandFilter).
+  /// @param rbase    The renderer to draw to.
+  /// @param sh       The styles of the shape.
+  template <class Rasterizer, class scanline_type>
+  void draw_fills(Rasterizer& rasc, const geometry::Range2d<int>& bounds,
+    const geometry::Range2d<int>& rows, const GnashPaths& paths,
+    const AggPaths& agg_paths, bool even_odd, double dx, double dy,
+    scanline_type& sl, renderer_base& rbase, StyleHandler& sh) {
+
+    agg::span_allocator<agg::rgba8> alloc;  // span allocator (?)
 
     // activate even-odd filling rule
     if (even_odd)
       rasc.filling_rule(agg::fill_even_odd);
     else
       rasc.filling_rule(agg::fill_non_zero);
-      
-    
-    for (const geometry::Range2d<int>* bounds : _clipbounds_selected) {
 
-      applyClipBox<ras_type> (rasc, *bounds);
-      
-      // push paths to AGG
-      const size_t pcount = paths.size();
+    applyClipBox<Rasterizer> (rasc, bounds);
   
-      for (size_t pno=0; pno<pcount; ++pno) {
-          
-        const Path &this_path_gnash = paths[pno];
-        agg::path_storage &this_path_agg = 
-          const_cast<agg::path_storage&>(agg_paths[pno]);
-        
-        agg::conv_curve<agg::path_storage> curve(this_path_agg);        
+    // push paths to AGG
+    const size_t pcount = paths.size();
 
-        if ((this_path_gnash.m_fill0==0) && (this_path_gnash.m_fill1==0)) {
-          // Skip this path as it contains no fill style
-          continue;
-        } 
-        
-        // Tell the rasterizer which styles the following path will use.
-        // The good thing is, that it already supports two fill styles out of
-        // the box. 
-        // Flash uses value "0" for "no fill", whereas AGG uses "-1" for that. 
-        rasc.styles(this_path_gnash.m_fill0-1, this_path_gnash.m_fill1-1);
-                
-        // add path to the compound rasterizer
-        rasc.add_path(curve);
+    for (size_t pno=0; pno<pcount; ++pno) {
       
-      }
-
-      agg::render_scanlines_compound_layered(rasc, sl, rbase, alloc, sh);
+      const Path &this_path_gnash = paths[pno];
+
+      if ((this_path_gnash.m_fill0==0) && (this_path_gnash.m_fill1==0)) {
+        // Skip this path as it contains no fill style
+        continue;
+      } 
+    
+      PathReader reader(agg_paths[pno], dx, dy);
+      BandFilter<PathReader> band(reader, rows.getMinY(), rows.getMaxY());
+      agg::conv_curve<BandFilter<PathReader> > curve(band);
+
+      // Tell the rasterizer which styles the following path will use.
+      // The good thing is, that it already supports two fill styles
+      // out of the box. 
+      // Flash uses value "0" for "no fill", whereas AGG uses "-1"
+      // for that. 
+      rasc.styles(this_path_gnash.m_fill0-1, this_path_gnash.m_fill1-1);
+            
+      // add path to the compound rasterizer
+      rasc.add_path(curve);
+  
     }
-    
-  } // draw_shape_impl
+
+    agg::render_scanlines_compound_layered(rasc, sl, rbase, alloc, sh);
+  }
 
 
 
 
   // very similar to draw_shape but used for generating masks. There are no
   // fill styles nor subshapes and such. Just render plain solid shapes.
+  // The shapes are kept until the mask is complete; see end_submit_mask().
   void draw_mask_shape(const GnashPaths& paths, bool even_odd)
   {
-
-    const AlphaMasks::size_type mask_count = _alphaMasks.size();
-    
-    if (mask_count < 2) {
-    
-      // This is the first level mask
-      
-      typedef agg::scanline_u8 scanline_type;
-      
-      scanline_type sl;
-      
-      draw_mask_shape_impl(paths, even_odd, sl);
-        
-    }
-    else {
-    
-      // Woohoo! We're drawing a nested mask! Use the previous mask while 
-      // drawing the new one, the result will be the intersection.
-      
-      typedef agg::scanline_u8_am<agg::alpha_mask_gray8> scanline_type;
-      
-      scanline_type sl(_alphaMasks[mask_count - 2].getMask());
-      
-      draw_mask_shape_impl(paths, even_odd, sl);
-        
-    }
-    
+    const MaskShape shape = { paths, even_odd };
+    _maskShapes.push_back(shape);
   }
   
   
-  template <class scanline_type>
-  void draw_mask_shape_impl(const GnashPaths& paths, bool even_odd,
-    scanline_type& sl) {
+  /// Draw the coverage of shapes, as for masks and cached glyphs.
+  //
+  /// @param paths    The paths, in device TWIPS.
+  /// @param buffer   The coverage of the pixels within the bounds.
+  /// @param bounds   The pixels to draw to.
+  /// @param stride   The number of bytes between rows of the buffer.
+  void draw_coverage(const GnashPaths& paths, bool even_odd,
+    std::uint8_t* buffer, const geometry::Range2d<int>& bounds,
+    size_t stride) {
     
     typedef agg::pixfmt_gray8 pixfmt;
     typedef agg::renderer_base<pixfmt> renderer_base;
     
-    assert(!_alphaMasks.empty());
-    
     // dummy style handler
     typedef agg_mask_style_handler sh_type;
     sh_type sh;                   
@@ -1571,6 +1930,10 @@ public:
     if (even_odd) rasc.filling_rule(agg::fill_even_odd);
     else rasc.filling_rule(agg::fill_non_zero);
       
+    // The buffer starts at the top left corner of the bounds.
+    const double left = bounds.getMinX();
+    const double top = bounds.getMinY();
+
     // push paths to AGG
     agg::path_storage path; 
     agg::conv_curve<agg::path_storage> curve(path);
@@ -1590,6 +1953,7 @@ public:
       // Add all edges to the path.
       std::for_each(this_path.m_edges.begin(), this_path.m_edges.end(),
               EdgeToPath(path));
+      path.translate_all_paths(-left, -top);
       
       // add to rasterizer
       rasc.add_path(curve);
@@ -1597,17 +1961,21 @@ public:
     } // for path
     
     // renderer base
-    renderer_base& rbase = _alphaMasks.back().get_rbase();
+    agg::rendering_buffer rbuf(buffer, bounds.width() + 1,
+            bounds.height() + 1, stride);
+    pixfmt pixf(rbuf);
+    renderer_base rbase(pixf);
     
     // span allocator
     typedef agg::span_allocator<agg::gray8> alloc_type;
     alloc_type alloc; 
       
+    agg::scanline_u8 sl;
     
     // now render that thing!
     agg::render_scanlines_compound_layered (rasc, sl, rbase, alloc, sh);
         
-  } // draw_mask_shape
+  } // draw_coverage
 
 
 
@@ -1615,7 +1983,7 @@ public:
   void draw_outlines(const GnashPaths &paths,
     const AggPaths& agg_paths,
     const std::vector<LineStyle> &line_styles, const SWFCxForm& cx,
-    const SWFMatrix& linestyle_matrix) {
+    const SWFMatrix& linestyle_matrix, double dx, double dy) {
     
     if (_alphaMasks.empty()) {
     
@@ -1626,30 +1994,49 @@ public:
       scanline_type sl;
       
       draw_outlines_impl<scanline_type> (paths, agg_paths, 
-        line_styles, cx, linestyle_matrix, sl);
+        line_styles, cx, linestyle_matrix, dx, dy, sl);
         
     } else {
     
       // Mask is active, use alpha mask scanline renderer
       
-      typedef agg::scanline_u8_am<agg::alpha_mask_gray8> scanline_type;
+      typedef agg::scanline_u8_am<AlphaMask> scanline_type;
       
-      scanline_type sl(_alphaMasks.back().getMask());
+      scanline_type sl(_alphaMasks.back());
       
       draw_outlines_impl<scanline_type> (paths, agg_paths,
-        line_styles, cx, linestyle_matrix, sl);
+        line_styles, cx, linestyle_matrix, dx, dy, sl);
         
     }
     
   } //draw_outlines
 
 
+  /// The scale of the line styles of a shape, from TWIPS to pixels.
+  float strokeScale(const SWFMatrix& mat) {
+    // use avg between x and y scale
+    return (std::abs(mat.get_x_scale()) + std::abs(mat.get_y_scale())) /
+      2.0f * get_stroke_scale();
+  }
+
+  /// The width of a line on screen, in pixels.
+  static float strokeWidth(const LineStyle& lstyle, float stroke_scale) {
+    const int thickness = lstyle.getThickness();
+    if (!thickness) return 1; // hairline
+    if (!lstyle.scaleThicknessVertically() &&
+        !lstyle.scaleThicknessHorizontally()) {
+      return twipsToPixels(thickness);
+    }
+    return std::max(1.0f, thickness * stroke_scale);
+  }
+
   /// Template for draw_outlines(), see draw_shapes_impl().
   template <class scanline_type>
   void draw_outlines_impl(const GnashPaths &paths,
     const AggPaths& agg_paths,
     const std::vector<LineStyle> &line_styles, const SWFCxForm& cx, 
-    const SWFMatrix& linestyle_matrix, scanline_type& sl) {
+    const SWFMatrix& linestyle_matrix, double dx, double dy,
+    scanline_type& sl) {
     
     assert(m_pixf.get());
 
@@ -1662,9 +2049,7 @@ public:
     // has a line style associated, so that we avoid walking the paths again
     // when there really are no outlines to draw...
     
-    // use avg between x and y scale
-    const float stroke_scale = (std::abs(linestyle_matrix.get_x_scale()) + 
-       std::abs(linestyle_matrix.get_y_scale())) / 2.0f * get_stroke_scale();
+    const float stroke_scale = strokeScale(linestyle_matrix);
     
     
     // AGG stuff
@@ -1685,37 +2070,27 @@ public:
 
         const Path& this_path_gnash = paths[pno];
 
-        agg::path_storage &this_path_agg = 
-          const_cast<agg::path_storage&>(agg_paths[pno]);
-        
         if (this_path_gnash.m_line==0) {
           // Skip this path as it contains no line style
           continue;
         } 
         
-        agg::conv_curve< agg::path_storage > curve(this_path_agg); // to render curves
-        agg::conv_stroke< agg::conv_curve < agg::path_storage > > 
+        PathReader reader(agg_paths[pno], dx, dy);
+        agg::conv_curve<PathReader> curve(reader); // to render curves
+        agg::conv_stroke< agg::conv_curve<PathReader> > 
           stroke(curve);  // to get an outline
 
         const LineStyle& lstyle = line_styles[this_path_gnash.m_line-1];
           
-        int thickness = lstyle.getThickness();
-        if (!thickness) stroke.width(1); // hairline
-        else if ( (!lstyle.scaleThicknessVertically()) && (!lstyle.scaleThicknessHorizontally()) )
-        {
-          stroke.width(twipsToPixels(thickness));
-        }
-        else
+        if (lstyle.getThickness() && (lstyle.scaleThicknessVertically() !=
+                    lstyle.scaleThicknessHorizontally()))
         {
-          if ((!lstyle.scaleThicknessVertically()) ||
-                  (!lstyle.scaleThicknessHorizontally()))
-          {
              LOG_ONCE(log_unimpl(_("Unidirectionally scaled strokes in "
 				   "AGG renderer (we'll scale by the "
 				   "scalable one)")) );
-          }
-          stroke.width(std::max(1.0f, thickness*stroke_scale));
         }
+        const float width = strokeWidth(lstyle, stroke_scale);
+        stroke.width(width);
         
         // TODO: support endCapStyle
         
@@ -1728,7 +2103,10 @@ public:
           default : case CAP_ROUND : stroke.line_cap(agg::round_cap); 
         }
         
-        switch (lstyle.joinStyle()) {
+        // Joins of hairlines all look the same, and bevels have the
+        // fewest vertices.
+        if (width <= 1) stroke.line_join(agg::bevel_join);
+        else switch (lstyle.joinStyle()) {
           case JOIN_BEVEL : stroke.line_join(agg::bevel_join); break;
           case JOIN_MITER : stroke.line_join(agg::miter_join); break;
           default : case JOIN_ROUND : stroke.line_join(agg::round_join);
@@ -1841,9 +2219,9 @@ public:
     
       // apply mask
       
-      typedef agg::scanline_u8_am<agg::alpha_mask_gray8> sl_type; 
+      typedef agg::scanline_u8_am<AlphaMask> sl_type; 
       
-      sl_type sl(_alphaMasks.back().getMask());
+      sl_type sl(_alphaMasks.back());
          
       draw_poly_impl<sl_type>(&corners.front(), corners.size(), fill, outline, sl, mat);       
     
@@ -1911,6 +2289,8 @@ public:
   virtual void set_invalidated_regions(const InvalidatedRanges& ranges) {
     using gnash::geometry::Range2d;
     
+    sync();
+
     int count=0;
 
     _clipbounds_selected.clear();
@@ -1940,6 +2320,18 @@ public:
     //log_debug(_("%d inv. bounds in frame"), count);
     
   }
+
+  // Each clip bound only costs a scanline pass over the shapes touching
+  // it, so small scattered updates are best kept in small tiles.
+  virtual int getInvalidatedTileSize() const {
+    return 32;
+  }
+
+  // Drawing only touches the buffer and per-frame state, which the
+  // functions called from outside it sync() before changing.
+  virtual bool supportsBackgroundDrawing() const {
+    return true;
+  }
   
   
   virtual bool bounds_in_clipping_area(const geometry::Range2d<int>& bounds)
@@ -1958,6 +2350,8 @@ public:
 
   bool getPixel(rgba& color_return, int x, int y) const {
   
+    sync();
+
     if ((x<0) || (y<0) || (x>=xres) || (y>=yres))
       return false;
 
@@ -1973,12 +2367,14 @@ public:
   
   void set_scale(float new_xscale, float new_yscale) {
     
+    sync();
     scale_set=true;
     stage_matrix.set_identity();
     stage_matrix.set_scale(new_xscale/20.0f, new_yscale/20.0f);
   }
 
   void set_translation(float xoff, float yoff) {
+    sync();
     stage_matrix.set_translation(xoff, yoff);
   }
 
@@ -2015,6 +2411,18 @@ private:  // private variables
 
     // Alpha mask stack
     AlphaMasks _alphaMasks;
+
+    // The shapes of the mask being submitted
+    std::vector<MaskShape> _maskShapes;
+
+    /// The colors of recently drawn gradients.
+    GradientCache _gradients;
+
+    /// The AGG paths of recently drawn shapes.
+    PathCache _pathCache;
+
+    /// The coverage of recently drawn glyphs.
+    GlyphCache _glyphs;
     
     /// Cached fill style list with just one entry used for font rendering
     std::vector<FillStyle> m_single_FillStyles;
@@ -2077,21 +2485,25 @@ DSOEXPORT Renderer_agg_base*  create_Renderer_agg(const char *pixelformat)
 #endif   
 #ifdef PIXELFORMAT_RGBA32 
   if (!strcmp(pixelformat, "RGBA32"))
-    return new Renderer_agg<agg::pixfmt_rgba32_pre> (32);
+    return new Renderer_agg<SimdPixelFormat<agg::pixfmt_rgba32_pre,
+           simd::ORDER_RGBA> > (32);
   else 
 #endif   
 #ifdef PIXELFORMAT_BGRA32  
   if (!strcmp(pixelformat, "BGRA32"))
-    return new Renderer_agg<agg::pixfmt_bgra32_pre> (32);
+    return new Renderer_agg<SimdPixelFormat<agg::pixfmt_bgra32_pre,
+           simd::ORDER_BGRA> > (32);
 #endif   
 #ifdef PIXELFORMAT_RGBA32 
   if (!strcmp(pixelformat, "ARGB32"))
-    return new Renderer_agg<agg::pixfmt_argb32_pre> (32);
+    return new Renderer_agg<SimdPixelFormat<agg::pixfmt_argb32_pre,
+           simd::ORDER_ARGB> > (32);
   else 
 #endif   
 #ifdef PIXELFORMAT_BGRA32  
   if (!strcmp(pixelformat, "ABGR32"))
-    return new Renderer_agg<agg::pixfmt_abgr32_pre> (32);
+    return new Renderer_agg<SimdPixelFormat<agg::pixfmt_abgr32_pre,
+           simd::ORDER_ABGR> > (32);
         
   else 
 #endif
@@ -25,6 +25,8 @@
 
 #include "GnashImage.h"
 #include "CachedBitmap.h"
+#include "MipMaps.h"
+#include "SWFMatrix.h"
 
 namespace gnash {
 
@@ -41,16 +43,34 @@ public:
   
     image::GnashImage& image() {
         assert(!disposed());
+        // The image may be changed.
+        _mips.clear();
         return *_image;
     }
   
     void dispose() {
         _image.reset();
+        _mips.clear();
     }
 
     bool disposed() const {
         return !_image.get();
     }
+
+    size_t memoryUsage() const {
+        return _image.get() ? _image->size() + _mips.memoryUsage() : 0;
+    }
+
+    /// The image to draw the bitmap from, see MipMaps::select().
+    //
+    /// @param mat      The matrix from the device to the bitmap's pixels,
+    ///                 changed to one to the image's.
+    /// @param smooth   Whether the bitmap is smoothed.
+    std::shared_ptr<const image::GnashImage> select(SWFMatrix& mat,
+            bool smooth) const {
+        assert(!disposed());
+        return _mips.select(_image, mat, smooth);
+    }
    
     int get_width() const { return _image->width(); }  
     int get_height() const { return _image->height();  }  
@@ -60,9 +80,12 @@ public:
     
 private:
   
-    std::unique_ptr<image::GnashImage> _image;
+    std::shared_ptr<image::GnashImage> _image;
   
     int _bpp;
+
+    /// Images of the bitmap at halved sizes, built when drawn.
+    mutable MipMaps _mips;
       
 };
 
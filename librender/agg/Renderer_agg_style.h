@@ -24,10 +24,10 @@
 // to re-check the bitmap definitions as parsing goes on.
 
 #include <vector>
+#include <memory>
 #include <boost/ptr_container/ptr_vector.hpp>
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
-#include <agg_gradient_lut.h>
 #include <agg_color_rgba.h>
 #include <agg_color_gray.h>
 #include <agg_image_accessors.h>
@@ -41,7 +41,7 @@
 #include <agg_pixfmt_rgba.h>
 #pragma GCC diagnostic pop
 
-#include "LinearRGB.h"
+#include "GradientCache.h"
 #include "Renderer_agg_bitmap.h"
 #include "GnashAlgorithm.h"
 #include "FillStyle.h"
@@ -64,14 +64,13 @@ namespace {
             const agg_bitmap_info* bi, const SWFMatrix& mat, const SWFCxForm& cx,
             bool smooth);
 
-    /// Creates many (should be 18) gradient functions.
+    /// Creates many (should be 9) gradient functions.
     void storeGradient(StyleHandler& st, const GradientFill& fs,
-            const SWFMatrix& mat, const SWFCxForm& cx);
+            const SWFMatrix& mat,
+            const std::shared_ptr<const GradientCache::Lut>& lut);
     template<typename Spread> void storeGradient(StyleHandler& st,
-            const GradientFill& fs, const SWFMatrix& mat, const SWFCxForm& cx);
-    template<typename Spread, typename Interpolation>
-            void storeGradient(StyleHandler& st, const GradientFill& fs,
-            const SWFMatrix& mat, const SWFCxForm& cx);
+            const GradientFill& fs, const SWFMatrix& mat,
+            const std::shared_ptr<const GradientCache::Lut>& lut);
 }
 
 /// Internal style class that represents a fill style. Roughly speaking, AGG 
@@ -214,20 +213,28 @@ struct Pad
     };
 };
 
-/// The default RGB color interpolator
-struct InterpolatorLinearRGB
+/// The colors of a gradient, looked up by AGG's span_gradient.
+class GradientColors
 {
-    template<typename Pixel> struct Type {
-        typedef agg::gradient_lut<linear_rgb_interpolator<Pixel>, 256> type;
-    };
-};
+public:
+    typedef agg::rgba8 color_type;
 
-/// The default RGB color interpolator
-struct InterpolatorRGB
-{
-    template<typename Pixel> struct Type {
-        typedef agg::gradient_lut<agg::color_interpolator<Pixel>, 256> type;
-    };
+    explicit GradientColors(std::shared_ptr<const GradientCache::Lut> lut)
+        :
+        _lut(std::move(lut))
+    {
+    }
+
+    static unsigned size() {
+        return std::tuple_size<GradientCache::Lut>::value;
+    }
+
+    const color_type& operator[](unsigned i) const {
+        return (*_lut)[i];
+    }
+
+private:
+    std::shared_ptr<const GradientCache::Lut> _lut;
 };
 
 /// AGG gradient fill style. Don't use Gnash texture bitmaps as this is slower
@@ -241,56 +248,31 @@ class GradientStyle : public AggStyle
 {
 public:
   
-    GradientStyle(const GradientFill& fs, const SWFMatrix& mat,
-            SWFCxForm cx, int norm_size, GradientType gr = GradientType())
+    /// @param lut      The premultiplied colors of the gradient, which are
+    ///                 built and shared by a GradientCache.
+    GradientStyle(const SWFMatrix& mat,
+            std::shared_ptr<const GradientCache::Lut> lut, int norm_size,
+            GradientType gr = GradientType())
         :
         AggStyle(false),
-        m_cx(std::move(cx)),
         m_tr(mat.a() / 65536.0, mat.b() / 65536.0, mat.c() / 65536.0,
               mat.d() / 65536.0, mat.tx(), mat.ty()),
         m_span_interpolator(m_tr),
         m_gradient_adaptor(std::move(gr)),
+        m_gradient_lut(std::move(lut)),
         m_sg(m_span_interpolator, m_gradient_adaptor, m_gradient_lut, 0,
-                norm_size),
-      
-        m_need_premultiply(false)
+                norm_size)
     {
-        // Build gradient lookup table
-        m_gradient_lut.remove_all(); 
-        const size_t size = fs.recordCount();
-      
-        // It is essential that at least two colours are added; otherwise agg
-        // will use uninitialized values.
-        assert(size > 1);
-    
-        for (size_t i = 0; i != size; ++i) { 
-            const GradientRecord& gr = fs.record(i); 
-            const rgba tr = m_cx.transform(gr.color);
-            if (tr.m_a < 0xff) m_need_premultiply = true;    
-            m_gradient_lut.add_color(gr.ratio / 255.0,
-                    agg::rgba8(tr.m_r, tr.m_g, tr.m_b, tr.m_a));
-        } 
-        m_gradient_lut.build_lut();
-        
     } // GradientStyle constructor
   
     virtual ~GradientStyle() { }
   
     void generate_span(Color* span, int x, int y, unsigned len) {
         m_sg.generate(span, x, y, len);
-        if (!m_need_premultiply) return;
-        
-        while (len--) {
-            span->premultiply();
-            ++span;
-        }
     }
     
 protected:
     
-    // Color transform
-    SWFCxForm m_cx;
-    
     // Span allocator
     Allocator m_sa;
     
@@ -308,23 +290,19 @@ protected:
     
     // Span generator
     SpanGenerator m_sg;  
-  
-    // premultiplication necessary?
-    bool m_need_premultiply;
 }; 
 
 /// A set of typedefs for a Gradient
 //
 /// @tparam G       An agg gradient type
 /// @tparam A       The type of Adaptor: see Reflect, Repeat, Pad
-/// @tparam I       The type of ColorInterpolator: see InterpolatorRGB
-template<typename G, typename A, typename I>
+template<typename G, typename A>
 struct Gradient
 {
     typedef agg::rgba8 Color;            
     typedef G GradientType;
     typedef typename A::template Type<G>::type Adaptor;
-    typedef typename I::template Type<Color>::type ColorInterpolator;
+    typedef GradientColors ColorInterpolator;
     typedef agg::span_allocator<Color> Allocator;
     typedef agg::span_interpolator_linear<agg::trans_affine> Interpolator;
     typedef agg::span_gradient<Color, Interpolator, Adaptor,
@@ -358,18 +336,23 @@ public:
 /// the class types are defined outside. The bitmap can be tiled or clipped.
 /// It can have any transformation SWFMatrix and color transform. Any pixel format
 /// can be used, too. 
+///
+/// The image is the bitmap or one of its mip levels, and is kept while the
+/// style is used.
 template <class PixelFormat, class Allocator, class SourceType,
        class Interpolator, class Generator>
 class BitmapStyle : public AggStyle
 {
 public:
     
-  BitmapStyle(int width, int height, int rowlen, std::uint8_t* data,
+  BitmapStyle(std::shared_ptr<const image::GnashImage> im,
     const SWFMatrix& mat, SWFCxForm cx)
     :
     AggStyle(false),
     m_cx(std::move(cx)),
-    m_rbuf(data, width, height, rowlen),  
+    _image(std::move(im)),
+    m_rbuf(const_cast<std::uint8_t*>(_image->begin()), _image->width(),
+            _image->height(), _image->stride()),
     m_pixf(m_rbuf),
     m_img_src(m_pixf),
     m_tr(mat.a() / 65535.0, mat.b() / 65535.0, mat.c() / 65535.0,
@@ -407,6 +390,9 @@ private:
     // Color transform
     SWFCxForm m_cx;
 
+    // The pixels
+    const std::shared_ptr<const image::GnashImage> _image;
+
     // Pixel access
     agg::rendering_buffer m_rbuf;
     PixelFormat m_pixf;
@@ -474,24 +460,24 @@ public:
     } 
 
     template<typename T>
-    void addLinearGradient(const GradientFill& fs, const SWFMatrix& mat,
-            const SWFCxForm& cx)
+    void addLinearGradient(const SWFMatrix& mat,
+            const std::shared_ptr<const GradientCache::Lut>& lut)
     {
         // NOTE: The value 256 is based on the bitmap texture used by other
         // Gnash renderers which is normally 256x1 pixels for linear gradients.
-        typename T::Type* st = new typename T::Type(fs, mat, cx, 256);
+        typename T::Type* st = new typename T::Type(mat, lut, 256);
         _styles.push_back(st);
     }
     
     template<typename T>
     void addFocalGradient(const GradientFill& fs, const SWFMatrix& mat,
-            const SWFCxForm& cx)
+            const std::shared_ptr<const GradientCache::Lut>& lut)
     {
         typename T::GradientType gr;
         gr.init(32.0, fs.focalPoint() * 32.0, 0.0);
         
         // div 2 because we need radius, not diameter      
-        typename T::Type* st = new typename T::Type(fs, mat, cx, 32.0, gr); 
+        typename T::Type* st = new typename T::Type(mat, lut, 32.0, gr); 
         
         // NOTE: The value 64 is based on the bitmap texture used by other
         // Gnash renderers which is normally 64x64 pixels for radial gradients.
@@ -499,12 +485,12 @@ public:
     }
     
     template<typename T>
-    void addRadialGradient(const GradientFill& fs, const SWFMatrix& mat,
-            const SWFCxForm& cx)
+    void addRadialGradient(const SWFMatrix& mat,
+            const std::shared_ptr<const GradientCache::Lut>& lut)
     {
 
         // div 2 because we need radius, not diameter      
-        typename T::Type* st = new typename T::Type(fs, mat, cx, 64 / 2); 
+        typename T::Type* st = new typename T::Type(mat, lut, 64 / 2); 
           
         // NOTE: The value 64 is based on the bitmap texture used by other
         // Gnash renderers which is normally 64x64 pixels for radial gradients.
@@ -532,9 +518,12 @@ public:
     //
     /// @tparam Filter      The FilterType to use. This affects scaling
     ///                     quality, pixel type etc.
+    ///
+    /// @param smooth       Whether the filter smoothes the bitmap, which
+    ///                     decides how its mip levels are built.
     template<typename Filter> void
     addBitmap(const agg_bitmap_info* bi, const SWFMatrix& mat,
-            const SWFCxForm& cx)
+            const SWFCxForm& cx, bool smooth)
     {
         typedef typename Filter::PixelFormat PixelFormat;
         typedef typename Filter::Generator Generator;
@@ -545,8 +534,9 @@ public:
         typedef BitmapStyle<PixelFormat, Allocator,
                 SourceType, Interpolator, Generator> Style;
       
-        Style* st = new Style(bi->get_width(), bi->get_height(),
-          bi->get_rowlen(), bi->get_data(), mat, cx);       
+        // Bitmaps drawn scaled down are drawn from a smaller image.
+        SWFMatrix m = mat;
+        Style* st = new Style(bi->select(m, smooth), m, cx);
         
         _styles.push_back(st);
     }
@@ -592,13 +582,14 @@ private:
 struct AddStyles : boost::static_visitor<>
 {
     AddStyles(SWFMatrix stage, SWFMatrix fill, const SWFCxForm& c,
-            StyleHandler& sh, Quality q)
+            StyleHandler& sh, Quality q, GradientCache& gradients)
         :
         _stageMatrix(stage.invert()),
         _fillMatrix(fill.invert()),
         _cx(c),
         _sh(sh),
-        _quality(q)
+        _quality(q),
+        _gradients(gradients)
     {
     }
 
@@ -606,7 +597,7 @@ struct AddStyles : boost::static_visitor<>
           SWFMatrix m = f.matrix();
           m.concatenate(_fillMatrix);
           m.concatenate(_stageMatrix);
-          storeGradient(_sh, f, m, _cx);
+          storeGradient(_sh, f, m, _gradients.get(f, _cx));
     }
 
     void operator()(const SolidFill& f) const {
@@ -674,6 +665,9 @@ private:
     const SWFCxForm& _cx;
     StyleHandler& _sh;
     const Quality _quality;
+
+    /// Where the colors of gradients are built.
+    GradientCache& _gradients;
 };  
 
 namespace {
@@ -684,10 +678,10 @@ storeBitmap(StyleHandler& st, const agg_bitmap_info* bi,
         const SWFMatrix& mat, const SWFCxForm& cx, bool smooth)
 {
     if (smooth) {
-        st.addBitmap<AA<Pixel, FillMode> >(bi, mat, cx);
+        st.addBitmap<AA<Pixel, FillMode> >(bi, mat, cx, true);
         return;
     }
-    st.addBitmap<NN<Pixel, FillMode> >(bi, mat, cx);
+    st.addBitmap<NN<Pixel, FillMode> >(bi, mat, cx, false);
 }
 
 template<typename FillMode>
@@ -703,64 +697,48 @@ storeBitmap(StyleHandler& st, const agg_bitmap_info* bi,
     storeBitmap<FillMode, RGBA>(st, bi, mat, cx, smooth);
 }
 
-template<typename Spread, typename Interpolation>
+template<typename Spread>
 void
 storeGradient(StyleHandler& st, const GradientFill& fs, const SWFMatrix& mat,
-        const SWFCxForm& cx)
+        const std::shared_ptr<const GradientCache::Lut>& lut)
 {
       
     typedef agg::gradient_x Linear;
     typedef agg::gradient_radial Radial;
     typedef agg::gradient_radial_focus Focal;
 
-    typedef Gradient<Linear, Spread, Interpolation> LinearGradient;
-    typedef Gradient<Focal, Spread, Interpolation> FocalGradient;
-    typedef Gradient<Radial, Spread, Interpolation> RadialGradient;
+    typedef Gradient<Linear, Spread> LinearGradient;
+    typedef Gradient<Focal, Spread> FocalGradient;
+    typedef Gradient<Radial, Spread> RadialGradient;
 
     switch (fs.type()) {
         case GradientFill::LINEAR:
-            st.addLinearGradient<LinearGradient>(fs, mat, cx);
+            st.addLinearGradient<LinearGradient>(mat, lut);
             return;
       
         case GradientFill::RADIAL:
             if (fs.focalPoint()) {
-                st.addFocalGradient<FocalGradient>(fs, mat, cx);
+                st.addFocalGradient<FocalGradient>(fs, mat, lut);
                 return;
             }
-            st.addRadialGradient<RadialGradient>(fs, mat, cx);
+            st.addRadialGradient<RadialGradient>(mat, lut);
     }
 }
 
-template<typename Spread>
-void
-storeGradient(StyleHandler& st, const GradientFill& fs, const SWFMatrix& mat,
-        const SWFCxForm& cx)
-{
-    switch (fs.interpolation) {
-        case SWF::GRADIENT_INTERPOLATION_NORMAL:
-            storeGradient<Spread, InterpolatorRGB>(st, fs, mat, cx);
-            break;
-        case SWF::GRADIENT_INTERPOLATION_LINEAR:
-            storeGradient<Spread, InterpolatorLinearRGB>(st, fs, mat, cx);
-            break;
-    }
-
-}
-
 void
 storeGradient(StyleHandler& st, const GradientFill& fs, const SWFMatrix& mat,
-        const SWFCxForm& cx)
+        const std::shared_ptr<const GradientCache::Lut>& lut)
 {   
 
       switch (fs.spreadMode) {
           case GradientFill::PAD:
-              storeGradient<Pad>(st, fs, mat, cx);
+              storeGradient<Pad>(st, fs, mat, lut);
               break;
           case GradientFill::REFLECT:
-              storeGradient<Reflect>(st, fs, mat, cx);
+              storeGradient<Reflect>(st, fs, mat, lut);
               break;
           case GradientFill::REPEAT:
-              storeGradient<Repeat>(st, fs, mat, cx);
+              storeGradient<Repeat>(st, fs, mat, lut);
               break;
       }
 }
@@ -0,0 +1,356 @@
+// SimdBlend.cpp: vectorized blending of premultiplied pixels, for Gnash.
+//
+//   Copyright (C) 2012 Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#include "SimdBlend.h"
+
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+# define GNASH_SIMD_X86 1
+# include <immintrin.h>
+#endif
+
+// AGG blends a premultiplied color c with alpha a and coverage cover
+// over a pixel p as follows, with k = cover + 1 and a' = (a * k) >> 8:
+//
+//  color channels: (p * (255 - a') + c * k) >> 8
+//  alpha channel:  255 - (((255 - a') * (255 - p)) >> 8)
+//
+// This is also what its shortcuts for full coverage and opaque colors
+// give. When c <= a, as it is for valid premultiplied colors, no
+// intermediate value exceeds 65535, so the vector code works on 16-bit
+// lanes. Colors breaking that rule are blended by the scalar code.
+
+namespace gnash {
+namespace simd {
+
+namespace {
+
+/// The positions of the channels in a pixel.
+template<Order O> struct Channels;
+
+template<> struct Channels<ORDER_RGBA> { enum { R = 0, G = 1, B = 2, A = 3 }; };
+template<> struct Channels<ORDER_BGRA> { enum { R = 2, G = 1, B = 0, A = 3 }; };
+template<> struct Channels<ORDER_ARGB> { enum { R = 1, G = 2, B = 3, A = 0 }; };
+template<> struct Channels<ORDER_ABGR> { enum { R = 3, G = 2, B = 1, A = 0 }; };
+
+template<class C>
+inline void
+blendPixel(std::uint8_t* p, const std::uint8_t* c, unsigned cover)
+{
+    const unsigned a = c[3];
+    if (!a) return;
+
+    const unsigned k = cover + 1;
+    const unsigned inv = 255 - ((a * k) >> 8);
+    p[C::R] = (p[C::R] * inv + c[0] * k) >> 8;
+    p[C::G] = (p[C::G] * inv + c[1] * k) >> 8;
+    p[C::B] = (p[C::B] * inv + c[2] * k) >> 8;
+    p[C::A] = 255 - ((inv * (255 - p[C::A])) >> 8);
+}
+
+template<class C>
+void
+blendScalar(std::uint8_t* p, unsigned len, const std::uint8_t* colors,
+        bool solid, const std::uint8_t* covers, std::uint8_t cover)
+{
+    for (; len; --len, p += 4) {
+        blendPixel<C>(p, colors, covers ? *covers++ : cover);
+        if (!solid) colors += 4;
+    }
+}
+
+#ifdef GNASH_SIMD_X86
+
+/// The pshuflw/pshufhw immediate moving r, g, b, a to their positions.
+template<class C>
+struct Shuffle
+{
+    enum { value = (0 << (2 * C::R)) | (1 << (2 * C::G)) |
+        (2 << (2 * C::B)) | (3 << (2 * C::A)) };
+};
+
+/// Whether any channel of four r, g, b, a colors exceeds its alpha.
+__attribute__((target("sse2")))
+inline bool
+invalidSSE2(__m128i c)
+{
+    __m128i a = _mm_srli_epi32(c, 24);
+    a = _mm_or_si128(a, _mm_slli_epi32(a, 8));
+    a = _mm_or_si128(a, _mm_slli_epi32(a, 16));
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_max_epu8(c, a), a)) != 0xffff;
+}
+
+/// Repeat four coverage values four times each.
+__attribute__((target("sse2")))
+inline __m128i
+coversSSE2(const std::uint8_t* covers)
+{
+    std::int32_t v;
+    std::memcpy(&v, covers, 4);
+    __m128i c = _mm_cvtsi32_si128(v);
+    c = _mm_unpacklo_epi8(c, c);
+    return _mm_unpacklo_epi16(c, c);
+}
+
+/// Blend two pixels held in 16-bit lanes.
+template<class C>
+__attribute__((target("sse2")))
+inline __m128i
+blendSSE2(__m128i d, __m128i s, __m128i cover)
+{
+    const __m128i full = _mm_set1_epi16(255);
+    const __m128i alphaLanes = C::A != 0 ?
+        _mm_set_epi16(-1, 0, 0, 0, -1, 0, 0, 0) :
+        _mm_set_epi16(0, 0, 0, -1, 0, 0, 0, -1);
+
+    const __m128i a = _mm_shufflehi_epi16(_mm_shufflelo_epi16(s, 0xff), 0xff);
+    const __m128i k = _mm_add_epi16(cover, _mm_set1_epi16(1));
+    const __m128i inv = _mm_sub_epi16(full,
+            _mm_srli_epi16(_mm_mullo_epi16(a, k), 8));
+
+    s = _mm_shufflelo_epi16(s, Shuffle<C>::value);
+    s = _mm_shufflehi_epi16(s, Shuffle<C>::value);
+
+    const __m128i color = _mm_srli_epi16(_mm_add_epi16(
+                _mm_mullo_epi16(d, inv), _mm_mullo_epi16(s, k)), 8);
+    const __m128i alpha = _mm_sub_epi16(full, _mm_srli_epi16(
+                _mm_mullo_epi16(inv, _mm_sub_epi16(full, d)), 8));
+
+    const __m128i r = _mm_or_si128(_mm_and_si128(alphaLanes, alpha),
+            _mm_andnot_si128(alphaLanes, color));
+
+    // Pixels under a transparent color are left alone.
+    const __m128i skip = _mm_cmpeq_epi16(a, _mm_setzero_si128());
+    return _mm_or_si128(_mm_and_si128(skip, d), _mm_andnot_si128(skip, r));
+}
+
+template<class C>
+__attribute__((target("sse2")))
+void
+blendSpanSSE2(std::uint8_t* p, unsigned len, const std::uint8_t* colors,
+        bool solid, const std::uint8_t* covers, std::uint8_t cover)
+{
+    const __m128i zero = _mm_setzero_si128();
+
+    __m128i src = zero;
+    if (solid) {
+        std::int32_t v;
+        std::memcpy(&v, colors, 4);
+        src = _mm_set1_epi32(v);
+        if (invalidSSE2(src)) {
+            blendScalar<C>(p, len, colors, solid, covers, cover);
+            return;
+        }
+    }
+    __m128i cov = _mm_set1_epi8(cover);
+
+    for (; len >= 4; len -= 4, p += 16) {
+        if (!solid) {
+            src = _mm_loadu_si128(reinterpret_cast<const __m128i*>(colors));
+            if (invalidSSE2(src)) {
+                blendScalar<C>(p, 4, colors, solid, covers, cover);
+                colors += 16;
+                if (covers) covers += 4;
+                continue;
+            }
+            colors += 16;
+        }
+        if (covers) {
+            cov = coversSSE2(covers);
+            covers += 4;
+        }
+
+        __m128i* dst = reinterpret_cast<__m128i*>(p);
+        const __m128i d = _mm_loadu_si128(dst);
+        const __m128i lo = blendSSE2<C>(_mm_unpacklo_epi8(d, zero),
+                _mm_unpacklo_epi8(src, zero), _mm_unpacklo_epi8(cov, zero));
+        const __m128i hi = blendSSE2<C>(_mm_unpackhi_epi8(d, zero),
+                _mm_unpackhi_epi8(src, zero), _mm_unpackhi_epi8(cov, zero));
+        _mm_storeu_si128(dst, _mm_packus_epi16(lo, hi));
+    }
+
+    blendScalar<C>(p, len, colors, solid, covers, cover);
+}
+
+__attribute__((target("avx2")))
+inline bool
+invalidAVX2(__m256i c)
+{
+    __m256i a = _mm256_srli_epi32(c, 24);
+    a = _mm256_or_si256(a, _mm256_slli_epi32(a, 8));
+    a = _mm256_or_si256(a, _mm256_slli_epi32(a, 16));
+    return _mm256_movemask_epi8(
+            _mm256_cmpeq_epi8(_mm256_max_epu8(c, a), a)) != -1;
+}
+
+/// Repeat eight coverage values four times each.
+__attribute__((target("avx2")))
+inline __m256i
+coversAVX2(const std::uint8_t* covers)
+{
+    __m128i c = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(covers));
+    c = _mm_unpacklo_epi8(c, c);
+    return _mm256_inserti128_si256(
+            _mm256_castsi128_si256(_mm_unpacklo_epi16(c, c)),
+            _mm_unpackhi_epi16(c, c), 1);
+}
+
+/// Blend four pixels held in 16-bit lanes, two in each half.
+template<class C>
+__attribute__((target("avx2")))
+inline __m256i
+blendAVX2(__m256i d, __m256i s, __m256i cover)
+{
+    const __m256i full = _mm256_set1_epi16(255);
+    const __m256i alphaLanes = C::A != 0 ?
+        _mm256_set_epi16(-1, 0, 0, 0, -1, 0, 0, 0, -1, 0, 0, 0, -1, 0, 0, 0) :
+        _mm256_set_epi16(0, 0, 0, -1, 0, 0, 0, -1, 0, 0, 0, -1, 0, 0, 0, -1);
+
+    const __m256i a =
+        _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(s, 0xff), 0xff);
+    const __m256i k = _mm256_add_epi16(cover, _mm256_set1_epi16(1));
+    const __m256i inv = _mm256_sub_epi16(full,
+            _mm256_srli_epi16(_mm256_mullo_epi16(a, k), 8));
+
+    s = _mm256_shufflelo_epi16(s, Shuffle<C>::value);
+    s = _mm256_shufflehi_epi16(s, Shuffle<C>::value);
+
+    const __m256i color = _mm256_srli_epi16(_mm256_add_epi16(
+                _mm256_mullo_epi16(d, inv), _mm256_mullo_epi16(s, k)), 8);
+    const __m256i alpha = _mm256_sub_epi16(full, _mm256_srli_epi16(
+                _mm256_mullo_epi16(inv, _mm256_sub_epi16(full, d)), 8));
+
+    const __m256i r = _mm256_blendv_epi8(color, alpha, alphaLanes);
+
+    const __m256i skip = _mm256_cmpeq_epi16(a, _mm256_setzero_si256());
+    return _mm256_blendv_epi8(r, d, skip);
+}
+
+template<class C>
+__attribute__((target("avx2")))
+void
+blendSpanAVX2(std::uint8_t* p, unsigned len, const std::uint8_t* colors,
+        bool solid, const std::uint8_t* covers, std::uint8_t cover)
+{
+    const __m256i zero = _mm256_setzero_si256();
+
+    __m256i src = zero;
+    if (solid) {
+        std::int32_t v;
+        std::memcpy(&v, colors, 4);
+        src = _mm256_set1_epi32(v);
+        if (invalidAVX2(src)) {
+            blendScalar<C>(p, len, colors, solid, covers, cover);
+            return;
+        }
+    }
+    __m256i cov = _mm256_set1_epi8(cover);
+
+    for (; len >= 8; len -= 8, p += 32) {
+        if (!solid) {
+            src = _mm256_loadu_si256(
+                    reinterpret_cast<const __m256i*>(colors));
+            if (invalidAVX2(src)) {
+                blendScalar<C>(p, 8, colors, solid, covers, cover);
+                colors += 32;
+                if (covers) covers += 8;
+                continue;
+            }
+            colors += 32;
+        }
+        if (covers) {
+            cov = coversAVX2(covers);
+            covers += 8;
+        }
+
+        __m256i* dst = reinterpret_cast<__m256i*>(p);
+        const __m256i d = _mm256_loadu_si256(dst);
+        const __m256i lo = blendAVX2<C>(_mm256_unpacklo_epi8(d, zero),
+                _mm256_unpacklo_epi8(src, zero),
+                _mm256_unpacklo_epi8(cov, zero));
+        const __m256i hi = blendAVX2<C>(_mm256_unpackhi_epi8(d, zero),
+                _mm256_unpackhi_epi8(src, zero),
+                _mm256_unpackhi_epi8(cov, zero));
+        _mm256_storeu_si256(dst, _mm256_packus_epi16(lo, hi));
+    }
+
+    blendSpanSSE2<C>(p, len, colors, solid, covers, cover);
+}
+
+#endif // GNASH_SIMD_X86
+
+template<Order O>
+void
+blend(Level level, std::uint8_t* p, unsigned len, const std::uint8_t* colors,
+        bool solid, const std::uint8_t* covers, std::uint8_t cover)
+{
+    typedef Channels<O> C;
+
+    if (solid && !colors[3]) return;
+
+    switch (level) {
+#ifdef GNASH_SIMD_X86
+        case LEVEL_AVX2:
+            blendSpanAVX2<C>(p, len, colors, solid, covers, cover);
+            return;
+        case LEVEL_SSE2:
+            blendSpanSSE2<C>(p, len, colors, solid, covers, cover);
+            return;
+#endif
+        default:
+            blendScalar<C>(p, len, colors, solid, covers, cover);
+    }
+}
+
+} // anonymous namespace
+
+Level
+bestLevel()
+{
+#ifdef GNASH_SIMD_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return LEVEL_AVX2;
+    if (__builtin_cpu_supports("sse2")) return LEVEL_SSE2;
+#endif
+    return LEVEL_SCALAR;
+}
+
+void
+blendSpan(Level level, Order order, std::uint8_t* p, unsigned len,
+        const std::uint8_t* colors, bool solid, const std::uint8_t* covers,
+        std::uint8_t cover)
+{
+    switch (order) {
+        case ORDER_RGBA:
+            blend<ORDER_RGBA>(level, p, len, colors, solid, covers, cover);
+            break;
+        case ORDER_BGRA:
+            blend<ORDER_BGRA>(level, p, len, colors, solid, covers, cover);
+            break;
+        case ORDER_ARGB:
+            blend<ORDER_ARGB>(level, p, len, colors, solid, covers, cover);
+            break;
+        case ORDER_ABGR:
+            blend<ORDER_ABGR>(level, p, len, colors, solid, covers, cover);
+            break;
+    }
+}
+
+} // namespace simd
+} // namespace gnash
@@ -0,0 +1,73 @@
+// SimdBlend.h: vectorized blending of premultiplied pixels, for Gnash.
+//
+//   Copyright (C) 2012 Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifndef GNASH_SIMDBLEND_H
+#define GNASH_SIMDBLEND_H
+
+#include <cstdint>
+
+#include "dsodefs.h" // for DSOEXPORT
+
+namespace gnash {
+namespace simd {
+
+/// The instructions used for blending.
+enum Level
+{
+    LEVEL_SCALAR,
+    LEVEL_SSE2,
+    LEVEL_AVX2
+};
+
+/// The positions of the channels in a 32-bit pixel, in memory order.
+enum Order
+{
+    ORDER_RGBA,
+    ORDER_BGRA,
+    ORDER_ARGB,
+    ORDER_ABGR
+};
+
+/// The fastest level the processor supports.
+DSOEXPORT Level bestLevel();
+
+/// Blend premultiplied colors over a row of 32-bit premultiplied pixels.
+//
+/// The result is exactly what AGG 2.4's pixfmt_alpha_blend_rgba gives
+/// with blender_rgba_pre, at any level. Pixels whose color has a zero
+/// alpha are left alone.
+///
+/// @param level    The instructions to use. Levels the processor does not
+///                 support must not be used.
+/// @param order    The order of the channels of the pixels.
+/// @param p        The first pixel.
+/// @param len      The number of pixels.
+/// @param colors   The colors, four bytes each in r, g, b, a order.
+/// @param solid    If true, colors holds one color blended over all the
+///                 pixels, otherwise it holds one color per pixel.
+/// @param covers   One coverage value per pixel, or nullptr to use
+///                 cover for all pixels.
+/// @param cover    The coverage of all pixels if covers is nullptr.
+DSOEXPORT void blendSpan(Level level, Order order, std::uint8_t* p,
+        unsigned len, const std::uint8_t* colors, bool solid,
+        const std::uint8_t* covers, std::uint8_t cover);
+
+} // namespace simd
+} // namespace gnash
+
+#endif
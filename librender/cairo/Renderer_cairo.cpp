@@ -129,6 +129,11 @@ class bitmap_info_cairo : public CachedBitmap, boost::noncopyable
     virtual bool disposed() const {
         return !_data.get();
     }
+
+    virtual size_t memoryUsage() const {
+        // Cairo surfaces always use 32 bits per pixel.
+        return _data.get() ? static_cast<size_t>(_width) * _height * 4 : 0;
+    }
    
     
     image::GnashImage& image() {
@@ -142,6 +142,11 @@ public:
         return _disposed;
     }
 
+    virtual size_t memoryUsage() const {
+        const size_t channels = _pixel_format == GL_RGB ? 3 : 4;
+        return _orig_width * _orig_height * channels;
+    }
+
     virtual image::GnashImage& image() {
         if (_cache.get()) return *_cache;
         switch (_pixel_format) {
@@ -49,6 +49,7 @@ public:
 
     void dispose()  { _image.reset(); }
     bool disposed() const { return !_image.get(); }
+    size_t memoryUsage() const { return _image.get() ? _image->size() : 0; }
 
     image::GnashImage& image() {
         assert(!disposed());
@@ -0,0 +1,135 @@
+// 
+//   Copyright (C) 2012 Free Software Foundation, Inc
+// 
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifdef HAVE_CONFIG_H
+#include "gnashconfig.h"
+#endif
+
+#include "check.h"
+
+#include "DiskCache.h"
+#include "IOChannel.h"
+
+#include <cstdio>
+#include <cstring>
+#include <utime.h>
+#include <string>
+#include <vector>
+#include <memory>
+
+using namespace gnash;
+
+TestState runtest;
+
+namespace {
+
+const char* const cacheDir = "DiskCacheTestDir";
+
+bool
+store(DiskCache& cache, const std::string& key, size_t size, char c)
+{
+    std::string temp;
+    std::unique_ptr<IOChannel> out = cache.create(key, temp);
+    if (!out.get()) return false;
+    const std::vector<char> data(size, c);
+    const bool ok = out->write(&data.front(), size) ==
+        static_cast<std::streamsize>(size);
+    out.reset();
+    return cache.commit(key, temp, ok);
+}
+
+}
+
+int
+main(int /*argc*/, char** /*argv*/)
+{
+    DiskCache disabled("", 1000);
+    check(!disabled.enabled());
+    std::string temp;
+    check(!disabled.create("key", temp).get());
+    check(!disabled.get("key").get());
+
+    // Keys depend on the data and its size.
+    const std::uint8_t a[] = { 1, 2, 3 };
+    const std::uint8_t b[] = { 1, 2, 4 };
+    check(DiskCache::makeKey("x", a, 3) != DiskCache::makeKey("x", b, 3));
+    check(DiskCache::makeKey("x", a, 3) != DiskCache::makeKey("x", a, 2));
+    check(DiskCache::makeKey("x", a, 3) != DiskCache::makeKey("y", a, 3));
+    check_equals(DiskCache::makeKey("x", a, 3), DiskCache::makeKey("x", a, 3));
+
+    // They are SHA-256 digests.
+    const std::uint8_t abc[] = { 'a', 'b', 'c' };
+    check_equals(DiskCache::makeKey("x", abc, 3), "x-ba7816bf8f01cfea4141"
+            "40de5dae2223b00361a396177a9cb410ff61f20015ad");
+    const std::vector<std::uint8_t> million(1000000, 'a');
+    check_equals(DiskCache::makeKey("x", &million.front(), million.size()),
+            "x-cdc76e5c9914fb9281a1c7e284d73e67f1809a48a4972"
+            "00e046d39ccc7112cd0");
+
+    DiskCache cache(cacheDir, 1000);
+    check(cache.enabled());
+
+    check(store(cache, "one", 400, 'a'));
+    std::unique_ptr<IOChannel> in = cache.get("one");
+    check(in.get());
+    if (in.get()) {
+        check_equals(in->size(), 400);
+        const std::uint8_t* data = in->contiguousData(400);
+        check(data && data[0] == 'a' && data[399] == 'a');
+    }
+    in.reset();
+
+    // Failed writes aren't stored.
+    std::unique_ptr<IOChannel> out = cache.create("failed", temp);
+    check(out.get());
+    out.reset();
+    check(!cache.commit("failed", temp, false));
+    check(!cache.get("failed").get());
+
+    // Writers of the same entry don't share a file.
+    std::string temp2;
+    out = cache.create("shared", temp);
+    std::unique_ptr<IOChannel> out2 = cache.create("shared", temp2);
+    check(out.get() && out2.get());
+    check(temp != temp2);
+    out->write("a", 1);
+    out2->write("bb", 2);
+    out.reset();
+    out2.reset();
+    check(cache.commit("shared", temp2));
+    check(cache.commit("shared", temp));
+    in = cache.get("shared");
+    check(in.get() && in->size() == 1);
+    in.reset();
+    cache.remove("shared");
+
+    // Going over the limit removes the oldest entries.
+    check(store(cache, "two", 400, 'b'));
+    struct utimbuf old = { 1000, 1000 };
+    utime((std::string(cacheDir) + "/one.cache").c_str(), &old);
+    check(store(cache, "three", 400, 'c'));
+    check(!cache.get("one").get());
+    check(cache.get("three").get());
+
+    cache.remove("two");
+    cache.remove("three");
+    check(!cache.get("three").get());
+    std::remove(cacheDir);
+
+    return 0;
+}
+
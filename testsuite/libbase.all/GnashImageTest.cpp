@@ -0,0 +1,163 @@
+//
+//   Copyright (C) 2012 Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifdef HAVE_CONFIG_H
+#include "gnashconfig.h"
+#endif
+
+#include "check.h"
+
+#include "GnashImage.h"
+#include "GnashEnums.h"
+#include "IOChannel.h"
+#include "tu_file.h"
+
+#include <cstdio>
+#include <vector>
+#include <memory>
+#include <sstream>
+#include <algorithm>
+
+using namespace gnash;
+using namespace gnash::image;
+
+TestState runtest;
+
+namespace {
+
+const char* jpegFile = "GnashImageTestData.jpg";
+const char* alphaFile = "GnashImageTestData.alpha";
+
+unsigned int seed = 1;
+
+std::uint8_t
+random8()
+{
+    seed = seed * 1103515245 + 12345;
+    return seed >> 16;
+}
+
+void
+writeFile(const char* filename, const std::vector<std::uint8_t>& data)
+{
+    FILE* f = std::fopen(filename, "wb");
+    if (!f) return;
+    std::fwrite(&data.front(), 1, data.size(), f);
+    std::fclose(f);
+}
+
+/// Check that merging alpha into a row of the given width gives the
+/// same result as the plain algorithm.
+bool
+checkMergeAlpha(size_t width)
+{
+    ImageRGBA im(width, 1);
+    std::vector<std::uint8_t> alpha(width);
+    std::generate(im.begin(), im.end(), random8);
+    std::generate(alpha.begin(), alpha.end(), random8);
+
+    std::vector<std::uint8_t> expected(im.begin(), im.end());
+    for (size_t i = 0; i < width; ++i) {
+        for (size_t c = 0; c < 3; ++c) {
+            expected[i * 4 + c] = std::min(expected[i * 4 + c], alpha[i]);
+        }
+        expected[i * 4 + 3] = alpha[i];
+    }
+
+    mergeAlpha(im, &alpha.front(), width);
+    return std::equal(expected.begin(), expected.end(), im.begin());
+}
+
+}
+
+TRYMAIN(_runtest);
+int
+trymain(int /*argc*/, char** /*argv*/)
+{
+    // Widths around the sizes processed at once.
+    bool ok = true;
+    for (size_t width = 1; width < 70; ++width) {
+        if (!checkMergeAlpha(width)) {
+            std::ostringstream ss;
+            ss << "mergeAlpha on a row of " << width << " pixels";
+            runtest.fail(ss.str());
+            ok = false;
+        }
+    }
+    if (ok) runtest.pass("mergeAlpha on rows of 1 to 69 pixels");
+
+    // A JPEG with alpha data, merged while decoding.
+    const size_t width = 37;
+    const size_t height = 9;
+
+    ImageRGB rgb(width, height);
+    std::fill(rgb.begin(), rgb.end(), 200);
+
+    std::shared_ptr<IOChannel> out(makeFileChannel(jpegFile, "wb").release());
+    check(out.get());
+    if (!out.get()) return 0;
+    Output::writeImageData(GNASH_FILETYPE_JPEG, out, rgb, 100);
+    out.reset();
+
+    std::vector<std::uint8_t> alpha(width * height);
+    std::generate(alpha.begin(), alpha.end(), random8);
+    writeFile(alphaFile, alpha);
+
+    std::shared_ptr<IOChannel> in(makeFileChannel(jpegFile, "rb").release());
+    std::unique_ptr<IOChannel> alphaIn = makeFileChannel(alphaFile, "rb");
+    check(in.get());
+    check(alphaIn.get());
+    if (!in.get() || !alphaIn.get()) return 0;
+
+    std::unique_ptr<ImageRGBA> im = Input::readSWFJpeg3(in, alphaIn.get());
+    check(im.get());
+    if (!im.get()) return 0;
+
+    check_equals(im->width(), width);
+    check_equals(im->height(), height);
+
+    bool alphaOK = true;
+    bool colourOK = true;
+    for (size_t i = 0; i < width * height; ++i) {
+        const GnashImage::const_iterator p = im->begin() + i * 4;
+        if (p[3] != alpha[i]) alphaOK = false;
+        if (p[0] > alpha[i] || p[1] > alpha[i] || p[2] > alpha[i]) {
+            colourOK = false;
+        }
+    }
+    check(alphaOK);
+    check(colourOK);
+
+    // Without alpha data, the image is opaque.
+    in.reset(makeFileChannel(jpegFile, "rb").release());
+    im = Input::readSWFJpeg3(in);
+    check(im.get());
+    if (!im.get()) return 0;
+
+    bool opaque = true;
+    for (size_t i = 0; i < width * height; ++i) {
+        if (im->begin()[i * 4 + 3] != 255) opaque = false;
+    }
+    check(opaque);
+    check_equals(+im->begin()[0], 200);
+
+    std::remove(jpegFile);
+    std::remove(alphaFile);
+
+    return 0;
+}
+
@@ -158,6 +158,28 @@ trymain(int /*argc*/, char** /*argv*/)
     std::unique_ptr<gnash::IOChannel> orig = gnash::makeFileChannel(f, false);
 	lseek(raw, 0, SEEK_SET);
 	compare_reads(orig.get(), raw, "cache", "raw");
+
+	std::unique_ptr<gnash::IOChannel> mapped =
+		gnash::makeMappedFileChannel(input);
+	if (mapped.get()) {
+		lseek(raw, 0, SEEK_SET);
+		compare_reads(mapped.get(), raw, "mapped", "raw");
+
+		mapped->seek(0);
+		const std::uint8_t* data = mapped->contiguousData(CHUNK_SIZE);
+		char buf[CHUNK_SIZE];
+		lseek(raw, 0, SEEK_SET);
+		if (data && read(raw, buf, CHUNK_SIZE) == CHUNK_SIZE &&
+				!memcmp(data, buf, CHUNK_SIZE)) {
+			runtest.pass("mapped file gives direct access to its data");
+		}
+		else {
+			runtest.fail("mapped file gives direct access to its data");
+		}
+	}
+	else {
+		runtest.unresolved("Unable to map input file");
+	}
 	close(raw);
 
 
@@ -0,0 +1,140 @@
+// 
+//   Copyright (C) 2012 Free Software Foundation, Inc
+// 
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifdef HAVE_CONFIG_H
+#include "gnashconfig.h"
+#endif
+
+#include "check.h"
+
+#include "zlib_adapter.h"
+#include "IOChannel.h"
+#include "tu_file.h"
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <memory>
+#include <sstream>
+
+#ifdef HAVE_ZLIB_H
+extern "C" {
+# include <zlib.h>
+}
+#endif
+
+using namespace gnash;
+
+TestState runtest;
+
+namespace {
+
+// Offset of the compressed data in the file, as for a CWS header.
+const std::streamoff HEADER_SIZE = 8;
+
+bool
+readAt(IOChannel& in, const std::vector<unsigned char>& orig,
+        size_t pos, size_t len)
+{
+    std::vector<unsigned char> buf(len);
+    if (!in.seek(pos + HEADER_SIZE)) return false;
+    if (in.read(&buf.front(), len) != static_cast<std::streamsize>(len)) {
+        return false;
+    }
+    return !std::memcmp(&buf.front(), &orig[pos], len);
+}
+
+}
+
+TRYMAIN(_runtest);
+int
+trymain(int /*argc*/, char** /*argv*/)
+{
+#ifdef HAVE_ZLIB_H
+    const char* filename = "ZlibAdapterTestData";
+
+    // Several MB of partly compressible data, so that the inflater
+    // creates a few seek checkpoints.
+    const size_t size = 6 << 20;
+    std::vector<unsigned char> orig(size);
+    unsigned int seed = 1;
+    for (size_t i = 0; i < size; ++i) {
+        seed = seed * 1103515245 + 12345;
+        orig[i] = (i % 1000 < 500) ? (seed >> 16) : (i & 0x3f);
+    }
+
+    uLongf complen = compressBound(size);
+    std::vector<unsigned char> comp(complen);
+    check_equals(compress2(&comp.front(), &complen, &orig.front(), size, 6),
+            Z_OK);
+
+    FILE* f = std::fopen(filename, "wb");
+    check(f);
+    if (!f) return 0;
+    std::fwrite("CWS\012\0\0\0\0", 1, HEADER_SIZE, f);
+    std::fwrite(&comp.front(), 1, complen, f);
+    std::fclose(f);
+
+    std::unique_ptr<IOChannel> file = makeFileChannel(filename, "rb");
+    check(file.get());
+    if (!file.get()) return 0;
+    file->seek(HEADER_SIZE);
+
+    std::unique_ptr<IOChannel> in = zlib_adapter::make_inflater(std::move(file));
+
+    check(readAt(*in, orig, 0, 100));
+    check_equals(in->tell(), HEADER_SIZE + 100);
+
+    // Forward, then backward past several checkpoints.
+    check(readAt(*in, orig, size - 70000, 70000));
+    check(readAt(*in, orig, 3000000, 12345));
+    check(readAt(*in, orig, 1048575, 3));
+    check(readAt(*in, orig, 10, 2 << 20));
+    check(readAt(*in, orig, 5000000, 1));
+    check(readAt(*in, orig, 4999999, 1));
+
+    // Random seeks in both directions.
+    bool ok = true;
+    for (int i = 0; i < 100; ++i) {
+        seed = seed * 1103515245 + 12345;
+        const size_t pos = (seed >> 4) % (size - 10000);
+        const size_t len = 1 + seed % 9999;
+        if (!readAt(*in, orig, pos, len)) {
+            std::ostringstream ss;
+            ss << "Reading " << len << " bytes at " << pos << " failed";
+            runtest.fail(ss.str());
+            ok = false;
+            break;
+        }
+    }
+    if (ok) runtest.pass("Random seeks read the original data");
+
+    in->go_to_end();
+    check_equals(in->tell(), HEADER_SIZE + std::streamoff(size));
+    check(in->eof());
+
+    // Back to the start, which is before the first checkpoint.
+    check(readAt(*in, orig, 0, 4096));
+
+    std::remove(filename);
+#else
+    runtest.unresolved("zlib support not compiled in");
+#endif
+
+    return 0;
+}
+
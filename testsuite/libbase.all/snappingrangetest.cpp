@@ -225,6 +225,67 @@ main(int /*argc*/, char** /*argv*/)
 	finSnap4.add(Range2d<int>(40,273, 108,287));
 
 	check(finSnap3.contains(finSnap4));
+
+	//
+	// Test ranges aligned to tiles
+	//
+
+	// Scattered ranges are kept apart.
+	SnappingRanges2d<int> tiles;
+	tiles.setTileSize(100);
+	tiles.add(Range2d<int>(10, 10, 20, 20));
+	tiles.add(Range2d<int>(510, 10, 520, 20));
+	tiles.add(Range2d<int>(10, 510, 20, 520));
+	tiles.add(Range2d<int>(-150, -150, -140, -140));
+	check_equals(tiles.size(), 4u);
+	check(tiles.contains(0, 0));
+	check(tiles.contains(99, 99));
+	check(tiles.contains(550, 50));
+	check(tiles.contains(-199, -199));
+	check(!tiles.contains(300, 300));
+	check(!tiles.contains(-50, -50));
+
+	// Runs of tiles are joined, also across rows.
+	SnappingRanges2d<int> runs;
+	runs.setTileSize(100);
+	runs.add(Range2d<int>(10, 10, 20, 20));
+	runs.add(Range2d<int>(110, 10, 120, 20));
+	runs.add(Range2d<int>(150, 150, 250, 250));
+	check_equals(runs.size(), 2u);
+	check(runs.contains(Range2d<int>(0, 0, 200, 100)));
+	check(runs.contains(Range2d<int>(100, 100, 300, 300)));
+	check(!runs.contains(50, 150));
+
+	// The grid can start anywhere.
+	SnappingRanges2d<int> shifted;
+	shifted.setTileSize(100, 30, -40);
+	shifted.add(Range2d<int>(40, 70, 50, 80));
+	shifted.add(Range2d<int>(240, 70, 250, 80));
+	check_equals(shifted.size(), 2u);
+	check(shifted.contains(Range2d<int>(30, 60, 130, 160)));
+	check(!shifted.contains(20, 70));
+	check(!shifted.contains(70, 170));
+	check(shifted.contains(Range2d<int>(230, 60, 330, 160)));
+
+	// Tiles are made larger rather than exceeding the limit.
+	SnappingRanges2d<int> many;
+	many.setTileSize(10);
+	many.setRangeCountLimit(4);
+	for (int i = 0; i < 10; ++i) {
+		many.add(Range2d<int>(i * 100, 0, i * 100 + 1, 1));
+	}
+	check(many.size() <= 4u);
+	bool covered = true;
+	for (int i = 0; i < 10; ++i) {
+		if (!many.contains(i * 100, 0)) covered = false;
+	}
+	check(covered);
+
+	// A WORLD range is kept.
+	tiles.add(worldRange);
+	tiles.add(Range2d<int>(10, 10, 20, 20));
+	check(tiles.isWorld());
+
 	return 0;
 }
 
@@ -0,0 +1,257 @@
+//
+//   Copyright (C) 2012 Free Software Foundation, Inc.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifdef HAVE_CONFIG_H
+#include "gnashconfig.h"
+#endif
+
+#include "BitmapCache.h"
+#include "movie_root.h"
+#include "Movie.h"
+#include "MovieClip.h"
+#include "DynamicShape.h"
+#include "Renderer.h"
+#include "CachedBitmap.h"
+#include "GnashImage.h"
+#include "FillStyle.h"
+#include "Transform.h"
+#include "SWFMatrix.h"
+#include "SWFCxForm.h"
+#include "RGBA.h"
+#include "log.h"
+#include "DummyMovieDefinition.h"
+#include "ManualClock.h"
+#include "RunResources.h"
+#include "StreamProvider.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "check.h"
+
+using namespace gnash;
+
+namespace {
+
+class TestBitmap : public CachedBitmap
+{
+public:
+    explicit TestBitmap(std::unique_ptr<image::GnashImage> im)
+        :
+        _image(std::move(im))
+    {}
+
+    virtual image::GnashImage& image() { return *_image; }
+    virtual void dispose() { _image.reset(); }
+    virtual bool disposed() const { return !_image.get(); }
+
+private:
+    std::unique_ptr<image::GnashImage> _image;
+};
+
+/// A Renderer recording what a BitmapCache does with it.
+class TestRenderer : public Renderer
+{
+public:
+
+    TestRenderer()
+        :
+        bitmaps(0),
+        twipsPerPixel(20),
+        _internal(false)
+    {}
+
+    virtual std::string description() const { return "Test"; }
+
+    virtual CachedBitmap* createCachedBitmap(
+            std::unique_ptr<image::GnashImage> im) {
+        ++bitmaps;
+        return new TestBitmap(std::move(im));
+    }
+
+    virtual void drawVideoFrame(image::GnashImage*, const Transform&,
+            const SWFRect*, bool) {}
+
+    virtual void drawLine(const std::vector<point>&, const rgba&,
+            const SWFMatrix&) {}
+
+    virtual void draw_poly(const std::vector<point>&, const rgba&,
+            const rgba&, const SWFMatrix&, bool) {}
+
+    virtual void drawShape(const SWF::ShapeRecord&, const Transform& xform) {
+        // Only the image of the cache is drawn to the stage.
+        if (!_internal) displayed = xform;
+    }
+
+    virtual void drawGlyph(const SWF::ShapeRecord&, const rgba&,
+            const SWFMatrix&) {}
+
+    virtual void begin_submit_mask() {}
+    virtual void end_submit_mask() {}
+    virtual void disable_mask() {}
+
+    virtual geometry::Range2d<int> world_to_pixel(const SWFRect& b) const {
+        return geometry::Range2d<int>(b.get_x_min() / twipsPerPixel,
+                b.get_y_min() / twipsPerPixel, b.get_x_max() / twipsPerPixel,
+                b.get_y_max() / twipsPerPixel);
+    }
+
+    virtual point pixel_to_world(int x, int y) const {
+        return point(x * twipsPerPixel, y * twipsPerPixel);
+    }
+
+    virtual void begin_display(const rgba&, int, int, float, float, float,
+            float) {}
+    virtual void end_display() {}
+
+    virtual Renderer* startInternalRender(image::GnashImage&) {
+        _internal = true;
+        return this;
+    }
+
+    virtual void endInternalRender() {
+        _internal = false;
+    }
+
+    /// The number of images created.
+    size_t bitmaps;
+
+    /// The scale of the stage.
+    int twipsPerPixel;
+
+    /// The transform the image was last displayed with.
+    Transform displayed;
+
+private:
+    bool _internal;
+};
+
+SWFMatrix
+translated(std::int32_t x, std::int32_t y)
+{
+    SWFMatrix m;
+    m.set_translation(x, y);
+    return m;
+}
+
+/// Display the MovieClip through the cache, as MovieClip::display() does.
+bool
+display(BitmapCache& cache, MovieClip& mc, Renderer& r, const Transform& xf)
+{
+    const bool ret = cache.display(mc, r, xf);
+    mc.clear_invalidated();
+    return ret;
+}
+
+}
+
+TRYMAIN(_runtest);
+int
+trymain(int /*argc*/, char** /*argv*/)
+{
+    RunResources ri;
+    const URL url("");
+    ri.setStreamProvider(
+            std::shared_ptr<StreamProvider>(new StreamProvider(url, url)));
+
+    boost::intrusive_ptr<movie_definition> md(new DummyMovieDefinition(ri, 8));
+
+    ManualClock clock;
+    movie_root stage(clock, ri);
+
+    MovieClip::MovieVariables v;
+    stage.init(md.get(), v);
+
+    MovieClip* mc = const_cast<Movie*>(&stage.getRootMovie());
+
+    // A red square of 50 pixels.
+    DynamicShape& shape = mc->graphics();
+    shape.beginFill(SolidFill(rgba(255, 0, 0, 255)));
+    shape.moveTo(0, 0);
+    shape.lineTo(1000, 0, 8);
+    shape.lineTo(1000, 1000, 8);
+    shape.lineTo(0, 1000, 8);
+    shape.lineTo(0, 0, 8);
+    shape.endFill();
+
+    BitmapCache cache;
+    TestRenderer r;
+
+    check(display(cache, *mc, r, Transform(translated(100, 100))));
+    check_equals(r.bitmaps, 1u);
+
+    // Moves reuse the image, snapped to whole pixels.
+    check(display(cache, *mc, r, Transform(translated(150, 330))));
+    check_equals(r.bitmaps, 1u);
+    check_equals(r.displayed.matrix.tx() % 20, 0);
+    check_equals(r.displayed.matrix.ty() % 20, 0);
+
+    check(display(cache, *mc, r, Transform(translated(-4000, 7000))));
+    check_equals(r.bitmaps, 1u);
+
+    // Scaling renders it again, once.
+    SWFMatrix m = translated(100, 100);
+    m.set_scale(2, 2);
+    check(display(cache, *mc, r, Transform(m)));
+    check_equals(r.bitmaps, 2u);
+    check(display(cache, *mc, r, Transform(m)));
+    check_equals(r.bitmaps, 2u);
+
+    // So does rotating.
+    m.set_rotation(0.5);
+    check(display(cache, *mc, r, Transform(m)));
+    check_equals(r.bitmaps, 3u);
+    m.set_translation(500, 500);
+    check(display(cache, *mc, r, Transform(m)));
+    check_equals(r.bitmaps, 3u);
+
+    // And scaling the stage.
+    r.twipsPerPixel = 10;
+    check(display(cache, *mc, r, Transform(m)));
+    check_equals(r.bitmaps, 4u);
+    r.twipsPerPixel = 20;
+    check(display(cache, *mc, r, Transform(m)));
+    check_equals(r.bitmaps, 5u);
+
+    // The image is rendered without the color transform, so a new one
+    // applies at once.
+    SWFCxForm cx;
+    cx.ra = 128;
+    check(display(cache, *mc, r, Transform(m, cx)));
+    check_equals(r.bitmaps, 5u);
+    check_equals(r.displayed.colorTransform, cx);
+
+    cx.ba = 64;
+    check(display(cache, *mc, r, Transform(m, cx)));
+    check_equals(r.bitmaps, 5u);
+    check_equals(r.displayed.colorTransform, cx);
+
+    // Changing the contents renders it again.
+    mc->graphics().lineTo(2000, 2000, 8);
+    check(display(cache, *mc, r, Transform(m, cx)));
+    check_equals(r.bitmaps, 6u);
+
+    // Even when only a child changed.
+    mc->set_child_invalidated();
+    check(display(cache, *mc, r, Transform(m, cx)));
+    check_equals(r.bitmaps, 7u);
+    check(display(cache, *mc, r, Transform(m, cx)));
+    check_equals(r.bitmaps, 7u);
+
+    return 0;
+}
@@ -0,0 +1,257 @@
+//
+//   Copyright (C) 2012 Free Software Foundation, Inc.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifdef HAVE_CONFIG_H
+#include "gnashconfig.h"
+#endif
+
+#include "DisplayListRecordsTag.h"
+#include "PlaceObject2Tag.h"
+#include "DefinitionTag.h"
+#include "TimelineSnapshots.h"
+#include "DisplayList.h"
+#include "movie_root.h"
+#include "Movie.h"
+#include "MovieClip.h"
+#include "Filters.h"
+#include "IOChannel.h"
+#include "SWFStream.h"
+#include "SWF.h"
+#include "Global_as.h"
+#include "DummyMovieDefinition.h"
+#include "DummyCharacter.h"
+#include "ManualClock.h"
+#include "RunResources.h"
+#include "StreamProvider.h"
+
+#include <vector>
+#include <cstring>
+#include <cstdint>
+
+#include "check.h"
+
+using namespace gnash;
+
+namespace {
+
+/// Reads the bytes of a tag.
+class TagReader : public IOChannel
+{
+public:
+
+    explicit TagReader(const std::vector<std::uint8_t>& bytes)
+        :
+        _bytes(bytes),
+        _pos(0)
+    {}
+
+    virtual std::streamsize read(void* dst, std::streamsize num) {
+        const std::streamsize left = _bytes.size() - _pos;
+        if (num > left) num = left;
+        std::memcpy(dst, &_bytes[_pos], num);
+        _pos += num;
+        return num;
+    }
+
+    virtual std::streampos tell() const { return _pos; }
+
+    virtual bool seek(std::streampos p) {
+        if (p > static_cast<std::streampos>(_bytes.size())) return false;
+        _pos = p;
+        return true;
+    }
+
+    virtual void go_to_end() { _pos = _bytes.size(); }
+
+    virtual bool eof() const { return _pos == _bytes.size(); }
+
+    virtual bool bad() const { return false; }
+
+private:
+    const std::vector<std::uint8_t> _bytes;
+    size_t _pos;
+};
+
+/// Defines DummyCharacters.
+class DummyDefinition : public SWF::DefinitionTag
+{
+public:
+
+    explicit DummyDefinition(std::uint16_t id) : DefinitionTag(id) {}
+
+    virtual DisplayObject* createDisplayObject(Global_as& gl,
+            DisplayObject* parent) const {
+        return new DummyCharacter(createObject(gl), parent);
+    }
+};
+
+/// A movie whose playlists are set by the test.
+class TimelineDefinition : public DummyMovieDefinition
+{
+public:
+
+    explicit TimelineDefinition(const RunResources& ri)
+        :
+        DummyMovieDefinition(ri, 8),
+        frames(2)
+    {}
+
+    virtual const PlayList* getPlaylist(size_t frame) const {
+        return frame < frames.size() ? &frames[frame] : nullptr;
+    }
+
+    std::vector<PlayList> frames;
+};
+
+// PlaceObject3 flags.
+const std::uint8_t move = 1 << 0;
+const std::uint8_t hasCharacter = 1 << 1;
+const std::uint8_t hasRatio = 1 << 4;
+const std::uint8_t hasFilters = 1 << 0;
+
+/// The depth of the DisplayObjects, as in the tags.
+const int depth = 10;
+
+boost::intrusive_ptr<SWF::PlaceObject2Tag>
+readTag(const movie_definition& md, const std::vector<std::uint8_t>& bytes)
+{
+    TagReader reader(bytes);
+    SWFStream in(&reader);
+    boost::intrusive_ptr<SWF::PlaceObject2Tag> tag(
+            new SWF::PlaceObject2Tag(md));
+    tag->read(in, SWF::PLACEOBJECT3);
+    return tag;
+}
+
+/// Place DisplayObject 1.
+boost::intrusive_ptr<SWF::PlaceObject2Tag>
+place(const movie_definition& md)
+{
+    const std::uint8_t bytes[] = { hasCharacter, 0, depth, 0, 1, 0 };
+    return readTag(md, std::vector<std::uint8_t>(bytes, bytes + 6));
+}
+
+/// Change the ratio.
+boost::intrusive_ptr<SWF::PlaceObject2Tag>
+moveRatio(const movie_definition& md, std::uint8_t ratio)
+{
+    const std::uint8_t bytes[] = { move | hasRatio, 0, depth, 0, ratio, 0 };
+    return readTag(md, std::vector<std::uint8_t>(bytes, bytes + 6));
+}
+
+/// Change the filters to a blur of some pixels, in one pass.
+boost::intrusive_ptr<SWF::PlaceObject2Tag>
+moveBlur(const movie_definition& md, std::uint8_t blur)
+{
+    const std::uint8_t bytes[] = { move, hasFilters, depth, 0,
+        1, 1, 0, 0, blur, 0, 0, 0, blur, 0, 1 << 3 };
+    return readTag(md, std::vector<std::uint8_t>(bytes, bytes + 15));
+}
+
+/// The horizontal blur of the only filter of a DisplayObject, or 0.
+float
+blurOf(const DisplayObject& ch)
+{
+    if (ch.filters().size() != 1) return 0;
+    const BlurFilter* f =
+        dynamic_cast<const BlurFilter*>(ch.filters().front().get());
+    return f ? f->m_blurX : 0;
+}
+
+}
+
+TRYMAIN(_runtest);
+int
+trymain(int /*argc*/, char** /*argv*/)
+{
+    RunResources ri;
+    const URL url("");
+    ri.setStreamProvider(
+            std::shared_ptr<StreamProvider>(new StreamProvider(url, url)));
+
+    boost::intrusive_ptr<TimelineDefinition> md(new TimelineDefinition(ri));
+    md->addDisplayObject(1, new DummyDefinition(1));
+
+    ManualClock clock;
+    movie_root stage(clock, ri);
+
+    MovieClip::MovieVariables v;
+    stage.init(md.get(), v);
+
+    MovieClip* root = const_cast<Movie*>(&stage.getRootMovie());
+
+    const int placed = depth + DisplayObject::staticDepthOffset;
+
+    DisplayList dlist;
+    DisplayObject* ch =
+        new DummyCharacter(createObject(getGlobal(*getObject(root))), root);
+    dlist.placeDisplayObject(ch, placed);
+
+    // MOVE tags setting filters are stored with the others.
+    movie_definition::PlayList playlist;
+    SWF::DisplayListRecordsTag::addTag(playlist, moveRatio(*md, 1));
+    SWF::DisplayListRecordsTag::addTag(playlist, moveBlur(*md, 4));
+    SWF::DisplayListRecordsTag::addTag(playlist, moveRatio(*md, 2));
+    check_equals(playlist.size(), 1u);
+
+    const SWF::DisplayListRecordsTag* records =
+        dynamic_cast<const SWF::DisplayListRecordsTag*>(playlist[0].get());
+    check(records);
+    if (records) check_equals(records->size(), 3u);
+
+    // And set them, which later moves without filters don't change.
+    playlist[0]->executeState(root, dlist);
+    check_equals(blurOf(*ch), 4);
+    check_equals(ch->get_ratio(), 2);
+
+    // A snapshot of frames placing and blurring a DisplayObject, as used
+    // when seeking back, blurs it too.
+    md->frames[0].push_back(place(*md));
+    SWF::DisplayListRecordsTag::addTag(md->frames[1], moveRatio(*md, 1));
+    SWF::DisplayListRecordsTag::addTag(md->frames[1], moveBlur(*md, 6));
+    check_equals(md->frames[1].size(), 1u);
+
+    TimelineSnapshot snapshot;
+    check(snapshot.addFrame(*md));
+    check(snapshot.addFrame(*md));
+
+    DisplayList restored;
+    snapshot.restore(*root, restored);
+    DisplayObject* seeked = restored.getDisplayObjectAtDepth(placed);
+    check(seeked);
+    if (seeked) {
+        check_equals(blurOf(*seeked), 6);
+        check_equals(seeked->get_ratio(), 1);
+    }
+
+    // Moves merged in the snapshot keep the last filters.
+    md->frames.push_back(movie_definition::PlayList());
+    SWF::DisplayListRecordsTag::addTag(md->frames[2], moveBlur(*md, 8));
+    SWF::DisplayListRecordsTag::addTag(md->frames[2], moveRatio(*md, 3));
+    check(snapshot.addFrame(*md));
+
+    DisplayList later;
+    snapshot.restore(*root, later);
+    seeked = later.getDisplayObjectAtDepth(placed);
+    check(seeked);
+    if (seeked) {
+        check_equals(blurOf(*seeked), 8);
+        check_equals(seeked->get_ratio(), 3);
+    }
+
+    return 0;
+}
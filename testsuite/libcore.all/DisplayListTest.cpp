@@ -91,6 +91,123 @@ trymain(int /*argc*/, char** /*argv*/)
     
     dlist2.placeDisplayObject(ch2, 1);
     dlist2.placeDisplayObject(ch1, 2);
+
+    // A list of DisplayObjects placed in no particular order.
+    DisplayList dlist3;
+    const int count = 200;
+    for (int i = 0; i < count; ++i) {
+        as_object* ob = createObject(getGlobal(*getObject(root)));
+        dlist3.placeDisplayObject(new DummyCharacter(ob, root), i * 37 % count);
+    }
+
+    check(dlist3.checkInvariant());
+    check_equals(dlist3.size(), static_cast<size_t>(count));
+    check_equals(dlist3.getNextHighestDepth(), count);
+
+    bool found = true;
+    for (int depth = 0; depth < count; ++depth) {
+        DisplayObject* ch = dlist3.getDisplayObjectAtDepth(depth);
+        if (!ch || ch->get_depth() != depth) found = false;
+    }
+    check(found);
+    check(!dlist3.getDisplayObjectAtDepth(count));
+    check(!dlist3.getDisplayObjectAtDepth(-1));
+
+    // Swapping to a free depth moves a DisplayObject up and down.
+    DisplayObject* ch3 = dlist3.getDisplayObjectAtDepth(10);
+    dlist3.swapDepths(ch3, count + 5);
+    check(dlist3.checkInvariant());
+    check_equals(dlist3.getDisplayObjectAtDepth(count + 5), ch3);
+    check(!dlist3.getDisplayObjectAtDepth(10));
+    check_equals(dlist3.getNextHighestDepth(), count + 6);
+
+    dlist3.swapDepths(ch3, 10);
+    check(dlist3.checkInvariant());
+    check_equals(dlist3.getDisplayObjectAtDepth(10), ch3);
+    check_equals(dlist3.getNextHighestDepth(), count);
+
+    // Swapping to an occupied depth exchanges the DisplayObjects.
+    DisplayObject* ch4 = dlist3.getDisplayObjectAtDepth(20);
+    dlist3.swapDepths(ch3, 20);
+    check(dlist3.checkInvariant());
+    check_equals(dlist3.getDisplayObjectAtDepth(20), ch3);
+    check_equals(dlist3.getDisplayObjectAtDepth(10), ch4);
+
+    // Inserting shifts the DisplayObjects above up.
+    DisplayObject* ch5 = dlist3.getDisplayObjectAtDepth(50);
+    as_object* ob5 = createObject(getGlobal(*getObject(root)));
+    DisplayObject* ch6 = new DummyCharacter(ob5, root);
+    dlist3.insertDisplayObject(ch6, 50);
+    check(dlist3.checkInvariant());
+    check_equals(dlist3.size(), static_cast<size_t>(count + 1));
+    check_equals(dlist3.getDisplayObjectAtDepth(50), ch6);
+    check_equals(dlist3.getDisplayObjectAtDepth(51), ch5);
+    check_equals(dlist3.getNextHighestDepth(), count + 1);
+
+    dlist3.removeDisplayObject(30);
+    check(dlist3.checkInvariant());
+    check(!dlist3.getDisplayObjectAtDepth(30));
+    check_equals(dlist3.size(), static_cast<size_t>(count));
+
+    // Cached world matrices follow changes to the parent's matrix.
+    SWFMatrix m5;
+    m5.set_translation(100, 200);
+    ch5->setMatrix(m5);
+    SWFMatrix expected = getWorldMatrix(*root);
+    expected.concatenate(m5);
+    check_equals(getWorldMatrix(*ch5), expected);
+
+    SWFMatrix rootMatrix;
+    rootMatrix.set_translation(1000, 0);
+    root->setMatrix(rootMatrix);
+    expected = rootMatrix;
+    expected.concatenate(m5);
+    check_equals(getWorldMatrix(*ch5), expected);
+
+    // And to the matrix of any ancestor, not only the parent.
+    as_object* ob7 = createObject(getGlobal(*getObject(root)));
+    DisplayObject* ch7 = new DummyCharacter(ob7, ch5);
+    SWFMatrix m7;
+    m7.set_translation(5, 5);
+    ch7->setMatrix(m7);
+    expected.concatenate(m7);
+    check_equals(getWorldMatrix(*ch7), expected);
+
+    rootMatrix.set_translation(2000, 0);
+    root->setMatrix(rootMatrix);
+    expected = rootMatrix;
+    expected.concatenate(m5);
+    expected.concatenate(m7);
+    check_equals(getWorldMatrix(*ch7), expected);
+
+    // Cached color transforms too.
+    SWFCxForm cx5;
+    cx5.ra = 128;
+    ch5->setCxForm(cx5);
+    SWFCxForm cx7;
+    cx7.ga = 64;
+    ch7->setCxForm(cx7);
+    SWFCxForm expectedCx = getWorldCxForm(*root);
+    expectedCx.concatenate(cx5);
+    expectedCx.concatenate(cx7);
+    check_equals(getWorldCxForm(*ch7), expectedCx);
+
+    cx5.ba = 32;
+    ch5->setCxForm(cx5);
+    expectedCx = getWorldCxForm(*root);
+    expectedCx.concatenate(cx5);
+    expectedCx.concatenate(cx7);
+    check_equals(getWorldCxForm(*ch7), expectedCx);
+
+    // Changes are recorded in the content stamps of the ancestors only.
+    const std::uint64_t rootVersion = root->contentVersion();
+    const std::uint64_t ch5Version = ch5->contentVersion();
+    const std::uint64_t ch6Version = ch6->contentVersion();
+    m7.set_translation(10, 10);
+    ch7->setMatrix(m7);
+    check(root->contentVersion() != rootVersion);
+    check(ch5->contentVersion() != ch5Version);
+    check_equals(ch6->contentVersion(), ch6Version);
     
     return 0;
 }
@@ -0,0 +1,224 @@
+//
+//   Copyright (C) 2012 Free Software Foundation, Inc.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifdef HAVE_CONFIG_H
+#include "gnashconfig.h"
+#endif
+
+#include "DisplayObject.h"
+#include "movie_root.h"
+#include "Movie.h"
+#include "MovieClip.h"
+#include "DynamicShape.h"
+#include "FillStyle.h"
+#include "SWFMatrix.h"
+#include "SWFCxForm.h"
+#include "SWFRect.h"
+#include "RGBA.h"
+#include "DummyMovieDefinition.h"
+#include "DummyCharacter.h"
+#include "ManualClock.h"
+#include "RunResources.h"
+#include "StreamProvider.h"
+
+#include "check.h"
+
+using namespace gnash;
+
+namespace {
+
+/// A DisplayObject whose bounds are set by the test.
+class Box : public DummyCharacter
+{
+public:
+
+    Box(as_object* object, DisplayObject* parent)
+        :
+        DummyCharacter(object, parent)
+    {}
+
+    virtual SWFRect getBounds() const { return _box; }
+
+    /// Change the bounds, as a change to the content would.
+    void setBox(const SWFRect& box) {
+        set_invalidated();
+        _box = box;
+    }
+
+private:
+    SWFRect _box;
+};
+
+SWFMatrix
+translated(std::int32_t x, std::int32_t y)
+{
+    SWFMatrix m;
+    m.set_translation(x, y);
+    return m;
+}
+
+/// SWFRect has no comparison of its own.
+bool
+operator==(const SWFRect& a, const SWFRect& b)
+{
+    if (a.is_null() || b.is_null()) return a.is_null() == b.is_null();
+    return a.get_x_min() == b.get_x_min() && a.get_y_min() == b.get_y_min() &&
+        a.get_x_max() == b.get_x_max() && a.get_y_max() == b.get_y_max();
+}
+
+/// The world matrix of some nested DisplayObjects, given their matrices
+/// outermost first, computed without any cache.
+SWFMatrix
+concatenated(const SWFMatrix& a, const SWFMatrix& b,
+        const SWFMatrix& c = SWFMatrix())
+{
+    SWFMatrix m = a;
+    m.concatenate(b);
+    m.concatenate(c);
+    return m;
+}
+
+}
+
+TRYMAIN(_runtest);
+int
+trymain(int /*argc*/, char** /*argv*/)
+{
+    RunResources ri;
+    const URL url("");
+    ri.setStreamProvider(
+            std::shared_ptr<StreamProvider>(new StreamProvider(url, url)));
+
+    boost::intrusive_ptr<movie_definition> md(new DummyMovieDefinition(ri, 8));
+
+    ManualClock clock;
+    movie_root stage(clock, ri);
+
+    MovieClip::MovieVariables v;
+    stage.init(md.get(), v);
+
+    MovieClip* root = const_cast<Movie*>(&stage.getRootMovie());
+    Global_as& gl = getGlobal(*getObject(root));
+
+    const SWFMatrix rootMatrix = translated(1000, 0);
+    root->setMatrix(rootMatrix);
+
+    // A box in a box on the root, and another box on the root.
+    Box* outer = new Box(createObject(gl), root);
+    Box* inner = new Box(createObject(gl), outer);
+    Box* other = new Box(createObject(gl), root);
+    root->addDisplayListObject(outer, DisplayObject::staticDepthOffset + 1);
+    root->addDisplayListObject(other, DisplayObject::staticDepthOffset + 2);
+
+    const SWFMatrix outerMatrix = translated(100, 200);
+    const SWFMatrix innerMatrix = translated(5, 5);
+    outer->setMatrix(outerMatrix);
+    inner->setMatrix(innerMatrix);
+
+    // World matrices are the same when cached.
+    const SWFMatrix world = concatenated(rootMatrix, outerMatrix, innerMatrix);
+    check_equals(getWorldMatrix(*inner), world);
+    check_equals(getWorldMatrix(*inner), world);
+    check_equals(getWorldMatrix(*outer),
+            concatenated(rootMatrix, outerMatrix));
+
+    // A change elsewhere leaves them as they were.
+    other->setMatrix(translated(-50, -50));
+    check_equals(getWorldMatrix(*inner), world);
+    check_equals(getWorldMatrix(*other),
+            concatenated(rootMatrix, translated(-50, -50)));
+
+    // A change to an ancestor reaches them, whichever is asked first.
+    const SWFMatrix movedOuter = translated(300, 400);
+    outer->setMatrix(movedOuter);
+    check_equals(getWorldMatrix(*inner),
+            concatenated(rootMatrix, movedOuter, innerMatrix));
+    check_equals(getWorldMatrix(*outer),
+            concatenated(rootMatrix, movedOuter));
+
+    const SWFMatrix movedRoot = translated(2000, 0);
+    root->setMatrix(movedRoot);
+    check_equals(getWorldMatrix(*outer), concatenated(movedRoot, movedOuter));
+    check_equals(getWorldMatrix(*inner),
+            concatenated(movedRoot, movedOuter, innerMatrix));
+
+    // So does a change of parent.
+    const std::uint64_t outerVersion = outer->contentVersion();
+    const std::uint64_t otherVersion = other->contentVersion();
+    inner->set_parent(other);
+    check_equals(getWorldMatrix(*inner),
+            concatenated(movedRoot, translated(-50, -50), innerMatrix));
+    check(outer->contentVersion() != outerVersion);
+    check(other->contentVersion() != otherVersion);
+
+    // And to color transforms.
+    SWFCxForm cx;
+    cx.ra = 128;
+    other->setCxForm(cx);
+    SWFCxForm innerCx;
+    innerCx.ga = 64;
+    inner->setCxForm(innerCx);
+    SWFCxForm expectedCx = getWorldCxForm(*root);
+    expectedCx.concatenate(cx);
+    expectedCx.concatenate(innerCx);
+    check_equals(getWorldCxForm(*inner), expectedCx);
+    check_equals(getWorldCxForm(*inner), expectedCx);
+
+    cx.ba = 32;
+    other->setCxForm(cx);
+    expectedCx = getWorldCxForm(*root);
+    expectedCx.concatenate(cx);
+    expectedCx.concatenate(innerCx);
+    check_equals(getWorldCxForm(*inner), expectedCx);
+
+    // The bounds of a MovieClip are those of its children, and follow
+    // changes to their content.
+    outer->setMatrix(SWFMatrix());
+    other->setMatrix(SWFMatrix());
+    outer->setBox(SWFRect(0, 0, 100, 100));
+    check_equals(root->getBounds(), SWFRect(0, 0, 100, 100));
+    check_equals(root->getBounds(), SWFRect(0, 0, 100, 100));
+    check_equals(root->getHitBounds(), SWFRect(0, 0, 100, 100));
+
+    const std::uint64_t rootVersion = root->contentVersion();
+    other->setBox(SWFRect(200, 200, 300, 300));
+    check(root->contentVersion() != rootVersion);
+    check_equals(root->getBounds(), SWFRect(0, 0, 300, 300));
+    check_equals(root->getHitBounds(), SWFRect(0, 0, 300, 300));
+
+    // And to their matrices.
+    other->setMatrix(translated(100, 0));
+    check_equals(root->getBounds(), SWFRect(0, 0, 400, 300));
+    check_equals(root->getHitBounds(), SWFRect(0, 0, 400, 300));
+
+    // And to the drawing API.
+    DynamicShape& shape = root->graphics();
+    shape.beginFill(SolidFill(rgba(255, 0, 0, 255)));
+    shape.moveTo(0, 0);
+    shape.lineTo(1000, 0, 8);
+    shape.lineTo(1000, 500, 8);
+    shape.lineTo(0, 0, 8);
+    shape.endFill();
+    check_equals(root->getBounds(), SWFRect(0, 0, 1000, 500));
+
+    // Children don't change with the matrix of their parent.
+    root->setMatrix(translated(-3000, 0));
+    check_equals(root->getBounds(), SWFRect(0, 0, 1000, 500));
+    check_equals(outer->getBounds(), SWFRect(0, 0, 100, 100));
+
+    return 0;
+}
@@ -0,0 +1,177 @@
+// 
+//   Copyright (C) 2012 Free Software Foundation, Inc.
+// 
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifdef HAVE_CONFIG_H
+#include "gnashconfig.h"
+#endif
+
+#include "HitGrid.h"
+#include "DisplayList.h"
+#include "movie_root.h"
+#include "DisplayObject.h"
+#include "log.h"
+#include "DummyMovieDefinition.h"
+#include "DummyCharacter.h"
+#include "ManualClock.h"
+#include "RunResources.h"
+#include "StreamProvider.h"
+#include "SWFMatrix.h"
+
+#include <vector>
+#include <algorithm>
+
+#include "check.h"
+
+using namespace gnash;
+
+namespace {
+
+/// A DummyCharacter covering a square of 100 twips.
+class BoxCharacter : public DummyCharacter
+{
+public:
+    BoxCharacter(as_object* object, DisplayObject* parent)
+        :
+        DummyCharacter(object, parent)
+    {}
+
+    virtual SWFRect getBounds() const { return SWFRect(0, 0, 100, 100); }
+};
+
+SWFMatrix
+scaled(double x, double y)
+{
+    SWFMatrix m;
+    m.set_scale(x, y);
+    return m;
+}
+
+bool
+contains(const std::vector<DisplayObject*>& chars, DisplayObject* ch)
+{
+    return std::find(chars.begin(), chars.end(), ch) != chars.end();
+}
+
+bool
+depthSorted(const std::vector<DisplayObject*>& chars)
+{
+    for (size_t i = 1; i < chars.size(); ++i) {
+        if (chars[i - 1]->get_depth() >= chars[i]->get_depth()) return false;
+    }
+    return true;
+}
+
+}
+
+TRYMAIN(_runtest);
+int
+trymain(int /*argc*/, char** /*argv*/)
+{
+    RunResources ri;
+    const URL url("");
+    ri.setStreamProvider(
+            std::shared_ptr<StreamProvider>(new StreamProvider(url, url)));
+    
+    boost::intrusive_ptr<movie_definition> md(new DummyMovieDefinition(ri, 6));
+    
+    ManualClock clock;
+    movie_root stage(clock, ri);
+    
+    MovieClip::MovieVariables v;
+    stage.init(md.get(), v);
+
+    MovieClip* root = const_cast<Movie*>(&stage.getRootMovie());
+
+    // A 10x10 grid of boxes, 1000 twips apart.
+    DisplayList dlist;
+    std::vector<DisplayObject*> boxes;
+    for (int i = 0; i < 100; ++i) {
+        as_object* ob = createObject(getGlobal(*getObject(root)));
+        DisplayObject* ch = new BoxCharacter(ob, root);
+        SWFMatrix m;
+        m.set_translation(i % 10 * 1000, i / 10 * 1000);
+        ch->setMatrix(m);
+        dlist.placeDisplayObject(ch, i);
+        boxes.push_back(ch);
+    }
+
+    // A mask layer, far from the point queried.
+    as_object* ob = createObject(getGlobal(*getObject(root)));
+    DisplayObject* mask = new BoxCharacter(ob, root);
+    mask->set_clip_depth(200);
+    dlist.placeDisplayObject(mask, 150);
+
+    HitGrid grid(*root, dlist);
+    check(grid.current());
+
+    std::vector<DisplayObject*> chars;
+
+    // Inside the box at column 3, row 4.
+    grid.find(point(3050, 4050), chars);
+    check(contains(chars, boxes[43]));
+    check(contains(chars, mask));
+    check(!contains(chars, boxes[44]));
+    check(!contains(chars, boxes[33]));
+    check(depthSorted(chars));
+    check(chars.size() < 10);
+
+    // Points on the edge of a box are kept.
+    grid.find(point(9100, 9100), chars);
+    check(contains(chars, boxes[99]));
+
+    // Outside all boxes only the mask is left.
+    grid.find(point(-5000, 3000), chars);
+    check_equals(chars.size(), static_cast<size_t>(1));
+    check(contains(chars, mask));
+
+    // Changes outside the owner's subtree keep the grid current.
+    ob = createObject(getGlobal(*getObject(root)));
+    DisplayObject* other = new BoxCharacter(ob, nullptr);
+    ob = createObject(getGlobal(*getObject(root)));
+    DisplayObject* otherChild = new BoxCharacter(ob, other);
+    otherChild->setMatrix(scaled(2, 2));
+    other->setMatrix(scaled(3, 3));
+    check(grid.current());
+
+    // Changes to a descendant deeper than the children do not.
+    ob = createObject(getGlobal(*getObject(root)));
+    DisplayObject* inner = new BoxCharacter(ob, boxes[10]);
+    inner->setMatrix(scaled(2, 2));
+    check(!grid.current());
+
+    HitGrid grid2(*root, dlist);
+    check(grid2.current());
+
+    // Moving a box makes the grid stale.
+    SWFMatrix m;
+    m.set_translation(20000, 20000);
+    boxes[43]->setMatrix(m);
+    check(!grid2.current());
+
+    HitGrid moved(*root, dlist);
+    check(moved.current());
+    moved.find(point(3050, 4050), chars);
+    check(!contains(chars, boxes[43]));
+    moved.find(point(20050, 20050), chars);
+    check(contains(chars, boxes[43]));
+
+    // So does removing one.
+    dlist.removeDisplayObject(44);
+    check(!moved.current());
+
+    return 0;
+}
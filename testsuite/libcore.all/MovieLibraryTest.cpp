@@ -0,0 +1,132 @@
+//
+//   Copyright (C) 2012 Free Software Foundation, Inc.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifdef HAVE_CONFIG_H
+#include "gnashconfig.h"
+#endif
+
+#include "MovieLibrary.h"
+#include "DummyMovieDefinition.h"
+#include "RunResources.h"
+
+#include <boost/intrusive_ptr.hpp>
+
+#include "check.h"
+
+using namespace gnash;
+
+namespace {
+
+/// A movie using some memory, which grows by some bytes each time it is
+/// asked, as while it loads.
+class SizedDefinition : public DummyMovieDefinition
+{
+public:
+
+    SizedDefinition(const RunResources& ri, size_t bytes, size_t growth = 0)
+        :
+        DummyMovieDefinition(ri),
+        _bytes(bytes),
+        _growth(growth)
+    {}
+
+    virtual size_t memoryUsage() const {
+        const size_t ret = _bytes;
+        _bytes += _growth;
+        return ret;
+    }
+
+private:
+    mutable size_t _bytes;
+    const size_t _growth;
+};
+
+bool
+has(MovieLibrary& library, const std::string& key)
+{
+    boost::intrusive_ptr<movie_definition> md;
+    return library.get(key, &md);
+}
+
+}
+
+TRYMAIN(_runtest);
+int
+trymain(int /*argc*/, char** /*argv*/)
+{
+    RunResources ri;
+
+    MovieLibrary library;
+    library.setLimit(8);
+    library.setMemoryLimit(0);
+
+    // Lookups are counted.
+    library.add("a", new SizedDefinition(ri, 100));
+    check(has(library, "a"));
+    check(!has(library, "b"));
+
+    MovieLibrary::Stats stats = library.stats();
+    check_equals(stats.hits, 1u);
+    check_equals(stats.misses, 1u);
+    check_equals(stats.evictions, 0u);
+    check_equals(stats.items, 1u);
+    check_equals(stats.bytes, 100u);
+
+    // Items over the memory limit are dropped, least recently used
+    // first.
+    library.add("b", new SizedDefinition(ri, 100));
+    library.add("c", new SizedDefinition(ri, 100));
+    check(has(library, "a"));
+    library.setMemoryLimit(250);
+
+    check(has(library, "a"));
+    check(!has(library, "b"));
+    check(has(library, "c"));
+
+    stats = library.stats();
+    check_equals(stats.evictions, 1u);
+    check_equals(stats.items, 2u);
+    check_equals(stats.bytes, 200u);
+
+    // The most recently used item is kept whatever its size.
+    library.add("d", new SizedDefinition(ri, 1000));
+    check(has(library, "d"));
+    check(!has(library, "a"));
+    check(!has(library, "c"));
+    check_equals(library.stats().items, 1u);
+
+    // Items that grow while they are counted don't make the count wrap
+    // around, which would drop all items but one.
+    library.clear();
+    library.setMemoryLimit(0);
+    library.add("e", new SizedDefinition(ri, 100, 1000));
+    library.add("f", new SizedDefinition(ri, 100));
+    library.add("g", new SizedDefinition(ri, 100));
+    library.setMemoryLimit(250);
+
+    check(!has(library, "e"));
+    check(has(library, "f"));
+    check(has(library, "g"));
+
+    // The number of items is bounded too.
+    library.setMemoryLimit(0);
+    library.setLimit(1);
+    check(!has(library, "f"));
+    check(has(library, "g"));
+
+    return 0;
+}
@@ -0,0 +1,98 @@
+//
+//   Copyright (C) 2012 Free Software Foundation, Inc.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifdef HAVE_CONFIG_H
+#include "gnashconfig.h"
+#endif
+
+#include "ShapeRecord.h"
+#include "FillStyle.h"
+#include "LineStyle.h"
+#include "Geometry.h"
+#include "RGBA.h"
+
+#include "check.h"
+
+using namespace gnash;
+using gnash::SWF::ShapeRecord;
+using gnash::SWF::Subshape;
+
+TestState runtest;
+
+namespace {
+
+/// A square filled with a color.
+Subshape
+square(std::int32_t size, const rgba& color)
+{
+    Subshape sub;
+    sub.addFillStyle(FillStyle(SolidFill(color)));
+    Path p(0, 0, 1, 0, 0);
+    p.drawLineTo(size, 0);
+    p.drawLineTo(size, size);
+    p.drawLineTo(0, size);
+    p.close();
+    sub.addPath(p);
+    return sub;
+}
+
+} // anonymous namespace
+
+int
+main(int /*argc*/, char** /*argv*/)
+{
+    const rgba red(255, 0, 0, 255);
+
+    ShapeRecord shape;
+    const std::uint64_t empty = shape.contentHash();
+
+    shape.addSubshape(square(100, red));
+    const std::uint64_t hash = shape.contentHash();
+    check(hash != empty);
+
+    // Copies and shapes built the same way have the same hash.
+    const ShapeRecord copy = shape;
+    check_equals(copy.contentHash(), hash);
+
+    ShapeRecord same;
+    same.addSubshape(square(100, red));
+    check_equals(same.contentHash(), hash);
+
+    // Other paths, styles or subshapes change it.
+    ShapeRecord bigger;
+    bigger.addSubshape(square(200, red));
+    check(bigger.contentHash() != hash);
+
+    ShapeRecord blue;
+    blue.addSubshape(square(100, rgba(0, 0, 255, 255)));
+    check(blue.contentHash() != hash);
+
+    Subshape outlined = square(100, red);
+    outlined.addLineStyle(LineStyle(20, red));
+    ShapeRecord lines;
+    lines.addSubshape(outlined);
+    check(lines.contentHash() != hash);
+
+    shape.addSubshape(square(100, red));
+    check(shape.contentHash() != hash);
+
+    // Clearing a shape makes it empty again.
+    shape.clear();
+    check_equals(shape.contentHash(), empty);
+
+    return 0;
+}
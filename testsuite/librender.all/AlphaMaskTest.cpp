@@ -0,0 +1,119 @@
+//
+//   Copyright (C) 2012 Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifdef HAVE_CONFIG_H
+#include "gnashconfig.h"
+#endif
+
+#include "check.h"
+#include "RenderTestUtils.h"
+
+#include "AlphaMask.h"
+
+#include <vector>
+#include <cstdint>
+
+using namespace gnash;
+using gnash::test::rectangle;
+
+TestState runtest;
+
+namespace {
+
+/// Coverage of a span of fully covered pixels.
+std::vector<std::uint8_t>
+span(const AlphaMask& mask, int x, int y, int count)
+{
+    std::vector<std::uint8_t> covers(count, 255);
+    mask.combine_hspan(x, y, &covers.front(), count);
+    return covers;
+}
+
+} // anonymous namespace
+
+int
+main(int /*argc*/, char** /*argv*/)
+{
+    typedef geometry::Range2d<int> Bounds;
+
+    // Rectangles of whole pixels are found, whichever way they are drawn.
+    Bounds rect;
+    check(pixelRectangle(rectangle(200, 100, 400, 60), rect));
+    check_equals(rect, Bounds(10, 5, 29, 7));
+    check(pixelRectangle(rectangle(600, 160, -400, -60), rect));
+    check_equals(rect, Bounds(10, 5, 29, 7));
+
+    check(!pixelRectangle(rectangle(210, 100, 400, 60), rect));
+    check(!pixelRectangle(std::vector<Path>(), rect));
+
+    std::vector<Path> skewed = rectangle(200, 100, 400, 60);
+    skewed[0].m_edges[1].ap.x += 20;
+    skewed[0].m_edges[2].ap.x += 20;
+    check(!pixelRectangle(skewed, rect));
+
+    std::vector<Path> two = rectangle(0, 0, 20, 20);
+    two.push_back(two.front());
+    check(!pixelRectangle(two, rect));
+
+    // Paths touch the pixels holding any of their points.
+    check_equals(pathBounds(rectangle(210, 100, 400, 60)),
+            Bounds(10, 5, 30, 8));
+    check_equals(pathBounds(rectangle(-10, -30, 20, 20)),
+            Bounds(-1, -2, 0, -1));
+    check(pathBounds(std::vector<Path>()).isNull());
+
+    // Rectangular masks cover their pixels fully, and nothing else.
+    AlphaMask mask;
+    check(span(mask, 0, 0, 4) == std::vector<std::uint8_t>(4, 0));
+
+    mask.setRectangle(Bounds(10, 5, 29, 7));
+    check(mask.rectangular());
+    check(!mask.buffer());
+    std::vector<std::uint8_t> covers = span(mask, 8, 6, 4);
+    check_equals(static_cast<int>(covers[1]), 0);
+    check_equals(static_cast<int>(covers[2]), 255);
+    check(span(mask, 8, 4, 4) == std::vector<std::uint8_t>(4, 0));
+    check(span(mask, 30, 6, 4) == std::vector<std::uint8_t>(4, 0));
+
+    // Buffered masks keep coverage values over their bounds only.
+    AlphaMask buffered;
+    buffered.setBuffer(Bounds(20, 6, 39, 6));
+    check(!buffered.rectangular());
+    check_equals(buffered.stride(), 20u);
+    buffered.buffer()[0] = 255;
+    buffered.buffer()[1] = 128;
+    buffered.buffer()[2] = 255;
+    covers = span(buffered, 19, 6, 4);
+    check_equals(static_cast<int>(covers[0]), 0);
+    check_equals(static_cast<int>(covers[1]), 255);
+    check_equals(static_cast<int>(covers[2]), 128);
+    check_equals(static_cast<int>(covers[3]), 255);
+
+    // Intersections keep what both masks cover.
+    buffered.buffer()[15] = 255;
+    buffered.intersect(mask);
+    check_equals(static_cast<int>(span(buffered, 35, 6, 1)[0]), 0);
+    covers = span(buffered, 20, 6, 2);
+    check_equals(static_cast<int>(covers[1]), 128);
+
+    AlphaMask inner;
+    inner.setRectangle(Bounds(0, 0, 12, 12));
+    inner.intersect(mask);
+    check_equals(inner.bounds(), Bounds(10, 5, 12, 7));
+
+    return 0;
+}
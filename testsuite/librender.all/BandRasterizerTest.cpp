@@ -0,0 +1,238 @@
+//
+//   Copyright (C) 2012 Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifdef HAVE_CONFIG_H
+#include "gnashconfig.h"
+#endif
+
+#include "check.h"
+
+#include "BandRasterizer.h"
+
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wshadow"
+#include <agg_rendering_buffer.h>
+#include <agg_pixfmt_rgba.h>
+#include <agg_renderer_base.h>
+#include <agg_renderer_scanline.h>
+#include <agg_rasterizer_compound_aa.h>
+#include <agg_rasterizer_sl_clip.h>
+#include <agg_scanline_u.h>
+#include <agg_span_allocator.h>
+#include <agg_path_storage.h>
+#include <agg_conv_curve.h>
+#pragma GCC diagnostic pop
+
+using namespace gnash;
+
+TestState runtest;
+
+namespace {
+
+typedef agg::pixfmt_rgba32_pre PixelFormat;
+typedef agg::renderer_base<PixelFormat> BaseRenderer;
+typedef agg::rasterizer_compound_aa<agg::rasterizer_sl_clip_int> Rasterizer;
+
+const int size = 200;
+
+/// A solid style, and one whose color depends on the pixel.
+class Styles
+{
+public:
+
+    bool is_solid(unsigned style) const {
+        return style == 0;
+    }
+
+    agg::rgba8 color(unsigned /*style*/) const {
+        return agg::rgba8(200, 0, 0, 255);
+    }
+
+    void generate_span(agg::rgba8* span, int x, int y, unsigned len,
+            unsigned /*style*/) {
+        for (unsigned i = 0; i < len; ++i) {
+            span[i] = agg::rgba8((x + i) * 7 & 0xff, y * 5 & 0xff, 128, 200);
+            span[i].premultiply();
+        }
+    }
+};
+
+/// A disc with a slanted triangle over it, both with curved or
+/// slanted edges crossing every band.
+void
+addShape(agg::path_storage& disc, agg::path_storage& triangle)
+{
+    disc.move_to(100.3, 3.7);
+    disc.curve3(196.1, 4.2, 196.6, 100.1);
+    disc.curve3(195.9, 196.8, 100.4, 196.2);
+    disc.curve3(3.3, 195.7, 4.1, 99.9);
+    disc.curve3(3.8, 4.4, 100.3, 3.7);
+    disc.close_polygon();
+
+    triangle.move_to(20.25, 10.5);
+    triangle.line_to(180.75, 60.125);
+    triangle.line_to(60.5, 190.875);
+    triangle.close_polygon();
+}
+
+typedef BandFilter<agg::path_storage> Filter;
+
+/// Draw the shape, sweeping only the rows from top to bottom, and
+/// rasterizing only the edges reaching them.
+template<class R>
+void
+draw(R& ras, BaseRenderer& rbase, int top = 0, int bottom = size - 1)
+{
+    agg::path_storage disc;
+    agg::path_storage triangle;
+    addShape(disc, triangle);
+
+    ras.filling_rule(agg::fill_even_odd);
+    ras.clip_box(0, 0, size, size);
+
+    Filter discBand(disc, top, bottom);
+    agg::conv_curve<Filter> discCurve(discBand);
+    ras.styles(0, -1);
+    ras.add_path(discCurve);
+
+    Filter triangleBand(triangle, top, bottom);
+    agg::conv_curve<Filter> triangleCurve(triangleBand);
+    ras.styles(1, -1);
+    ras.add_path(triangleCurve);
+
+    agg::scanline_u8 sl;
+    agg::span_allocator<agg::rgba8> alloc;
+    Styles sh;
+    agg::render_scanlines_compound_layered(ras, sl, rbase, alloc, sh);
+}
+
+/// Draw the shape whole.
+std::vector<std::uint8_t>
+drawWhole()
+{
+    std::vector<std::uint8_t> buf(size * size * 4, 0);
+    agg::rendering_buffer rbuf(&buf.front(), size, size, size * 4);
+    PixelFormat pixf(rbuf);
+    BaseRenderer rbase(pixf);
+
+    Rasterizer ras;
+    draw(ras, rbase);
+    return buf;
+}
+
+/// Draw the shape in bands of some height, from the bottom one up.
+std::vector<std::uint8_t>
+drawBands(int height)
+{
+    std::vector<std::uint8_t> buf(size * size * 4, 0);
+    agg::rendering_buffer rbuf(&buf.front(), size, size, size * 4);
+    PixelFormat pixf(rbuf);
+
+    for (int top = (size - 1) / height * height; top >= 0; top -= height) {
+        const int bottom = std::min(top + height, size) - 1;
+        BaseRenderer rbase(pixf);
+        rbase.clip_box(0, top, size - 1, bottom);
+
+        BandRasterizer<Rasterizer> ras(top, bottom);
+        draw(ras, rbase, top, bottom);
+    }
+    return buf;
+}
+
+/// The number of lines and curves of a path a band keeps.
+size_t
+edges(agg::path_storage& path, int top, int bottom)
+{
+    Filter band(path, top, bottom);
+    band.rewind(0);
+    size_t count = 0;
+    double x, y;
+    unsigned cmd;
+    while (!agg::is_stop(cmd = band.vertex(&x, &y))) {
+        if (agg::is_vertex(cmd) && !agg::is_move_to(cmd)) ++count;
+    }
+    return count;
+}
+
+/// The number of pixels with some coverage.
+size_t
+drawn(const std::vector<std::uint8_t>& buf)
+{
+    size_t count = 0;
+    for (size_t i = 3; i < buf.size(); i += 4) {
+        if (buf[i]) ++count;
+    }
+    return count;
+}
+
+} // anonymous namespace
+
+int
+main(int /*argc*/, char** /*argv*/)
+{
+    const std::vector<std::uint8_t> whole = drawWhole();
+    check(drawn(whole) > size * size / 2);
+
+    // Bands of any height give the same pixels as drawing it whole.
+    check(drawBands(64) == whole);
+    check(drawBands(37) == whole);
+    check(drawBands(1) == whole);
+    check(drawBands(size) == whole);
+
+    // A band only writes its rows.
+    std::vector<std::uint8_t> buf(size * size * 4, 0);
+    agg::rendering_buffer rbuf(&buf.front(), size, size, size * 4);
+    PixelFormat pixf(rbuf);
+    BaseRenderer rbase(pixf);
+    rbase.clip_box(0, 50, size - 1, 99);
+    BandRasterizer<Rasterizer> ras(50, 99);
+    draw(ras, rbase, 50, 99);
+
+    const size_t row = size * 4;
+    check(std::memcmp(&buf[50 * row], &whole[50 * row], 50 * row) == 0);
+    check_equals(drawn(std::vector<std::uint8_t>(buf.begin(),
+                    buf.begin() + 50 * row)), 0u);
+    check_equals(drawn(std::vector<std::uint8_t>(buf.begin() + 100 * row,
+                    buf.end())), 0u);
+
+    // A band below the shape draws nothing.
+    std::vector<std::uint8_t> empty(size * size * 4, 0);
+    agg::rendering_buffer erbuf(&empty.front(), size, size, size * 4);
+    PixelFormat epixf(erbuf);
+    BaseRenderer erbase(epixf);
+    BandRasterizer<Rasterizer> below(size + 10, size + 20);
+    draw(below, erbase, size + 10, size + 20);
+    check_equals(drawn(empty), 0u);
+
+    // Bands leave out the edges that don't reach them, and close
+    // polygons with a line.
+    agg::path_storage disc;
+    agg::path_storage triangle;
+    addShape(disc, triangle);
+    check_equals(edges(disc, 0, size - 1), 9u);
+    check_equals(edges(disc, 0, 19), 5u);
+    check_equals(edges(disc, size + 10, size + 20), 0u);
+    check_equals(edges(triangle, 0, size - 1), 3u);
+    check_equals(edges(triangle, 100, 149), 2u);
+
+    return 0;
+}
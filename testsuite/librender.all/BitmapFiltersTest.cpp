@@ -0,0 +1,201 @@
+//
+//   Copyright (C) 2012 Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifdef HAVE_CONFIG_H
+#include "gnashconfig.h"
+#endif
+
+#include "check.h"
+#include "RenderTestUtils.h"
+
+#include "BitmapFilters.h"
+#include "GnashImage.h"
+#include "Filters.h"
+
+#include <vector>
+#include <cstdint>
+#include <cstdlib>
+#include <algorithm>
+
+using namespace gnash;
+using namespace gnash::simd;
+using gnash::test::random8;
+
+TestState runtest;
+
+namespace {
+
+/// Random premultiplied pixels, many of them transparent or opaque.
+std::vector<std::uint8_t>
+randomPixels(size_t count)
+{
+    std::vector<std::uint8_t> p(count * 4);
+    for (size_t i = 0; i < p.size(); i += 4) {
+        const int r = random8() % 4;
+        const std::uint8_t a = r == 0 ? 0 : r == 1 ? 255 : random8();
+        for (size_t c = 0; c < 3; ++c) p[i + c] = random8() * a / 255;
+        p[i + 3] = a;
+    }
+    return p;
+}
+
+/// Blur random images at a level and count those that differ from the
+/// scalar code.
+size_t
+compareBlur(Level level, size_t channels)
+{
+    size_t failures = 0;
+
+    for (size_t run = 0; run < 50; ++run) {
+        const size_t width = random8() % 70 + 1;
+        const size_t height = random8() % 70 + 1;
+        const unsigned rx = random8() % 40;
+        const unsigned ry = random8() % 40;
+        const unsigned passes = random8() % 3 + 1;
+
+        std::vector<std::uint8_t> expected(width * height * channels);
+        std::generate(expected.begin(), expected.end(), random8);
+        std::vector<std::uint8_t> actual(expected);
+
+        boxBlur(LEVEL_SCALAR, &expected.front(), width, height, channels,
+                rx, ry, passes);
+        boxBlur(level, &actual.front(), width, height, channels, rx, ry,
+                passes);
+
+        if (expected != actual) ++failures;
+    }
+    return failures;
+}
+
+/// An image with an opaque white square in the middle.
+std::unique_ptr<image::GnashImage>
+squareImage(size_t size, size_t margin)
+{
+    const size_t side = size + 2 * margin;
+    std::unique_ptr<image::GnashImage> im(new image::ImageRGBA(side, side));
+    std::fill(im->begin(), im->end(), 0);
+    for (size_t y = margin; y < margin + size; ++y) {
+        std::fill(scanline(*im, y) + margin * 4,
+                scanline(*im, y) + (margin + size) * 4, 255);
+    }
+    return im;
+}
+
+const std::uint8_t*
+pixel(const image::GnashImage& im, size_t x, size_t y)
+{
+    return scanline(im, y) + x * 4;
+}
+
+} // anonymous namespace
+
+int
+main(int /*argc*/, char** /*argv*/)
+{
+    const Level best = bestLevel();
+
+    // Every level blurs exactly like the scalar code.
+    for (int l = LEVEL_SSE2; l <= best; ++l) {
+        const Level level = static_cast<Level>(l);
+        check_equals(compareBlur(level, 1), 0u);
+        check_equals(compareBlur(level, 4), 0u);
+    }
+
+    check_equals(blurRadius(4, 1), 2u);
+    check_equals(blurRadius(4, 2), 4u);
+    check_equals(blurRadius(1, 1), 0u);
+    check_equals(blurRadius(0, 10), 0u);
+
+    // A blurred dot spreads evenly, and keeps its weight.
+    std::vector<std::uint8_t> dot(21 * 21);
+    dot[10 * 21 + 10] = 255;
+    boxBlur(best, &dot.front(), 21, 21, 1, 1, 1, 1);
+    check_equals(static_cast<int>(dot[10 * 21 + 10]), 28);
+    check_equals(static_cast<int>(dot[9 * 21 + 9]), 28);
+    check_equals(static_cast<int>(dot[11 * 21 + 12]), 0);
+    check_equals(static_cast<int>(dot[8 * 21 + 10]), 0);
+
+    // Radii larger than the image only spread what is there.
+    std::vector<std::uint8_t> tiny(3, 255);
+    boxBlur(best, &tiny.front(), 3, 1, 1, 10, 0, 1);
+    check_equals(static_cast<int>(tiny[0]), 36);
+
+    // The identity matrix changes nothing; other matrices give the same
+    // colors at every level, give or take one.
+    const float identity[20] = { 1, 0, 0, 0, 0, 0, 1, 0, 0, 0,
+        0, 0, 1, 0, 0, 0, 0, 0, 1, 0 };
+    const float sepia[20] = { 0.393f, 0.769f, 0.189f, 0, 0,
+        0.349f, 0.686f, 0.168f, 0, 0, 0.272f, 0.534f, 0.131f, 0, 0,
+        0, 0, 0, 0.5f, 20 };
+
+    const std::vector<std::uint8_t> original = randomPixels(1000);
+    for (int l = LEVEL_SCALAR; l <= best; ++l) {
+        const Level level = static_cast<Level>(l);
+        std::vector<std::uint8_t> p(original);
+        colorMatrix(level, &p.front(), 1000, identity);
+        check(p == original);
+    }
+
+    std::vector<std::uint8_t> expected(original);
+    colorMatrix(LEVEL_SCALAR, &expected.front(), 1000, sepia);
+    for (int l = LEVEL_SSE2; l <= best; ++l) {
+        std::vector<std::uint8_t> p(original);
+        colorMatrix(static_cast<Level>(l), &p.front(), 1000, sepia);
+        int most = 0;
+        bool premultiplied = true;
+        for (size_t i = 0; i < p.size(); ++i) {
+            most = std::max(most, std::abs(p[i] - expected[i]));
+            if (i % 4 != 3 && p[i] > p[i - i % 4 + 3]) premultiplied = false;
+        }
+        check(most <= 1);
+        check(premultiplied);
+    }
+
+    // A red glow outside a white square.
+    Filters glow;
+    glow.emplace_back(new GlowFilter(0xff0000, 255, 4, 4, 1, 1, false,
+                false));
+    std::unique_ptr<image::GnashImage> im = squareImage(10, 5);
+    applyFilters(best, *im, glow, 1, 1);
+    check_equals(static_cast<int>(pixel(*im, 10, 10)[1]), 255);
+    check(pixel(*im, 4, 10)[3] > 0);
+    check_equals(pixel(*im, 4, 10)[0], pixel(*im, 4, 10)[3]);
+    check_equals(static_cast<int>(pixel(*im, 4, 10)[1]), 0);
+    check_equals(static_cast<int>(pixel(*im, 0, 0)[3]), 0);
+
+    // Knocked out, the square is gone but its glow is left.
+    glow.front().reset(new GlowFilter(0xff0000, 255, 4, 4, 1, 1, false,
+                true));
+    im = squareImage(10, 5);
+    applyFilters(best, *im, glow, 1, 1);
+    check_equals(static_cast<int>(pixel(*im, 10, 10)[3]), 0);
+    check(pixel(*im, 4, 10)[3] > 0);
+
+    // A drop shadow down and to the right, twice as far at twice the
+    // scale. The shadow alone is left when the object is hidden.
+    Filters shadow;
+    shadow.emplace_back(new DropShadowFilter(2, 0.7853982f, 0, 255, 0, 0,
+                1, 1, false, false, true));
+    im = squareImage(10, 10);
+    applyFilters(best, *im, shadow, 2, 2);
+    check_equals(static_cast<int>(pixel(*im, 10, 10)[3]), 0);
+    check_equals(static_cast<int>(pixel(*im, 22, 22)[3]), 255);
+    check_equals(static_cast<int>(pixel(*im, 22, 22)[0]), 0);
+    check_equals(static_cast<int>(pixel(*im, 23, 23)[3]), 0);
+
+    return 0;
+}
@@ -0,0 +1,209 @@
+//
+//   Copyright (C) 2012 Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifdef HAVE_CONFIG_H
+#include "gnashconfig.h"
+#endif
+
+#include "check.h"
+
+#include "CommandBuffer.h"
+#include "swf/ShapeRecord.h"
+#include "SWFRect.h"
+#include "RGBA.h"
+#include "Transform.h"
+
+#include <vector>
+
+using namespace gnash;
+
+TestState runtest;
+
+namespace {
+
+typedef geometry::Range2d<std::int32_t> Range;
+
+/// The corners of a square.
+std::vector<point>
+corners(std::int32_t x, std::int32_t y, std::int32_t size)
+{
+    std::vector<point> corners;
+    corners.push_back(point(x, y));
+    corners.push_back(point(x + size, y));
+    corners.push_back(point(x + size, y + size));
+    corners.push_back(point(x, y + size));
+    return corners;
+}
+
+void
+addSquare(CommandBuffer& b, std::int32_t x, std::int32_t y,
+        const rgba& color = rgba(255, 0, 0, 255))
+{
+    b.addPolygon(corners(x, y, 100), color, color, SWFMatrix(), false);
+}
+
+InvalidatedRanges
+ranges(const Range& r)
+{
+    InvalidatedRanges ranges;
+    ranges.add(r);
+    return ranges;
+}
+
+InvalidatedRanges
+world()
+{
+    InvalidatedRanges ranges;
+    ranges.setWorld();
+    return ranges;
+}
+
+/// Record a frame drawn to a region, and find what needs drawing.
+InvalidatedRanges
+draw(CommandBuffer& drawn, CommandBuffer& frame, const InvalidatedRanges& r)
+{
+    InvalidatedRanges damage;
+    frame.damage(drawn, r, damage);
+    frame.retain(drawn, r);
+    drawn.swap(frame);
+    frame.clear();
+    return damage;
+}
+
+} // anonymous namespace
+
+int
+main(int /*argc*/, char** /*argv*/)
+{
+    CommandBuffer drawn;
+    CommandBuffer frame;
+
+    // Until the whole stage is drawn, everything changed needs drawing.
+    addSquare(frame, 0, 0);
+    addSquare(frame, 1000, 0);
+    const InvalidatedRanges left = ranges(Range(0, 0, 500, 500));
+    check_equals(draw(drawn, frame, left).getFullArea(),
+            Range(0, 0, 500, 500));
+    check(!drawn.complete());
+
+    addSquare(frame, 0, 0);
+    addSquare(frame, 1000, 0);
+    check(draw(drawn, frame, world()).isWorld());
+    check(drawn.complete());
+    check_equals(drawn.size(), 2u);
+
+    // The same frame needs no drawing.
+    addSquare(frame, 0, 0);
+    addSquare(frame, 1000, 0);
+    check(draw(drawn, frame, world()).isNull());
+
+    // Only the old and new places of a moved square need drawing.
+    addSquare(frame, 200, 0);
+    check_equals(draw(drawn, frame, left).getFullArea(),
+            Range(0, 0, 300, 100));
+    check_equals(drawn.size(), 2u);
+
+    // Commands outside the region are kept, so the square on the right can
+    // be found gone later.
+    const InvalidatedRanges right = ranges(Range(900, 0, 1500, 500));
+    check_equals(draw(drawn, frame, right).getFullArea(),
+            Range(1000, 0, 1100, 100));
+    check_equals(drawn.size(), 1u);
+
+    // A change of color is a change too.
+    addSquare(frame, 200, 0, rgba(0, 255, 0, 255));
+    check_equals(draw(drawn, frame, left).getFullArea(),
+            Range(200, 0, 300, 100));
+
+    // Changing the order of overlapping squares draws both again.
+    addSquare(frame, 200, 0, rgba(0, 255, 0, 255));
+    addSquare(frame, 250, 0);
+    check_equals(draw(drawn, frame, left).getFullArea(),
+            Range(250, 0, 350, 100));
+
+    addSquare(frame, 250, 0);
+    addSquare(frame, 200, 0, rgba(0, 255, 0, 255));
+    check_equals(draw(drawn, frame, left).getFullArea(),
+            Range(200, 0, 350, 100));
+
+    // Video may change at any time.
+    SWFRect video(0, 400, 100, 500);
+    frame.addVideo(Transform(), video);
+    addSquare(frame, 250, 0);
+    addSquare(frame, 200, 0, rgba(0, 255, 0, 255));
+    check_equals(draw(drawn, frame, left).getFullArea(),
+            Range(0, 400, 100, 500));
+
+    // New masks change everything drawn.
+    frame.addVideo(Transform(), video);
+    frame.addMask(CommandBuffer::BEGIN_MASK);
+    addSquare(frame, 250, 0);
+    frame.addMask(CommandBuffer::END_MASK);
+    addSquare(frame, 200, 0, rgba(0, 255, 0, 255));
+    frame.addMask(CommandBuffer::DISABLE_MASK);
+    check_equals(draw(drawn, frame, left).getFullArea(),
+            Range(0, 0, 500, 500));
+
+    // A green square over a red one.
+    CommandBuffer shown;
+    addSquare(frame, 0, 0);
+    addSquare(frame, 50, 0, rgba(0, 255, 0, 255));
+    check(draw(shown, frame, world()).isWorld());
+
+    // Drawing only the red one again keeps the green one, but before it.
+    addSquare(frame, 0, 0);
+    check(draw(shown, frame, ranges(Range(0, 0, 40, 40))).isNull());
+    check_equals(shown.size(), 2u);
+
+    // So swapping their depths must not look like no change.
+    addSquare(frame, 50, 0, rgba(0, 255, 0, 255));
+    addSquare(frame, 0, 0);
+    check_equals(draw(shown, frame, ranges(Range(0, 0, 150, 100)))
+            .getFullArea(), Range(50, 0, 150, 100));
+
+    // Both were drawn again, so their order is known again.
+    addSquare(frame, 50, 0, rgba(0, 255, 0, 255));
+    addSquare(frame, 0, 0);
+    check(draw(shown, frame, world()).isNull());
+
+    // Shapes with the same checksum are still told apart.
+    SWF::ShapeRecord one;
+    one.setBounds(SWFRect(0, 0, 100, 100));
+    const SWF::ShapeRecord two(one);
+    check_equals(one.contentHash(), two.contentHash());
+
+    CommandBuffer shapes;
+    frame.addShape(one, Transform());
+    check(draw(shapes, frame, world()).isWorld());
+    frame.addShape(one, Transform());
+    check(draw(shapes, frame, world()).isNull());
+    frame.addShape(two, Transform());
+    check_equals(draw(shapes, frame, world()).getFullArea(),
+            Range(0, 0, 100, 100));
+
+    // And glyphs by their color.
+    frame.addGlyph(two, rgba(255, 0, 0, 255), SWFMatrix());
+    check_equals(draw(shapes, frame, world()).getFullArea(),
+            Range(0, 0, 100, 100));
+    frame.addGlyph(two, rgba(255, 0, 0, 255), SWFMatrix());
+    check(draw(shapes, frame, world()).isNull());
+    frame.addGlyph(two, rgba(0, 0, 255, 255), SWFMatrix());
+    check_equals(draw(shapes, frame, world()).getFullArea(),
+            Range(0, 0, 100, 100));
+
+    return 0;
+}
@@ -0,0 +1,354 @@
+//
+//   Copyright (C) 2012 Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifdef HAVE_CONFIG_H
+#include "gnashconfig.h"
+#endif
+
+#include "check.h"
+
+#include "DisplaySnapshot.h"
+#include "RenderThread.h"
+#include "Renderer.h"
+#include "CachedBitmap.h"
+#include "GnashImage.h"
+#include "swf/ShapeRecord.h"
+#include "SWFRect.h"
+#include "RGBA.h"
+#include "Transform.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace gnash;
+
+TestState runtest;
+
+namespace {
+
+typedef std::vector<std::string> Buffer;
+
+class TestBitmap : public CachedBitmap
+{
+public:
+    explicit TestBitmap(std::unique_ptr<image::GnashImage> im)
+        :
+        _image(std::move(im))
+    {}
+
+    virtual image::GnashImage& image() { return *_image; }
+    virtual void dispose() { _image.reset(); }
+    virtual bool disposed() const { return !_image.get(); }
+
+private:
+    std::unique_ptr<image::GnashImage> _image;
+};
+
+/// A Renderer writing what is drawn to a buffer, as those GUIs use.
+//
+/// Shapes can be held back, to draw them in the background for as long
+/// as a test needs.
+class TestRenderer : public Renderer
+{
+public:
+
+    TestRenderer()
+        :
+        buffer(new Buffer),
+        bitmaps(0),
+        _open(true)
+    {}
+
+    /// Replace the buffer, as GUIs do when their window is resized.
+    void resize() {
+        sync();
+        freed.reset(buffer.release());
+        buffer.reset(new Buffer);
+    }
+
+    /// Make shapes wait until open() is called.
+    void close() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _open = false;
+    }
+
+    void open() {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _open = true;
+        }
+        _opened.notify_all();
+    }
+
+    virtual std::string description() const { return "Test"; }
+
+    virtual bool supportsBackgroundDrawing() const { return true; }
+
+    virtual CachedBitmap* createCachedBitmap(
+            std::unique_ptr<image::GnashImage> im) {
+        ++bitmaps;
+        return new TestBitmap(std::move(im));
+    }
+
+    virtual void drawVideoFrame(image::GnashImage* frame, const Transform&,
+            const SWFRect*, bool) {
+        std::ostringstream s;
+        s << "video " << static_cast<int>(*frame->begin());
+        buffer->push_back(s.str());
+    }
+
+    virtual void drawLine(const std::vector<point>&, const rgba&,
+            const SWFMatrix&) {
+        buffer->push_back("line");
+    }
+
+    virtual void draw_poly(const std::vector<point>&, const rgba&,
+            const rgba&, const SWFMatrix&, bool) {
+        buffer->push_back("poly");
+    }
+
+    virtual void drawShape(const SWF::ShapeRecord& shape, const Transform&) {
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _opened.wait(lock, [this] { return _open; });
+        }
+        std::ostringstream s;
+        s << "shape " << shape.getBounds().width();
+        buffer->push_back(s.str());
+    }
+
+    virtual void drawGlyph(const SWF::ShapeRecord& rec, const rgba&,
+            const SWFMatrix&) {
+        std::ostringstream s;
+        s << "glyph " << rec.getBounds().width();
+        buffer->push_back(s.str());
+    }
+
+    virtual void begin_submit_mask() { buffer->push_back("begin mask"); }
+    virtual void end_submit_mask() { buffer->push_back("end mask"); }
+    virtual void disable_mask() { buffer->push_back("disable mask"); }
+
+    virtual geometry::Range2d<int> world_to_pixel(const SWFRect& b) const {
+        return geometry::Range2d<int>(b.get_x_min() / 20, b.get_y_min() / 20,
+                b.get_x_max() / 20, b.get_y_max() / 20);
+    }
+
+    virtual point pixel_to_world(int x, int y) const {
+        return point(x * 20, y * 20);
+    }
+
+    virtual void begin_display(const rgba&, int, int, float, float, float,
+            float) {
+        buffer->push_back("begin");
+    }
+
+    virtual void end_display() { buffer->push_back("end"); }
+
+    virtual Renderer* startInternalRender(image::GnashImage&) {
+        return this;
+    }
+
+    virtual void endInternalRender() {}
+
+    /// Where frames are drawn.
+    std::unique_ptr<Buffer> buffer;
+
+    /// The buffer replaced last.
+    std::unique_ptr<Buffer> freed;
+
+    /// The number of images created.
+    size_t bitmaps;
+
+private:
+    std::mutex _mutex;
+    std::condition_variable _opened;
+    bool _open;
+};
+
+/// A shape record of some width.
+SWF::ShapeRecord
+shape(std::int32_t width)
+{
+    SWF::ShapeRecord s;
+    s.setBounds(SWFRect(0, 0, width, 100));
+    return s;
+}
+
+std::vector<point>
+corners()
+{
+    std::vector<point> corners;
+    corners.push_back(point(0, 0));
+    corners.push_back(point(100, 0));
+    corners.push_back(point(100, 100));
+    return corners;
+}
+
+/// Record a frame with a shape of some width.
+std::unique_ptr<DisplaySnapshot>
+frame(TestRenderer& r, std::int32_t width)
+{
+    std::unique_ptr<DisplaySnapshot> s(new DisplaySnapshot(r));
+    Renderer::External ex(*s, rgba());
+    s->drawShape(shape(width), Transform());
+    return s;
+}
+
+std::string
+join(const Buffer& b)
+{
+    std::string s;
+    for (const std::string& e : b) {
+        if (!s.empty()) s += ", ";
+        s += e;
+    }
+    return s;
+}
+
+} // anonymous namespace
+
+int
+main(int /*argc*/, char** /*argv*/)
+{
+    TestRenderer r;
+
+    // Nothing is drawn from a snapshot that wasn't displayed.
+    {
+        DisplaySnapshot s(r);
+        s.drawShape(shape(10), Transform());
+        s.replay(r);
+        check(r.buffer->empty());
+    }
+
+    // A frame is drawn as it was recorded.
+    {
+        DisplaySnapshot s(r);
+        {
+            Renderer::External ex(s, rgba());
+            s.draw_poly(corners(), rgba(), rgba(), SWFMatrix(), false);
+            s.begin_submit_mask();
+            s.drawShape(shape(10), Transform());
+            s.end_submit_mask();
+            s.drawLine(corners(), rgba(), SWFMatrix());
+            s.drawGlyph(shape(20), rgba(), SWFMatrix());
+            s.disable_mask();
+        }
+        check_equals(s.commands().size(), 7u);
+        check(r.buffer->empty());
+
+        s.replay(r);
+        check_equals(join(*r.buffer), "begin, poly, begin mask, shape 10, "
+                "end mask, line, glyph 20, disable mask, end");
+        r.buffer->clear();
+    }
+
+    // Shapes and video frames are copied, so that the movie can change
+    // them before the frame is drawn.
+    {
+        SWF::ShapeRecord changing = shape(10);
+        image::ImageRGB video(2, 2);
+        *video.begin() = 1;
+
+        DisplaySnapshot copied(r);
+        DisplaySnapshot shared(r, false);
+        for (DisplaySnapshot* s : { &copied, &shared }) {
+            Renderer::External ex(*s, rgba());
+            s->drawShape(changing, Transform());
+            const SWFRect bounds(0, 0, 100, 100);
+            s->drawVideoFrame(&video, Transform(), &bounds, false);
+        }
+
+        changing.setBounds(SWFRect(0, 0, 30, 100));
+        *video.begin() = 2;
+
+        copied.replay(r);
+        check_equals(join(*r.buffer), "begin, shape 10, video 1, end");
+        r.buffer->clear();
+
+        shared.replay(r);
+        check_equals(join(*r.buffer), "begin, shape 30, video 2, end");
+        r.buffer->clear();
+    }
+
+    // Queries and bitmaps are handled by the target renderer.
+    {
+        DisplaySnapshot s(r);
+        check_equals(s.pixel_to_world(3, 4), point(60, 80));
+        check_equals(s.world_to_pixel(SWFRect(0, 0, 200, 400)),
+                geometry::Range2d<int>(0, 0, 10, 20));
+        std::unique_ptr<CachedBitmap> bm(s.createCachedBitmap(
+                    std::unique_ptr<image::GnashImage>(
+                        new image::ImageRGB(1, 1))));
+        check_equals(r.bitmaps, 1u);
+    }
+
+    // Frames are drawn in the background, in order, and waiting for them
+    // says whether one was drawn.
+    {
+        RenderThread t(r);
+        check(!t.wait());
+
+        t.draw(frame(r, 10));
+        t.draw(frame(r, 20));
+        check(t.wait());
+        check_equals(join(*r.buffer), "begin, shape 10, end, "
+                "begin, shape 20, end");
+        check(!t.wait());
+        r.buffer->clear();
+    }
+
+    // A frame still being drawn is finished when the thread stops.
+    {
+        std::unique_ptr<RenderThread> t(new RenderThread(r));
+        r.close();
+        t->draw(frame(r, 30));
+        std::thread opener([&r] {
+                std::this_thread::sleep_for(std::chrono::milliseconds(50));
+                r.open();
+            });
+        t.reset();
+        opener.join();
+        check_equals(join(*r.buffer), "begin, shape 30, end");
+        r.buffer->clear();
+    }
+
+    // A buffer replaced while a frame is drawn to it, as on resizing,
+    // gets the whole frame, and the new buffer none of it.
+    {
+        RenderThread t(r);
+        r.close();
+        t.draw(frame(r, 40));
+        std::thread opener([&r] {
+                std::this_thread::sleep_for(std::chrono::milliseconds(50));
+                r.open();
+            });
+        r.resize();
+        opener.join();
+
+        check_equals(join(*r.freed), "begin, shape 40, end");
+        check(r.buffer->empty());
+        check(t.wait());
+    }
+
+    return 0;
+}
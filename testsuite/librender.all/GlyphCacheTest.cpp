@@ -0,0 +1,105 @@
+//
+//   Copyright (C) 2012 Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifdef HAVE_CONFIG_H
+#include "gnashconfig.h"
+#endif
+
+#include "check.h"
+#include "RenderTestUtils.h"
+
+#include "GlyphCache.h"
+#include "SWFMatrix.h"
+
+#include <vector>
+
+using namespace gnash;
+using gnash::test::scaled;
+using gnash::test::square;
+
+TestState runtest;
+
+int
+main(int /*argc*/, char** /*argv*/)
+{
+    // Glyphs are found by the hashes of their shapes, and where they
+    // start within a pixel, to a quarter of it.
+    GlyphCache::Key key;
+    point origin;
+    check(GlyphCache::key(100, scaled(2, 2, 47, -47), key, origin));
+    check_equals(origin, point(2, -3));
+    check_equals(static_cast<int>(key.x), 1);
+    check_equals(static_cast<int>(key.y), 2);
+
+    GlyphCache::Key moved;
+    check(GlyphCache::key(100, scaled(2, 2, 1049, 13), moved, origin));
+    check_equals(origin, point(52, 0));
+    check(!(key < moved) && !(moved < key));
+
+    GlyphCache::Key other;
+    GlyphCache::key(120, scaled(2, 2, 47, -47), other, origin);
+    check(key < other || other < key);
+    GlyphCache::key(100, scaled(3, 3, 47, -47), other, origin);
+    check(key < other || other < key);
+
+    SWFMatrix rotated;
+    rotated.set_rotation(0.5);
+    check(!GlyphCache::key(100, rotated, other, origin));
+
+    // Glyphs are packed into rows of similar height.
+    const std::vector<Path> glyph = square(100);
+    GlyphCache cache(128);
+    check_equals(cache.maxSize(), 8);
+    check(!cache.find(key, glyph));
+    check(!cache.insert(key, glyph, 0, 0, 9, 2));
+
+    const GlyphCache::Glyph* g = cache.insert(key, glyph, -1, -2, 8, 7);
+    check(g);
+    check_equals(g->x, 0);
+    check_equals(g->y, 0);
+    check_equals(g->left, -1);
+    check_equals(g->top, -2);
+    check_equals(static_cast<int>(cache.row(*g, 6)[7]), 0);
+    cache.row(*g, 6)[7] = 255;
+    check(cache.find(key, glyph) == g);
+
+    // Other paths with the same hash are not confused with them.
+    check(!cache.find(key, square(120)));
+
+    g = cache.insert(other, glyph, 0, 0, 3, 5);
+    check_equals(g->x, 8);
+    check_equals(g->y, 0);
+
+    GlyphCache::key(140, scaled(2, 2, 47, -47), other, origin);
+    g = cache.insert(other, glyph, 0, 0, 3, 3);
+    check_equals(g->x, 0);
+    check_equals(g->y, 8);
+    check_equals(cache.size(), 3u);
+
+    // A full atlas is emptied.
+    for (int i = 0; i < 300; ++i) {
+        GlyphCache::key(200 + i, scaled(2, 2, 0, 0), other, origin);
+        cache.insert(other, glyph, 0, 0, 8, 8);
+    }
+    check(!cache.find(key, glyph));
+    check(cache.size() < 300u);
+
+    cache.clear();
+    check_equals(cache.size(), 0u);
+
+    return 0;
+}
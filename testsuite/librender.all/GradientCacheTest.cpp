@@ -0,0 +1,111 @@
+//
+//   Copyright (C) 2012 Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifdef HAVE_CONFIG_H
+#include "gnashconfig.h"
+#endif
+
+#include "check.h"
+
+#include "GradientCache.h"
+#include "FillStyle.h"
+#include "SWFCxForm.h"
+#include "SWFMatrix.h"
+#include "RGBA.h"
+
+using namespace gnash;
+
+TestState runtest;
+
+namespace {
+
+GradientFill
+makeGradient(const rgba& from, const rgba& to)
+{
+    GradientFill::GradientRecords recs;
+    recs.push_back(GradientRecord(0, from));
+    recs.push_back(GradientRecord(255, to));
+    return GradientFill(GradientFill::LINEAR, SWFMatrix(), recs);
+}
+
+bool
+sameColor(const agg::rgba8& c, int r, int g, int b, int a)
+{
+    return c.r == r && c.g == g && c.b == b && c.a == a;
+}
+
+} // anonymous namespace
+
+int
+main(int /*argc*/, char** /*argv*/)
+{
+    GradientCache cache(2);
+    const SWFCxForm identity;
+
+    const GradientFill black = makeGradient(rgba(0, 0, 0, 255),
+            rgba(255, 255, 255, 255));
+
+    std::shared_ptr<const GradientCache::Lut> a = cache.get(black, identity);
+    check(sameColor((*a)[0], 0, 0, 0, 255));
+    check((*a)[255].r > 250);
+
+    // The same gradient is looked up, not built again.
+    check_equals(cache.get(black, identity), a);
+    check_equals(cache.size(), 1u);
+
+    // A color transform gives different colors...
+    SWFCxForm red;
+    red.ga = 0;
+    red.ba = 0;
+    std::shared_ptr<const GradientCache::Lut> b = cache.get(black, red);
+    check(b != a);
+    check((*b)[255].r > 250);
+    check_equals((*b)[255].g, 0);
+
+    // ...unless the gradient looks the same afterwards.
+    const GradientFill redOnly = makeGradient(rgba(0, 0, 0, 255),
+            rgba(255, 0, 0, 255));
+    check_equals(cache.get(redOnly, identity), b);
+    check_equals(cache.size(), 2u);
+
+    // The interpolation mode changes the colors between the records.
+    GradientFill linear = black;
+    linear.interpolation = GradientFill::LINEAR_RGB;
+    std::shared_ptr<const GradientCache::Lut> c = cache.get(linear, identity);
+    check(c != a);
+    check((*c)[128].r != (*a)[128].r);
+
+    // Only two tables are kept, and the least recently used went.
+    check_equals(cache.size(), 2u);
+    check(cache.get(black, identity) != a);
+
+    // A dropped table can still be used by whoever holds it.
+    check(sameColor((*a)[0], 0, 0, 0, 255));
+
+    // Transparent colors are premultiplied.
+    const GradientFill faded = makeGradient(rgba(255, 255, 255, 128),
+            rgba(255, 255, 255, 0));
+    std::shared_ptr<const GradientCache::Lut> d = cache.get(faded, identity);
+    check(sameColor((*d)[0], 128, 128, 128, 128));
+    bool premultiplied = true;
+    for (const agg::rgba8& col : *d) {
+        if (col.r > col.a) premultiplied = false;
+    }
+    check(premultiplied);
+
+    return 0;
+}
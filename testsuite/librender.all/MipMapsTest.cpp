@@ -0,0 +1,118 @@
+//
+//   Copyright (C) 2012 Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifdef HAVE_CONFIG_H
+#include "gnashconfig.h"
+#endif
+
+#include "check.h"
+#include "RenderTestUtils.h"
+
+#include "MipMaps.h"
+#include "GnashImage.h"
+#include "SWFMatrix.h"
+
+#include <memory>
+
+using namespace gnash;
+using gnash::test::scaled;
+
+TestState runtest;
+
+namespace {
+
+/// The red value of a pixel.
+int
+red(const image::GnashImage& im, size_t x, size_t y)
+{
+    return image::scanline(im, y)[x * im.channels()];
+}
+
+} // anonymous namespace
+
+int
+main(int /*argc*/, char** /*argv*/)
+{
+    // Bitmaps are halved as often as both axes allow.
+    check_equals(mipLevel(SWFMatrix()), 0u);
+    check_equals(mipLevel(scaled(1.9, 1.9)), 0u);
+    check_equals(mipLevel(scaled(2, 2)), 1u);
+    check_equals(mipLevel(scaled(8.5, 8)), 3u);
+    check_equals(mipLevel(scaled(16, 2)), 1u);
+    check_equals(mipLevel(scaled(0.25, 0.25)), 0u);
+
+    // Halving averages each square of four pixels, or keeps the first.
+    image::ImageRGBA im(3, 3);
+    for (size_t y = 0; y < 3; ++y) {
+        for (size_t x = 0; x < 3; ++x) {
+            im.setPixel(x, y, 10 * (y * 3 + x), 0, 0, 255);
+        }
+    }
+
+    std::unique_ptr<image::GnashImage> half = halve(im, true);
+    check_equals(half->width(), 2u);
+    check_equals(half->height(), 2u);
+    check_equals(half->type(), image::TYPE_RGBA);
+    check_equals(red(*half, 0, 0), 20);
+    check_equals(red(*half, 1, 0), 35);
+    check_equals(red(*half, 1, 1), 80);
+    check_equals(static_cast<int>(half->begin()[3]), 255);
+
+    half = halve(im, false);
+    check_equals(red(*half, 1, 0), 20);
+    check_equals(red(*half, 0, 1), 60);
+
+    image::ImageRGB rgb(1, 1);
+    check_equals(halve(rgb, true)->type(), image::TYPE_RGB);
+
+    // Bitmaps are drawn from the level of their size on screen, with the
+    // matrix to its pixels.
+    std::shared_ptr<image::GnashImage> base(new image::ImageRGBA(64, 32));
+    MipMaps mips;
+
+    SWFMatrix mat = scaled(1, 1);
+    check(mips.select(base, mat, true) == base);
+    check_equals(mips.memoryUsage(), 0u);
+
+    mat = scaled(4, 4);
+    std::shared_ptr<const image::GnashImage> level =
+        mips.select(base, mat, true);
+    check_equals(level->width(), 16u);
+    check_equals(level->height(), 8u);
+    check_equals(mat.get_x_scale(), 1.0);
+    check_equals(mat.get_y_scale(), 1.0);
+    check_equals(mips.memoryUsage(), (32u * 16 + 16 * 8) * 4);
+
+    // Levels are kept until the bitmap changes.
+    mat = scaled(4, 4);
+    check(mips.select(base, mat, true) == level);
+    mat = scaled(4, 4);
+    check(mips.select(base, mat, false) != level);
+
+    mips.clear();
+    check_equals(mips.memoryUsage(), 0u);
+    mat = scaled(4, 4);
+    check(mips.select(base, mat, true) != level);
+
+    // Nothing is smaller than a pixel.
+    mat = scaled(1024, 1024);
+    level = mips.select(base, mat, true);
+    check_equals(level->width(), 1u);
+    check_equals(level->height(), 1u);
+
+    return 0;
+}
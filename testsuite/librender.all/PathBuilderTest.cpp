@@ -0,0 +1,216 @@
+//
+//   Copyright (C) 2012 Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifdef HAVE_CONFIG_H
+#include "gnashconfig.h"
+#endif
+
+#include "check.h"
+#include "RenderTestUtils.h"
+
+#include "PathBuilder.h"
+#include "SWFRect.h"
+#include "SWFMatrix.h"
+
+#include <vector>
+#include <cmath>
+#include <utility>
+#include <algorithm>
+
+using namespace gnash;
+using gnash::test::rectangle;
+using gnash::test::scaled;
+
+TestState runtest;
+
+namespace {
+
+typedef std::vector<std::pair<double, double> > Polyline;
+
+/// The vertices of AGG paths, with curves flattened finely.
+Polyline
+flatten(const AggPaths& paths)
+{
+    Polyline line;
+    for (const agg::path_storage& p : paths) {
+        for (unsigned i = 0; i < p.total_vertices(); ++i) {
+            double x, y;
+            const unsigned cmd = p.vertex(i, &x, &y);
+            if (!agg::is_curve3(cmd) || line.empty()) {
+                line.push_back(std::make_pair(x, y));
+                continue;
+            }
+            double ax, ay;
+            p.vertex(++i, &ax, &ay);
+            const double x0 = line.back().first;
+            const double y0 = line.back().second;
+            for (int s = 1; s <= 16; ++s) {
+                const double t = s / 16.0;
+                const double u = 1 - t;
+                line.push_back(std::make_pair(
+                            u * u * x0 + 2 * u * t * x + t * t * ax,
+                            u * u * y0 + 2 * u * t * y + t * t * ay));
+            }
+        }
+    }
+    return line;
+}
+
+/// The distance of a point from the nearest segment of a polyline.
+double
+distance(const std::pair<double, double>& pt, const Polyline& line)
+{
+    double best = HUGE_VAL;
+    for (size_t i = 1; i < line.size(); ++i) {
+        const double ax = line[i - 1].first, ay = line[i - 1].second;
+        const double dx = line[i].first - ax, dy = line[i].second - ay;
+        const double len = dx * dx + dy * dy;
+        double t = len ? ((pt.first - ax) * dx + (pt.second - ay) * dy) / len
+            : 0;
+        t = clamp(t, 0.0, 1.0);
+        best = std::min(best, std::hypot(pt.first - (ax + t * dx),
+                    pt.second - (ay + t * dy)));
+    }
+    return best;
+}
+
+/// The furthest any point of a polyline is from another.
+double
+deviation(const Polyline& from, const Polyline& to)
+{
+    double worst = 0;
+    for (const auto& pt : from) worst = std::max(worst, distance(pt, to));
+    return worst;
+}
+
+size_t
+vertices(const AggPaths& paths)
+{
+    size_t count = 0;
+    for (const agg::path_storage& p : paths) count += p.total_vertices();
+    return count;
+}
+
+/// Build AGG paths as buildPaths() does, but with some tolerance.
+AggPaths
+build(const std::vector<Path>& paths, double tolerance)
+{
+    AggPaths dest(paths.size());
+    std::for_each(paths.begin(), paths.end(),
+            GnashToAggPath(dest, 0.05, tolerance));
+    return dest;
+}
+
+/// A circle of many short edges, and a line of curves, some nearly flat.
+std::vector<Path>
+dense()
+{
+    const double pi = 3.14159265358979323846;
+    const int steps = 400;
+    const std::int32_t r = 2000;
+
+    Path circle(r, 0, 1, 0, 0);
+    for (int i = 1; i <= steps; ++i) {
+        circle.drawLineTo(std::lround(r * std::cos(2 * pi * i / steps)),
+                std::lround(r * std::sin(2 * pi * i / steps)));
+    }
+
+    Path curves(0, 3000, 1, 0, 0);
+    for (int i = 1; i <= 40; ++i) {
+        curves.drawCurveTo(i * 100 - 50, 3000 + (i % 5 ? 20 : 600),
+                i * 100, 3000);
+    }
+    curves.drawLineTo(0, 3000);
+
+    std::vector<Path> paths;
+    paths.push_back(circle);
+    paths.push_back(curves);
+    return paths;
+}
+
+/// A shape drawn at 1:1 whose edges are all at least a pixel long.
+std::vector<Path>
+coarse()
+{
+    std::vector<Path> paths = rectangle(0, 0, 2000, 1000);
+
+    Path steps(0, 0, 1, 0, 0);
+    for (int i = 1; i <= 20; ++i) {
+        steps.drawLineTo(i * 20, (i - 1) * 20);
+        steps.drawLineTo(i * 20, i * 20);
+    }
+    steps.drawCurveTo(800, 0, 0, 0);
+    paths.push_back(steps);
+
+    Path round(3000, 0, 1, 0, 0);
+    round.drawCurveTo(4000, 0, 4000, 1000);
+    round.drawCurveTo(4000, 2000, 3000, 2000);
+    round.drawLineTo(3000, 0);
+    paths.push_back(round);
+
+    return paths;
+}
+
+} // anonymous namespace
+
+int
+main(int /*argc*/, char** /*argv*/)
+{
+    // Shapes drawn to less than a pixel each way aren't filled.
+    const SWFRect box(0, 0, 100, 100);
+    check(subpixelSize(box, scaled(0.04, 0.04)));
+    check(!subpixelSize(box, scaled(0.06, 0.06)));
+    check(!subpixelSize(box, SWFMatrix()));
+    check(subpixelSize(box, scaled(0.04, 0.04, 5000, 5000)));
+
+    // Not when one way is long, or they have no bounds.
+    check(!subpixelSize(SWFRect(0, 0, 100, 10000), scaled(0.04, 0.04)));
+    check(!subpixelSize(SWFRect(), scaled(0.04, 0.04)));
+
+    // Zoomed out, dense shapes lose vertices but stay within the
+    // tolerance of their outlines.
+    std::vector<Path> small = dense();
+    for (Path& p : small) p.transform(scaled(0.05, 0.05));
+
+    const AggPaths exact = build(small, 0);
+    const AggPaths simple = build(small, pathTolerance);
+    check(vertices(simple) < vertices(exact) * 2 / 3);
+
+    const Polyline exactLine = flatten(exact);
+    const Polyline simpleLine = flatten(simple);
+    check(deviation(exactLine, simpleLine) <= pathTolerance + 1e-9);
+    check(deviation(simpleLine, exactLine) <= pathTolerance + 1e-9);
+
+    // The paths still end where they did.
+    for (size_t i = 0; i < exact.size(); ++i) {
+        double ex, ey, sx, sy;
+        exact[i].vertex(exact[i].total_vertices() - 1, &ex, &ey);
+        simple[i].vertex(simple[i].total_vertices() - 1, &sx, &sy);
+        check_equals(ex, sx);
+        check_equals(ey, sy);
+    }
+
+    // Shapes whose edges are long enough are built as they were.
+    const std::vector<Path> large = coarse();
+    const AggPaths whole = build(large, 0);
+    AggPaths built;
+    buildPaths(built, large);
+    check_equals(vertices(built), vertices(whole));
+    check(flatten(built) == flatten(whole));
+
+    return 0;
+}
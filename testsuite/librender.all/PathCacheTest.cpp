@@ -0,0 +1,113 @@
+//
+//   Copyright (C) 2012 Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifdef HAVE_CONFIG_H
+#include "gnashconfig.h"
+#endif
+
+#include "check.h"
+#include "RenderTestUtils.h"
+
+#include "PathCache.h"
+#include "LineStyle.h"
+#include "SWFMatrix.h"
+
+using namespace gnash;
+using gnash::test::square;
+
+TestState runtest;
+
+namespace {
+
+/// Pretend the renderer converted the paths.
+void
+fill(PathCache& cache, ShapePaths& e, size_t vertices, PathCache::Use use)
+{
+    e.fills.resize(1);
+    for (size_t i = 0; i < vertices; ++i) e.fills[0].line_to(i, i);
+    e.haveFills = true;
+    cache.used(e, use);
+}
+
+} // anonymous namespace
+
+int
+main(int /*argc*/, char** /*argv*/)
+{
+    const std::vector<LineStyle> noLines;
+
+    PathCache cache(64 * 1024);
+
+    // The hashes the shapes would have.
+    const std::uint64_t smallHash = 100;
+    const std::uint64_t otherHash = 200;
+
+    const std::vector<Path> small = square(100);
+    SWFMatrix mat;
+    ShapePaths& e = cache.get(smallHash, small, noLines, mat);
+    check(!e.haveFills);
+    fill(cache, e, 4, PathCache::USE_BUILT);
+    check_equals(cache.uses(PathCache::USE_BUILT), 1u);
+
+    // Copies of the paths share the entry, wherever they are drawn.
+    const std::vector<Path> copy = square(100);
+    mat.set_translation(2000, 400);
+    check_equals(&cache.get(smallHash, copy, noLines, mat), &e);
+    check(e.haveFills);
+    cache.used(e, PathCache::USE_MOVED);
+    check_equals(cache.size(), 1u);
+
+    // Other paths or scales do not.
+    ShapePaths& other = cache.get(otherHash, square(200), noLines, mat);
+    check(&other != &e);
+    check(!other.haveFills);
+    fill(cache, other, 4, PathCache::USE_BUILT);
+    SWFMatrix scaled;
+    scaled.set_scale(2.0, 2.0);
+    check(&cache.get(smallHash, small, noLines, scaled) != &e);
+    cache.used(cache.get(smallHash, small, noLines, scaled),
+            PathCache::USE_BUILT);
+    check_equals(cache.size(), 3u);
+
+    // Other paths with the same hash are never drawn from the entry.
+    ShapePaths& collision = cache.get(smallHash, square(150), noLines, mat);
+    check(!collision.haveFills);
+    fill(cache, collision, 4, PathCache::USE_BUILT);
+    check_equals(cache.size(), 3u);
+    check(!cache.get(smallHash, small, noLines, mat).haveFills);
+    fill(cache, e, 4, PathCache::USE_BUILT);
+
+    // Line styles change outlines, so they are part of the key.
+    std::vector<LineStyle> lines(1);
+    ShapePaths& outlined = cache.get(smallHash, small, lines, mat);
+    check(!outlined.haveFills);
+    fill(cache, outlined, 4, PathCache::USE_BUILT);
+    check(cache.get(otherHash, square(200), noLines, mat).haveFills);
+    cache.used(other, PathCache::USE_HIT);
+
+    // The least recently used entries go when the budget is exceeded, but
+    // never the one just used.
+    ShapePaths& big = cache.get(300, square(300), noLines, mat);
+    fill(cache, big, 10000, PathCache::USE_BUILT);
+    check_equals(cache.size(), 1u);
+    check(cache.memory() > 64 * 1024u);
+    check(big.haveFills);
+
+    check(!cache.get(smallHash, small, noLines, SWFMatrix()).haveFills);
+
+    return 0;
+}
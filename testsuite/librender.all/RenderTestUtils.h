@@ -0,0 +1,72 @@
+// RenderTestUtils.h: helpers shared by the renderer tests.
+//
+//   Copyright (C) 2012 Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifndef GNASH_RENDERTESTUTILS_H
+#define GNASH_RENDERTESTUTILS_H
+
+#include <vector>
+#include <cstdint>
+
+#include "Geometry.h"
+#include "SWFMatrix.h"
+
+namespace gnash {
+namespace test {
+
+/// A random byte, the same sequence on every run.
+inline std::uint8_t
+random8()
+{
+    static unsigned int seed = 1;
+    seed = seed * 1103515245 + 12345;
+    return seed >> 16;
+}
+
+/// A rectangle in twips filled with the first fill style.
+inline std::vector<Path>
+rectangle(std::int32_t x, std::int32_t y, std::int32_t w, std::int32_t h)
+{
+    Path p(x, y, 1, 0, 0);
+    p.drawLineTo(x + w, y);
+    p.drawLineTo(x + w, y + h);
+    p.drawLineTo(x, y + h);
+    p.close();
+    return std::vector<Path>(1, p);
+}
+
+/// A square in twips at the origin filled with the first fill style.
+inline std::vector<Path>
+square(std::int32_t size)
+{
+    return rectangle(0, 0, size, size);
+}
+
+/// A matrix scaling and then moving.
+inline SWFMatrix
+scaled(double x, double y, std::int32_t tx = 0, std::int32_t ty = 0)
+{
+    SWFMatrix mat;
+    mat.set_scale(x, y);
+    mat.set_translation(tx, ty);
+    return mat;
+}
+
+} // namespace test
+} // namespace gnash
+
+#endif
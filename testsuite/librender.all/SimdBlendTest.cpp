@@ -0,0 +1,139 @@
+//
+//   Copyright (C) 2012 Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifdef HAVE_CONFIG_H
+#include "gnashconfig.h"
+#endif
+
+#include "check.h"
+#include "RenderTestUtils.h"
+
+#include "SimdBlend.h"
+
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include <agg_rendering_buffer.h>
+#include <agg_pixfmt_rgba.h>
+
+using namespace gnash;
+using namespace gnash::simd;
+using gnash::test::random8;
+
+TestState runtest;
+
+namespace {
+
+/// A premultiplied color, or sometimes one with a channel above its alpha.
+agg::rgba8
+randomColor(bool valid)
+{
+    const int r = random8() % 4;
+    const std::uint8_t a = r == 0 ? 0 : r == 1 ? 255 : random8();
+    if (!valid) return agg::rgba8(random8(), random8(), random8(), a);
+    return agg::rgba8(random8() * a / 255, random8() * a / 255,
+            random8() * a / 255, a);
+}
+
+std::uint8_t
+randomCover()
+{
+    const int r = random8() % 4;
+    return r == 0 ? 0 : r == 1 ? 255 : random8();
+}
+
+/// Blend random spans with AGG and with blendSpan at a level, and count
+/// the spans that differ.
+template<typename PixelFormat>
+size_t
+compare(Level level, Order order, bool valid)
+{
+    size_t failures = 0;
+
+    for (size_t run = 0; run < 2000; ++run) {
+
+        const unsigned len = random8() % 40 + 1;
+
+        std::vector<agg::int8u> expected(len * 4);
+        std::generate(expected.begin(), expected.end(), random8);
+        std::vector<agg::int8u> actual(expected);
+
+        std::vector<agg::rgba8> colors(len);
+        for (agg::rgba8& c : colors) c = randomColor(valid);
+
+        std::vector<agg::int8u> covers(len);
+        std::generate(covers.begin(), covers.end(), randomCover);
+        const agg::int8u cover = randomCover();
+
+        agg::rendering_buffer rb(&expected.front(), len, 1, len * 4);
+        PixelFormat pf(rb);
+        std::uint8_t* p = &actual.front();
+
+        switch (run % 4) {
+            case 0:
+                pf.blend_hline(0, 0, len, colors[0], cover);
+                blendSpan(level, order, p, len, &colors[0].r, true,
+                        nullptr, cover);
+                break;
+            case 1:
+                pf.blend_solid_hspan(0, 0, len, colors[0], &covers.front());
+                blendSpan(level, order, p, len, &colors[0].r, true,
+                        &covers.front(), 0);
+                break;
+            case 2:
+                pf.blend_color_hspan(0, 0, len, &colors.front(),
+                        &covers.front(), 0);
+                blendSpan(level, order, p, len, &colors.front().r, false,
+                        &covers.front(), 0);
+                break;
+            default:
+                pf.blend_color_hspan(0, 0, len, &colors.front(), nullptr,
+                        cover);
+                blendSpan(level, order, p, len, &colors.front().r, false,
+                        nullptr, cover);
+        }
+
+        if (expected != actual) ++failures;
+    }
+    return failures;
+}
+
+} // anonymous namespace
+
+int
+main(int /*argc*/, char** /*argv*/)
+{
+    const Level best = bestLevel();
+
+    // Every level the processor supports must blend exactly like AGG,
+    // including colors that are not properly premultiplied.
+    for (int l = LEVEL_SCALAR; l <= best; ++l) {
+        const Level level = static_cast<Level>(l);
+        for (int valid = 0; valid < 2; ++valid) {
+            check_equals(compare<agg::pixfmt_rgba32_pre>(level,
+                        ORDER_RGBA, valid), 0u);
+            check_equals(compare<agg::pixfmt_bgra32_pre>(level,
+                        ORDER_BGRA, valid), 0u);
+            check_equals(compare<agg::pixfmt_argb32_pre>(level,
+                        ORDER_ARGB, valid), 0u);
+            check_equals(compare<agg::pixfmt_abgr32_pre>(level,
+                        ORDER_ABGR, valid), 0u);
+        }
+    }
+
+    return 0;
+}
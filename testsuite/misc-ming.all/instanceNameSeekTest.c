@@ -0,0 +1,125 @@
+/*
+ *   Copyright (C) 2012 Free Software Foundation, Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+/*
+ * Test the names synthesized for unnamed sprites when jumping back to a
+ * frame far enough in the timeline to be restored from a snapshot of
+ * its first frames.
+ *
+ * Timeline:
+ *
+ *   Frame  | 1 | 2 | ... | 35 | 36 | 37 |
+ *  --------+---+---+-----+----+----+----+
+ *   Event  |   | PA|     | PB |RB PC| J  |
+ *
+ *  P = place (by PlaceObject2)
+ *  R = remove (by RemoveObject2)
+ *  J = jump back to frame 35
+ *
+ * Expected behaviour:
+ *
+ *  (1) A, placed before the snapshot and never removed, keeps its name.
+ *  (2) B is placed again, after a copy of A was created and discarded,
+ *      so it is named after the instance following C.
+ *  (3) C is removed.
+ */
+
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <ming.h>
+
+#include "ming_utils.h"
+
+#define OUTPUT_VERSION 7
+#define OUTPUT_FILENAME "instanceNameSeekTest.swf"
+
+
+int
+main(int argc, char** argv)
+{
+  SWFMovie mo;
+  SWFDisplayItem itA, itB, itC;
+  SWFMovieClip mcA, mcB, mcC, dejagnuclip;
+  const char *srcdir=".";
+  int i;
+
+  if ( argc>1 )
+    srcdir=argv[1];
+
+  Ming_init();
+  Ming_useSWFVersion (OUTPUT_VERSION);
+
+  mo = newSWFMovie();
+  SWFMovie_setDimension(mo, 800, 600);
+  SWFMovie_setRate(mo, 12);
+
+  dejagnuclip = get_dejagnu_clip((SWFBlock)get_default_font(srcdir), 10, 0, 0, 800, 600);
+  SWFMovie_add(mo, (SWFBlock)dejagnuclip);
+  add_actions(mo, " jumped=false;"
+                  " number = function(mc) {"
+                  "   return parseInt(mc._name.substr(8));"
+                  " };");
+  SWFMovie_nextFrame(mo); // frame 1
+
+  mcA = newSWFMovieClip();
+  SWFMovieClip_nextFrame(mcA);
+  mcB = newSWFMovieClip();
+  SWFMovieClip_nextFrame(mcB);
+  mcC = newSWFMovieClip();
+  SWFMovieClip_nextFrame(mcC);
+
+  itA = SWFMovie_add(mo, (SWFBlock)mcA);
+  SWFDisplayItem_setDepth(itA, 10);
+  add_actions(mo, " nameA = getInstanceAtDepth(-16374)._name;");
+  SWFMovie_nextFrame(mo); // frame 2
+
+  for (i = 3; i < 35; ++i) {
+    SWFMovie_nextFrame(mo);
+  }
+
+  itB = SWFMovie_add(mo, (SWFBlock)mcB);
+  SWFDisplayItem_setDepth(itB, 11);
+  add_actions(mo,
+        " if (jumped) {"
+        "   check_equals(getInstanceAtDepth(-16374)._name, nameA);"
+        "   check_equals(number(getInstanceAtDepth(-16373)), numberC + 2);"
+        "   check_equals(typeof(getInstanceAtDepth(-16372)), 'undefined');"
+        "   totals(4);"
+        "   stop();"
+        " }");
+  SWFMovie_nextFrame(mo); // frame 35
+
+  SWFDisplayItem_remove(itB);
+  itC = SWFMovie_add(mo, (SWFBlock)mcC);
+  SWFDisplayItem_setDepth(itC, 12);
+  SWFMovie_nextFrame(mo); // frame 36
+
+  add_actions(mo,
+        " numberC = number(getInstanceAtDepth(-16372));"
+        " check(numberC > number(getInstanceAtDepth(-16374)));"
+        " jumped = true;"
+        " gotoAndStop(35);");
+  SWFMovie_nextFrame(mo); // frame 37
+
+  //Output movie
+  puts("Saving " OUTPUT_FILENAME );
+  SWFMovie_save(mo, OUTPUT_FILENAME);
+
+  return 0;
+}